@@ -5,14 +5,76 @@
 #ifndef BISYM
 #define BISYM
 
-int bisym_size(int dim);
+#include <stdint.h>
+#include "workspace.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * Return index for the (i,j)th elements of a bisymmetric square matrix (fast; must have j <= i).
+ *
+ * \param[in]  i Row index.
+ * \param[in]  j Column index.
+ * \param[in]  dim Matrix dimension.
+ * \retval The index of the j-th element of the i-th row.
+ */
+static inline long bisym_ind(int i, int j, int dim){
+
+  // Rows below the middle one get shorter: remove (i-h)*(dim%2+i-h) from the naive count
+  const int h = dim / 2 + dim % 2;
+  if( i >= h )
+    return (long)i*(i+1)/2 + j - (long)(i - h) * ( dim % 2 + (i - h) );
+  else
+    return (long)i*(i+1)/2 + j;
+
+}
+
+long bisym_size(int dim);
 void bisym_alloc(double **mat, int dim);
-int bisym_ind(int i, int j, int dim);
+void bisym_alloc_ws(double **mat, int dim, workspace *ws);
 void bisym_full_random(double *mat, int dim);
-void bisym_full_extractcomp(double *matcomp, double *matfull, int dim);
-int bisym_assertequal(double *matcomp1, double *matcomp2, int dim);
-void bisym_print(double *mat, int dim);
-void bisym_product(double *outmat, double *mat1, double *mat2, int dim);
-int bisym_isvalid(double *mat, int dim);
+void bisym_random(double *mat, int dim, uint64_t seed, uint64_t stream);
+void bisym_full_extractcomp(double *matcomp, const double *matfull, int dim);
+void bisym_comp_expandfull(double *matfull, const double *matcomp, int dim);
+int bisym_assertequal(const double *matcomp1, const double *matcomp2, int dim);
+void bisym_print(const double *mat, int dim);
+void bisym_product(double *outmat, const double *mat1, const double *mat2, int dim);
+void bisym_product_ws(double *outmat, const double *mat1, const double *mat2, int dim, workspace *ws);
+int bisym_isvalid(const double *mat, int dim);
+double bisym_trace(const double *mat, int dim);
+double bisym_traceprod(const double *mat1, const double *mat2, int dim);
+double bisym_quadform(const double *x, const double *mat, const double *y, int dim);
+double bisym_quadform_ws(const double *x, const double *mat, const double *y, int dim, workspace *ws);
+void bisym_matvec(double *y, const double *mat, const double *x, int dim);
+void bisym_matvec_ws(double *y, const double *mat, const double *x, int dim, workspace *ws);
+void bisym_fold(double *matplus, double *matminus, const double *mat, int dim);
+void bisym_to_centrosym(double *matrow, const double *mat, int dim);
+int bisym_eig(double *eigval, double *eigvec, const double *mat, int dim);
+int bisym_eigval(double *eigval, const double *mat, int dim);
+void bisym_eigvec_expand(double *vec, const double *eigvec, int k, int dim);
+void bisym_alloc_f(float **mat, int dim);
+void bisym_full_extractcomp_f(float *matcomp, const double *matfull, int dim);
+void bisym_fold_f(float *matplus, float *matminus, const float *mat, int dim);
+void bisym_to_centrosym_f(float *matrow, const float *mat, int dim);
+void bisym_product_f(float *outmat, const float *mat1, const float *mat2, int dim);
+void bisym_product_fd(float *outmat, const float *mat1, const float *mat2, int dim);
+void bisym_product_ws_f(float *outmat, const float *mat1, const float *mat2, int dim, workspace *ws);
+void bisym_product_ws_fd(float *outmat, const float *mat1, const float *mat2, int dim, workspace *ws);
+double bisym_traceprod_f(const float *mat1, const float *mat2, int dim);
+double bisym_traceprod_fd(const float *mat1, const float *mat2, int dim);
+double bisym_quadform_f(const float *x, const float *mat, const float *y, int dim);
+double bisym_quadform_fd(const float *x, const float *mat, const float *y, int dim);
+double bisym_quadform_ws_f(const float *x, const float *mat, const float *y, int dim, workspace *ws);
+double bisym_quadform_ws_fd(const float *x, const float *mat, const float *y, int dim, workspace *ws);
+void bisym_matvec_f(float *y, const float *mat, const float *x, int dim);
+void bisym_matvec_fd(float *y, const float *mat, const float *x, int dim);
+void bisym_matvec_ws_f(float *y, const float *mat, const float *x, int dim, workspace *ws);
+void bisym_matvec_ws_fd(float *y, const float *mat, const float *x, int dim, workspace *ws);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif
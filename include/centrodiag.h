@@ -0,0 +1,63 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#ifndef CENTRODIAG
+#define CENTRODIAG
+
+#include "workspace.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * Return the index of the first element of the k-th subdiagonal of a centrosymmetric matrix
+ * in diagonal-major compressed form (diagonal by diagonal, each one from top to bottom).
+ *
+ * \param[in]  k Diagonal index (0 for the main diagonal).
+ * \param[in]  dim Matrix dimension.
+ * \retval The index of the element (k,0).
+ */
+static inline long centrodiag_diag(int k, int dim){
+
+  return (long)k * dim - (long)k * (k - 1) / 2;
+
+}
+
+/*!
+ * Return index for the (i,j)th elements of a centrosymmetric square matrix
+ * in diagonal-major compressed form (fast; must have j <= i). Same as centrosym_ind2.
+ *
+ * \param[in]  i Row index.
+ * \param[in]  j Column index.
+ * \param[in]  dim Matrix dimension.
+ * \retval The index of the j-th element of the (i-j)-th subdiagonal.
+ */
+static inline long centrodiag_ind(int i, int j, int dim){
+
+  return centrodiag_diag(i - j, dim) + j;
+
+}
+
+long centrodiag_size(int dim);
+void centrodiag_alloc(double **mat, int dim);
+void centrodiag_alloc_ws(double **mat, int dim, workspace *ws);
+void centrodiag_full_extractcomp(double *matcomp, const double *matfull, int dim);
+void centrodiag_comp_expandfull(double *matfull, const double *matcomp, int dim);
+void centrodiag_from_centrosym(double *matdiag, const double *matrow, int dim);
+void centrodiag_to_centrosym(double *matrow, const double *matdiag, int dim);
+void centrodiag_product(double *outmat, const double *mat1, const double *mat2, int dim);
+void centrodiag_product_ws(double *outmat, const double *mat1, const double *mat2, int dim, workspace *ws);
+double centrodiag_trace(const double *mat, int dim);
+double centrodiag_traceprod(const double *mat1, const double *mat2, int dim);
+double centrodiag_quadform(const double *x, const double *mat, const double *y, int dim);
+double centrodiag_quadform_ws(const double *x, const double *mat, const double *y, int dim, workspace *ws);
+void centrodiag_matvec(double *y, const double *mat, const double *x, int dim);
+void centrodiag_matvec_ws(double *y, const double *mat, const double *x, int dim, workspace *ws);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
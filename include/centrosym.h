@@ -5,18 +5,109 @@
 #ifndef CENTROSYM
 #define CENTROSYM
 
+#include <stdint.h>
+#include "workspace.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * Return index for the (i,j)th elements of a centrosymmetric square matrix (fast; must have j <= i).
+ * Naive indexing : row by row
+ *
+ * \param[in]  i Row index.
+ * \param[in]  j Column index.
+ * \param[in]  dim Matrix dimension.
+ * \retval The index of the j-th element of the i-th row.
+ */
+static inline long centrosym_ind(int i, int j, int dim){  // NAIVE INDEXING: ROW by ROW
+
+  return (long)i * (i + 1) / 2 + j ;
+
+}
+
+/*!
+ * Return index for the (i,j)th elements of a centrosymmetric square matrix (fast; must have j <= i).
+ * Second indexing : diagonal by diagonal
+ *
+ * \param[in]  i Row index.
+ * \param[in]  j Column index.
+ * \param[in]  dim Matrix dimension.
+ * \retval The index of the j-th element of the i-th row.
+ */
+static inline long centrosym_ind2(int i, int j, int dim){  // SECOND INDEXING: DIAG by DIAG
+
+  long N = dim - 2;
+  long k = i - j;
+
+  return 2L * i - j + N * k - k * (k + 1) / 2 + k;
+
+}
+
+long centrosym_size(int dim);
 void centrosym_alloc(double **mat, int dim);
-int centrosym_ind(int i, int j, int dim);
-int centrosym_ind2(int i, int j, int dim);
+void centrosym_alloc_ws(double **mat, int dim, workspace *ws);
 void centrosym_full_random(double *mat, int dim);
-void centrosym_full_extractcomp(double *matcomp, double *matfull, int dim);
-int centrosym_assertequal(double *matcomp1, double *matcomp2, int dim);
-void centrosym_print(double *mat, int dim);
-void centrosym_product(double *outmat, double *mat1, double *mat2, int dim);
-int centrosym_isvalid(double *mat, int dim);
-double centrosym_trace(double *mat, int dim);
-double centrosym_traceprod(double *mat1, double *mat2, int dim);
-double centrosym_traceprod2(double *mat1, double *mat2, int dim);
-double centrosym_quadform(double *x, double *mat, double *y, int dim);
+void centrosym_random(double *mat, int dim, uint64_t seed, uint64_t stream);
+void centrosym_full_extractcomp(double *matcomp, const double *matfull, int dim);
+void centrosym_comp_expandfull(double *matfull, const double *matcomp, int dim);
+int centrosym_assertequal(const double *matcomp1, const double *matcomp2, int dim);
+void centrosym_print(const double *mat, int dim);
+void centrosym_getrow(double *row, const double *mat, int i, int j0, int j1, int dim);
+void centrosym_getrow_split(double *row, const double *rowlo, const double *rowhi, int i, int j0, int j1, int dim);
+void centrosym_product(double *outmat, const double *mat1, const double *mat2, int dim);
+void centrosym_product_ws(double *outmat, const double *mat1, const double *mat2, int dim, workspace *ws);
+void centrosym_fold(double *matplus, double *matminus, const double *mat, int dim);
+void centrosym_unfold(double *mat, const double *matplus, const double *matminus, int dim);
+void centrosym_product_blockdiag(double *outmat, const double *mat1, const double *mat2, int dim);
+void centrosym_product_blockdiag_ws(double *outmat, const double *mat1, const double *mat2, int dim, workspace *ws);
+void centrosym_product_folded_ws(double *outmat, const double *mat1, const double *mat2,
+  void (*fold)(double *matplus, double *matminus, const double *mat, int dim), int dim, workspace *ws);
+int centrosym_isvalid(const double *mat, int dim);
+double centrosym_trace(const double *mat, int dim);
+double centrosym_traceprod(const double *mat1, const double *mat2, int dim);
+double centrosym_traceprod_ws(const double *mat1, const double *mat2, int dim, workspace *ws);
+double centrosym_traceprod2(const double *mat1, const double *mat2, int dim);
+double centrosym_traceprod2_ws(const double *mat1, const double *mat2, int dim, workspace *ws);
+void centrosym_traceprod_batch(double *trmat, double **mats1, int nmat1, double **mats2, int nmat2, int dim);
+void centrosym_traceprod_batch_ws(double *trmat, double **mats1, int nmat1, double **mats2, int nmat2, int dim, workspace *ws);
+double centrosym_quadform(const double *x, const double *mat, const double *y, int dim);
+void centrosym_matvec(double *y, const double *mat, const double *x, int dim);
+void centrosym_matvec_ws(double *y, const double *mat, const double *x, int dim, workspace *ws);
+void centrosym_times_dense(double *y, const double *mat, const double *x, int nvec, int dim);
+void centrosym_times_dense_ws(double *y, const double *mat, const double *x, int nvec, int dim, workspace *ws);
+void dense_times_centrosym(double *outmat, const double *x, const double *mat, int nrows, int dim);
+void dense_times_centrosym_ws(double *outmat, const double *x, const double *mat, int nrows, int dim, workspace *ws);
+int centrosym_inverse(double *outmat, const double *mat, int dim);
+int centrosym_solve(double *x, const double *mat, const double *b, int dim);
+int centrosym_solve_multi(double *x, const double *mat, const double *b, int nrhs, int dim);
+void centrosym_alloc_f(float **mat, int dim);
+void centrosym_full_extractcomp_f(float *matcomp, const double *matfull, int dim);
+void centrosym_getrow_f(float *row, const float *mat, int i, int j0, int j1, int dim);
+void centrosym_getrow_split_f(float *row, const float *rowlo, const float *rowhi, int i, int j0, int j1, int dim);
+void centrosym_product_f(float *outmat, const float *mat1, const float *mat2, int dim);
+void centrosym_product_fd(float *outmat, const float *mat1, const float *mat2, int dim);
+void centrosym_product_ws_f(float *outmat, const float *mat1, const float *mat2, int dim, workspace *ws);
+void centrosym_product_ws_fd(float *outmat, const float *mat1, const float *mat2, int dim, workspace *ws);
+void centrosym_unfold_f(float *mat, const float *matplus, const float *matminus, int dim);
+void centrosym_product_folded_ws_f(float *outmat, const float *mat1, const float *mat2,
+  void (*fold)(float *matplus, float *matminus, const float *mat, int dim), int dim, workspace *ws);
+void centrosym_product_folded_ws_fd(float *outmat, const float *mat1, const float *mat2,
+  void (*fold)(float *matplus, float *matminus, const float *mat, int dim), int dim, workspace *ws);
+double centrosym_traceprod_f(const float *mat1, const float *mat2, int dim);
+double centrosym_traceprod_fd(const float *mat1, const float *mat2, int dim);
+double centrosym_traceprod_ws_f(const float *mat1, const float *mat2, int dim, workspace *ws);
+double centrosym_traceprod_ws_fd(const float *mat1, const float *mat2, int dim, workspace *ws);
+double centrosym_quadform_f(const float *x, const float *mat, const float *y, int dim);
+double centrosym_quadform_fd(const float *x, const float *mat, const float *y, int dim);
+void centrosym_matvec_f(float *y, const float *mat, const float *x, int dim);
+void centrosym_matvec_fd(float *y, const float *mat, const float *x, int dim);
+void centrosym_matvec_ws_f(float *y, const float *mat, const float *x, int dim, workspace *ws);
+void centrosym_matvec_ws_fd(float *y, const float *mat, const float *x, int dim, workspace *ws);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif
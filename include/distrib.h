@@ -0,0 +1,65 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#ifndef DISTRIB
+#define DISTRIB
+
+#include <stdint.h>
+#include <mpi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * Two-dimensional grid of processes (rank = myrow * npcol + mycol in comm).
+ */
+typedef struct {
+  MPI_Comm comm;          // All the processes of the grid
+  MPI_Comm rowcomm;       // Processes of the same row (ranked by column)
+  MPI_Comm colcomm;       // Processes of the same column (ranked by row)
+  int nprow, npcol;       // Shape of the grid
+  int myrow, mycol;       // Position of this process
+} distrib_grid;
+
+/*!
+ * Dense square matrix with a 2D block-cyclic distribution: block (I,J) of nb x nb elements
+ * is held by process (I mod nprow, J mod npcol), and the blocks of a process are stored
+ * together in row-major order (local matrix of mloc x nloc elements).
+ */
+typedef struct {
+  const distrib_grid *grid;
+  int n;                  // Global dimension
+  int nb;                 // Block size
+  int mloc, nloc;         // Local numbers of rows and columns
+  double *data;           // Local elements
+} distrib_block;
+
+/*!
+ * Distributed centrosymmetric matrix, held as its two half-size blocks (see centrosym_fold):
+ * the plus block ((dim+1)/2 x (dim+1)/2) and the minus block (dim/2 x dim/2).
+ */
+typedef struct {
+  int dim;
+  distrib_block plus;
+  distrib_block minus;
+} distrib_centrosym;
+
+int distrib_grid_init(distrib_grid *grid, MPI_Comm comm);
+void distrib_grid_free(distrib_grid *grid);
+int distrib_centrosym_alloc(distrib_centrosym *mat, int dim, int nb, const distrib_grid *grid);
+void distrib_centrosym_free(distrib_centrosym *mat);
+size_t distrib_centrosym_localsize(const distrib_centrosym *mat);
+void distrib_centrosym_random(distrib_centrosym *mat, uint64_t seed, uint64_t stream);
+void distrib_centrosym_full_extractcomp(distrib_centrosym *mat, const double *matfull);
+void distrib_centrosym_comp_extract(distrib_centrosym *mat, const double *matcomp);
+int distrib_centrosym_gather(double *matcomp, const distrib_centrosym *mat, int root);
+int distrib_centrosym_product(distrib_centrosym *outmat, const distrib_centrosym *mat1, const distrib_centrosym *mat2);
+double distrib_centrosym_traceprod(const distrib_centrosym *mat1, const distrib_centrosym *mat2);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,99 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#ifndef MATFILE
+#define MATFILE
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MATFILE_VERSION 1
+#define MATFILE_HEADER_SIZE 64
+
+// Matrix types
+#define MATFILE_SQUARE 1
+#define MATFILE_CENTROSYM 2
+#define MATFILE_BISYM 3
+#define MATFILE_SYMMAT 4
+#define MATFILE_TOEPLITZ 5
+
+// Layouts of the packed payload
+#define MATFILE_ROWMAJOR 0     // square_ind, centrosym_ind, bisym_ind, symmat_ind, toeplitz_ind
+#define MATFILE_DIAGMAJOR 1    // centrosym_ind2 (centrodiag.h), centrosymmetric matrices only
+
+// Element types
+#define MATFILE_FLOAT64 1
+
+// Flags of matfile_open
+#define MATFILE_VERIFY 1
+#define MATFILE_WRITABLE 2
+
+/*!
+ * Header of a matrix file, followed by the packed payload (MATFILE_HEADER_SIZE bytes, native byte order).
+ */
+typedef struct {
+  char magic[8];          // "SYMTRX" and two zero bytes
+  uint32_t version;       // MATFILE_VERSION
+  uint32_t byteorder;     // 0x01020304 as written by the host
+  uint32_t type;          // MATFILE_SQUARE, ...
+  uint32_t layout;        // MATFILE_ROWMAJOR or MATFILE_DIAGMAJOR
+  uint32_t dtype;         // MATFILE_FLOAT64
+  uint32_t reserved;
+  int64_t dim;            // Dimension of the matrix
+  int64_t size;           // Number of elements of the payload
+  uint64_t checksum;      // XXH64 of the payload (seed 0)
+  char pad[8];
+} matfile_header;
+
+/*!
+ * Matrix file mapped in memory: data points to the packed payload (read-only).
+ */
+typedef struct {
+  matfile_header header;
+  const double *data;
+  double *writable;       // The payload, if mapped with MATFILE_WRITABLE (NULL otherwise)
+  void *map;
+  size_t mapsize;
+} matfile;
+
+/*!
+ * Running checksum of a payload written in pieces (see matfile_checksum).
+ */
+typedef struct {
+  uint64_t acc[4];
+  unsigned char buf[32];  // Bytes not yet hashed (less than a stripe)
+  int nbuf;
+  uint64_t nbytes;
+} matfile_hash;
+
+/*!
+ * State of a streaming write: the payload is appended in pieces, and the header is written on close.
+ */
+typedef struct {
+  FILE *fp;
+  matfile_header header;
+  matfile_hash hash;
+  int64_t written;        // Number of elements written so far
+} matfile_writer;
+
+long matfile_size(int type, int layout, int dim);
+uint64_t matfile_checksum(const void *data, size_t nbytes);
+int matfile_writer_open(matfile_writer *w, const char *filename, int type, int layout, int dim);
+int matfile_writer_append(matfile_writer *w, const double *data, long n);
+int matfile_writer_close(matfile_writer *w);
+int matfile_write(const char *filename, int type, int layout, int dim, const double *mat);
+int matfile_check_header(const matfile_header *h, size_t filesize);
+int matfile_open(matfile *mf, const char *filename, int flags);
+int matfile_verify(const matfile *mf);
+void matfile_close(matfile *mf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -5,6 +5,19 @@
 #ifndef MISCMATH
 #define MISCMATH
 
+#include "workspace.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 double ran2_dp(int idum);
+int fft_size(int n);
+void fft_dp(double *re, double *im, int n, int sign);
+void fft_dp_ws(double *re, double *im, int n, int sign, workspace *ws);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif
@@ -0,0 +1,36 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#ifndef OUTOFCORE
+#define OUTOFCORE
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * Plan and statistics of an out-of-core product.
+ */
+typedef struct {
+  int stripe;             // Rows of the result computed per pass over the second matrix
+  int panel;              // Rows of the second matrix read at once
+  long nstripes;          // Number of passes over the second matrix
+  long npanels;           // Number of panels read
+  size_t memory;          // Bytes of buffers (at most the budget)
+  double nread;           // Bytes read from the input files
+  double nwritten;        // Bytes written to the output file
+  double twait;           // Seconds spent waiting for reads not overlapped with computation
+  double ttotal;          // Seconds in total
+} outofcore_stats;
+
+int outofcore_plan(outofcore_stats *plan, int dim, size_t budget);
+int outofcore_centrosym_product(const char *outfile, const char *file1, const char *file2, size_t budget, outofcore_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
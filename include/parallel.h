@@ -0,0 +1,25 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#ifndef PARALLEL
+#define PARALLEL
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PARALLEL_UNIFORM 0
+#define PARALLEL_TRIANGULAR 1
+
+void parallel_set_threads(int nthreads);
+int parallel_threads(void);
+int parallel_thread_num(void);
+int parallel_nchunks(int nrows, int minrows);
+void parallel_partition(int *bounds, int nchunks, int nrows, int shape);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
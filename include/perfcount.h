@@ -0,0 +1,34 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#ifndef PERFCOUNT
+#define PERFCOUNT
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PERFCOUNT_CYCLES 0
+#define PERFCOUNT_INSTRUCTIONS 1
+#define PERFCOUNT_L1D_MISSES 2
+#define PERFCOUNT_LLC_MISSES 3
+#define PERFCOUNT_BRANCH_MISSES 4
+#define PERFCOUNT_NEVENTS 5
+
+typedef struct {
+  int fd[PERFCOUNT_NEVENTS];
+  int navailable;
+} perfcount;
+
+int perfcount_open(perfcount *pc);
+void perfcount_start(perfcount *pc);
+void perfcount_stop(perfcount *pc, double *values);
+void perfcount_close(perfcount *pc);
+const char *perfcount_name(int event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
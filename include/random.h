@@ -0,0 +1,27 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#ifndef RANDOM
+#define RANDOM
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RANDOM_SEED_DEFAULT 2012
+
+void random_philox4x32(uint32_t *out, const uint32_t *ctr, const uint32_t *key);
+double random_uniform(uint64_t seed, uint64_t stream, uint64_t index);
+void random_fill(double *x, long n, uint64_t seed, uint64_t stream, uint64_t offset);
+void random_set_seed(uint64_t seed);
+uint64_t random_seed(void);
+uint64_t random_next_stream(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
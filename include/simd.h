@@ -0,0 +1,47 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#ifndef SIMD
+#define SIMD
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SIMD_SCALAR 0
+#define SIMD_SSE2 1
+#define SIMD_AVX2 2
+#define SIMD_AVX512 3
+
+int simd_detect(void);
+int simd_set(int level);
+int simd_level(void);
+const char *simd_name(int level);
+double simd_dot(const double *x, const double *y, long n);
+double simd_dotrev(const double *x, const double *y, long n);
+void simd_dot2(double *res, const double *a, const double *x, const double *y, long n);
+void simd_dotfold(double *res, const double *a, const double *b, const double *x0, const double *y0,
+  const double *x1, const double *y1, int n);
+void simd_copyrev(double *y, const double *x, long n);
+void simd_muladd(double *y, const double *a, const double *b, long n);
+void simd_vecmat(double *y, const double *a, const double *x, int ldx, int nk, int n);
+double simd_dot_f(const float *x, const float *y, long n);
+double simd_dot_fd(const float *x, const float *y, long n);
+double simd_dotrev_f(const float *x, const float *y, long n);
+double simd_dotrev_fd(const float *x, const float *y, long n);
+void simd_dot2_f(double *res, const float *a, const float *x, const float *y, long n);
+void simd_dot2_fd(double *res, const float *a, const float *x, const float *y, long n);
+void simd_dotfold_f(double *res, const float *a, const float *b, const float *x0, const float *y0,
+  const float *x1, const float *y1, int n);
+void simd_dotfold_fd(double *res, const float *a, const float *b, const double *x0, const double *y0,
+  const double *x1, const double *y1, int n);
+void simd_copyrev_f(float *y, const float *x, long n);
+void simd_vecmat_f(float *y, const float *a, const float *x, int ldx, int nk, int n);
+void simd_vecmat_fd(double *y, const float *a, const float *x, int ldx, int nk, int n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
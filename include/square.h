@@ -5,14 +5,58 @@
 #ifndef SQUARE
 #define SQUARE
 
+#include "workspace.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * Return index for the (i,j)th elements of a square matrix.
+ *
+ * \param[in]  i Row index.
+ * \param[in]  j Column index.
+ * \param[in]  dim Matrix dimension.
+ * \retval The index of the j-th element of the i-th row.
+ */
+static inline long square_ind(int i, int j, int dim){
+  return (long)i * dim + j;
+}
+
 void square_alloc(double **mat, int dim);
+void square_alloc_ws(double **mat, int dim, workspace *ws);
 void square_random(double *mat, int dim);
 void square_symmetrise(double *mat, int dim);
-int square_ind(int i, int j, int dim);
-void square_print(double *mat, int dim);
-void square_product(double *outmat, double *mat1, double *mat2, int dim);
-double square_trace(double *mat, int dim);
-double square_traceprod(double *mat1, double *mat2, int dim);
-double square_quadform(double *x, double *mat, double *y, int dim);
+void square_print(const double *mat, int dim);
+void square_product(double *outmat, const double *mat1, const double *mat2, int dim);
+void square_product_ws(double *outmat, const double *mat1, const double *mat2, int dim, workspace *ws);
+double square_trace(const double *mat, int dim);
+double square_traceprod(const double *mat1, const double *mat2, int dim);
+double square_traceprod_ws(const double *mat1, const double *mat2, int dim, workspace *ws);
+double square_quadform(const double *x, const double *mat, const double *y, int dim);
+void square_matvec(double *y, const double *mat, const double *x, int dim);
+void square_matmat(double *y, const double *mat, const double *x, int nvec, int dim);
+int square_cholesky(double *mat, int dim);
+void square_cholesky_solve(double *x, const double *chol, const double *b, int nrhs, int dim);
+int square_lu(double *mat, int *piv, int dim);
+void square_lu_solve(double *x, const double *lu, const int *piv, const double *b, int nrhs, int dim);
+int square_symeig(double *eigval, double *mat, int wantvec, int dim);
+void square_alloc_f(float **mat, int dim);
+void square_product_f(float *outmat, const float *mat1, const float *mat2, int dim);
+void square_product_fd(float *outmat, const float *mat1, const float *mat2, int dim);
+void square_product_ws_f(float *outmat, const float *mat1, const float *mat2, int dim, workspace *ws);
+void square_product_ws_fd(float *outmat, const float *mat1, const float *mat2, int dim, workspace *ws);
+double square_traceprod_f(const float *mat1, const float *mat2, int dim);
+double square_traceprod_fd(const float *mat1, const float *mat2, int dim);
+double square_traceprod_ws_f(const float *mat1, const float *mat2, int dim, workspace *ws);
+double square_traceprod_ws_fd(const float *mat1, const float *mat2, int dim, workspace *ws);
+double square_quadform_f(const float *x, const float *mat, const float *y, int dim);
+double square_quadform_fd(const float *x, const float *mat, const float *y, int dim);
+void square_matvec_f(float *y, const float *mat, const float *x, int dim);
+void square_matvec_fd(float *y, const float *mat, const float *x, int dim);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif
@@ -0,0 +1,54 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#ifndef SYMMAT
+#define SYMMAT
+
+#include <stdint.h>
+#include "workspace.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * Return index for the (i,j)th elements of a symmetric square matrix (fast; must have j <= i).
+ * Lower triangle, row by row.
+ *
+ * \param[in]  i Row index.
+ * \param[in]  j Column index.
+ * \param[in]  dim Matrix dimension.
+ * \retval The index of the j-th element of the i-th row.
+ */
+static inline long symmat_ind(int i, int j, int dim){
+
+  return (long)i * (i + 1) / 2 + j;
+
+}
+
+long symmat_size(int dim);
+void symmat_alloc(double **mat, int dim);
+void symmat_alloc_ws(double **mat, int dim, workspace *ws);
+void symmat_full_random(double *mat, int dim);
+void symmat_random(double *mat, int dim, uint64_t seed, uint64_t stream);
+void symmat_full_extractcomp(double *matcomp, const double *matfull, int dim);
+void symmat_comp_expandfull(double *matfull, const double *matcomp, int dim);
+int symmat_assertequal(const double *matcomp1, const double *matcomp2, int dim);
+void symmat_print(const double *mat, int dim);
+void symmat_getrow(double *row, const double *mat, int i, int j0, int j1, int dim);
+void symmat_product(double *outmat, const double *mat1, const double *mat2, int dim);
+void symmat_product_ws(double *outmat, const double *mat1, const double *mat2, int dim, workspace *ws);
+void symmat_matvec(double *y, const double *mat, const double *x, int dim);
+void symmat_matmat(double *y, const double *mat, const double *x, int nvec, int dim);
+void symmat_matmat_ws(double *y, const double *mat, const double *x, int nvec, int dim, workspace *ws);
+int symmat_isvalid(const double *mat, int dim);
+double symmat_trace(const double *mat, int dim);
+double symmat_traceprod(const double *mat1, const double *mat2, int dim);
+double symmat_quadform(const double *x, const double *mat, const double *y, int dim);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -6,9 +6,21 @@
 #define SYMTRX
 
 #include "bisym.h"
+#include "centrodiag.h"
 #include "centrosym.h"
+#include "matfile.h"
 #include "miscmath.h"
+#include "outofcore.h"
+#include "parallel.h"
+#include "perfcount.h"
+#include "random.h"
+#include "simd.h"
 #include "square.h"
+#include "symmat.h"
+#include "tiling.h"
+#include "timer.h"
+#include "toeplitz.h"
 #include "vector.h"
+#include "workspace.h"
 
 #endif
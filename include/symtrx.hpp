@@ -0,0 +1,458 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#ifndef SYMTRX_HPP
+#define SYMTRX_HPP
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "symtrx.h"
+
+/*!
+ * Header-only C++ layer over the packed matrices (C++11).
+ *
+ * Square<T>, Centrosym<T, Layout> and Bisym<T> own a matrix in compressed form (T is double or float,
+ * Layout is RowMajor, see centrosym.h, or DiagMajor, see centrodiag.h, in double only), Vector<T> a vector.
+ * Products of matrices are expression templates, evaluated when they are assigned or reduced:
+ *   - Centrosym<double> C = A * B;        one call to the product kernel, written in C directly;
+ *   - trace(A * B);                       the trace-product kernel, the product is never formed;
+ *   - trans(x) * (A * B) * y;             quadratic form of A with the vector B * y;
+ *   - Vector<double> z = A * B * x;       chain of matrix-vector products.
+ * The type of a product is deduced from the structure of its operands (bisym * bisym is centrosym),
+ * and the operands must have the same type. Every matrix type has a matrix-vector product kernel in its
+ * own compressed form, so that the last two forms never form nor convert a matrix.
+ * Float matrices use the _f kernels (the _fd ones for matrix-vector products), and all the scalar results are double.
+ * Dimension mismatches throw std::invalid_argument, failed allocations std::bad_alloc.
+ */
+namespace symtrx {
+
+struct RowMajor {};
+struct DiagMajor {};
+
+template<class T> class Vector;
+template<class T> class Square;
+template<class T, class Layout = RowMajor> class Centrosym;
+template<class T> class Bisym;
+template<class L, class R> class Product;
+
+namespace detail {
+
+template<class E, class T> class MatVecBase;
+
+inline double *allocate(double *, long n){ return workspace_calloc(n); }
+inline float *allocate(float *, long n){ return workspace_calloc_f(n); }
+
+/*!
+ * Owner of the elements of a matrix in compressed form, or of a vector (64-byte aligned).
+ */
+template<class T>
+class Storage {
+public:
+  typedef T value_type;
+  int dim() const { return dim_; }
+  long size() const { return size_; }
+  T *data() { return data_; }
+  const T *data() const { return data_; }
+  T &operator[](long k) { return data_[k]; }
+  const T &operator[](long k) const { return data_[k]; }
+  void swap(Storage &other) noexcept {
+    std::swap(dim_, other.dim_);
+    std::swap(size_, other.size_);
+    std::swap(data_, other.data_);
+  }
+protected:
+  Storage(int dim, long size) : dim_(dim), size_(size), data_(allocate((T*)0, size)) {
+    if( data_ == 0 && size > 0 ) throw std::bad_alloc();
+  }
+  Storage(const Storage &other) : Storage(other.dim_, other.size_) {
+    std::memcpy(data_, other.data_, size_ * sizeof(T));
+  }
+  Storage(Storage &&other) noexcept : dim_(other.dim_), size_(other.size_), data_(other.data_) {
+    other.data_ = 0;
+    other.dim_ = 0;
+    other.size_ = 0;
+  }
+  Storage &operator=(const Storage &other) { Storage tmp(other); swap(tmp); return *this; }
+  Storage &operator=(Storage &&other) noexcept { swap(other); return *this; }
+  ~Storage() { std::free(data_); }
+private:
+  int dim_;
+  long size_;
+  T *data_;
+};
+
+/*!
+ * Kernels of each matrix type: product (and its result type), trace-product, quadratic form,
+ * matrix-vector product, and the trace where it exists.
+ */
+template<class M> struct kernels;
+
+template<> struct kernels< Square<double> > {
+  typedef Square<double> product_type;
+  static void extract(double *comp, const double *full, int dim){ std::memcpy(comp, full, (size_t)dim * dim * sizeof(double)); }
+  static void product(double *out, const double *a, const double *b, int dim){ square_product(out, a, b, dim); }
+  static double traceprod(const double *a, const double *b, int dim){ return square_traceprod(a, b, dim); }
+  static double quadform(const double *x, const double *a, const double *y, int dim){ return square_quadform(x, a, y, dim); }
+  static void matvec(double *y, const double *a, const double *x, int dim){ square_matvec(y, a, x, dim); }
+  static double trace(const double *a, int dim){ return square_trace(a, dim); }
+};
+
+template<> struct kernels< Square<float> > {
+  typedef Square<float> product_type;
+  static void extract(float *comp, const double *full, int dim){ vector_to_float(comp, full, (long)dim * dim); }
+  static void product(float *out, const float *a, const float *b, int dim){ square_product_f(out, a, b, dim); }
+  static double traceprod(const float *a, const float *b, int dim){ return square_traceprod_f(a, b, dim); }
+  static double quadform(const float *x, const float *a, const float *y, int dim){ return square_quadform_f(x, a, y, dim); }
+  static void matvec(float *y, const float *a, const float *x, int dim){ square_matvec_fd(y, a, x, dim); }
+};
+
+template<> struct kernels< Centrosym<double, RowMajor> > {
+  typedef Centrosym<double, RowMajor> product_type;
+  static void extract(double *comp, const double *full, int dim){ centrosym_full_extractcomp(comp, full, dim); }
+  static void product(double *out, const double *a, const double *b, int dim){ centrosym_product(out, a, b, dim); }
+  static double traceprod(const double *a, const double *b, int dim){ return centrosym_traceprod(a, b, dim); }
+  static double quadform(const double *x, const double *a, const double *y, int dim){ return centrosym_quadform(x, a, y, dim); }
+  static void matvec(double *y, const double *a, const double *x, int dim){ centrosym_matvec(y, a, x, dim); }
+  static double trace(const double *a, int dim){ return centrosym_trace(a, dim); }
+};
+
+template<> struct kernels< Centrosym<float, RowMajor> > {
+  typedef Centrosym<float, RowMajor> product_type;
+  static void extract(float *comp, const double *full, int dim){ centrosym_full_extractcomp_f(comp, full, dim); }
+  static void product(float *out, const float *a, const float *b, int dim){ centrosym_product_f(out, a, b, dim); }
+  static double traceprod(const float *a, const float *b, int dim){ return centrosym_traceprod_f(a, b, dim); }
+  static double quadform(const float *x, const float *a, const float *y, int dim){ return centrosym_quadform_f(x, a, y, dim); }
+  static void matvec(float *y, const float *a, const float *x, int dim){ centrosym_matvec_fd(y, a, x, dim); }
+};
+
+template<> struct kernels< Centrosym<double, DiagMajor> > {
+  typedef Centrosym<double, DiagMajor> product_type;
+  static void extract(double *comp, const double *full, int dim){ centrodiag_full_extractcomp(comp, full, dim); }
+  static void product(double *out, const double *a, const double *b, int dim){ centrodiag_product(out, a, b, dim); }
+  static double traceprod(const double *a, const double *b, int dim){ return centrodiag_traceprod(a, b, dim); }
+  static double quadform(const double *x, const double *a, const double *y, int dim){ return centrodiag_quadform(x, a, y, dim); }
+  static void matvec(double *y, const double *a, const double *x, int dim){ centrodiag_matvec(y, a, x, dim); }
+  static double trace(const double *a, int dim){ return centrodiag_trace(a, dim); }
+};
+
+template<> struct kernels< Bisym<double> > {
+  typedef Centrosym<double, RowMajor> product_type;
+  static void extract(double *comp, const double *full, int dim){ bisym_full_extractcomp(comp, full, dim); }
+  static void product(double *out, const double *a, const double *b, int dim){ bisym_product(out, a, b, dim); }
+  static double traceprod(const double *a, const double *b, int dim){ return bisym_traceprod(a, b, dim); }
+  static double quadform(const double *x, const double *a, const double *y, int dim){ return bisym_quadform(x, a, y, dim); }
+  static void matvec(double *y, const double *a, const double *x, int dim){ bisym_matvec(y, a, x, dim); }
+  static double trace(const double *a, int dim){ return bisym_trace(a, dim); }
+};
+
+template<> struct kernels< Bisym<float> > {
+  typedef Centrosym<float, RowMajor> product_type;
+  static void extract(float *comp, const double *full, int dim){ bisym_full_extractcomp_f(comp, full, dim); }
+  static void product(float *out, const float *a, const float *b, int dim){ bisym_product_f(out, a, b, dim); }
+  static double traceprod(const float *a, const float *b, int dim){ return bisym_traceprod_f(a, b, dim); }
+  static double quadform(const float *x, const float *a, const float *y, int dim){ return bisym_quadform_f(x, a, y, dim); }
+  static void matvec(float *y, const float *a, const float *x, int dim){ bisym_matvec_fd(y, a, x, dim); }
+};
+
+// Matrices and products of matrices
+template<class M> struct is_matrix : std::false_type {};
+template<class T> struct is_matrix< Square<T> > : std::true_type {};
+template<class T, class Layout> struct is_matrix< Centrosym<T, Layout> > : std::true_type {};
+template<class T> struct is_matrix< Bisym<T> > : std::true_type {};
+
+template<class E> struct is_expression : is_matrix<E> {};
+template<class L, class R> struct is_expression< Product<L, R> > : std::true_type {};
+
+// Type of an expression once evaluated
+template<class E> struct eval_type { typedef E type; };
+template<class L, class R> struct eval_type< Product<L, R> > { typedef typename Product<L, R>::result_type type; };
+
+// Matrices are held by reference in the expressions, sub-expressions by value
+template<class E> struct operand {
+  typedef typename std::conditional<is_matrix<E>::value, const E &, const E>::type type;
+};
+
+template<class M>
+inline typename std::enable_if<is_matrix<M>::value, const M &>::type materialise(const M &m){ return m; }
+template<class L, class R>
+inline typename Product<L, R>::result_type materialise(const Product<L, R> &p){ return typename Product<L, R>::result_type(p); }
+
+template<class M>
+inline typename std::enable_if<is_matrix<M>::value, bool>::type aliases(const M &m, const void *p){ return m.data() == p; }
+template<class L, class R>
+inline bool aliases(const Product<L, R> &e, const void *p){ return aliases(e.left(), p) || aliases(e.right(), p); }
+
+inline void check_dims(int dim1, int dim2){
+  if( dim1 != dim2 ) throw std::invalid_argument("symtrx: the dimensions of the operands differ");
+}
+
+// y = E * x (y and x distinct), as a chain of matrix-vector products
+template<class M, class T>
+inline typename std::enable_if<is_matrix<M>::value>::type matvec(T *y, const M &m, const T *x){
+  kernels<M>::matvec(y, m.data(), x, m.dim());
+}
+template<class L, class R, class T>
+inline void matvec(T *y, const Product<L, R> &e, const T *x){
+  Vector<T> tmp(e.dim());
+  matvec(tmp.data(), e.right(), x);
+  matvec(y, e.left(), tmp.data());
+}
+
+// x^t * E * y
+template<class M, class T>
+inline typename std::enable_if<is_matrix<M>::value, double>::type quadform(const T *x, const M &m, const T *y){
+  return kernels<M>::quadform(x, m.data(), y, m.dim());
+}
+template<class L, class R, class T>
+inline double quadform(const T *x, const Product<L, R> &e, const T *y){
+  Vector<T> tmp(e.dim());
+  matvec(tmp.data(), e.right(), y);
+  return quadform(x, e.left(), tmp.data());
+}
+
+} // namespace detail
+
+/*!
+ * Vector of dim elements.
+ */
+template<class T>
+class Vector : public detail::Storage<T> {
+public:
+  explicit Vector(int dim) : detail::Storage<T>(dim, dim) {}
+  template<class E> Vector(const detail::MatVecBase<E, T> &expr);
+  template<class E> Vector &operator=(const detail::MatVecBase<E, T> &expr);
+};
+
+/*!
+ * Square matrix (row-major).
+ */
+template<class T>
+class Square : public detail::Storage<T> {
+public:
+  explicit Square(int dim) : detail::Storage<T>(dim, (long)dim * dim) {}
+  template<class L, class R> Square(const Product<L, R> &expr) : Square(expr.dim()) { expr.evaluate(*this); }
+  template<class L, class R> Square &operator=(const Product<L, R> &expr){ expr.assign(*this); return *this; }
+  static Square from_full(const double *full, int dim){ Square m(dim); detail::kernels<Square>::extract(m.data(), full, dim); return m; }
+};
+
+/*!
+ * Centrosymmetric matrix in compressed form, row by row (RowMajor) or diagonal by diagonal (DiagMajor).
+ */
+template<class T, class Layout>
+class Centrosym : public detail::Storage<T> {
+  static_assert(std::is_same<Layout, RowMajor>::value || std::is_same<T, double>::value,
+    "symtrx: the diagonal-major form is only available in double precision");
+public:
+  explicit Centrosym(int dim) : detail::Storage<T>(dim, centrosym_size(dim)) {}
+  template<class L, class R> Centrosym(const Product<L, R> &expr) : Centrosym(expr.dim()) { expr.evaluate(*this); }
+  template<class L, class R> Centrosym &operator=(const Product<L, R> &expr){ expr.assign(*this); return *this; }
+  static Centrosym from_full(const double *full, int dim){ Centrosym m(dim); detail::kernels<Centrosym>::extract(m.data(), full, dim); return m; }
+};
+
+/*!
+ * Bisymmetric matrix in compressed form.
+ */
+template<class T>
+class Bisym : public detail::Storage<T> {
+public:
+  explicit Bisym(int dim) : detail::Storage<T>(dim, bisym_size(dim)) {}
+  static Bisym from_full(const double *full, int dim){ Bisym m(dim); detail::kernels<Bisym>::extract(m.data(), full, dim); return m; }
+};
+
+/*!
+ * Product of two matrix expressions, evaluated when assigned (or with eval) or reduced (trace, quadform).
+ */
+template<class L, class R>
+class Product {
+public:
+  typedef typename detail::eval_type<L>::type left_type;
+  typedef typename detail::eval_type<R>::type right_type;
+  static_assert(std::is_same<left_type, right_type>::value,
+    "symtrx: the operands of a product must have the same type and precision");
+  typedef typename detail::kernels<left_type>::product_type result_type;
+  typedef typename result_type::value_type value_type;
+
+  Product(const L &l, const R &r) : l_(l), r_(r) { detail::check_dims(l.dim(), r.dim()); }
+  int dim() const { return l_.dim(); }
+  const L &left() const { return l_; }
+  const R &right() const { return r_; }
+  result_type eval() const { return result_type(*this); }
+
+  // Write the product in out, of the right size and not an operand
+  void evaluate(result_type &out) const {
+    const left_type &a = detail::materialise(l_);
+    const right_type &b = detail::materialise(r_);
+    detail::kernels<left_type>::product(out.data(), a.data(), b.data(), dim());
+  }
+  // Write the product in out, through a new matrix if needed
+  void assign(result_type &out) const {
+    if( out.dim() == dim() && !detail::aliases(*this, out.data()) )
+      evaluate(out);
+    else{
+      result_type res(*this);
+      out.swap(res);
+    }
+  }
+
+private:
+  typename detail::operand<L>::type l_;
+  typename detail::operand<R>::type r_;
+};
+
+namespace detail {
+
+/*!
+ * Product of a matrix expression and a vector, evaluated when assigned to a vector.
+ */
+template<class E, class T>
+class MatVecBase {
+public:
+  MatVecBase(const E &e, const Vector<T> &x) : e_(e), x_(x) { check_dims(e.dim(), x.dim()); }
+  int dim() const { return e_.dim(); }
+  void evaluate(T *y) const { matvec(y, e_, x_.data()); }
+  bool aliases(const void *p) const { return x_.data() == p; }
+private:
+  typename operand<E>::type e_;
+  const Vector<T> &x_;
+};
+
+/*!
+ * Transposed vector, and its product with a matrix expression (x^t * E), waiting for the right vector.
+ */
+template<class T>
+class Transposed {
+public:
+  explicit Transposed(const Vector<T> &x) : x_(x) {}
+  const Vector<T> &vector() const { return x_; }
+private:
+  const Vector<T> &x_;
+};
+
+template<class E, class T>
+class RowVec {
+public:
+  RowVec(const Vector<T> &x, const E &e) : x_(x), e_(e) { check_dims(x.dim(), e.dim()); }
+  double apply(const Vector<T> &y) const {
+    check_dims(y.dim(), e_.dim());
+    return quadform(x_.data(), e_, y.data());
+  }
+private:
+  const Vector<T> &x_;
+  typename operand<E>::type e_;
+};
+
+} // namespace detail
+
+template<class T>
+template<class E>
+Vector<T>::Vector(const detail::MatVecBase<E, T> &expr) : Vector(expr.dim())
+{
+  expr.evaluate(this->data());
+}
+
+template<class T>
+template<class E>
+Vector<T> &Vector<T>::operator=(const detail::MatVecBase<E, T> &expr)
+{
+  if( this->dim() == expr.dim() && !expr.aliases(this->data()) )
+    expr.evaluate(this->data());
+  else{
+    Vector res(expr);
+    this->swap(res);
+  }
+  return *this;
+}
+
+/*!
+ * Product of two matrix expressions (lazy).
+ */
+template<class L, class R>
+inline typename std::enable_if<detail::is_expression<L>::value && detail::is_expression<R>::value, Product<L, R> >::type
+operator*(const L &l, const R &r)
+{
+  return Product<L, R>(l, r);
+}
+
+/*!
+ * Product of a matrix expression and a vector (lazy).
+ */
+template<class E, class T>
+inline typename std::enable_if<detail::is_expression<E>::value, detail::MatVecBase<E, T> >::type
+operator*(const E &e, const Vector<T> &x)
+{
+  static_assert(std::is_same<typename detail::eval_type<E>::type::value_type, T>::value,
+    "symtrx: the matrix and the vector must have the same precision");
+  return detail::MatVecBase<E, T>(e, x);
+}
+
+/*!
+ * Transposed vector, for quadratic forms written trans(x) * E * y.
+ */
+template<class T>
+inline detail::Transposed<T> trans(const Vector<T> &x)
+{
+  return detail::Transposed<T>(x);
+}
+
+template<class E, class T>
+inline typename std::enable_if<detail::is_expression<E>::value, detail::RowVec<E, T> >::type
+operator*(const detail::Transposed<T> &xt, const E &e)
+{
+  return detail::RowVec<E, T>(xt.vector(), e);
+}
+
+template<class E, class T>
+inline double operator*(const detail::RowVec<E, T> &xe, const Vector<T> &y)
+{
+  return xe.apply(y);
+}
+
+/*!
+ * Quadratic form x^t * E * y of a matrix expression.
+ */
+template<class E, class T>
+inline typename std::enable_if<detail::is_expression<E>::value, double>::type
+quadform(const Vector<T> &x, const E &e, const Vector<T> &y)
+{
+  return detail::RowVec<E, T>(x, e).apply(y);
+}
+
+/*!
+ * Trace of a matrix (double precision only).
+ */
+template<class M>
+inline typename std::enable_if<detail::is_matrix<M>::value, double>::type trace(const M &m)
+{
+  return detail::kernels<M>::trace(m.data(), m.dim());
+}
+
+/*!
+ * Trace of a product, with the trace-product kernel: the product itself is not formed
+ * (its operands are, if they are products themselves).
+ */
+template<class L, class R>
+inline double trace(const Product<L, R> &e)
+{
+  typedef typename Product<L, R>::left_type M;
+  const M &a = detail::materialise(e.left());
+  const M &b = detail::materialise(e.right());
+  return detail::kernels<M>::traceprod(a.data(), b.data(), e.dim());
+}
+
+/*!
+ * Evaluate a product in a matrix of the deduced type.
+ */
+template<class L, class R>
+inline typename Product<L, R>::result_type eval(const Product<L, R> &e)
+{
+  return e.eval();
+}
+
+} // namespace symtrx
+
+#endif
@@ -0,0 +1,20 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#ifndef TILING
+#define TILING
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int tiling_probe(void);
+int tiling_size(void);
+void tiling_set(int tile);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
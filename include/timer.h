@@ -0,0 +1,19 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#ifndef TIMER
+#define TIMER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+double timer_now(void);
+double timer_resolution(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
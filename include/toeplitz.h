@@ -0,0 +1,54 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#ifndef TOEPLITZ
+#define TOEPLITZ
+
+#include <stdint.h>
+#include "workspace.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * Return index for the (i,j)th elements of a symmetric Toeplitz matrix (stored as its first row).
+ *
+ * \param[in]  i Row index.
+ * \param[in]  j Column index.
+ * \param[in]  dim Matrix dimension.
+ * \retval The index of the element of the first row on the same diagonal.
+ */
+static inline int toeplitz_ind(int i, int j, int dim){
+
+  return i > j ? i - j : j - i;
+
+}
+
+long toeplitz_size(int dim);
+void toeplitz_alloc(double **mat, int dim);
+void toeplitz_alloc_ws(double **mat, int dim, workspace *ws);
+void toeplitz_full_random(double *mat, int dim);
+void toeplitz_random(double *mat, int dim, uint64_t seed, uint64_t stream);
+void toeplitz_full_extractcomp(double *matcomp, double *matfull, int dim);
+void toeplitz_comp_expandfull(double *matfull, double *matcomp, int dim);
+void toeplitz_to_bisym(double *matbisym, double *mat, int dim);
+void toeplitz_from_bisym(double *mat, double *matbisym, int dim);
+int toeplitz_isvalid(double *mat, int dim);
+void toeplitz_matvec(double *y, double *mat, double *x, int dim);
+void toeplitz_matvec_ws(double *y, double *mat, double *x, int dim, workspace *ws);
+double toeplitz_trace(double *mat, int dim);
+double toeplitz_traceprod(double *mat1, double *mat2, int dim);
+double toeplitz_quadform(double *x, double *mat, double *y, int dim);
+double toeplitz_quadform_ws(double *x, double *mat, double *y, int dim, workspace *ws);
+int toeplitz_solve(double *x, double *mat, double *b, int dim);
+int toeplitz_solve_ws(double *x, double *mat, double *b, int dim, workspace *ws);
+double toeplitz_logdet(double *mat, int dim);
+double toeplitz_logdet_ws(double *mat, int dim, workspace *ws);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -5,6 +5,16 @@
 #ifndef VECTOR
 #define VECTOR
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 void vector_random(double *x, int dim);
+void vector_to_float(float *y, const double *x, long n);
+void vector_to_double(double *y, const float *x, long n);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif
@@ -0,0 +1,50 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#ifndef WORKSPACE
+#define WORKSPACE
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WORKSPACE_ALIGN 64
+#define WORKSPACE_HUGEPAGES 1
+
+/*!
+ * Preallocated pool of aligned buffers, handed out and given back in stack order.
+ * A workspace must not be shared between threads.
+ */
+typedef struct {
+  char *base;         // Start of the pool
+  size_t capacity;    // Size of the pool (bytes)
+  size_t used;        // Bytes currently handed out
+  size_t peak;        // Largest value of used since the last reset
+  long ntake;         // Number of buffers handed out from the pool
+  long nheap;         // Number of buffers that did not fit, allocated on the heap instead
+  int hugepages;      // 1 if the pool is backed by huge pages
+  int mapped;         // 1 if the pool was obtained with mmap
+} workspace;
+
+int workspace_init(workspace *ws, size_t nbytes, int flags);
+void workspace_free(workspace *ws);
+void workspace_reset(workspace *ws);
+size_t workspace_bytes(size_t n);
+void *workspace_take_bytes(workspace *ws, size_t nbytes);
+void workspace_give_bytes(workspace *ws, void *buf);
+double *workspace_take(workspace *ws, size_t n);
+void workspace_give(workspace *ws, double *buf);
+float *workspace_take_f(workspace *ws, size_t n);
+void workspace_give_f(workspace *ws, float *buf);
+double *workspace_calloc(size_t n);
+float *workspace_calloc_f(size_t n);
+void workspace_heap_stats(long *nalloc, double *nbytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,559 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#include "symtrx.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#define MAX(a,b) ((a) > (b) ? (a) : (b))
+#define MIN(a,b) ((a) > (b) ? (b) : (a))
+
+// Benchmark harness: every kernel is timed with the monotonic wall clock, after a warmup,
+// with enough calls per sample for each sample to last at least BENCH_MINTIME seconds.
+// The latency of a kernel is summarised by the median, 10th and 90th percentiles of the
+// samples, and converted to GFLOP/s and GB/s with the nominal operation and memory counts
+// of the algorithm (the compressed operands being read once, the outputs written once).
+// The operands are taken from one workspace, and the kernels that need scratch space
+// take it from a second one, so that no allocation is timed. The single and mixed precision
+// kernels (suffixes _f and _fd) have no workspace variants: their scratch space is allocated
+// at each call, and timed with them.
+
+#define BENCH_MAXLIST 32
+#define BENCH_SAMPLES 15
+#define BENCH_MINTIME 2e-3
+#define BENCH_WARMUP 2e-2
+#define BENCH_MAXTIME 2.0
+
+// Operands shared by all the kernels for a given size
+typedef struct {
+  int dim;
+  double *full1, *full2, *full3;
+  double *centro1, *centro2, *centro3;
+  double *diag1, *diag2, *diag3;
+  double *bisym1, *bisym2;
+  double *sym1, *sym2;
+  double *toep;
+  double *x, *y, *z;
+  float *full1f, *full2f, *full3f;
+  float *centro1f, *centro2f, *centro3f;
+  float *bisym1f, *bisym2f;
+  float *xf, *yf;
+  workspace pool, scratch;
+} bench_data;
+
+typedef struct {
+  const char *name;
+  void (*run)(bench_data *data);
+  double (*flops)(int dim);
+  double (*bytes)(int dim);
+} bench_kernel;
+
+typedef struct {
+  double median, p10, p90;
+  int nsamples, ncalls;
+  double counters[PERFCOUNT_NEVENTS];
+} bench_stats;
+
+static volatile double bench_sink = 0.0;
+
+
+static void run_square_product(bench_data *d) { square_product(d->full3, d->full1, d->full2, d->dim); }
+static void run_centrosym_product(bench_data *d) { centrosym_product(d->centro3, d->centro1, d->centro2, d->dim); }
+static void run_centrosym_product_blockdiag(bench_data *d) { centrosym_product_blockdiag_ws(d->centro3, d->centro1, d->centro2, d->dim, &d->scratch); }
+static void run_centrodiag_product(bench_data *d) { centrodiag_product_ws(d->diag3, d->diag1, d->diag2, d->dim, &d->scratch); }
+static void run_bisym_product(bench_data *d) { bisym_product_ws(d->centro3, d->bisym1, d->bisym2, d->dim, &d->scratch); }
+static void run_symmat_product(bench_data *d) { symmat_product(d->full3, d->sym1, d->sym2, d->dim); }
+static void run_centrosym_times_dense(bench_data *d) { centrosym_times_dense(d->full3, d->centro1, d->full1, d->dim, d->dim); }
+static void run_dense_times_centrosym(bench_data *d) { dense_times_centrosym(d->full3, d->full1, d->centro1, d->dim, d->dim); }
+static void run_square_matvec(bench_data *d) { square_matvec(d->y, d->full1, d->x, d->dim); }
+static void run_centrosym_matvec(bench_data *d) { centrosym_matvec(d->y, d->centro1, d->x, d->dim); }
+static void run_symmat_matvec(bench_data *d) { symmat_matvec(d->y, d->sym1, d->x, d->dim); }
+static void run_toeplitz_matvec(bench_data *d) { toeplitz_matvec_ws(d->y, d->toep, d->x, d->dim, &d->scratch); }
+static void run_square_traceprod(bench_data *d) { bench_sink += square_traceprod(d->full1, d->full2, d->dim); }
+static void run_centrosym_traceprod(bench_data *d) { bench_sink += centrosym_traceprod_ws(d->centro1, d->centro2, d->dim, &d->scratch); }
+static void run_centrodiag_traceprod(bench_data *d) { bench_sink += centrodiag_traceprod(d->diag1, d->diag2, d->dim); }
+static void run_bisym_traceprod(bench_data *d) { bench_sink += bisym_traceprod(d->bisym1, d->bisym2, d->dim); }
+static void run_symmat_traceprod(bench_data *d) { bench_sink += symmat_traceprod(d->sym1, d->sym2, d->dim); }
+static void run_square_quadform(bench_data *d) { bench_sink += square_quadform(d->x, d->full1, d->y, d->dim); }
+static void run_centrosym_quadform(bench_data *d) { bench_sink += centrosym_quadform(d->x, d->centro1, d->y, d->dim); }
+static void run_centrodiag_quadform(bench_data *d) { bench_sink += centrodiag_quadform_ws(d->x, d->diag1, d->y, d->dim, &d->scratch); }
+static void run_bisym_quadform(bench_data *d) { bench_sink += bisym_quadform_ws(d->x, d->bisym1, d->y, d->dim, &d->scratch); }
+static void run_symmat_quadform(bench_data *d) { bench_sink += symmat_quadform(d->x, d->sym1, d->y, d->dim); }
+static void run_toeplitz_solve(bench_data *d) { bench_sink += toeplitz_solve_ws(d->z, d->toep, d->x, d->dim, &d->scratch); }
+static void run_toeplitz_logdet(bench_data *d) { bench_sink += toeplitz_logdet_ws(d->toep, d->dim, &d->scratch); }
+static void run_square_product_f(bench_data *d) { square_product_f(d->full3f, d->full1f, d->full2f, d->dim); }
+static void run_square_product_fd(bench_data *d) { square_product_fd(d->full3f, d->full1f, d->full2f, d->dim); }
+static void run_centrosym_product_f(bench_data *d) { centrosym_product_f(d->centro3f, d->centro1f, d->centro2f, d->dim); }
+static void run_centrosym_product_fd(bench_data *d) { centrosym_product_fd(d->centro3f, d->centro1f, d->centro2f, d->dim); }
+static void run_bisym_product_f(bench_data *d) { bisym_product_f(d->centro3f, d->bisym1f, d->bisym2f, d->dim); }
+static void run_bisym_product_fd(bench_data *d) { bisym_product_fd(d->centro3f, d->bisym1f, d->bisym2f, d->dim); }
+static void run_square_traceprod_f(bench_data *d) { bench_sink += square_traceprod_f(d->full1f, d->full2f, d->dim); }
+static void run_square_traceprod_fd(bench_data *d) { bench_sink += square_traceprod_fd(d->full1f, d->full2f, d->dim); }
+static void run_centrosym_traceprod_f(bench_data *d) { bench_sink += centrosym_traceprod_f(d->centro1f, d->centro2f, d->dim); }
+static void run_centrosym_traceprod_fd(bench_data *d) { bench_sink += centrosym_traceprod_fd(d->centro1f, d->centro2f, d->dim); }
+static void run_bisym_traceprod_f(bench_data *d) { bench_sink += bisym_traceprod_f(d->bisym1f, d->bisym2f, d->dim); }
+static void run_bisym_traceprod_fd(bench_data *d) { bench_sink += bisym_traceprod_fd(d->bisym1f, d->bisym2f, d->dim); }
+static void run_square_quadform_f(bench_data *d) { bench_sink += square_quadform_f(d->xf, d->full1f, d->yf, d->dim); }
+static void run_square_quadform_fd(bench_data *d) { bench_sink += square_quadform_fd(d->xf, d->full1f, d->yf, d->dim); }
+static void run_centrosym_quadform_f(bench_data *d) { bench_sink += centrosym_quadform_f(d->xf, d->centro1f, d->yf, d->dim); }
+static void run_centrosym_quadform_fd(bench_data *d) { bench_sink += centrosym_quadform_fd(d->xf, d->centro1f, d->yf, d->dim); }
+static void run_bisym_quadform_f(bench_data *d) { bench_sink += bisym_quadform_f(d->xf, d->bisym1f, d->yf, d->dim); }
+static void run_bisym_quadform_fd(bench_data *d) { bench_sink += bisym_quadform_fd(d->xf, d->bisym1f, d->yf, d->dim); }
+
+// Nominal operation counts
+static double flops_cube2(int n) { return 2.0 * n * n * n; }
+static double flops_cube(int n) { return (double)n * n * n; }
+static double flops_blocks(int n) { double h = n - n / 2, m = n / 2; return 2.0 * (h * h * h + m * m * m); }
+static double flops_square2(int n) { return 2.0 * n * n; }
+static double flops_square(int n) { return (double)n * n; }
+static double flops_half(int n) { return 0.5 * n * n; }
+static double flops_fft(int n) { double nf = fft_size(2 * n - 1); return 2.0 * 5.0 * nf * log2(nf); }
+static double flops_levinson(int n) { return 4.0 * n * n; }
+static double flops_durbin(int n) { return 2.0 * n * n; }
+
+// Nominal memory traffic
+static double bytes_square_product(int n) { return 3.0 * n * n * sizeof(double); }
+static double bytes_centrosym_product(int n) { return 3.0 * centrosym_size(n) * sizeof(double); }
+static double bytes_bisym_product(int n) { return (2.0 * bisym_size(n) + centrosym_size(n)) * sizeof(double); }
+static double bytes_symmat_product(int n) { return (2.0 * symmat_size(n) + (double)n * n) * sizeof(double); }
+static double bytes_mixed_product(int n) { return (centrosym_size(n) + 2.0 * n * n) * sizeof(double); }
+static double bytes_square(int n) { return (double)n * n * sizeof(double); }
+static double bytes_centrosym(int n) { return (double)centrosym_size(n) * sizeof(double); }
+static double bytes_symmat(int n) { return (double)symmat_size(n) * sizeof(double); }
+static double bytes_bisym(int n) { return (double)bisym_size(n) * sizeof(double); }
+static double bytes_square_pair(int n) { return 2.0 * n * n * sizeof(double); }
+static double bytes_centrosym_pair(int n) { return 2.0 * centrosym_size(n) * sizeof(double); }
+static double bytes_bisym_pair(int n) { return 2.0 * bisym_size(n) * sizeof(double); }
+static double bytes_symmat_pair(int n) { return 2.0 * symmat_size(n) * sizeof(double); }
+static double bytes_fft(int n) { return 4.0 * fft_size(2 * n - 1) * sizeof(double); }
+static double bytes_vector(int n) { return 3.0 * n * sizeof(double); }
+static double bytes_centrodiag_product(int n) { return 3.0 * centrodiag_size(n) * sizeof(double); }
+static double bytes_centrodiag(int n) { return (double)centrodiag_size(n) * sizeof(double); }
+static double bytes_centrodiag_pair(int n) { return 2.0 * centrodiag_size(n) * sizeof(double); }
+// Single precision operands move half the bytes
+static double bytes_square_product_f(int n) { return bytes_square_product(n) / 2; }
+static double bytes_centrosym_product_f(int n) { return bytes_centrosym_product(n) / 2; }
+static double bytes_bisym_product_f(int n) { return bytes_bisym_product(n) / 2; }
+static double bytes_square_f(int n) { return bytes_square(n) / 2; }
+static double bytes_centrosym_f(int n) { return bytes_centrosym(n) / 2; }
+static double bytes_bisym_f(int n) { return bytes_bisym(n) / 2; }
+static double bytes_square_pair_f(int n) { return bytes_square_pair(n) / 2; }
+static double bytes_centrosym_pair_f(int n) { return bytes_centrosym_pair(n) / 2; }
+static double bytes_bisym_pair_f(int n) { return bytes_bisym_pair(n) / 2; }
+
+static const bench_kernel bench_kernels[] = {
+  { "square_product", run_square_product, flops_cube2, bytes_square_product },
+  { "centrosym_product", run_centrosym_product, flops_cube, bytes_centrosym_product },
+  { "centrosym_product_blockdiag", run_centrosym_product_blockdiag, flops_blocks, bytes_centrosym_product },
+  { "centrodiag_product", run_centrodiag_product, flops_cube, bytes_centrodiag_product },
+  { "bisym_product", run_bisym_product, flops_blocks, bytes_bisym_product },
+  { "symmat_product", run_symmat_product, flops_cube2, bytes_symmat_product },
+  { "centrosym_times_dense", run_centrosym_times_dense, flops_cube, bytes_mixed_product },
+  { "dense_times_centrosym", run_dense_times_centrosym, flops_cube, bytes_mixed_product },
+  { "square_matvec", run_square_matvec, flops_square2, bytes_square },
+  { "centrosym_matvec", run_centrosym_matvec, flops_square, bytes_centrosym },
+  { "symmat_matvec", run_symmat_matvec, flops_square2, bytes_symmat },
+  { "toeplitz_matvec", run_toeplitz_matvec, flops_fft, bytes_fft },
+  { "square_traceprod", run_square_traceprod, flops_square2, bytes_square_pair },
+  { "centrosym_traceprod", run_centrosym_traceprod, flops_square, bytes_centrosym_pair },
+  { "centrodiag_traceprod", run_centrodiag_traceprod, flops_square, bytes_centrodiag_pair },
+  { "bisym_traceprod", run_bisym_traceprod, flops_half, bytes_bisym_pair },
+  { "symmat_traceprod", run_symmat_traceprod, flops_square, bytes_symmat_pair },
+  { "square_quadform", run_square_quadform, flops_square2, bytes_square },
+  { "centrosym_quadform", run_centrosym_quadform, flops_square, bytes_centrosym },
+  { "centrodiag_quadform", run_centrodiag_quadform, flops_square, bytes_centrodiag },
+  { "bisym_quadform", run_bisym_quadform, flops_square, bytes_bisym },
+  { "symmat_quadform", run_symmat_quadform, flops_square2, bytes_symmat },
+  { "toeplitz_solve", run_toeplitz_solve, flops_levinson, bytes_vector },
+  { "toeplitz_logdet", run_toeplitz_logdet, flops_durbin, bytes_vector },
+  { "square_product_f", run_square_product_f, flops_cube2, bytes_square_product_f },
+  { "square_product_fd", run_square_product_fd, flops_cube2, bytes_square_product_f },
+  { "centrosym_product_f", run_centrosym_product_f, flops_cube, bytes_centrosym_product_f },
+  { "centrosym_product_fd", run_centrosym_product_fd, flops_cube, bytes_centrosym_product_f },
+  { "bisym_product_f", run_bisym_product_f, flops_blocks, bytes_bisym_product_f },
+  { "bisym_product_fd", run_bisym_product_fd, flops_blocks, bytes_bisym_product_f },
+  { "square_traceprod_f", run_square_traceprod_f, flops_square2, bytes_square_pair_f },
+  { "square_traceprod_fd", run_square_traceprod_fd, flops_square2, bytes_square_pair_f },
+  { "centrosym_traceprod_f", run_centrosym_traceprod_f, flops_square, bytes_centrosym_pair_f },
+  { "centrosym_traceprod_fd", run_centrosym_traceprod_fd, flops_square, bytes_centrosym_pair_f },
+  { "bisym_traceprod_f", run_bisym_traceprod_f, flops_half, bytes_bisym_pair_f },
+  { "bisym_traceprod_fd", run_bisym_traceprod_fd, flops_half, bytes_bisym_pair_f },
+  { "square_quadform_f", run_square_quadform_f, flops_square2, bytes_square_f },
+  { "square_quadform_fd", run_square_quadform_fd, flops_square2, bytes_square_f },
+  { "centrosym_quadform_f", run_centrosym_quadform_f, flops_square, bytes_centrosym_f },
+  { "centrosym_quadform_fd", run_centrosym_quadform_fd, flops_square, bytes_centrosym_f },
+  { "bisym_quadform_f", run_bisym_quadform_f, flops_square, bytes_bisym_f },
+  { "bisym_quadform_fd", run_bisym_quadform_fd, flops_square, bytes_bisym_f },
+};
+
+
+/*!
+ * Allocate and fill the operands of all the kernels for a given size.
+ * The scratch workspace is large enough for any of the kernels: the six half-size blocks of
+ * the block diagonal products, the transforms of toeplitz_matvec, the tile of centrosym_traceprod,
+ * or the row-major copies of centrodiag_product and the tiles of each thread of centrosym_product_ws.
+ * The single precision operands are allocated on the heap, since the workspaces hand out
+ * double precision buffers.
+ */
+static void bench_data_alloc(bench_data *d, int dim, int wsflags)
+{
+
+  const int m = dim / 2, h = dim - m;
+  d->dim = dim;
+  workspace_init(&d->pool, 3 * workspace_bytes((size_t)dim * dim) + 3 * workspace_bytes(centrosym_size(dim))
+    + 3 * workspace_bytes(centrodiag_size(dim))
+    + 2 * workspace_bytes(bisym_size(dim)) + 2 * workspace_bytes(symmat_size(dim))
+    + workspace_bytes(toeplitz_size(dim)) + workspace_bytes(3 * (size_t)dim), wsflags);
+  workspace_init(&d->scratch, 3 * workspace_bytes((size_t)h * h) + 3 * workspace_bytes((size_t)m * m)
+    + 2 * workspace_bytes(2 * (size_t)fft_size(2 * dim - 1)) + workspace_bytes(dim)
+    + workspace_bytes((size_t)tiling_size() * tiling_size()) + 3 * workspace_bytes(centrosym_size(dim))
+    + parallel_threads() * workspace_bytes((size_t)tiling_size() * (dim + tiling_size())) + workspace_bytes(dim), wsflags);
+  square_alloc_ws(&d->full1, dim, &d->pool);
+  square_alloc_ws(&d->full2, dim, &d->pool);
+  square_alloc_ws(&d->full3, dim, &d->pool);
+  centrosym_alloc_ws(&d->centro1, dim, &d->pool);
+  centrosym_alloc_ws(&d->centro2, dim, &d->pool);
+  centrosym_alloc_ws(&d->centro3, dim, &d->pool);
+  centrodiag_alloc_ws(&d->diag1, dim, &d->pool);
+  centrodiag_alloc_ws(&d->diag2, dim, &d->pool);
+  centrodiag_alloc_ws(&d->diag3, dim, &d->pool);
+  bisym_alloc_ws(&d->bisym1, dim, &d->pool);
+  bisym_alloc_ws(&d->bisym2, dim, &d->pool);
+  symmat_alloc_ws(&d->sym1, dim, &d->pool);
+  symmat_alloc_ws(&d->sym2, dim, &d->pool);
+  toeplitz_alloc_ws(&d->toep, dim, &d->pool);
+  d->x = workspace_take(&d->pool, 3 * (size_t)dim);
+  d->y = d->x + dim;
+  d->z = d->y + dim;
+  square_alloc_f(&d->full1f, dim);
+  square_alloc_f(&d->full2f, dim);
+  square_alloc_f(&d->full3f, dim);
+  centrosym_alloc_f(&d->centro1f, dim);
+  centrosym_alloc_f(&d->centro2f, dim);
+  centrosym_alloc_f(&d->centro3f, dim);
+  bisym_alloc_f(&d->bisym1f, dim);
+  bisym_alloc_f(&d->bisym2f, dim);
+  d->xf = workspace_calloc_f(2 * (size_t)dim);
+  d->yf = d->xf + dim;
+
+  // Bisymmetric matrices are also centrosymmetric and symmetric, so one pair feeds every format
+  bisym_full_random(d->full1, dim);
+  bisym_full_random(d->full2, dim);
+  centrosym_full_extractcomp(d->centro1, d->full1, dim);
+  centrosym_full_extractcomp(d->centro2, d->full2, dim);
+  centrodiag_full_extractcomp(d->diag1, d->full1, dim);
+  centrodiag_full_extractcomp(d->diag2, d->full2, dim);
+  bisym_full_extractcomp(d->bisym1, d->full1, dim);
+  bisym_full_extractcomp(d->bisym2, d->full2, dim);
+  symmat_full_extractcomp(d->sym1, d->full1, dim);
+  symmat_full_extractcomp(d->sym2, d->full2, dim);
+  toeplitz_full_extractcomp(d->toep, d->full1, dim);
+  d->toep[0] += 2 * dim;
+  vector_random(d->x, dim);
+  vector_random(d->y, dim);
+  vector_to_float(d->full1f, d->full1, (long)dim * dim);
+  vector_to_float(d->full2f, d->full2, (long)dim * dim);
+  centrosym_full_extractcomp_f(d->centro1f, d->full1, dim);
+  centrosym_full_extractcomp_f(d->centro2f, d->full2, dim);
+  bisym_full_extractcomp_f(d->bisym1f, d->full1, dim);
+  bisym_full_extractcomp_f(d->bisym2f, d->full2, dim);
+  vector_to_float(d->xf, d->x, dim);
+  vector_to_float(d->yf, d->y, dim);
+
+}
+
+
+static void bench_data_free(bench_data *d)
+{
+
+  workspace_free(&d->pool);
+  workspace_free(&d->scratch);
+  free(d->full1f);
+  free(d->full2f);
+  free(d->full3f);
+  free(d->centro1f);
+  free(d->centro2f);
+  free(d->centro3f);
+  free(d->bisym1f);
+  free(d->bisym2f);
+  free(d->xf);
+
+}
+
+
+static int bench_compare(const void *a, const void *b)
+{
+
+  const double da = *(const double*)a, db = *(const double*)b;
+  return (da > db) - (da < db);
+
+}
+
+
+/*!
+ * Percentile of sorted samples, with linear interpolation between the closest ranks.
+ */
+static double bench_percentile(const double *sorted, int n, double q)
+{
+
+  const double pos = q * (n - 1);
+  const int i = (int)floor(pos);
+  if( i >= n - 1 )
+    return sorted[n-1];
+  return sorted[i] + (pos - i) * (sorted[i+1] - sorted[i]);
+
+}
+
+
+/*!
+ * Time a kernel: warmup, then samples of ncalls calls, ncalls being chosen so that a sample
+ * lasts at least BENCH_MINTIME. Slow kernels get fewer samples so that a kernel never takes
+ * much more than BENCH_MAXTIME.
+ *
+ * \param[out]  stats The latency statistics (seconds per call).
+ * \param[in]  kernel The kernel.
+ * \param[in]  data Its operands.
+ * \param[in]  nsamples The maximal number of samples.
+ * \param[in]  pc The hardware counters, read over one more sample (NULL or none available to skip them).
+ * \retval none
+ */
+static void bench_run(bench_stats *stats, const bench_kernel *kernel, bench_data *data, int nsamples, perfcount *pc)
+{
+
+  int s, c, ncalls;
+  double t1, t2, tcall, twarm = 0.0;
+  double *samples = (double*)calloc(nsamples, sizeof(double));
+
+  // Warmup, which also gives a first estimate of the time per call
+  ncalls = 0;
+  t1 = timer_now();
+  do {
+    kernel->run(data);
+    ncalls++;
+    twarm = timer_now() - t1;
+  } while( twarm < BENCH_WARMUP && twarm < BENCH_MAXTIME / nsamples );
+  tcall = twarm / ncalls;
+
+  ncalls = MAX(1, (int)ceil(BENCH_MINTIME / tcall));
+  nsamples = MAX(3, MIN(nsamples, (int)(BENCH_MAXTIME / (tcall * ncalls))));
+  for(s = 0; s < nsamples; s++){
+    t1 = timer_now();
+    for(c = 0; c < ncalls; c++)
+      kernel->run(data);
+    t2 = timer_now();
+    samples[s] = (t2 - t1) / ncalls;
+  }
+
+  qsort(samples, nsamples, sizeof(double), bench_compare);
+  stats->median = bench_percentile(samples, nsamples, 0.5);
+  stats->p10 = bench_percentile(samples, nsamples, 0.1);
+  stats->p90 = bench_percentile(samples, nsamples, 0.9);
+  stats->nsamples = nsamples;
+  stats->ncalls = ncalls;
+  free(samples);
+
+  // Counters per call, over a separate sample so that they do not perturb the timings
+  for(s = 0; s < PERFCOUNT_NEVENTS; s++)
+    stats->counters[s] = NAN;
+  if( pc && pc->navailable > 0 ){
+    perfcount_start(pc);
+    for(c = 0; c < ncalls; c++)
+      kernel->run(data);
+    perfcount_stop(pc, stats->counters);
+    for(s = 0; s < PERFCOUNT_NEVENTS; s++)
+      stats->counters[s] /= ncalls;
+  }
+
+}
+
+
+/*!
+ * Parse a comma-separated list of positive integers.
+ *
+ * \retval The number of values read.
+ */
+static int bench_parse_list(int *list, const char *str)
+{
+
+  int n = 0;
+  const char *p = str;
+  while( *p && n < BENCH_MAXLIST ){
+    char *end;
+    long val = strtol(p, &end, 10);
+    if( end == p || val <= 0 )
+      break;
+    list[n++] = (int)val;
+    p = *end == ',' ? end + 1 : end;
+  }
+  return n;
+
+}
+
+
+static void bench_usage(const char *prog)
+{
+
+  printf("Usage: %s [options]\n", prog);
+  printf("  --sizes n1,n2,...     matrix dimensions (default 128,256,512)\n");
+  printf("  --threads t1,t2,...   thread counts (default 1 and the maximum)\n");
+  printf("  --samples n           maximal number of samples per kernel (default %i)\n", BENCH_SAMPLES);
+  printf("  --filter str          only run the kernels whose name contains str\n");
+  printf("  --csv file            write the results as CSV\n");
+  printf("  --json file           write the results as JSON\n");
+  printf("  --counters            collect hardware counters (Linux perf_event_open), per call\n");
+  printf("  --hugepages           back the operands and the scratch space with huge pages\n");
+
+}
+
+
+int main(int argc, char *argv[])
+{
+
+  int sizes[BENCH_MAXLIST] = { 128, 256, 512 }, threads[BENCH_MAXLIST];
+  int nsizes = 3, nthreads, nsamples = BENCH_SAMPLES;
+  int a, is, it, k, e, first = 1, counters = 0, wsflags = 0;
+  perfcount pc;
+  const char *filter = NULL, *csvname = NULL, *jsonname = NULL;
+  FILE *csv = NULL, *json = NULL;
+  const int nkernels = sizeof(bench_kernels) / sizeof(bench_kernels[0]);
+
+  parallel_set_threads(0);
+  threads[0] = 1;
+  threads[1] = parallel_threads();
+  nthreads = threads[1] > 1 ? 2 : 1;
+
+  for(a = 1; a < argc; a++){
+    if( strcmp(argv[a], "--sizes") == 0 && a + 1 < argc )
+      nsizes = bench_parse_list(sizes, argv[++a]);
+    else if( strcmp(argv[a], "--threads") == 0 && a + 1 < argc )
+      nthreads = bench_parse_list(threads, argv[++a]);
+    else if( strcmp(argv[a], "--samples") == 0 && a + 1 < argc ){
+      nsamples = atoi(argv[++a]);
+      nsamples = MAX(3, nsamples);
+    }
+    else if( strcmp(argv[a], "--filter") == 0 && a + 1 < argc )
+      filter = argv[++a];
+    else if( strcmp(argv[a], "--csv") == 0 && a + 1 < argc )
+      csvname = argv[++a];
+    else if( strcmp(argv[a], "--json") == 0 && a + 1 < argc )
+      jsonname = argv[++a];
+    else if( strcmp(argv[a], "--counters") == 0 )
+      counters = 1;
+    else if( strcmp(argv[a], "--hugepages") == 0 )
+      wsflags = WORKSPACE_HUGEPAGES;
+    else {
+      bench_usage(argv[0]);
+      return strcmp(argv[a], "--help") == 0 ? 0 : 1;
+    }
+  }
+
+  if( csvname ){
+    csv = fopen(csvname, "w");
+    if( csv == NULL ){
+      printf("Cannot open %s\n", csvname);
+      return 1;
+    }
+    fprintf(csv, "kernel,dim,threads,median_s,p10_s,p90_s,gflops,gbytes_per_s,samples,calls_per_sample");
+    for(e = 0; e < PERFCOUNT_NEVENTS; e++)
+      fprintf(csv, ",%s", perfcount_name(e));
+    fprintf(csv, "\n");
+  }
+  if( jsonname ){
+    json = fopen(jsonname, "w");
+    if( json == NULL ){
+      printf("Cannot open %s\n", jsonname);
+      return 1;
+    }
+    fprintf(json, "{\n  \"simd\": \"%s\",\n  \"tile\": %i,\n  \"timer_resolution_s\": %g,\n  \"results\": [",
+      simd_name(simd_level()), tiling_size(), timer_resolution());
+  }
+
+  printf("==============================================\n");
+  printf("SYMTRX BENCHMARKS\n");
+  printf("----------------------------------------------\n");
+  // Open the counters before the first parallel region, so that the OpenMP workers inherit them
+  if( counters && perfcount_open(&pc) == 0 )
+    printf("Hardware counters not available (perf_event_open failed), timings only\n");
+  printf("SIMD level : %s, tile size : %i, timer resolution : %g s\n",
+    simd_name(simd_level()), tiling_size(), timer_resolution());
+  printf("%-28s %6s %4s %12s %12s %12s %9s %9s\n",
+    "kernel", "dim", "thr", "median (s)", "p10 (s)", "p90 (s)", "GFLOP/s", "GB/s");
+
+  for(is = 0; is < nsizes; is++){
+    bench_data data;
+    bench_data_alloc(&data, sizes[is], wsflags);
+    for(it = 0; it < nthreads; it++){
+      parallel_set_threads(threads[it]);
+      for(k = 0; k < nkernels; k++){
+        const bench_kernel *kernel = &bench_kernels[k];
+        if( filter && strstr(kernel->name, filter) == NULL )
+          continue;
+        bench_stats stats;
+        bench_run(&stats, kernel, &data, nsamples, counters ? &pc : NULL);
+        const double gflops = kernel->flops(sizes[is]) / stats.median / 1e9;
+        const double gbytes = kernel->bytes(sizes[is]) / stats.median / 1e9;
+        printf("%-28s %6i %4i %12.4e %12.4e %12.4e %9.3f %9.3f\n", kernel->name, sizes[is], threads[it],
+          stats.median, stats.p10, stats.p90, gflops, gbytes);
+        if( counters && pc.navailable > 0 ){
+          printf("%-28s per call:", "");
+          for(e = 0; e < PERFCOUNT_NEVENTS; e++)
+            if( isnan(stats.counters[e]) )
+              printf(" %s n/a", perfcount_name(e));
+            else
+              printf(" %s %.4g", perfcount_name(e), stats.counters[e]);
+          if( !isnan(stats.counters[PERFCOUNT_INSTRUCTIONS]) && !isnan(stats.counters[PERFCOUNT_CYCLES]) )
+            printf(" (IPC %.2f)", stats.counters[PERFCOUNT_INSTRUCTIONS] / stats.counters[PERFCOUNT_CYCLES]);
+          printf("\n");
+        }
+        fflush(stdout);
+        if( csv ){
+          fprintf(csv, "%s,%i,%i,%.6e,%.6e,%.6e,%.4f,%.4f,%i,%i", kernel->name, sizes[is], threads[it],
+            stats.median, stats.p10, stats.p90, gflops, gbytes, stats.nsamples, stats.ncalls);
+          // Missing counters are left empty
+          for(e = 0; e < PERFCOUNT_NEVENTS; e++)
+            if( isnan(stats.counters[e]) )
+              fprintf(csv, ",");
+            else
+              fprintf(csv, ",%.6g", stats.counters[e]);
+          fprintf(csv, "\n");
+        }
+        if( json ){
+          fprintf(json, "%s\n    {\"kernel\": \"%s\", \"dim\": %i, \"threads\": %i, \"median_s\": %.6e, "
+            "\"p10_s\": %.6e, \"p90_s\": %.6e, \"gflops\": %.4f, \"gbytes_per_s\": %.4f, "
+            "\"samples\": %i, \"calls_per_sample\": %i", first ? "" : ",", kernel->name, sizes[is], threads[it],
+            stats.median, stats.p10, stats.p90, gflops, gbytes, stats.nsamples, stats.ncalls);
+          // Missing counters are null
+          for(e = 0; e < PERFCOUNT_NEVENTS; e++)
+            if( isnan(stats.counters[e]) )
+              fprintf(json, ", \"%s\": null", perfcount_name(e));
+            else
+              fprintf(json, ", \"%s\": %.6g", perfcount_name(e), stats.counters[e]);
+          fprintf(json, "}");
+          first = 0;
+        }
+      }
+    }
+    if( data.pool.nheap > 0 || data.scratch.nheap > 0 )
+      printf("Workspaces too small for dim %i (%li heap allocations)\n", sizes[is], data.pool.nheap + data.scratch.nheap);
+    printf("Workspaces for dim %i : operands %.2f MB, scratch peak %.2f MB%s\n", sizes[is],
+      data.pool.peak / 1048576.0, data.scratch.peak / 1048576.0, data.pool.hugepages ? " (huge pages)" : "");
+    bench_data_free(&data);
+  }
+  parallel_set_threads(0);
+  if( counters )
+    perfcount_close(&pc);
+
+  if( csv )
+    fclose(csv);
+  if( json ){
+    fprintf(json, "\n  ]\n}\n");
+    fclose(json);
+  }
+  printf("==============================================\n");
+  return 0;
+
+}
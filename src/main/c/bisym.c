@@ -19,12 +19,12 @@
  * \param[in]  dim The dimensions.
  * \retval Its size in memory.
  */
-int bisym_size(int dim){
+long bisym_size(int dim){
 
   if( dim % 2 == 0 ) // even 
-    return dim*(dim+2)/4;
+    return (long)dim*(dim+2)/4;
   else{ //odd
-    int n = floor(dim/2);
+    long n = dim / 2;
     return n*(n+1) + n + 1;
   }
 
@@ -41,41 +41,49 @@ int bisym_size(int dim){
 void bisym_alloc(double **mat, int dim)
 {
 
-  *mat = (double*)calloc( bisym_size(dim), sizeof(double));
+  *mat = workspace_calloc(bisym_size(dim));
 
 }
 
 
 /*!
- * Return index for the (i,j)th elements of a bisymmetric square matrix (fast; must have j <= i).
+ * Take space for a bisymmetric square matrix (compressed form) from a workspace (see workspace_take).
  *
- * \param[in]  i Row index.
- * \param[in]  j Column index.
- * \param[in]  dim Matrix dimension.
- * \retval The index of the j-th element of the i-th row.
+ * \param[out]  mat The matrix, to be given back with workspace_give.
+ * \param[in]  dim Its dimension.
+ * \param[in]  ws The workspace (may be NULL).
+ * \retval none
  */
-int bisym_ind(int i, int j, int dim){
+void bisym_alloc_ws(double **mat, int dim, workspace *ws)
+{
 
-  /*
-  int normalcount = i*(i+1)/2 + j;
-  int activator = i / ( dim / 2 + dim % 2 + 1 );
-  int numberofterms = i - ( dim / 2 + dim % 2 ) ;
-  int firstterm = 1 + dim % 2 ;
-  int lastterm = 2 * (i - ( dim / 2 + dim % 2 )) - 1 + dim % 2;
-  int count =  (numberofterms * (firstterm + lastterm)) / 2 ;
-  printf(" %i ", normalcount - activator*count);
-  */
-  if( i / ( dim / 2 + dim % 2 + 1 ) )
-    return i*(i+1)/2 + j - (i - ( dim / 2 + dim % 2 )) * ( 2 * dim % 2 + 2 * (i - ( dim / 2 + dim % 2 )) );
-  else
-    return i*(i+1)/2 + j;
+  *mat = workspace_take(ws, bisym_size(dim));
 
 }
 
 
 
 /*!
- * Create random bisymmetric square matrix (full form, full square matrix).
+ * Create random bisymmetric square matrix (compressed form), written directly in packed storage.
+ * Same result for any number of threads.
+ *
+ * \param[out]  mat The matrix in compressed form.
+ * \param[in]  dim Its dimension.
+ * \param[in]  seed The seed.
+ * \param[in]  stream The stream (see random_fill).
+ * \retval none
+ */
+void bisym_random(double *mat, int dim, uint64_t seed, uint64_t stream)
+{
+
+  random_fill(mat, bisym_size(dim), seed, stream, 0);
+
+}
+
+
+/*!
+ * Create random bisymmetric square matrix (full form, full square matrix),
+ * from the next stream of the default seed (see random_set_seed).
  *
  * \param[out]  mat The matrix.
  * \param[in]  dim Its dimension.
@@ -84,18 +92,11 @@ int bisym_ind(int i, int j, int dim){
 void bisym_full_random(double *mat, int dim)
 {
 
-  const int seed = (int)(10000.0*(double)clock()/(double)CLOCKS_PER_SEC);
-  int i, j;
-  double val;
-  for(i = 0; i < dim; i++){
-    for(j = 0; j <= MIN(i, dim-i-1) ; j++){
-      val = ran2_dp(seed);
-      mat[ square_ind(i,j,dim) ] = val;
-      mat[ square_ind(dim-i-1,dim-j-1,dim) ] = val ;
-      mat[ square_ind(j,i,dim) ] = val ;
-      mat[ square_ind(dim-j-1,dim-i-1,dim) ] = val ;
-    }
-  }
+  double *matcomp;
+  bisym_alloc(&matcomp, dim);
+  bisym_random(matcomp, dim, random_seed(), random_next_stream());
+  bisym_comp_expandfull(mat, matcomp, dim);
+  free(matcomp);
 
 }
 
@@ -108,13 +109,46 @@ void bisym_full_random(double *mat, int dim)
  * \param[in]  dim Its dimension.
  * \retval none
  */
-void bisym_full_extractcomp(double *matcomp, double *matfull, int dim)
+void bisym_full_extractcomp(double *matcomp, const double *matfull, int dim)
 {
 
-  int i, j;
-  for(i = 0; i < dim; i++)
-    for(j = 0; j <= MIN(i, dim-i-1); j++)
-      matcomp[ bisym_ind(i,j,dim) ] = matfull[ square_ind(i,j,dim) ];
+  int i, j, len;
+  double *row = matcomp;
+  for(i = 0; i < dim; i++){
+    len = MIN(i, dim-i-1) + 1;
+    for(j = 0; j < len; j++)
+      row[j] = matfull[ square_ind(i,j,dim) ];
+    row += len;
+  }
+
+}
+
+
+/*!
+ * Expand the full form of a bisymmetric matrix from its compressed form.
+ *
+ * \param[out]  matfull The matrix in full form (square matrix).
+ * \param[in]  matcomp The matrix in compressed form.
+ * \param[in]  dim Its dimension.
+ * \retval none
+ */
+void bisym_comp_expandfull(double *matfull, const double *matcomp, int dim)
+{
+
+  int i, j, len;
+  double val;
+  const double *row = matcomp;
+  for(i = 0; i < dim; i++){
+    len = MIN(i, dim-i-1) + 1;
+    for(j = 0; j < len; j++){
+      val = row[j];
+      matfull[ square_ind(i,j,dim) ] = val;
+      matfull[ square_ind(dim-i-1,dim-j-1,dim) ] = val;
+      matfull[ square_ind(j,i,dim) ] = val;
+      matfull[ square_ind(dim-j-1,dim-i-1,dim) ] = val;
+    }
+    row += len;
+  }
 
 }
 
@@ -127,16 +161,17 @@ void bisym_full_extractcomp(double *matcomp, double *matfull, int dim)
  * \param[in]  dim Their dimensions.
  * \retval 1 if they are equal.
  */
-int bisym_assertequal(double *matcomp1, double *matcomp2, int dim)
+int bisym_assertequal(const double *matcomp1, const double *matcomp2, int dim)
 {
 
-  int i, j;
-  for(i = 0; i < dim; i++)
-    for(j = 0; j <= MIN(i, dim-i-1); j++)
-      if( abs(matcomp1[ bisym_ind(i,j,dim) ] - matcomp2[ bisym_ind(i,j,dim)]) > PRECISION  ){
-        //WARNING: printf("Problem : %2.3e - %2.3e = %2.3e\n",matcomp1[ centrosym_ind(i,j,dim) ],matcomp2[ centrosym_ind(i,j,dim) ], matcomp1[ centrosym_ind(i,j,dim) ] - matcomp2[ centrosym_ind(i,j,dim)]);
-        return 0;
-      }
+  // The compressed forms are contiguous: compare them element by element
+  long t;
+  const long size = bisym_size(dim);
+  for(t = 0; t < size; t++)
+    if( fabs(matcomp1[t] - matcomp2[t]) > PRECISION  ){
+      //WARNING: printf("Problem : %2.3e - %2.3e = %2.3e\n",matcomp1[t],matcomp2[t], matcomp1[t] - matcomp2[t]);
+      return 0;
+    }
   return 1;  
 
 }
@@ -149,7 +184,7 @@ int bisym_assertequal(double *matcomp1, double *matcomp2, int dim)
  * \param[in]  dim Its dimension.
  * \retval none
  */
-void bisym_print(double *mat, int dim)
+void bisym_print(const double *mat, int dim)
 {
 
   int i, j;
@@ -163,36 +198,120 @@ void bisym_print(double *mat, int dim)
 }
 
 
+// Folds, products, trace-products and quadratic forms, in double, single and mixed precision
+#define PREC_FILE "bisym_prec.inc"
+#include "prec.inc"
+#undef PREC_FILE
+
+
 /*!
- * Compute the product of two bisymmetric square matrices in compressed form (v1, fast).
+ * Compute the trace of a bisymmetric square matrix in compressed form.
+ * The diagonal elements are the last ones of the first (dim+1)/2 rows.
  *
- * \param[out]  outmat The resulting matrix.
- * \param[in]  mat1 The first matrix.
- * \param[in]  mat2 The second matrix.
- * \param[in]  dim Their dimensions.
- * \retval none
+ * \param[in]  mat The input matrix.
+ * \param[in]  dim Its dimensions.
+ * \retval The trace of the matrix.
  */
-void bisym_product(double *outmat, double *mat1, double *mat2, int dim)
+double bisym_trace(const double *mat, int dim)
 {
 
-  int i, j, k;
-  for(i = 0; i < dim; i++){
+  int i;
+  const int m = dim / 2;
+  double res = 0.0;
+  const double *row = mat;
+  for(i = 0; i < m; i++){
+    res += row[i];
+    row += i + 1;
+  }
+  res *= 2.0;
+  if( dim % 2 == 1 )
+    res += row[m];
+  return res;
 
-    for(j = 0; j <= MIN(i, dim-i-1); j++)
-      outmat[ bisym_ind(i,j, dim) ] = 0.0;
+}
 
-    for(k = 0; k <= MIN(i, dim-i-1); k++){
 
-      for(j = 0; j <= MIN(k, dim-k-1); j++)
-        outmat[ bisym_ind(i,j,dim) ] += 
-          mat1[ bisym_ind(i,k,dim) ] * mat2[ bisym_ind(k,j,dim) ];
+/*!
+ * Compute the eigenvalues and eigenvectors of a bisymmetric matrix in compressed form.
+ * The eigenvectors are either symmetric or skew-symmetric under reversal, so the
+ * problem splits into two symmetric eigenproblems of size (dim+1)/2 and dim/2
+ * (see bisym_fold), solved with square_symeig.
+ * The eigenvectors are stored in packed form: the (dim+1)/2 symmetric ones come first,
+ * each as its first (dim+1)/2 folded coordinates, followed by the dim/2 skew-symmetric
+ * ones, each as its first dim/2 folded coordinates (see bisym_eigvec_expand).
+ *
+ * \param[out]  eigval The eigenvalues (dim elements: symmetric then skew-symmetric eigenvectors, each in increasing order).
+ * \param[out]  eigvec The eigenvectors in packed form (((dim+1)/2)^2 + (dim/2)^2 elements), or NULL.
+ * \param[in]  mat The matrix in compressed form.
+ * \param[in]  dim Its dimension.
+ * \retval 1 if the eigensolver converged, 0 otherwise.
+ */
+int bisym_eig(double *eigval, double *eigvec, const double *mat, int dim)
+{
 
-      //...
+  const int m = dim / 2;
+  const int h = dim - m;
+  const int wantvec = ( eigvec != NULL );
+  int res;
+  double *blocks = eigvec;
+  if( !wantvec )
+    blocks = (double*)calloc((size_t)h * h + (size_t)m * m, sizeof(double));
+  bisym_fold(blocks, blocks + (size_t)h * h, mat, dim);
+  res = square_symeig(eigval, blocks, wantvec, h)
+    && square_symeig(eigval + h, blocks + (size_t)h * h, wantvec, m);
+  if( !wantvec )
+    free(blocks);
+  return res;
 
-    }
+}
+
+
+/*!
+ * Compute the eigenvalues of a bisymmetric matrix in compressed form (fast, no eigenvectors).
+ *
+ * \param[out]  eigval The eigenvalues (same order as bisym_eig).
+ * \param[in]  mat The matrix in compressed form.
+ * \param[in]  dim Its dimension.
+ * \retval 1 if the eigensolver converged, 0 otherwise.
+ */
+int bisym_eigval(double *eigval, const double *mat, int dim)
+{
+
+  return bisym_eig(eigval, NULL, mat, dim);
 
-    //...
-    
+}
+
+
+/*!
+ * Expand one of the eigenvectors returned by bisym_eig into a full vector.
+ *
+ * \param[out]  vec The eigenvector (dim elements, unit norm).
+ * \param[in]  eigvec The eigenvectors in packed form (see bisym_eig).
+ * \param[in]  k The index of the eigenvector (same as for the eigenvalues).
+ * \param[in]  dim The dimension.
+ * \retval none
+ */
+void bisym_eigvec_expand(double *vec, const double *eigvec, int k, int dim)
+{
+
+  int i;
+  const int m = dim / 2;
+  const int h = dim - m;
+  const double *u;
+  if( k < h ){
+    u = eigvec + (size_t)k * h;
+    for(i = 0; i < m; i++)
+      vec[i] = vec[dim-i-1] = u[i] / M_SQRT2;
+    if( h > m )
+      vec[m] = u[m];
+  } else {
+    u = eigvec + (size_t)h * h + (size_t)(k - h) * m;
+    for(i = 0; i < m; i++){
+      vec[i] = u[i] / M_SQRT2;
+      vec[dim-i-1] = - u[i] / M_SQRT2;
+    }
+    if( h > m )
+      vec[m] = 0.0;
   }
 
 }
@@ -205,20 +324,20 @@ void bisym_product(double *outmat, double *mat1, double *mat2, int dim)
  * \param[in]  dim Its dimensions.
  * \retval 1 if valid bisymmetric matrix.
  */
-int bisym_isvalid(double *mat, int dim)
+int bisym_isvalid(const double *mat, int dim)
 {
 
   int i, j;
   for(i = 0; i < dim; i++){
     for(j = 0; j < dim; j++){
       if( 
-          abs(mat[ square_ind(i,j,dim) ] 
+          fabs(mat[ square_ind(i,j,dim) ] 
             - mat[ square_ind(dim-i-1,dim-j-1,dim) ]) > PRECISION 
           ||
-          abs(mat[ square_ind(i,j,dim) ] 
+          fabs(mat[ square_ind(i,j,dim) ] 
             - mat[ square_ind(j,i,dim) ]) > PRECISION 
           ||
-          abs(mat[ square_ind(i,j,dim) ] 
+          fabs(mat[ square_ind(i,j,dim) ] 
             - mat[ square_ind(dim-j-1,dim-i-1,dim) ]) > PRECISION 
           ){
         //WARNING: printf("Problem : %2.3e != %2.3e\n",mat[ square_ind(i,j,dim) ],mat[ square_ind(dim-i-1,dim-j-1,dim) ]);
@@ -229,3 +348,45 @@ int bisym_isvalid(double *mat, int dim)
   return 1;
 
 }
+
+
+// ======================================== //
+// Single precision: float storage, with float (_f) or double (_fd) accumulation (see simd.h).
+// The kernels are instantiated from bisym_prec.inc with the double precision ones.
+
+/*!
+ * Allocate space for bisymmetric square matrix in single precision.
+ *
+ * \param[out]  mat The matrix.
+ * \param[in]  dim Its dimension.
+ * \retval none
+ */
+void bisym_alloc_f(float **mat, int dim)
+{
+
+  *mat = workspace_calloc_f(bisym_size(dim));
+
+}
+
+
+/*!
+ * Extract the compressed form of a bisymmetric matrix in single precision.
+ *
+ * \param[out]  matcomp The matrix in compressed form (single precision).
+ * \param[in]  matfull The matrix in full form (square matrix).
+ * \param[in]  dim Its dimension.
+ * \retval none
+ */
+void bisym_full_extractcomp_f(float *matcomp, const double *matfull, int dim)
+{
+
+  int i, j, len;
+  float *row = matcomp;
+  for(i = 0; i < dim; i++){
+    len = MIN(i, dim-i-1) + 1;
+    for(j = 0; j < len; j++)
+      row[j] = (float)matfull[ square_ind(i,j,dim) ];
+    row += len;
+  }
+
+}
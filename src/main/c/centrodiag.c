@@ -0,0 +1,363 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#include "symtrx.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#define MAX(a,b) ((a) > (b) ? (a) : (b))
+#define MIN(a,b) ((a) > (b) ? (b) : (a))
+
+// Diagonal-major compressed form of a centrosymmetric matrix:
+// the subdiagonals k = 0..dim-1 are stored one after the other, the k-th one
+// holding A(k+j,j) for j = 0..dim-k-1. Since A(i,j) = A(dim-i-1,dim-j-1),
+// the k-th superdiagonal is the k-th subdiagonal read backwards, so that the
+// mirrored elements are contiguous too.
+
+/*!
+ * Compute the actual size of a centrosymmetric matrix in diagonal-major compressed form.
+ *
+ * \param[in]  dim The dimensions.
+ * \retval Its size in memory (same as centrosym_size).
+ */
+long centrodiag_size(int dim)
+{
+
+  return centrosym_size(dim);
+
+}
+
+
+/*!
+ * Allocate space for a centrosymmetric square matrix in diagonal-major compressed form.
+ *
+ * \param[out]  mat The matrix.
+ * \param[in]  dim Its dimension.
+ * \retval none
+ */
+void centrodiag_alloc(double **mat, int dim)
+{
+
+  *mat = workspace_calloc(centrodiag_size(dim));
+
+}
+
+
+/*!
+ * Take space for a centrosymmetric square matrix in diagonal-major compressed form from a workspace (see workspace_take).
+ *
+ * \param[out]  mat The matrix, to be given back with workspace_give.
+ * \param[in]  dim Its dimension.
+ * \param[in]  ws The workspace (may be NULL).
+ * \retval none
+ */
+void centrodiag_alloc_ws(double **mat, int dim, workspace *ws)
+{
+
+  *mat = workspace_take(ws, centrodiag_size(dim));
+
+}
+
+
+/*!
+ * Extract the diagonal-major compressed form of a centrosymmetric matrix from its square form.
+ *
+ * \param[out]  matcomp The matrix in diagonal-major compressed form.
+ * \param[in]  matfull The matrix in full form (square matrix).
+ * \param[in]  dim Its dimension.
+ * \retval none
+ */
+void centrodiag_full_extractcomp(double *matcomp, const double *matfull, int dim)
+{
+
+  int k, j;
+  double *diag = matcomp;
+  for(k = 0; k < dim; k++){
+    for(j = 0; j < dim-k; j++)
+      diag[j] = matfull[ square_ind(k+j,j,dim) ];
+    diag += dim - k;
+  }
+
+}
+
+
+/*!
+ * Expand the full form of a centrosymmetric matrix from its diagonal-major compressed form.
+ *
+ * \param[out]  matfull The matrix in full form (square matrix).
+ * \param[in]  matcomp The matrix in diagonal-major compressed form.
+ * \param[in]  dim Its dimension.
+ * \retval none
+ */
+void centrodiag_comp_expandfull(double *matfull, const double *matcomp, int dim)
+{
+
+  int k, j;
+  const double *diag = matcomp;
+  for(k = 0; k < dim; k++){
+    for(j = 0; j < dim-k; j++){
+      matfull[ square_ind(k+j,j,dim) ] = diag[j];
+      matfull[ square_ind(j,k+j,dim) ] = diag[dim-k-j-1];
+    }
+    diag += dim - k;
+  }
+
+}
+
+
+/*!
+ * Convert a centrosymmetric matrix from the row-major (centrosym) to the diagonal-major compressed form.
+ * Groups of tiling_size() diagonals are filled together, so that the rows they read stay in cache.
+ *
+ * \param[out]  matdiag The matrix in diagonal-major compressed form.
+ * \param[in]  matrow The matrix in row-major compressed form.
+ * \param[in]  dim Its dimension.
+ * \retval none
+ */
+void centrodiag_from_centrosym(double *matdiag, const double *matrow, int dim)
+{
+
+  int k, k0, k1, j;
+  long src, dst;
+  const int tile = tiling_size();
+  for(k0 = 0; k0 < dim; k0 += tile){
+    for(j = 0; j < dim-k0; j++){
+      // Element (k+j,j) for k = k0..k1-1: one row further down for each diagonal
+      k1 = MIN(k0 + tile, dim - j);
+      src = centrosym_ind(k0+j,j,dim);
+      dst = centrodiag_ind(k0+j,j,dim);
+      for(k = k0; k < k1; k++){
+        matdiag[dst] = matrow[src];
+        src += k + j + 1;
+        dst += dim - k;
+      }
+    }
+  }
+
+}
+
+
+/*!
+ * Convert a centrosymmetric matrix from the diagonal-major to the row-major (centrosym) compressed form.
+ * Same traversal as centrodiag_from_centrosym.
+ *
+ * \param[out]  matrow The matrix in row-major compressed form.
+ * \param[in]  matdiag The matrix in diagonal-major compressed form.
+ * \param[in]  dim Its dimension.
+ * \retval none
+ */
+void centrodiag_to_centrosym(double *matrow, const double *matdiag, int dim)
+{
+
+  int k, k0, k1, j;
+  long src, dst;
+  const int tile = tiling_size();
+  for(k0 = 0; k0 < dim; k0 += tile){
+    for(j = 0; j < dim-k0; j++){
+      k1 = MIN(k0 + tile, dim - j);
+      dst = centrosym_ind(k0+j,j,dim);
+      src = centrodiag_ind(k0+j,j,dim);
+      for(k = k0; k < k1; k++){
+        matrow[dst] = matdiag[src];
+        dst += k + j + 1;
+        src += dim - k;
+      }
+    }
+  }
+
+}
+
+
+/*!
+ * Compute the product of two centrosymmetric square matrices in diagonal-major compressed form.
+ * The operands are converted to the row-major form and multiplied with centrosym_product (blocked and
+ * threaded), and the result is converted back: the conversions are O(dim^2), and the product of
+ * the diagonals themselves (a sum of element-wise products of whole diagonals for each output
+ * diagonal) could not be blocked, so that it ran from memory for large matrices.
+ *
+ * \param[out]  outmat The resulting matrix.
+ * \param[in]  mat1 The first matrix.
+ * \param[in]  mat2 The second matrix.
+ * \param[in]  dim Their dimensions.
+ * \retval none
+ */
+void centrodiag_product(double *outmat, const double *mat1, const double *mat2, int dim)
+{
+
+  centrodiag_product_ws(outmat, mat1, mat2, dim, NULL);
+
+}
+
+
+/*!
+ * Same as centrodiag_product, with the row-major copies taken from a workspace
+ * (three centrosymmetric matrices, and the scratch space of centrosym_product_ws).
+ *
+ * \param[out]  outmat The resulting matrix.
+ * \param[in]  mat1 The first matrix.
+ * \param[in]  mat2 The second matrix.
+ * \param[in]  dim Their dimensions.
+ * \param[in]  ws The workspace (may be NULL).
+ * \retval none
+ */
+void centrodiag_product_ws(double *outmat, const double *mat1, const double *mat2, int dim, workspace *ws)
+{
+
+  double *row1, *row2, *row3;
+  centrosym_alloc_ws(&row1, dim, ws);
+  centrosym_alloc_ws(&row2, dim, ws);
+  centrosym_alloc_ws(&row3, dim, ws);
+  centrodiag_to_centrosym(row1, mat1, dim);
+  centrodiag_to_centrosym(row2, mat2, dim);
+  centrosym_product_ws(row3, row1, row2, dim, ws);
+  centrodiag_from_centrosym(outmat, row3, dim);
+  workspace_give(ws, row3);
+  workspace_give(ws, row2);
+  workspace_give(ws, row1);
+
+}
+
+
+/*!
+ * Compute the trace of a centrosymmetric square matrix in diagonal-major compressed form.
+ *
+ * \param[in]  mat The input matrix.
+ * \param[in]  dim Its dimensions.
+ * \retval The trace of the matrix.
+ */
+double centrodiag_trace(const double *mat, int dim)
+{
+
+  int j;
+  double res = 0.0;
+  for(j = 0; j < dim; j++)
+    res += mat[j];
+  return res;
+
+}
+
+
+/*!
+ * Compute the trace of the product of two centrosymmetric square matrices in diagonal-major compressed form.
+ * The k-th subdiagonal of the first matrix meets the k-th superdiagonal of the second, that is
+ * its k-th subdiagonal read backwards: Tr(AB) = a_0.b_0 + 2 sum_{k>0} a_k.rev(b_k).
+ *
+ * \param[in]  mat1 The first matrix.
+ * \param[in]  mat2 The second matrix.
+ * \param[in]  dim Their dimensions.
+ * \retval The trace of mat1 * mat2.
+ */
+double centrodiag_traceprod(const double *mat1, const double *mat2, int dim)
+{
+
+  int k;
+  double res = 0.0;
+  for(k = 1; k < dim; k++)
+    res += simd_dotrev(mat1 + centrodiag_diag(k,dim), mat2 + centrodiag_diag(k,dim), dim - k);
+  return 2.0 * res + simd_dot(mat1, mat2, dim);
+
+}
+
+
+/*!
+ * Compute the quadratic form of a centrosymmetric square matrix in diagonal-major compressed form and two vectors (x^t * A * y).
+ * The product z = A * y is accumulated diagonal by diagonal: the k-th subdiagonal a_k adds a_k[p] * y[p] to z[p+k],
+ * and the k-th superdiagonal adds a_k[p] * y[dim-p-1] to z[dim-p-k-1], i.e. to the reversed vector.
+ * Both updates are contiguous SIMD multiply-adds.
+ *
+ * \param[in]  x The first vector.
+ * \param[in]  mat The square matrix.
+ * \param[in]  y The second vector.
+ * \param[in]  dim Their dimensions.
+ * \retval The quadratic form (x^t * A * y).
+ */
+double centrodiag_quadform(const double *x, const double *mat, const double *y, int dim)
+{
+
+  return centrodiag_quadform_ws(x, mat, y, dim, NULL);
+
+}
+
+
+/*!
+ * Same as centrodiag_quadform, with the temporary vectors taken from a workspace (3*dim doubles).
+ *
+ * \param[in]  x The first vector.
+ * \param[in]  mat The square matrix.
+ * \param[in]  y The second vector.
+ * \param[in]  dim Their dimensions.
+ * \param[in]  ws The workspace (may be NULL).
+ * \retval The quadratic form (x^t * A * y).
+ */
+double centrodiag_quadform_ws(const double *x, const double *mat, const double *y, int dim, workspace *ws)
+{
+
+  int k;
+  double res;
+  double *yrev = workspace_take(ws, 3 * (size_t)dim);
+  double *z = yrev + dim;
+  double *zrev = z + dim;
+  simd_copyrev(yrev, y, dim);
+  simd_muladd(z, mat, y, dim);
+  for(k = 1; k < dim; k++){
+    simd_muladd(z + k, mat + centrodiag_diag(k,dim), y, dim - k);
+    simd_muladd(zrev + k, mat + centrodiag_diag(k,dim), yrev, dim - k);
+  }
+  res = simd_dot(x, z, dim) + simd_dotrev(x, zrev, dim);
+  workspace_give(ws, yrev);
+  return res;
+
+}
+
+
+/*!
+ * Compute the product of a centrosymmetric square matrix in diagonal-major compressed form and a vector (y = A * x).
+ * Same accumulation as centrodiag_quadform: the subdiagonals are multiply-added into y, and the superdiagonals
+ * into the reversed vector, from the reversed input.
+ *
+ * \param[out]  y The output vector.
+ * \param[in]  mat The matrix in compressed form.
+ * \param[in]  x The input vector.
+ * \param[in]  dim Their dimensions.
+ * \retval none
+ */
+void centrodiag_matvec(double *y, const double *mat, const double *x, int dim)
+{
+
+  centrodiag_matvec_ws(y, mat, x, dim, NULL);
+
+}
+
+
+/*!
+ * Same as centrodiag_matvec, with the temporary vectors taken from a workspace (2*dim doubles).
+ *
+ * \param[out]  y The output vector.
+ * \param[in]  mat The matrix in compressed form.
+ * \param[in]  x The input vector.
+ * \param[in]  dim Their dimensions.
+ * \param[in]  ws The workspace (may be NULL).
+ * \retval none
+ */
+void centrodiag_matvec_ws(double *y, const double *mat, const double *x, int dim, workspace *ws)
+{
+
+  int k, i;
+  double *xrev = workspace_take(ws, 2 * (size_t)dim);
+  double *yrev = xrev + dim;
+  simd_copyrev(xrev, x, dim);
+  memset(y, 0, dim * sizeof(double));
+  simd_muladd(y, mat, x, dim);
+  for(k = 1; k < dim; k++){
+    simd_muladd(y + k, mat + centrodiag_diag(k,dim), x, dim - k);
+    simd_muladd(yrev + k, mat + centrodiag_diag(k,dim), xrev, dim - k);
+  }
+  for(i = 0; i < dim; i++)
+    y[i] += yrev[dim-i-1];
+  workspace_give(ws, xrev);
+
+}
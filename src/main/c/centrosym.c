@@ -12,7 +12,20 @@
 #define PRECISION 1e-12
 #define MAX(a,b) ((a) > (b) ? (a) : (b))
 #define MIN(a,b) ((a) > (b) ? (b) : (a))
+#define ROUNDUP(n,m) (((n) + (m) - 1) / (m) * (m))
 
+// Memory for the panels of centrosym_traceprod_batch, and cache for one segment of its second panel
+#define TRACEPROD_BATCH_BUFFER (1L << 27)
+#define TRACEPROD_BATCH_CACHE (1L << 19)
+
+// Factors of the two half-size blocks of a centrosymmetric matrix (plus then minus)
+typedef struct {
+  int dim;
+  int size[2];
+  double *block[2];
+  int *piv[2];
+  int cholesky[2];
+} centrosym_factors;
 
 /*!
  * Compute the actual size of a centrosym square matrix.
@@ -23,7 +36,7 @@
 long centrosym_size(int dim)
 {
 
-  return dim * (dim+1) / 2;
+  return (long)dim * (dim+1) / 2;
 
 }
 
@@ -38,46 +51,51 @@ long centrosym_size(int dim)
 void centrosym_alloc(double **mat, int dim)
 {
 
-  *mat = (double*)calloc(dim * (dim+1) / 2, sizeof(double));
+  *mat = workspace_calloc(centrosym_size(dim));
 
 }
 
+
 /*!
- * Return index for the (i,j)th elements of a centrosymmetric square matrix (fast; must have j <= i).
- * Naive indexing : row by row
+ * Take space for a centrosymmetric square matrix (compressed form) from a workspace (see workspace_take).
  *
- * \param[in]  i Row index.
- * \param[in]  j Column index.
- * \param[in]  dim Matrix dimension.
- * \retval The index of the j-th element of the i-th row.
+ * \param[out]  mat The matrix, to be given back with workspace_give.
+ * \param[in]  dim Its dimension.
+ * \param[in]  ws The workspace (may be NULL).
+ * \retval none
  */
-int centrosym_ind(int i, int j, int dim){  // NAIVE INDEXING: ROW by ROW
+void centrosym_alloc_ws(double **mat, int dim, workspace *ws)
+{
 
-  return i * (i + 1) / 2 + j ;
+  *mat = workspace_take(ws, centrosym_size(dim));
 
 }
 
 /*!
- * Return index for the (i,j)th elements of a centrosymmetric square matrix (fast; must have j <= i).
- * Second indexing : diagonal by diagonal
+ * Create random centrosymmetric square matrix (compressed form), written directly in packed storage.
+ * Same result for any number of threads.
  *
- * \param[in]  i Row index.
- * \param[in]  j Column index.
- * \param[in]  dim Matrix dimension.
- * \retval The index of the j-th element of the i-th row.
+ * \param[out]  mat The matrix in compressed form.
+ * \param[in]  dim Its dimension.
+ * \param[in]  seed The seed.
+ * \param[in]  stream The stream (see random_fill).
+ * \retval none
  */
-int centrosym_ind2(int i, int j, int dim){  // SECOND INDEXING: DIAG by DIAG
-
-  int N = dim - 2;
-  int k = i - j;
+void centrosym_random(double *mat, int dim, uint64_t seed, uint64_t stream)
+{
 
-  return 2 * i - j + N * k - k * (k + 1) / 2 + k;
+  int i;
+  random_fill(mat, centrosym_size(dim), seed, stream, 0);
+  // The diagonal is stored twice (A(i,i) = A(dim-i-1,dim-i-1)): mirror its upper half
+  for(i = dim - dim / 2; i < dim; i++)
+    mat[ centrosym_ind(i,i,dim) ] = mat[ centrosym_ind(dim-i-1,dim-i-1,dim) ];
 
 }
 
 
 /*!
- * Create random centrosymmetric square matrix (full form, full square matrix).
+ * Create random centrosymmetric square matrix (full form, full square matrix),
+ * from the next stream of the default seed (see random_set_seed).
  *
  * \param[out]  mat The matrix.
  * \param[in]  dim Its dimension.
@@ -86,16 +104,11 @@ int centrosym_ind2(int i, int j, int dim){  // SECOND INDEXING: DIAG by DIAG
 void centrosym_full_random(double *mat, int dim)
 {
 
-  const int seed = (int)(10000.0*(double)clock()/(double)CLOCKS_PER_SEC);
-  int i, j;
-  double val;
-  for(i = 0; i < dim; i++){
-    for(j = 0; j <= i; j++){
-      val = ran2_dp(seed);
-      mat[ square_ind(i,j,dim) ] = val;
-      mat[ square_ind(dim-i-1,dim-j-1,dim) ] = val ;
-    }
-  }
+  double *matcomp;
+  centrosym_alloc(&matcomp, dim);
+  centrosym_random(matcomp, dim, random_seed(), random_next_stream());
+  centrosym_comp_expandfull(mat, matcomp, dim);
+  free(matcomp);
 
 }
 
@@ -108,13 +121,34 @@ void centrosym_full_random(double *mat, int dim)
  * \param[in]  dim Its dimension.
  * \retval none
  */
-void centrosym_full_extractcomp(double *matcomp, double *matfull, int dim)
+void centrosym_full_extractcomp(double *matcomp, const double *matfull, int dim)
 {
 
   int i, j;
-  for(i = 0; i < dim; i++)
+  double *row = matcomp;
+  for(i = 0; i < dim; i++){
     for(j = 0; j <= i; j++)
-      matcomp[ centrosym_ind(i,j,dim) ] = matfull[ square_ind(i,j,dim) ];
+      row[j] = matfull[ square_ind(i,j,dim) ];
+    row += i + 1;
+  }
+
+}
+
+
+/*!
+ * Expand the compressed form of a centrosymmetric matrix into its square form.
+ *
+ * \param[out]  matfull The matrix in full form (square matrix).
+ * \param[in]  matcomp The matrix in compressed form (triangle).
+ * \param[in]  dim Its dimension.
+ * \retval none
+ */
+void centrosym_comp_expandfull(double *matfull, const double *matcomp, int dim)
+{
+
+  int i;
+  for(i = 0; i < dim; i++)
+    centrosym_getrow(matfull + square_ind(i,0,dim), matcomp, i, 0, dim, dim);
 
 }
 
@@ -127,16 +161,17 @@ void centrosym_full_extractcomp(double *matcomp, double *matfull, int dim)
  * \param[in]  dim Their dimensions.
  * \retval 1 if they are equal.
  */
-int centrosym_assertequal(double *matcomp1, double *matcomp2, int dim)
+int centrosym_assertequal(const double *matcomp1, const double *matcomp2, int dim)
 {
 
-  int i, j;
-  for(i = 0; i < dim; i++)
-    for(j = 0; j <= i; j++)
-      if( abs(matcomp1[ centrosym_ind(i,j,dim) ] - matcomp2[ centrosym_ind(i,j,dim)]) > PRECISION  ){
-        //printf("Problem : %2.1f - %2.1f = %2.1e\n",matcomp1[ centrosym_ind(i,j,dim) ],matcomp2[ centrosym_ind(i,j,dim) ], matcomp1[ centrosym_ind(i,j,dim) ] - matcomp2[ centrosym_ind(i,j,dim)]);
-        return 0;
-      }
+  // The compressed forms are contiguous: compare them element by element
+  long t;
+  const long size = centrosym_size(dim);
+  for(t = 0; t < size; t++)
+    if( fabs(matcomp1[t] - matcomp2[t]) > PRECISION  ){
+      //printf("Problem : %2.1f - %2.1f = %2.1e\n",matcomp1[t],matcomp2[t], matcomp1[t] - matcomp2[t]);
+      return 0;
+    }
   return 1;   
 
 }
@@ -149,7 +184,7 @@ int centrosym_assertequal(double *matcomp1, double *matcomp2, int dim)
  * \param[in]  dim Its dimension.
  * \retval none
  */
-void centrosym_print(double *mat, int dim)
+void centrosym_print(const double *mat, int dim)
 {
   int i, j;
   for(i = 0; i < dim; i++){
@@ -161,8 +196,60 @@ void centrosym_print(double *mat, int dim)
 }
 
 
+// Rows, products, trace-products and quadratic forms, in double, single and mixed precision
+#define PREC_FILE "centrosym_prec.inc"
+#include "prec.inc"
+#undef PREC_FILE
+
+
+/*!
+ * Fold a centrosymmetric matrix in compressed form into its two half-size blocks.
+ * With J the reversal matrix, the orthogonal change of basis onto the
+ * J-symmetric and J-skew vectors makes the matrix block diagonal:
+ * the "plus" block has size (dim+1)/2 and the "minus" block has size dim/2.
+ * For odd dim the central row and column of the plus block carry a sqrt(2).
+ *
+ * \param[out]  matplus The plus block (square form, (dim+1)/2 x (dim+1)/2).
+ * \param[out]  matminus The minus block (square form, dim/2 x dim/2).
+ * \param[in]  mat The matrix in compressed form.
+ * \param[in]  dim Its dimension.
+ * \retval none
+ */
+void centrosym_fold(double *matplus, double *matminus, const double *mat, int dim)
+{
+
+  int i, k;
+  int m = dim / 2;
+  int h = dim - m;
+  const double *rowlo, *rowhi;
+  for(i = 0; i < m; i++){
+    rowlo = mat + centrosym_ind(i,0,dim);
+    rowhi = mat + centrosym_ind(dim-i-1,0,dim);
+    for(k = 0; k <= i; k++){
+      matplus[ square_ind(i,k,h) ] = rowlo[k] + rowhi[k];
+      matminus[ square_ind(i,k,m) ] = rowlo[k] - rowhi[k];
+    }
+    for(k = i+1; k < m; k++){
+      matplus[ square_ind(i,k,h) ] = rowhi[dim-k-1] + rowhi[k];
+      matminus[ square_ind(i,k,m) ] = rowhi[dim-k-1] - rowhi[k];
+    }
+    if( h > m )
+      matplus[ square_ind(i,m,h) ] = M_SQRT2 * rowhi[m];
+  }
+  if( h > m ){
+    rowlo = mat + centrosym_ind(m,0,dim);
+    for(k = 0; k < m; k++)
+      matplus[ square_ind(m,k,h) ] = M_SQRT2 * rowlo[k];
+    matplus[ square_ind(m,m,h) ] = rowlo[m];
+  }
+
+}
+
+
 /*!
- * Compute the product of two centrosymmetric square matrices in compressed form (v1, fast).
+ * Compute the product of two centrosymmetric square matrices in compressed form (v3, block diagonal).
+ * Both matrices are folded into their half-size blocks, which are multiplied
+ * as dense matrices, and the result is unfolded (about dim^3/4 flops).
  *
  * \param[out]  outmat The resulting matrix.
  * \param[in]  mat1 The first matrix.
@@ -170,64 +257,243 @@ void centrosym_print(double *mat, int dim)
  * \param[in]  dim Their dimensions.
  * \retval none
  */
-void centrosym_product(double *outmat, double *mat1, double *mat2, int dim)
+void centrosym_product_blockdiag(double *outmat, const double *mat1, const double *mat2, int dim)
 {
 
-  int i, j, k;
-  for(i = 0; i < dim; i++){
+  centrosym_product_blockdiag_ws(outmat, mat1, mat2, dim, NULL);
 
-    for(j = 0; j <= i; j++)
-      outmat[ centrosym_ind(i,j,dim) ] = 0.0;
+}
 
-    for(k = 0; k <= i; k++){
 
-      for(j = 0; j <= k; j++)
-        outmat[ centrosym_ind(i,j,dim) ] += 
-          mat1[ centrosym_ind(i,k,dim) ] * mat2[ centrosym_ind(k,j,dim) ];
+/*!
+ * Same as centrosym_product_blockdiag, with the blocks taken from a workspace
+ * (three square matrices of size dim-dim/2 and three of size dim/2).
+ *
+ * \param[out]  outmat The resulting matrix.
+ * \param[in]  mat1 The first matrix.
+ * \param[in]  mat2 The second matrix.
+ * \param[in]  dim Their dimensions.
+ * \param[in]  ws The workspace (may be NULL).
+ * \retval none
+ */
+void centrosym_product_blockdiag_ws(double *outmat, const double *mat1, const double *mat2, int dim, workspace *ws)
+{
+
+  centrosym_product_folded_ws(outmat, mat1, mat2, centrosym_fold, dim, ws);
+
+}
 
-      for(j = k+1; j <= i; j++)
-        outmat[ centrosym_ind(i,j,dim) ] += 
-          mat1[ centrosym_ind(i,k,dim) ] * mat2[ centrosym_ind(dim-k-1,dim-j-1,dim) ];
 
+/*!
+ * Factorise the two half-size blocks of a centrosymmetric matrix in compressed form.
+ * Each block is factorised with Cholesky if it is symmetric positive-definite
+ * (e.g. the matrix is bisymmetric and positive-definite), with LU otherwise.
+ *
+ * \param[out]  fact The factors (see centrosym_factors_free).
+ * \param[in]  mat The matrix in compressed form.
+ * \param[in]  dim Its dimension.
+ * \retval 1 if the matrix is invertible, 0 if it is singular.
+ */
+static int centrosym_factorise(centrosym_factors *fact, const double *mat, int dim)
+{
+
+  int b, i, j, size, symmetric;
+  double *block;
+  fact->dim = dim;
+  fact->size[0] = dim - dim / 2;
+  fact->size[1] = dim / 2;
+  for(b = 0; b < 2; b++){
+    square_alloc(&fact->block[b], fact->size[b]);
+    fact->piv[b] = (int*)calloc(fact->size[b] + 1, sizeof(int));
+  }
+  centrosym_fold(fact->block[0], fact->block[1], mat, dim);
+
+  for(b = 0; b < 2; b++){
+    size = fact->size[b];
+    block = fact->block[b];
+    symmetric = 1;
+    for(i = 0; i < size && symmetric; i++)
+      for(j = 0; j < i; j++)
+        if( block[ square_ind(i,j,size) ] != block[ square_ind(j,i,size) ] ){
+          symmetric = 0;
+          break;
+        }
+    fact->cholesky[b] = 0;
+    if( symmetric ){
+      double *chol;
+      square_alloc(&chol, size);
+      memcpy(chol, block, (size_t)size * size * sizeof(double));
+      if( square_cholesky(chol, size) ){
+        free(block);
+        fact->block[b] = chol;
+        fact->cholesky[b] = 1;
+        continue;
+      }
+      free(chol);
     }
+    if( square_lu(block, fact->piv[b], size) == 0 )
+      return 0;
+  }
+  return 1;
 
-    for(k = i+1 ; k < dim; k++){
+}
 
-      for(j = 0; j <= k; j++)
-        outmat[ centrosym_ind(i,j,dim) ] += 
-          mat1[ centrosym_ind(dim-i-1,dim-k-1,dim) ] * mat2[ centrosym_ind(k,j,dim) ];
 
-      for(j = k+1; j <= i; j++)
-        outmat[ centrosym_ind(i,j,dim) ] += 
-          mat1[ centrosym_ind(dim-i-1,dim-k-1,dim) ] * mat2[ centrosym_ind(dim-k-1,dim-j-1,dim) ];
+/*!
+ * Free the factors of a centrosymmetric matrix.
+ *
+ * \param[inout]  fact The factors (see centrosym_factorise).
+ * \retval none
+ */
+static void centrosym_factors_free(centrosym_factors *fact)
+{
 
-    }  
+  int b;
+  for(b = 0; b < 2; b++){
+    free(fact->block[b]);
+    free(fact->piv[b]);
   }
 
 }
 
 
 /*!
- * Compute the product of two centrosymmetric square matrices in compressed form (v2, slower).
+ * Solve one of the half-size systems, given its factors.
  *
- * \param[out]  outmat The resulting matrix.
- * \param[in]  mat1 The first matrix.
- * \param[in]  mat2 The second matrix.
- * \param[in]  dim Their dimensions.
+ * \param[inout]  x The right-hand sides, then the solutions (size x nrhs).
+ * \param[in]  fact The factors (see centrosym_factorise).
+ * \param[in]  b 0 for the plus block, 1 for the minus block.
+ * \param[in]  nrhs The number of right-hand sides.
  * \retval none
  */
-void centrosym_product2(double *outmat, double *mat1, double *mat2, int dim)
+static void centrosym_factors_solve(double *x, centrosym_factors *fact, int b, int nrhs)
 {
-  int i, j, k;
-  for(i = 0; i < dim; i++){
-    for(j = 0; j <= i; j++){
-      outmat[ centrosym_ind2(i,j,dim) ] = 0.0;
-      for(k = 0; k < dim; k++){
-        outmat[ centrosym_ind2(i,j,dim) ] += 
-          mat1[ centrosym_ind2(i,k,dim) ] * mat2[ centrosym_ind2(k,j,dim) ];
-      }
+
+  if( fact->size[b] == 0 )
+    return;
+  if( fact->cholesky[b] )
+    square_cholesky_solve(x, fact->block[b], x, nrhs, fact->size[b]);
+  else
+    square_lu_solve(x, fact->block[b], fact->piv[b], x, nrhs, fact->size[b]);
+
+}
+
+
+/*!
+ * Compute the inverse of a centrosymmetric matrix in compressed form.
+ * The inverse is centrosymmetric: it is obtained by inverting the two
+ * half-size blocks (see centrosym_fold), so that it costs about a quarter
+ * of a dense inversion.
+ *
+ * \param[out]  outmat The inverse in compressed form.
+ * \param[in]  mat The matrix in compressed form.
+ * \param[in]  dim Its dimension.
+ * \retval 1 if the matrix is invertible, 0 if it is singular.
+ */
+int centrosym_inverse(double *outmat, const double *mat, int dim)
+{
+
+  int b, i;
+  double *inv[2];
+  centrosym_factors fact;
+  if( centrosym_factorise(&fact, mat, dim) == 0 ){
+    centrosym_factors_free(&fact);
+    return 0;
+  }
+  for(b = 0; b < 2; b++){
+    square_alloc(&inv[b], fact.size[b]);
+    for(i = 0; i < fact.size[b]; i++)
+      inv[b][ square_ind(i,i,fact.size[b]) ] = 1.0;
+    centrosym_factors_solve(inv[b], &fact, b, fact.size[b]);
+  }
+  centrosym_unfold(outmat, inv[0], inv[1], dim);
+  free(inv[0]);
+  free(inv[1]);
+  centrosym_factors_free(&fact);
+  return 1;
+
+}
+
+
+/*!
+ * Solve a centrosymmetric linear system for several right-hand sides, in compressed form.
+ * The right-hand sides are split in their J-symmetric and J-skew parts,
+ * which are solved with the two half-size blocks (see centrosym_fold).
+ *
+ * \param[out]  x The solutions (square form, dim x nrhs; can be the same as b).
+ * \param[in]  mat The matrix in compressed form.
+ * \param[in]  b The right-hand sides (dim x nrhs).
+ * \param[in]  nrhs The number of right-hand sides.
+ * \param[in]  dim The dimension.
+ * \retval 1 if the matrix is invertible, 0 if it is singular.
+ */
+int centrosym_solve_multi(double *x, const double *mat, const double *b, int nrhs, int dim)
+{
+
+  int i, r;
+  const int m = dim / 2;
+  const int h = dim - m;
+  double *plus, *minus, *rowlo, *rowhi, *rowplus, *rowminus;
+  const double *blo, *bhi;
+  centrosym_factors fact;
+  if( centrosym_factorise(&fact, mat, dim) == 0 ){
+    centrosym_factors_free(&fact);
+    return 0;
+  }
+  plus = (double*)calloc((size_t)h * nrhs, sizeof(double));
+  minus = (double*)calloc((size_t)MAX(m, 1) * nrhs, sizeof(double));
+
+  for(i = 0; i < m; i++){
+    blo = b + (size_t)i * nrhs;
+    bhi = b + (size_t)(dim-i-1) * nrhs;
+    rowplus = plus + (size_t)i * nrhs;
+    rowminus = minus + (size_t)i * nrhs;
+    for(r = 0; r < nrhs; r++){
+      rowplus[r] = (blo[r] + bhi[r]) / M_SQRT2;
+      rowminus[r] = (blo[r] - bhi[r]) / M_SQRT2;
     }
   }
+  if( h > m )
+    memcpy(plus + (size_t)m * nrhs, b + (size_t)m * nrhs, nrhs * sizeof(double));
+
+  centrosym_factors_solve(plus, &fact, 0, nrhs);
+  centrosym_factors_solve(minus, &fact, 1, nrhs);
+
+  for(i = 0; i < m; i++){
+    rowlo = x + (size_t)i * nrhs;
+    rowhi = x + (size_t)(dim-i-1) * nrhs;
+    rowplus = plus + (size_t)i * nrhs;
+    rowminus = minus + (size_t)i * nrhs;
+    for(r = 0; r < nrhs; r++){
+      rowlo[r] = (rowplus[r] + rowminus[r]) / M_SQRT2;
+      rowhi[r] = (rowplus[r] - rowminus[r]) / M_SQRT2;
+    }
+  }
+  if( h > m )
+    memcpy(x + (size_t)m * nrhs, plus + (size_t)m * nrhs, nrhs * sizeof(double));
+
+  free(plus);
+  free(minus);
+  centrosym_factors_free(&fact);
+  return 1;
+
+}
+
+
+/*!
+ * Solve a centrosymmetric linear system (mat * x = b) in compressed form.
+ *
+ * \param[out]  x The solution (can be the same as b).
+ * \param[in]  mat The matrix in compressed form.
+ * \param[in]  b The right-hand side.
+ * \param[in]  dim The dimension.
+ * \retval 1 if the matrix is invertible, 0 if it is singular.
+ */
+int centrosym_solve(double *x, const double *mat, const double *b, int dim)
+{
+
+  return centrosym_solve_multi(x, mat, b, 1, dim);
+
 }
 
 
@@ -238,13 +504,13 @@ void centrosym_product2(double *outmat, double *mat1, double *mat2, int dim)
  * \param[in]  dim Its dimensions.
  * \retval 1 if valid centrosymmetric matrix.
  */
-int centrosym_isvalid(double *mat, int dim)
+int centrosym_isvalid(const double *mat, int dim)
 {
 
   int i, j;
   for(i = 0; i < dim; i++){
     for(j = 0; j < dim; j++){
-      if( abs(mat[ square_ind(i,j,dim) ] - mat[ square_ind(dim-i-1,dim-j-1,dim) ]) > PRECISION ){
+      if( fabs(mat[ square_ind(i,j,dim) ] - mat[ square_ind(dim-i-1,dim-j-1,dim) ]) > PRECISION ){
         //printf("Problem : %2.3e != %2.3e\n",mat[ square_ind(i,j,dim) ],mat[ square_ind(dim-i-1,dim-j-1,dim) ]);
         return 0;
       }
@@ -262,13 +528,15 @@ int centrosym_isvalid(double *mat, int dim)
  * \param[in]  dim Its dimensions.
  * \retval The trace of the matrix.
  */
-double centrosym_trace(double *mat, int dim)
+double centrosym_trace(const double *mat, int dim)
 {
 
   int i;
   double res = 0.0;
+  const double *diag = mat;
   for(i = 0; i < dim; i++){
-     res += mat[ centrosym_ind(i,i,dim) ];
+     res += *diag;
+     diag += i + 2;
   }
   return res;
 
@@ -283,70 +551,508 @@ double centrosym_trace(double *mat, int dim)
  * \param[in]  dim Their dimensions.
  * \retval The trace of mat1  *mat2.
  */
-double centrosym_traceprod2(double *mat1, double *mat2, int dim)
+double centrosym_traceprod2(const double *mat1, const double *mat2, int dim)
 {
 
-  double *matprod;
-  centrosym_alloc(&matprod, dim);
-  centrosym_product(matprod, mat1, mat2, dim);
-  double res = centrosym_trace(matprod, dim);
-  free(matprod);
-  return res;
+  return centrosym_traceprod2_ws(mat1, mat2, dim, NULL);
 
 }
 
+
 /*!
- * Compute the trace of the product of two centrosymmetric square matrices in compressed form (direct, fast).
+ * Same as centrosym_traceprod2, with the product and its scratch space taken from a workspace
+ * (one centrosymmetric matrix, and the scratch space of centrosym_product_ws).
  *
  * \param[in]  mat1 The first matrix.
  * \param[in]  mat2 The second matrix.
  * \param[in]  dim Their dimensions.
+ * \param[in]  ws The workspace (may be NULL).
  * \retval The trace of mat1  *mat2.
  */
-double centrosym_traceprod(double *mat1, double *mat2, int dim)
+double centrosym_traceprod2_ws(const double *mat1, const double *mat2, int dim, workspace *ws)
 {
 
-  int i, j;
-  double res = 0.0;
-  for(i = 0; i < dim; i++){
+  double *matprod;
+  centrosym_alloc_ws(&matprod, dim, ws);
+  centrosym_product_ws(matprod, mat1, mat2, dim, ws);
+  double res = centrosym_trace(matprod, dim);
+  workspace_give(ws, matprod);
+  return res;
 
-    for(j = 0; j <= i; j++){
-      res += mat1[ centrosym_ind(i,j,dim) ] * mat2[ centrosym_ind(dim-j-1,dim-i-1,dim) ];
+}
+
+/*!
+ * Extract the i-th column of a centrosymmetric matrix in compressed form.
+ * The elements below the diagonal are read down the i-th column of the compressed form,
+ * and those above it up the mirrored column, by stepping a cursor over the rows.
+ *
+ * \param[out]  col The column (dim elements).
+ * \param[in]  mat The matrix in compressed form.
+ * \param[in]  i Column index.
+ * \param[in]  dim Its dimension.
+ * \retval none
+ */
+static void centrosym_getcol(double *col, const double *mat, int i, int dim)
+{
+
+  int k;
+  long t;
+  // A(k,i) = A(dim-k-1,dim-i-1) for k < i, from the bottom row upwards
+  t = centrosym_ind(dim-1,dim-i-1,dim);
+  for(k = 0; k < i; k++){
+    col[k] = mat[t];
+    t -= dim - k - 1;
+  }
+  // A(k,i) for k >= i, from the diagonal downwards
+  t = centrosym_ind(i,i,dim);
+  for(k = i; k < dim; k++){
+    col[k] = mat[t];
+    t += k + 1;
+  }
+
+}
+
+
+/*!
+ * Fold rows r0..r1 of the plus (or minus) block of a centrosymmetric matrix, or of its transpose.
+ * Same conventions as centrosym_fold; the elements of the rows are written one after the other,
+ * stride elements apart.
+ *
+ * \param[out]  rows The rows of the block (square form, (r1-r0) x blocksize).
+ * \param[in]  stride The distance between two consecutive elements in rows.
+ * \param[in]  mat The matrix in compressed form.
+ * \param[in]  r0 First row.
+ * \param[in]  r1 Last row (excluded).
+ * \param[in]  minus 1 for the minus block, 0 for the plus block.
+ * \param[in]  transpose 1 to fold the transpose of the matrix.
+ * \param[in]  dim Its dimension.
+ * \param[in]  line Scratch space (dim elements).
+ * \retval none
+ */
+static void centrosym_fold_rows(double *rows, size_t stride, const double *mat, int r0, int r1, int minus, int transpose, int dim, double *line)
+{
+
+  int i, k;
+  const int m = dim / 2;
+  const int size = minus ? m : dim - m;
+  const double sign = minus ? -1.0 : 1.0;
+  double *out = rows;
+  for(i = r0; i < r1; i++){
+    // Row i of the matrix (or of its transpose), folded with its mirrored half
+    if( transpose )
+      centrosym_getcol(line, mat, i, dim);
+    else
+      centrosym_getrow(line, mat, i, 0, dim, dim);
+    if( i < m ){
+      for(k = 0; k < m; k++)
+        out[k * stride] = line[k] + sign * line[dim-k-1];
+      if( size > m )
+        out[m * stride] = M_SQRT2 * line[m];
+    } else {
+      for(k = 0; k < m; k++)
+        out[k * stride] = M_SQRT2 * line[k];
+      out[m * stride] = line[m];
     }
-    for(j = i+1; j < dim; j++){
-      res += mat1[ centrosym_ind(dim-i-1,dim-j-1,dim) ] * mat2[ centrosym_ind(j,i,dim) ];
+    out += size * stride;
+  }
+
+}
+
+
+/*!
+ * Compute the traces of the products of every pair of centrosymmetric matrices from two sets, in compressed form.
+ * Uses Tr(AB) = Tr(A+ B+) + Tr(A- B-) (see centrosym_fold) and Tr(A+ B+) = vec(A+).vec(B+^t):
+ * for each slice of rows of the blocks, the folded matrices are stored as the rows
+ * (first set) and columns (second set) of two panels whose product is accumulated
+ * with the blocked kernel simd_vecmat, so every loaded slice is reused for all pairs.
+ * If both sets are the same, only half of the output is computed.
+ * Threaded over the matrices of the first set.
+ *
+ * \param[out]  trmat The traces (nmat1 x nmat2, trmat[a*nmat2+b] = Tr(mats1[a] * mats2[b])).
+ * \param[in]  mats1 The first set of matrices.
+ * \param[in]  nmat1 The number of matrices in the first set.
+ * \param[in]  mats2 The second set of matrices.
+ * \param[in]  nmat2 The number of matrices in the second set.
+ * \param[in]  dim Their dimensions.
+ * \retval none
+ */
+void centrosym_traceprod_batch(double *trmat, double **mats1, int nmat1, double **mats2, int nmat2, int dim)
+{
+
+  centrosym_traceprod_batch_ws(trmat, mats1, nmat1, mats2, nmat2, dim, NULL);
+
+}
+
+
+/*!
+ * Same as centrosym_traceprod_batch, with the scratch space taken from a workspace: the two panels,
+ * (nmat1 + nmat2) * nrows * ((dim+1)/2) doubles with nrows at most (dim+1)/2 (and TRACEPROD_BATCH_BUFFER bytes in all),
+ * a row of dim doubles per thread, and the chunk boundaries of the threads.
+ *
+ * \param[out]  trmat The traces (nmat1 x nmat2, trmat[a*nmat2+b] = Tr(mats1[a] * mats2[b])).
+ * \param[in]  mats1 The first set of matrices.
+ * \param[in]  nmat1 The number of matrices in the first set.
+ * \param[in]  mats2 The second set of matrices.
+ * \param[in]  nmat2 The number of matrices in the second set.
+ * \param[in]  dim Their dimensions.
+ * \param[in]  ws The workspace (may be NULL).
+ * \retval none
+ */
+void centrosym_traceprod_batch_ws(double *trmat, double **mats1, int nmat1, double **mats2, int nmat2, int dim, workspace *ws)
+{
+
+  int a, b, c, t0, t1, r0, r1, minus, size, nrows, nchunks, len, seg;
+  const int m = dim / 2;
+  const int symmetric = ( mats1 == mats2 && nmat1 == nmat2 );
+  const int shape = symmetric ? PARALLEL_TRIANGULAR : PARALLEL_UNIFORM;
+  const int nthreads = parallel_threads();
+  const size_t nline = ROUNDUP((size_t)dim, WORKSPACE_ALIGN / sizeof(double));
+  double *panel1, *panel2, *lines;
+  int *bounds;
+
+  // Slices of rows of the folded blocks are sized to fit TRACEPROD_BATCH_BUFFER (at most a whole block),
+  // and the columns of the second panel to fit TRACEPROD_BATCH_CACHE.
+  nrows = MAX(1, (int)(TRACEPROD_BATCH_BUFFER / (2 * sizeof(double) * (size_t)MAX(nmat1, nmat2) * MAX(dim - m, 1))));
+  nrows = MIN(nrows, MAX(dim - m, 1));
+  seg = MAX(16, (int)(TRACEPROD_BATCH_CACHE / (sizeof(double) * (size_t)nmat2)));
+  panel1 = workspace_take(ws, (size_t)nmat1 * nrows * (dim - m));
+  panel2 = workspace_take(ws, (size_t)nmat2 * nrows * (dim - m));
+  lines = workspace_take(ws, nthreads * nline);
+  nchunks = parallel_nchunks(nmat1, 1);
+  bounds = (int*)workspace_take_bytes(ws, (nchunks + 1) * sizeof(int));
+  parallel_partition(bounds, nchunks, nmat1, shape);
+
+  memset(trmat, 0, (size_t)nmat1 * nmat2 * sizeof(double));
+
+  for(minus = 0; minus <= 1; minus++){
+    size = minus ? m : dim - m;
+    for(r0 = 0; r0 < size; r0 += nrows){
+      r1 = MIN(r0 + nrows, size);
+      len = (r1 - r0) * size;
+
+      // First panel: one folded slice per row; second panel: one transposed folded slice per column
+      #pragma omp parallel for schedule(static) num_threads(nthreads)
+      for(a = 0; a < nmat1; a++)
+        centrosym_fold_rows(panel1 + (size_t)a * len, 1, mats1[a], r0, r1, minus, 0, dim, lines + parallel_thread_num() * nline);
+      #pragma omp parallel for schedule(static) num_threads(nthreads)
+      for(b = 0; b < nmat2; b++)
+        centrosym_fold_rows(panel2 + b, nmat2, mats2[b], r0, r1, minus, 1, dim, lines + parallel_thread_num() * nline);
+
+      // trmat += panel1 * panel2, by segments of the slice
+      #pragma omp parallel for schedule(dynamic,1) num_threads(nthreads) private(a, t0, t1)
+      for(c = 0; c < nchunks; c++)
+        for(t0 = 0; t0 < len; t0 += seg){
+          t1 = MIN(t0 + seg, len);
+          for(a = bounds[c]; a < bounds[c+1]; a++)
+            simd_vecmat(trmat + (size_t)a * nmat2, panel1 + (size_t)a * len + t0, 
+              panel2 + (size_t)t0 * nmat2, nmat2, t1 - t0, symmetric ? a + 1 : nmat2);
+        }
     }
+  }
+
+  if( symmetric )
+    for(a = 0; a < nmat1; a++)
+      for(b = a + 1; b < nmat2; b++)
+        trmat[ (size_t)a * nmat2 + b ] = trmat[ (size_t)b * nmat2 + a ];
+
+  workspace_give_bytes(ws, bounds);
+  workspace_give(ws, lines);
+  workspace_give(ws, panel2);
+  workspace_give(ws, panel1);
 
+}
+
+
+/*!
+ * Compute the rows r0..r1-1 (r1 <= (dim+1)/2) of a centrosymmetric matrix-panel product and their mirrors,
+ * blocked as square_product. Each tile of rows of the matrix is folded once, and multiplied by tiles
+ * of the upper halves s and d of the panel (ld elements per row). scratch holds dim + tile * (dim + 2 * nvec) elements.
+ */
+static void centrosym_times_dense_rows(double *y, const double *mat, double *s, double *d, int nvec, int ld, int r0, int r1, int dim, double *scratch)
+{
+
+  int i, j, k, i0, k0, j0, ni, nk, nkm, nj;
+  const int m = dim / 2;
+  const int h = dim - m;
+  const int tile = MAX(8, tiling_size());
+  double *row = scratch;
+  double *plus = row + dim;
+  double *minus = plus + (size_t)tile * h;
+  double *sym = minus + (size_t)tile * m;
+  double *skew = sym + (size_t)tile * nvec;
+
+  for(i0 = r0; i0 < r1; i0 += tile){
+    // Fold a tile of rows: P(i,k) = A(i,k) + A(i,dim-k-1), M(i,k) = A(i,k) - A(i,dim-k-1)
+    ni = MIN(tile, r1 - i0);
+    for(i = 0; i < ni; i++){
+      centrosym_getrow(row, mat, i0 + i, 0, dim, dim);
+      for(k = 0; k < m; k++){
+        plus[ (size_t)i * h + k ] = row[k] + row[dim-k-1];
+        minus[ (size_t)i * m + k ] = row[k] - row[dim-k-1];
+      }
+      if( h > m )
+        plus[ (size_t)i * h + m ] = row[m];
+    }
+    memset(sym, 0, (size_t)ni * nvec * sizeof(double));
+    memset(skew, 0, (size_t)ni * nvec * sizeof(double));
+    // The central row of the panel (odd dim) has no antisymmetric part, hence only m - k0 rows of d
+    for(k0 = 0; k0 < h; k0 += tile){
+      nk = MIN(tile, h - k0);
+      nkm = MIN(tile, m - k0);
+      for(j0 = 0; j0 < nvec; j0 += tile){
+        nj = MIN(tile, nvec - j0);
+        // One tile of s, then one tile of d, so that a single tile of the panel is in cache at a time
+        for(i = 0; i < ni; i++)
+          simd_vecmat(sym + (size_t)i * nvec + j0, plus + (size_t)i * h + k0, s + (size_t)k0 * ld + j0, ld, nk, nj);
+        for(i = 0; i < ni && nkm > 0; i++)
+          simd_vecmat(skew + (size_t)i * nvec + j0, minus + (size_t)i * m + k0, d + (size_t)k0 * ld + j0, ld, nkm, nj);
+      }
+    }
+    for(i = 0; i < ni; i++)
+      for(j = 0; j < nvec; j++){
+        y[ (size_t)(i0+i) * nvec + j ] = 0.5 * ( sym[ (size_t)i * nvec + j ] + skew[ (size_t)i * nvec + j ] );
+        y[ (size_t)(dim-i0-i-1) * nvec + j ] = 0.5 * ( sym[ (size_t)i * nvec + j ] - skew[ (size_t)i * nvec + j ] );
+      }
   }
-  return res;
 
 }
 
 
 /*!
- * Compute the quadratic form of a centrosymmetric square matrix in compressed form and two vectors (x^t * A * y).
+ * Compute the product of a centrosymmetric matrix in compressed form and a dense dim x m matrix (out = A * X).
+ * The rows of the panel are split into their symmetric and antisymmetric parts as in centrosym_matvec;
+ * the rows of the matrix are then folded (A[i][k] +/- A[i][dim-k-1]) so that they only meet the upper
+ * halves of the two parts, which halves the number of operations. The folded rows are multiplied by tiles,
+ * as in square_product, and the product is threaded over chunks of the upper half of the rows.
  *
- * \param[in]  x The first vector.
- * \param[in]  mat2 The square matrix.
- * \param[in]  y The second vector.
- * \param[in]  dim Their dimensions.
- * \retval The quadratic form (x^t * A * y).
+ * \param[out]  y The output matrix (dim rows of nvec elements).
+ * \param[in]  mat The matrix in compressed form.
+ * \param[in]  x The dense matrix (dim rows of nvec elements).
+ * \param[in]  nvec The number of columns of the dense matrices.
+ * \param[in]  dim The dimension of the centrosymmetric matrix.
+ * \retval none
  */
-double centrosym_quadform(double *x, double *mat, double *y, int dim)
+void centrosym_times_dense(double *y, const double *mat, const double *x, int nvec, int dim)
 {
 
-  int i, j;
-  double res = 0.0;
-  for(i = 0; i < dim; i++){
+  centrosym_times_dense_ws(y, mat, x, nvec, dim, NULL);
 
-    for(j = 0; j <= i; j++){
-      res += x[i] * y[j] * mat[ centrosym_ind(i,j,dim) ] ;
+}
+
+
+/*!
+ * Same as centrosym_times_dense, with the scratch space taken from a workspace: the two parts of the panel
+ * ((dim+1)/2 rows of nvec rounded up to 8, plus 8 doubles each), a row, a folded tile and its products for each thread
+ * (dim + tile * (dim + 2 * nvec) doubles, see tiling_size), and the chunk boundaries of the threads.
+ *
+ * \param[out]  y The output matrix (dim rows of nvec elements).
+ * \param[in]  mat The matrix in compressed form.
+ * \param[in]  x The dense matrix (dim rows of nvec elements).
+ * \param[in]  nvec The number of columns of the dense matrices.
+ * \param[in]  dim The dimension of the centrosymmetric matrix.
+ * \param[in]  ws The workspace (may be NULL).
+ * \retval none
+ */
+void centrosym_times_dense_ws(double *y, const double *mat, const double *x, int nvec, int dim, workspace *ws)
+{
+
+  int t, j, c;
+  const int h = dim - dim / 2;
+  const int tile = MAX(8, tiling_size()), nthreads = parallel_threads();
+  // The rows of the two parts are padded by a cache line, so that the rows of a tile do not all fall
+  // in the same cache sets when nvec is a multiple of a power of two (about 30% faster for nvec = 1024)
+  const int ld = ROUNDUP(nvec, 8) + 8;
+  const size_t len = (size_t)h * ld;
+  double *s = workspace_take(ws, 2 * len);
+  double *d = s + len;
+  for(t = 0; t < h; t++){
+    for(j = 0; j < nvec; j++){
+      s[ (size_t)t * ld + j ] = x[ (size_t)t * nvec + j ] + x[ (size_t)(dim-t-1) * nvec + j ];
+      d[ (size_t)t * ld + j ] = x[ (size_t)t * nvec + j ] - x[ (size_t)(dim-t-1) * nvec + j ];
+    }
+  }
+
+  const int nchunks = parallel_nchunks(h, tile);
+  int *bounds = (int*)workspace_take_bytes(ws, (nchunks + 1) * sizeof(int));
+  parallel_partition(bounds, nchunks, h, PARALLEL_UNIFORM);
+  // Scratch space of each thread (a row, the folded tile and its products), rounded up to the alignment
+  const size_t nscratch = ROUNDUP(dim + (size_t)tile * (dim + 2 * (size_t)nvec), WORKSPACE_ALIGN / sizeof(double));
+  double *scratch = workspace_take(ws, nthreads * nscratch);
+
+  #pragma omp parallel for schedule(dynamic,1) num_threads(nthreads) if(nchunks > 1)
+  for(c = 0; c < nchunks; c++)
+    centrosym_times_dense_rows(y, mat, s, d, nvec, ld, bounds[c], bounds[c+1], dim, scratch + parallel_thread_num() * nscratch);
+
+  workspace_give(ws, scratch);
+  workspace_give_bytes(ws, bounds);
+  workspace_give(ws, s);
+
+}
+
+
+/*!
+ * Compute the rows r0..r1-1 of the product of a dense matrix and a centrosymmetric matrix (see dense_times_centrosym).
+ * s and d hold the symmetric and antisymmetric parts of the rows of the dense matrix (h and m elements per row);
+ * scratch holds dim + (tile + r1 - r0) * dim elements.
+ */
+static void dense_times_centrosym_rows(double *outmat, const double *mat, double *s, double *d, int r0, int r1, int dim, double *scratch)
+{
+
+  int r, j, k, k0, kb;
+  const int m = dim / 2;
+  const int h = dim - m;
+  const int tile = MAX(8, tiling_size());
+  const int nr = r1 - r0;
+  double *row = scratch;
+  double *plus = row + dim;
+  double *minus = plus + (size_t)tile * h;
+  double *sumplus = minus + (size_t)tile * m;
+  double *summinus = sumplus + (size_t)nr * h;
+  memset(sumplus, 0, (size_t)nr * (h + m) * sizeof(double));
+
+  for(k0 = 0; k0 < h; k0 += tile){
+    // Fold a block of rows of the centrosymmetric matrix: P(k,j) = A(k,j) + A(k,dim-j-1), M(k,j) = A(k,j) - A(k,dim-j-1)
+    kb = MIN(tile, h - k0);
+    for(k = 0; k < kb; k++){
+      centrosym_getrow(row, mat, k0 + k, 0, dim, dim);
+      for(j = 0; j < m; j++){
+        plus[ (size_t)k * h + j ] = row[j] + row[dim-j-1];
+        minus[ (size_t)k * m + j ] = row[j] - row[dim-j-1];
+      }
+      if( h > m )
+        plus[ (size_t)k * h + m ] = 2.0 * row[m];
     }
-    for(j = i+1; j < dim; j++){
-      res += x[i] * y[j] * mat[ centrosym_ind(dim-i-1,dim-j-1,dim) ] ;
+    // The central row (odd dim) has no antisymmetric part, hence only m - k0 rows of M
+    for(r = 0; r < nr; r++){
+      simd_vecmat(sumplus + (size_t)r * h, s + (size_t)(r0+r) * h + k0, plus, h, kb, h);
+      simd_vecmat(summinus + (size_t)r * m, d + (size_t)(r0+r) * m + k0, minus, m, MIN(kb, m - k0), m);
     }
+  }
 
+  for(r = 0; r < nr; r++){
+    double *out = outmat + (size_t)(r0+r) * dim;
+    for(j = 0; j < m; j++){
+      out[j] = 0.5 * ( sumplus[ (size_t)r * h + j ] + summinus[ (size_t)r * m + j ] );
+      out[dim-j-1] = 0.5 * ( sumplus[ (size_t)r * h + j ] - summinus[ (size_t)r * m + j ] );
+    }
+    if( h > m )
+      out[m] = 0.5 * sumplus[ (size_t)r * h + m ];
+  }
+
+}
+
+
+/*!
+ * Compute the product of a dense nrows x dim matrix and a centrosymmetric matrix in compressed form (out = X * A).
+ * Since A(dim-k-1,j) = A(k,dim-j-1), the sum and the difference of the mirrored columns j and dim-j-1 of the output
+ * only involve the symmetric part X(r,k) + X(r,dim-k-1) and the antisymmetric part X(r,k) - X(r,dim-k-1) of the rows
+ * of X, multiplied by the folded upper half of A: half the operations of the dense product. The rows of A are folded
+ * on the fly by blocks, and the product is threaded over chunks of rows of X.
+ *
+ * \param[out]  outmat The output matrix (nrows rows of dim elements).
+ * \param[in]  x The dense matrix (nrows rows of dim elements).
+ * \param[in]  mat The centrosymmetric matrix in compressed form.
+ * \param[in]  nrows The number of rows of the dense matrices.
+ * \param[in]  dim The dimension of the centrosymmetric matrix.
+ * \retval none
+ */
+void dense_times_centrosym(double *outmat, const double *x, const double *mat, int nrows, int dim)
+{
+
+  dense_times_centrosym_ws(outmat, x, mat, nrows, dim, NULL);
+
+}
+
+
+/*!
+ * Same as dense_times_centrosym, with the scratch space taken from a workspace: the two parts of the rows
+ * (nrows * dim doubles), a row, a folded block and the sums of a chunk for each thread (dim + (tile + chunk) * dim
+ * doubles, see tiling_size and parallel_nchunks), and the chunk boundaries of the threads.
+ *
+ * \param[out]  outmat The output matrix (nrows rows of dim elements).
+ * \param[in]  x The dense matrix (nrows rows of dim elements).
+ * \param[in]  mat The centrosymmetric matrix in compressed form.
+ * \param[in]  nrows The number of rows of the dense matrices.
+ * \param[in]  dim The dimension of the centrosymmetric matrix.
+ * \param[in]  ws The workspace (may be NULL).
+ * \retval none
+ */
+void dense_times_centrosym_ws(double *outmat, const double *x, const double *mat, int nrows, int dim, workspace *ws)
+{
+
+  int r, k, c, maxrows = 0;
+  const int m = dim / 2;
+  const int h = dim - m;
+  const int tile = MAX(8, tiling_size()), nthreads = parallel_threads();
+  double *s = workspace_take(ws, (size_t)nrows * (h + m));
+  double *d = s + (size_t)nrows * h;
+  for(r = 0; r < nrows; r++){
+    const double *xr = x + (size_t)r * dim;
+    for(k = 0; k < m; k++){
+      s[ (size_t)r * h + k ] = xr[k] + xr[dim-k-1];
+      d[ (size_t)r * m + k ] = xr[k] - xr[dim-k-1];
+    }
+    if( h > m )
+      s[ (size_t)r * h + m ] = xr[m];
+  }
+
+  // Each chunk folds the whole of A again, which is small compared to its share of the product
+  const int nchunks = parallel_nchunks(nrows, tiling_size());
+  int *bounds = (int*)workspace_take_bytes(ws, (nchunks + 1) * sizeof(int));
+  parallel_partition(bounds, nchunks, nrows, PARALLEL_UNIFORM);
+  for(c = 0; c < nchunks; c++)
+    maxrows = MAX(maxrows, bounds[c+1] - bounds[c]);
+  // Scratch space of each thread, rounded up to the alignment
+  const size_t nscratch = ROUNDUP(dim + (size_t)(tile + maxrows) * dim, WORKSPACE_ALIGN / sizeof(double));
+  double *scratch = workspace_take(ws, nthreads * nscratch);
+
+  #pragma omp parallel for schedule(dynamic,1) num_threads(nthreads) if(nchunks > 1)
+  for(c = 0; c < nchunks; c++)
+    dense_times_centrosym_rows(outmat, mat, s, d, bounds[c], bounds[c+1], dim, scratch + parallel_thread_num() * nscratch);
+
+  workspace_give(ws, scratch);
+  workspace_give_bytes(ws, bounds);
+  workspace_give(ws, s);
+
+}
+
+
+// ======================================== //
+// Single precision: float storage, with float (_f) or double (_fd) accumulation (see simd.h).
+// The kernels are instantiated from centrosym_prec.inc with the double precision ones.
+
+/*!
+ * Allocate space for centrosymmetric square matrix in single precision.
+ *
+ * \param[out]  mat The matrix.
+ * \param[in]  dim Its dimension.
+ * \retval none
+ */
+void centrosym_alloc_f(float **mat, int dim)
+{
+
+  *mat = workspace_calloc_f(centrosym_size(dim));
+
+}
+
+
+/*!
+ * Extract the compressed form of a centrosymmetric matrix in single precision.
+ *
+ * \param[out]  matcomp The matrix in compressed form (single precision).
+ * \param[in]  matfull The matrix in full form (square matrix).
+ * \param[in]  dim Its dimension.
+ * \retval none
+ */
+void centrosym_full_extractcomp_f(float *matcomp, const double *matfull, int dim)
+{
+
+  int i, j;
+  float *row = matcomp;
+  for(i = 0; i < dim; i++){
+    for(j = 0; j <= i; j++)
+      row[j] = (float)matfull[ square_ind(i,j,dim) ];
+    row += i + 1;
   }
-  return res;
 
 }
@@ -0,0 +1,688 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#include "symtrx.h"
+#include "distrib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#define MAX(a,b) ((a) > (b) ? (a) : (b))
+#define MIN(a,b) ((a) > (b) ? (b) : (a))
+
+// Distributed centrosymmetric matrices (MPI). A centrosymmetric matrix is held as its two
+// half-size blocks (see centrosym_fold), which are dense square matrices distributed 2D
+// block-cyclically over a grid of processes: the product of two centrosymmetric matrices is
+// the products of their blocks, and their trace-product the sum of the trace-products of the
+// blocks. The products follow SUMMA: for each block column of the first matrix (and block row
+// of the second one), the owners broadcast it along the rows (columns) of the grid, and every
+// process accumulates the product of the two panels into its part of the result. The panels
+// are broadcast with nonblocking collectives one step ahead (double buffering), so that the
+// communication overlaps the computation. No process ever holds more than its share of the
+// matrices and two panels of each, so that the size of the matrices grows with the number of nodes.
+
+/*!
+ * Getter of the (i,j)th element of a centrosymmetric matrix (see distrib_centrosym_fill).
+ */
+typedef double (*distrib_getter)(const void *src, int i, int j, int dim);
+
+/*!
+ * Seed and stream of a random centrosymmetric matrix (see centrosym_random).
+ */
+typedef struct {
+  uint64_t seed;
+  uint64_t stream;
+} distrib_randomsrc;
+
+/*!
+ * Transposition of a distributed block in progress (see distrib_block_traceprod_start).
+ */
+typedef struct {
+  double *sendbuf, *recvbuf;
+  int *sendcounts, *sdispls, *recvcounts, *rdispls;
+  MPI_Request req;
+} distrib_transpose;
+
+
+/*!
+ * Number of rows (or columns) of a block-cyclic distribution held by a process.
+ *
+ * \param[in]  n The global number of rows.
+ * \param[in]  nb The block size.
+ * \param[in]  iproc The process row (or column).
+ * \param[in]  nprocs The number of process rows (or columns).
+ * \retval The local number of rows.
+ */
+static int distrib_numroc(int n, int nb, int iproc, int nprocs)
+{
+
+  const int nblocks = n / nb;
+  const int extra = nblocks % nprocs;
+  int num = (nblocks / nprocs) * nb;
+  if( iproc < extra )
+    num += nb;
+  else if( iproc == extra )
+    num += n % nb;
+  return num;
+
+}
+
+
+/*!
+ * Global index of a local row (or column) of a block-cyclic distribution.
+ *
+ * \param[in]  l The local index.
+ * \param[in]  nb The block size.
+ * \param[in]  iproc The process row (or column).
+ * \param[in]  nprocs The number of process rows (or columns).
+ * \retval The global index.
+ */
+static inline int distrib_l2g(int l, int nb, int iproc, int nprocs)
+{
+
+  return ((l / nb) * nprocs + iproc) * nb + l % nb;
+
+}
+
+
+/*!
+ * Rank of the process holding the (i,j)th element of a block-cyclic distribution.
+ *
+ * \param[in]  i Row index.
+ * \param[in]  j Column index.
+ * \param[in]  nb The block size.
+ * \param[in]  grid The grid of processes.
+ * \retval The rank in grid->comm.
+ */
+static inline int distrib_owner(int i, int j, int nb, const distrib_grid *grid)
+{
+
+  return ((i / nb) % grid->nprow) * grid->npcol + (j / nb) % grid->npcol;
+
+}
+
+
+/*!
+ * Set up a two-dimensional grid of processes, as square as possible (see MPI_Dims_create).
+ * Collective over comm.
+ *
+ * \param[out]  grid The grid.
+ * \param[in]  comm The processes.
+ * \retval 1 if the grid was created, 0 otherwise.
+ */
+int distrib_grid_init(distrib_grid *grid, MPI_Comm comm)
+{
+
+  int nprocs, rank, dims[2] = { 0, 0 };
+  memset(grid, 0, sizeof(distrib_grid));
+  grid->comm = grid->rowcomm = grid->colcomm = MPI_COMM_NULL;
+  if( MPI_Comm_dup(comm, &grid->comm) != MPI_SUCCESS )
+    return 0;
+  MPI_Comm_size(grid->comm, &nprocs);
+  MPI_Comm_rank(grid->comm, &rank);
+  MPI_Dims_create(nprocs, 2, dims);
+  grid->nprow = dims[0];
+  grid->npcol = dims[1];
+  grid->myrow = rank / grid->npcol;
+  grid->mycol = rank % grid->npcol;
+  return MPI_Comm_split(grid->comm, grid->myrow, grid->mycol, &grid->rowcomm) == MPI_SUCCESS
+    && MPI_Comm_split(grid->comm, grid->mycol, grid->myrow, &grid->colcomm) == MPI_SUCCESS;
+
+}
+
+
+/*!
+ * Release a grid of processes. Collective.
+ *
+ * \param[in]  grid The grid.
+ * \retval none
+ */
+void distrib_grid_free(distrib_grid *grid)
+{
+
+  if( grid->rowcomm != MPI_COMM_NULL )
+    MPI_Comm_free(&grid->rowcomm);
+  if( grid->colcomm != MPI_COMM_NULL )
+    MPI_Comm_free(&grid->colcomm);
+  if( grid->comm != MPI_COMM_NULL )
+    MPI_Comm_free(&grid->comm);
+
+}
+
+
+/*!
+ * Allocate the local part of a distributed dense square matrix.
+ *
+ * \param[out]  blk The matrix.
+ * \param[in]  n Its dimension.
+ * \param[in]  nb The block size.
+ * \param[in]  grid The grid of processes.
+ * \retval 1 if the local part was allocated, 0 otherwise.
+ */
+static int distrib_block_alloc(distrib_block *blk, int n, int nb, const distrib_grid *grid)
+{
+
+  blk->grid = grid;
+  blk->n = n;
+  blk->nb = nb;
+  blk->mloc = distrib_numroc(n, nb, grid->myrow, grid->nprow);
+  blk->nloc = distrib_numroc(n, nb, grid->mycol, grid->npcol);
+  blk->data = workspace_calloc((size_t)blk->mloc * blk->nloc);
+  return blk->data != NULL;
+
+}
+
+
+/*!
+ * Allocate a distributed centrosymmetric matrix (local parts of its two half-size blocks).
+ *
+ * \param[out]  mat The matrix.
+ * \param[in]  dim Its dimension.
+ * \param[in]  nb The block size of the distribution.
+ * \param[in]  grid The grid of processes (must outlive the matrix).
+ * \retval 1 if the local parts were allocated, 0 otherwise.
+ */
+int distrib_centrosym_alloc(distrib_centrosym *mat, int dim, int nb, const distrib_grid *grid)
+{
+
+  memset(mat, 0, sizeof(distrib_centrosym));
+  if( dim < 0 || nb < 1 )
+    return 0;
+  mat->dim = dim;
+  if( distrib_block_alloc(&mat->plus, dim - dim / 2, nb, grid) == 0
+      || distrib_block_alloc(&mat->minus, dim / 2, nb, grid) == 0 ){
+    distrib_centrosym_free(mat);
+    return 0;
+  }
+  return 1;
+
+}
+
+
+/*!
+ * Release the local parts of a distributed centrosymmetric matrix.
+ *
+ * \param[in]  mat The matrix.
+ * \retval none
+ */
+void distrib_centrosym_free(distrib_centrosym *mat)
+{
+
+  free(mat->plus.data);
+  free(mat->minus.data);
+  memset(mat, 0, sizeof(distrib_centrosym));
+
+}
+
+
+/*!
+ * Number of elements held by this process for a distributed centrosymmetric matrix.
+ *
+ * \param[in]  mat The matrix.
+ * \retval The number of elements.
+ */
+size_t distrib_centrosym_localsize(const distrib_centrosym *mat)
+{
+
+  return (size_t)mat->plus.mloc * mat->plus.nloc + (size_t)mat->minus.mloc * mat->minus.nloc;
+
+}
+
+
+/*!
+ * Getters of the (i,j)th element of a centrosymmetric matrix in full form,
+ * in compressed form, and of a random one in compressed form (see centrosym_random).
+ */
+static double distrib_get_full(const void *src, int i, int j, int dim)
+{
+
+  return ((const double*)src)[ square_ind(i,j,dim) ];
+
+}
+
+static double distrib_get_comp(const void *src, int i, int j, int dim)
+{
+
+  return j <= i ? ((const double*)src)[ centrosym_ind(i,j,dim) ]
+    : ((const double*)src)[ centrosym_ind(dim-i-1,dim-j-1,dim) ];
+
+}
+
+static double distrib_get_random(const void *src, int i, int j, int dim)
+{
+
+  const distrib_randomsrc *rnd = (const distrib_randomsrc*)src;
+  if( j > i || (j == i && i >= dim - dim / 2) ){
+    i = dim - i - 1;
+    j = dim - j - 1;
+  }
+  return random_uniform(rnd->seed, rnd->stream, centrosym_ind(i,j,dim));
+
+}
+
+
+/*!
+ * Fill the local parts of a distributed centrosymmetric matrix from its elements (see centrosym_fold).
+ * Only the rows of the matrix matching the local rows of the blocks are read.
+ *
+ * \param[out]  mat The matrix.
+ * \param[in]  get The getter of the (i,j)th element.
+ * \param[in]  src The source of the elements.
+ * \retval none
+ */
+static void distrib_centrosym_fill(distrib_centrosym *mat, distrib_getter get, const void *src)
+{
+
+  int li;
+  const int dim = mat->dim, m = dim / 2;
+  const distrib_grid *grid = mat->plus.grid;
+  distrib_block *plus = &mat->plus, *minus = &mat->minus;
+
+  #pragma omp parallel for num_threads(parallel_threads())
+  for(li = 0; li < plus->mloc; li++){
+    int lj;
+    const int a = distrib_l2g(li, plus->nb, grid->myrow, grid->nprow);
+    for(lj = 0; lj < plus->nloc; lj++){
+      const int b = distrib_l2g(lj, plus->nb, grid->mycol, grid->npcol);
+      double v;
+      if( a < m && b < m )
+        v = get(src, a, b, dim) + get(src, a, dim-b-1, dim);
+      else if( a < m )
+        v = M_SQRT2 * get(src, a, m, dim);
+      else if( b < m )
+        v = M_SQRT2 * get(src, m, b, dim);
+      else
+        v = get(src, m, m, dim);
+      plus->data[ (long)li * plus->nloc + lj ] = v;
+    }
+  }
+
+  #pragma omp parallel for num_threads(parallel_threads())
+  for(li = 0; li < minus->mloc; li++){
+    int lj;
+    const int a = distrib_l2g(li, minus->nb, grid->myrow, grid->nprow);
+    for(lj = 0; lj < minus->nloc; lj++){
+      const int b = distrib_l2g(lj, minus->nb, grid->mycol, grid->npcol);
+      minus->data[ (long)li * minus->nloc + lj ] = get(src, a, b, dim) - get(src, a, dim-b-1, dim);
+    }
+  }
+
+}
+
+
+/*!
+ * Fill a distributed centrosymmetric matrix with random numbers: the same matrix as centrosym_random,
+ * generated in place on each process. Not collective.
+ *
+ * \param[out]  mat The matrix.
+ * \param[in]  seed The seed.
+ * \param[in]  stream The stream (see random_fill).
+ * \retval none
+ */
+void distrib_centrosym_random(distrib_centrosym *mat, uint64_t seed, uint64_t stream)
+{
+
+  const distrib_randomsrc rnd = { seed, stream };
+  distrib_centrosym_fill(mat, distrib_get_random, &rnd);
+
+}
+
+
+/*!
+ * Extract the local parts of a distributed centrosymmetric matrix from its full form.
+ * Each process reads only its rows of matfull (e.g. of a shared or memory-mapped array). Not collective.
+ *
+ * \param[out]  mat The matrix.
+ * \param[in]  matfull The matrix in full form.
+ * \retval none
+ */
+void distrib_centrosym_full_extractcomp(distrib_centrosym *mat, const double *matfull)
+{
+
+  distrib_centrosym_fill(mat, distrib_get_full, matfull);
+
+}
+
+
+/*!
+ * Extract the local parts of a distributed centrosymmetric matrix from its compressed form
+ * (e.g. a memory-mapped matrix file, see matfile_open). Not collective.
+ *
+ * \param[out]  mat The matrix.
+ * \param[in]  matcomp The matrix in compressed form.
+ * \retval none
+ */
+void distrib_centrosym_comp_extract(distrib_centrosym *mat, const double *matcomp)
+{
+
+  distrib_centrosym_fill(mat, distrib_get_comp, matcomp);
+
+}
+
+
+/*!
+ * Gather a distributed dense matrix in full form on one process. Collective.
+ *
+ * \param[out]  full The matrix in full form (on root only, n x n).
+ * \param[in]  blk The distributed matrix.
+ * \param[in]  root The rank receiving the matrix.
+ * \retval 1 on success, 0 otherwise.
+ */
+static int distrib_block_gather(double *full, const distrib_block *blk, int root)
+{
+
+  int r, li, lj, rank, nprocs, res = 1;
+  const distrib_grid *grid = blk->grid;
+  int *counts = NULL, *displs = NULL;
+  double *buf = NULL;
+  MPI_Comm_rank(grid->comm, &rank);
+  MPI_Comm_size(grid->comm, &nprocs);
+
+  if( rank == root ){
+    counts = (int*)calloc(nprocs, sizeof(int));
+    displs = (int*)calloc(nprocs, sizeof(int));
+    buf = workspace_calloc((size_t)blk->n * blk->n);
+    for(r = 0; r < nprocs; r++){
+      counts[r] = distrib_numroc(blk->n, blk->nb, r / grid->npcol, grid->nprow)
+        * distrib_numroc(blk->n, blk->nb, r % grid->npcol, grid->npcol);
+      displs[r] = r > 0 ? displs[r-1] + counts[r-1] : 0;
+    }
+  }
+  if( MPI_Gatherv(blk->data, blk->mloc * blk->nloc, MPI_DOUBLE, buf, counts, displs, MPI_DOUBLE, root, grid->comm) != MPI_SUCCESS )
+    res = 0;
+
+  if( rank == root && res ){
+    for(r = 0; r < nprocs; r++){
+      const int prow = r / grid->npcol, pcol = r % grid->npcol;
+      const int mloc = distrib_numroc(blk->n, blk->nb, prow, grid->nprow);
+      const int nloc = distrib_numroc(blk->n, blk->nb, pcol, grid->npcol);
+      for(li = 0; li < mloc; li++)
+        for(lj = 0; lj < nloc; lj++)
+          full[ square_ind(distrib_l2g(li, blk->nb, prow, grid->nprow), distrib_l2g(lj, blk->nb, pcol, grid->npcol), blk->n) ]
+            = buf[ displs[r] + (long)li * nloc + lj ];
+    }
+  }
+
+  free(counts);
+  free(displs);
+  free(buf);
+  return res;
+
+}
+
+
+/*!
+ * Gather a distributed centrosymmetric matrix in compressed form on one process (e.g. for output). Collective.
+ *
+ * \param[out]  matcomp The matrix in compressed form (on root only).
+ * \param[in]  mat The distributed matrix.
+ * \param[in]  root The rank receiving the matrix.
+ * \retval 1 on success, 0 otherwise.
+ */
+int distrib_centrosym_gather(double *matcomp, const distrib_centrosym *mat, int root)
+{
+
+  int rank, res;
+  double *plus = NULL, *minus = NULL;
+  MPI_Comm_rank(mat->plus.grid->comm, &rank);
+  if( rank == root ){
+    square_alloc(&plus, mat->plus.n);
+    square_alloc(&minus, mat->minus.n);
+  }
+  res = distrib_block_gather(plus, &mat->plus, root);
+  res = distrib_block_gather(minus, &mat->minus, root) && res;
+  if( rank == root && res )
+    centrosym_unfold(matcomp, plus, minus, mat->dim);
+  free(plus);
+  free(minus);
+  return res;
+
+}
+
+
+/*!
+ * Start the broadcasts of the k-th panels of a SUMMA product: block column k of the first
+ * matrix along the rows of the grid, and block row k of the second one along its columns.
+ *
+ * \param[out]  apanel The panel of the first matrix (mloc x kb).
+ * \param[out]  bpanel The panel of the second matrix (kb x nloc).
+ * \param[out]  req The two requests.
+ * \param[in]  a The first matrix.
+ * \param[in]  b The second matrix.
+ * \param[in]  k The index of the panels.
+ * \retval none
+ */
+static void distrib_panels_start(double *apanel, double *bpanel, MPI_Request *req,
+  const distrib_block *a, const distrib_block *b, int k)
+{
+
+  int li;
+  const distrib_grid *grid = a->grid;
+  const int kb = MIN(a->nb, a->n - k * a->nb);
+  const int pcol = k % grid->npcol, prow = k % grid->nprow;
+
+  if( grid->mycol == pcol ){
+    const int lc = (k / grid->npcol) * a->nb;
+    for(li = 0; li < a->mloc; li++)
+      memcpy(apanel + (long)li * kb, a->data + (long)li * a->nloc + lc, kb * sizeof(double));
+  }
+  if( grid->myrow == prow ){
+    const int lr = (k / grid->nprow) * b->nb;
+    memcpy(bpanel, b->data + (long)lr * b->nloc, (size_t)kb * b->nloc * sizeof(double));
+  }
+  MPI_Ibcast(apanel, a->mloc * kb, MPI_DOUBLE, pcol, grid->rowcomm, &req[0]);
+  MPI_Ibcast(bpanel, kb * b->nloc, MPI_DOUBLE, prow, grid->colcomm, &req[1]);
+
+}
+
+
+/*!
+ * Product of two distributed dense matrices (SUMMA, with the broadcasts of the next panels
+ * overlapping the computation on the current ones). Collective.
+ *
+ * \param[out]  c The resulting matrix.
+ * \param[in]  a The first matrix.
+ * \param[in]  b The second matrix.
+ * \retval none
+ */
+static void distrib_block_product(distrib_block *c, const distrib_block *a, const distrib_block *b)
+{
+
+  int k, cur, r0, r1, flag;
+  const int n = a->n, nb = a->nb, nblocks = (n + nb - 1) / nb;
+  const int step = MAX(1, (c->mloc + 7) / 8);
+  double *apanel[2], *bpanel[2];
+  MPI_Request req[2][2];
+
+  memset(c->data, 0, (size_t)c->mloc * c->nloc * sizeof(double));
+  if( nblocks == 0 )
+    return;
+  for(cur = 0; cur < 2; cur++){
+    apanel[cur] = workspace_calloc((size_t)a->mloc * nb);
+    bpanel[cur] = workspace_calloc((size_t)nb * b->nloc);
+  }
+
+  distrib_panels_start(apanel[0], bpanel[0], req[0], a, b, 0);
+  for(k = 0; k < nblocks; k++){
+    cur = k % 2;
+    const int kb = MIN(nb, n - k * nb);
+    MPI_Waitall(2, req[cur], MPI_STATUSES_IGNORE);
+    if( k + 1 < nblocks )
+      distrib_panels_start(apanel[1-cur], bpanel[1-cur], req[1-cur], a, b, k + 1);
+
+    // Rows of the result by chunks, letting MPI progress the next broadcasts in between
+    for(r0 = 0; r0 < c->mloc; r0 = r1){
+      int li;
+      r1 = MIN(r0 + step, c->mloc);
+      #pragma omp parallel for num_threads(parallel_threads())
+      for(li = r0; li < r1; li++)
+        simd_vecmat(c->data + (long)li * c->nloc, apanel[cur] + (long)li * kb, bpanel[cur], c->nloc, kb, c->nloc);
+      if( k + 1 < nblocks )
+        MPI_Testall(2, req[1-cur], &flag, MPI_STATUSES_IGNORE);
+    }
+  }
+
+  for(cur = 0; cur < 2; cur++){
+    free(apanel[cur]);
+    free(bpanel[cur]);
+  }
+
+}
+
+
+/*!
+ * Check that two distributed centrosymmetric matrices have the same dimension and distribution.
+ *
+ * \param[in]  mat1 The first matrix.
+ * \param[in]  mat2 The second matrix.
+ * \retval 1 if they match.
+ */
+static int distrib_centrosym_match(const distrib_centrosym *mat1, const distrib_centrosym *mat2)
+{
+
+  return mat1->dim == mat2->dim && mat1->plus.nb == mat2->plus.nb && mat1->plus.grid == mat2->plus.grid;
+
+}
+
+
+/*!
+ * Compute the product of two distributed centrosymmetric matrices (products of their half-size blocks). Collective.
+ *
+ * \param[out]  outmat The resulting matrix (allocated with the same dimension and distribution, distinct from the others).
+ * \param[in]  mat1 The first matrix.
+ * \param[in]  mat2 The second matrix.
+ * \retval 1 on success, 0 if the matrices do not match.
+ */
+int distrib_centrosym_product(distrib_centrosym *outmat, const distrib_centrosym *mat1, const distrib_centrosym *mat2)
+{
+
+  if( !distrib_centrosym_match(mat1, mat2) || !distrib_centrosym_match(outmat, mat1)
+      || outmat == mat1 || outmat == mat2 )
+    return 0;
+  distrib_block_product(&outmat->plus, &mat1->plus, &mat2->plus);
+  distrib_block_product(&outmat->minus, &mat1->minus, &mat2->minus);
+  return 1;
+
+}
+
+
+/*!
+ * Start the transposition of a distributed dense matrix y onto the distribution of x:
+ * each element y(j,i) is sent to the process holding x(i,j).
+ *
+ * \param[out]  tr The transposition in progress.
+ * \param[in]  x The matrix whose distribution is the target.
+ * \param[in]  y The matrix to transpose.
+ * \retval none
+ */
+static void distrib_block_traceprod_start(distrib_transpose *tr, const distrib_block *x, const distrib_block *y)
+{
+
+  int li, lj, r, nprocs;
+  const distrib_grid *grid = y->grid;
+  MPI_Comm_size(grid->comm, &nprocs);
+  tr->sendcounts = (int*)calloc(nprocs, sizeof(int));
+  tr->sdispls = (int*)calloc(nprocs, sizeof(int));
+  tr->recvcounts = (int*)calloc(nprocs, sizeof(int));
+  tr->rdispls = (int*)calloc(nprocs, sizeof(int));
+  tr->sendbuf = workspace_calloc((size_t)y->mloc * y->nloc);
+  tr->recvbuf = workspace_calloc((size_t)x->mloc * x->nloc);
+  int *pos = (int*)calloc(nprocs, sizeof(int));
+
+  // Sent in the local row-major order of y, i.e. by increasing (j,i), which is
+  // the local column-major order of x on the receiving side
+  for(li = 0; li < y->mloc; li++){
+    const int j = distrib_l2g(li, y->nb, grid->myrow, grid->nprow);
+    for(lj = 0; lj < y->nloc; lj++)
+      tr->sendcounts[ distrib_owner(distrib_l2g(lj, y->nb, grid->mycol, grid->npcol), j, x->nb, grid) ]++;
+  }
+  for(lj = 0; lj < x->nloc; lj++){
+    const int j = distrib_l2g(lj, x->nb, grid->mycol, grid->npcol);
+    for(li = 0; li < x->mloc; li++)
+      tr->recvcounts[ distrib_owner(j, distrib_l2g(li, x->nb, grid->myrow, grid->nprow), y->nb, grid) ]++;
+  }
+  for(r = 1; r < nprocs; r++){
+    tr->sdispls[r] = tr->sdispls[r-1] + tr->sendcounts[r-1];
+    tr->rdispls[r] = tr->rdispls[r-1] + tr->recvcounts[r-1];
+  }
+  for(li = 0; li < y->mloc; li++){
+    const int j = distrib_l2g(li, y->nb, grid->myrow, grid->nprow);
+    for(lj = 0; lj < y->nloc; lj++){
+      r = distrib_owner(distrib_l2g(lj, y->nb, grid->mycol, grid->npcol), j, x->nb, grid);
+      tr->sendbuf[ tr->sdispls[r] + pos[r]++ ] = y->data[ (long)li * y->nloc + lj ];
+    }
+  }
+  free(pos);
+
+  MPI_Ialltoallv(tr->sendbuf, tr->sendcounts, tr->sdispls, MPI_DOUBLE,
+    tr->recvbuf, tr->recvcounts, tr->rdispls, MPI_DOUBLE, grid->comm, &tr->req);
+
+}
+
+
+/*!
+ * Complete the transposition of y (see distrib_block_traceprod_start), and compute
+ * the local part of tr(x y) = sum_ij x(i,j) y(j,i).
+ *
+ * \param[in]  tr The transposition in progress.
+ * \param[in]  x The first matrix.
+ * \param[in]  y The second matrix.
+ * \retval The local part of the trace-product.
+ */
+static double distrib_block_traceprod_finish(distrib_transpose *tr, const distrib_block *x, const distrib_block *y)
+{
+
+  int li, lj, nprocs;
+  double res = 0.0;
+  const distrib_grid *grid = x->grid;
+  MPI_Comm_size(grid->comm, &nprocs);
+  int *pos = (int*)calloc(nprocs, sizeof(int));
+
+  MPI_Wait(&tr->req, MPI_STATUS_IGNORE);
+  for(lj = 0; lj < x->nloc; lj++){
+    const int j = distrib_l2g(lj, x->nb, grid->mycol, grid->npcol);
+    for(li = 0; li < x->mloc; li++){
+      const int r = distrib_owner(j, distrib_l2g(li, x->nb, grid->myrow, grid->nprow), y->nb, grid);
+      res += x->data[ (long)li * x->nloc + lj ] * tr->recvbuf[ tr->rdispls[r] + pos[r]++ ];
+    }
+  }
+
+  free(pos);
+  free(tr->sendbuf);
+  free(tr->recvbuf);
+  free(tr->sendcounts);
+  free(tr->sdispls);
+  free(tr->recvcounts);
+  free(tr->rdispls);
+  return res;
+
+}
+
+
+/*!
+ * Compute the trace of the product of two distributed centrosymmetric matrices
+ * (sum of the trace-products of their half-size blocks). Collective.
+ * The transposition of the minus blocks overlaps the trace-product of the plus blocks.
+ *
+ * \param[in]  mat1 The first matrix.
+ * \param[in]  mat2 The second matrix.
+ * \retval The trace of the product (on all processes), or NAN if the matrices do not match.
+ */
+double distrib_centrosym_traceprod(const distrib_centrosym *mat1, const distrib_centrosym *mat2)
+{
+
+  double local, res = 0.0;
+  distrib_transpose trplus, trminus;
+  if( !distrib_centrosym_match(mat1, mat2) )
+    return NAN;
+  distrib_block_traceprod_start(&trplus, &mat1->plus, &mat2->plus);
+  distrib_block_traceprod_start(&trminus, &mat1->minus, &mat2->minus);
+  local = distrib_block_traceprod_finish(&trplus, &mat1->plus, &mat2->plus);
+  local += distrib_block_traceprod_finish(&trminus, &mat1->minus, &mat2->minus);
+  MPI_Allreduce(&local, &res, 1, MPI_DOUBLE, MPI_SUM, mat1->plus.grid->comm);
+  return res;
+
+}
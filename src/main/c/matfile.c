@@ -0,0 +1,423 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#include "symtrx.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MAX(a,b) ((a) > (b) ? (a) : (b))
+#define MIN(a,b) ((a) > (b) ? (b) : (a))
+
+// Binary files of matrices in compressed form: a header of MATFILE_HEADER_SIZE bytes
+// (type, layout, dimension, element type, checksum), followed by the packed payload exactly
+// as it is stored in memory. Loading maps the file, so that the payload is handed to the
+// kernels without being copied or parsed, and is read from disk on demand. Writing is
+// streaming: the payload can be appended in pieces (e.g. generated row by row), the
+// checksum is updated on the fly, and the header is written last, so that an unfinished
+// file is never accepted. The checksum is XXH64, which runs at memory speed.
+
+static const char matfile_magic[8] = { 'S', 'Y', 'M', 'T', 'R', 'X', 0, 0 };
+
+#define MATFILE_BYTEORDER 0x01020304u
+
+_Static_assert(sizeof(matfile_header) == MATFILE_HEADER_SIZE, "matfile_header must be MATFILE_HEADER_SIZE bytes");
+
+#define XXH_P1 11400714785074694791ULL
+#define XXH_P2 14029467366897019727ULL
+#define XXH_P3 1609587929392839161ULL
+#define XXH_P4 9650029242287828579ULL
+#define XXH_P5 2870177450012600261ULL
+
+
+static inline uint64_t matfile_rotl(uint64_t x, int r)
+{
+  return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t matfile_read64(const unsigned char *p)
+{
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint64_t matfile_round(uint64_t acc, uint64_t input)
+{
+  acc += input * XXH_P2;
+  return matfile_rotl(acc, 31) * XXH_P1;
+}
+
+static inline uint64_t matfile_merge(uint64_t h, uint64_t acc)
+{
+  h ^= matfile_round(0, acc);
+  return h * XXH_P1 + XXH_P4;
+}
+
+
+static void matfile_hash_init(matfile_hash *hs)
+{
+
+  memset(hs, 0, sizeof(matfile_hash));
+  hs->acc[0] = XXH_P1 + XXH_P2;
+  hs->acc[1] = XXH_P2;
+  hs->acc[2] = 0;
+  hs->acc[3] = - XXH_P1;
+
+}
+
+
+/*!
+ * Hash stripes of 32 bytes in four independent lanes.
+ */
+static void matfile_hash_stripes(uint64_t *acc, const unsigned char *p, size_t nstripes)
+{
+
+  size_t s;
+  uint64_t a0 = acc[0], a1 = acc[1], a2 = acc[2], a3 = acc[3];
+  for(s = 0; s < nstripes; s++, p += 32){
+    a0 = matfile_round(a0, matfile_read64(p));
+    a1 = matfile_round(a1, matfile_read64(p + 8));
+    a2 = matfile_round(a2, matfile_read64(p + 16));
+    a3 = matfile_round(a3, matfile_read64(p + 24));
+  }
+  acc[0] = a0; acc[1] = a1; acc[2] = a2; acc[3] = a3;
+
+}
+
+
+static void matfile_hash_update(matfile_hash *hs, const void *data, size_t nbytes)
+{
+
+  const unsigned char *p = (const unsigned char*)data;
+  size_t n;
+  hs->nbytes += nbytes;
+  // Complete the pending stripe first
+  if( hs->nbuf > 0 ){
+    n = MIN(nbytes, (size_t)(32 - hs->nbuf));
+    memcpy(hs->buf + hs->nbuf, p, n);
+    hs->nbuf += (int)n;
+    p += n;
+    nbytes -= n;
+    if( hs->nbuf < 32 )
+      return;
+    matfile_hash_stripes(hs->acc, hs->buf, 1);
+    hs->nbuf = 0;
+  }
+  matfile_hash_stripes(hs->acc, p, nbytes / 32);
+  p += nbytes / 32 * 32;
+  hs->nbuf = (int)(nbytes % 32);
+  memcpy(hs->buf, p, hs->nbuf);
+
+}
+
+
+static uint64_t matfile_hash_digest(const matfile_hash *hs)
+{
+
+  uint64_t h, k;
+  uint32_t k32;
+  const unsigned char *p = hs->buf;
+  int n = hs->nbuf;
+  if( hs->nbytes >= 32 ){
+    h = matfile_rotl(hs->acc[0], 1) + matfile_rotl(hs->acc[1], 7)
+      + matfile_rotl(hs->acc[2], 12) + matfile_rotl(hs->acc[3], 18);
+    h = matfile_merge(h, hs->acc[0]);
+    h = matfile_merge(h, hs->acc[1]);
+    h = matfile_merge(h, hs->acc[2]);
+    h = matfile_merge(h, hs->acc[3]);
+  } else {
+    h = XXH_P5;
+  }
+  h += hs->nbytes;
+  for(; n >= 8; n -= 8, p += 8){
+    k = matfile_round(0, matfile_read64(p));
+    h = matfile_rotl(h ^ k, 27) * XXH_P1 + XXH_P4;
+  }
+  if( n >= 4 ){
+    memcpy(&k32, p, sizeof(k32));
+    h = matfile_rotl(h ^ ((uint64_t)k32 * XXH_P1), 23) * XXH_P2 + XXH_P3;
+    n -= 4;
+    p += 4;
+  }
+  for(; n > 0; n--, p++)
+    h = matfile_rotl(h ^ (*p * XXH_P5), 11) * XXH_P1;
+  h ^= h >> 33;
+  h *= XXH_P2;
+  h ^= h >> 29;
+  h *= XXH_P3;
+  h ^= h >> 32;
+  return h;
+
+}
+
+
+/*!
+ * Compute the checksum of a payload (XXH64 with seed 0).
+ *
+ * \param[in]  data The payload.
+ * \param[in]  nbytes Its size in bytes.
+ * \retval The checksum.
+ */
+uint64_t matfile_checksum(const void *data, size_t nbytes)
+{
+
+  matfile_hash hs;
+  matfile_hash_init(&hs);
+  matfile_hash_update(&hs, data, nbytes);
+  return matfile_hash_digest(&hs);
+
+}
+
+
+/*!
+ * Number of elements of the payload of a matrix file.
+ *
+ * \param[in]  type The type of matrix (MATFILE_SQUARE, ...).
+ * \param[in]  layout The layout (MATFILE_DIAGMAJOR for centrosymmetric matrices only).
+ * \param[in]  dim The dimension.
+ * \retval The number of elements, or -1 if the type or layout is not supported.
+ */
+long matfile_size(int type, int layout, int dim)
+{
+
+  if( dim < 0 || (layout != MATFILE_ROWMAJOR && layout != MATFILE_DIAGMAJOR) )
+    return -1;
+  if( layout == MATFILE_DIAGMAJOR && type != MATFILE_CENTROSYM )
+    return -1;
+  switch( type ){
+    case MATFILE_SQUARE: return (long)dim * dim;
+    case MATFILE_CENTROSYM: return centrosym_size(dim);
+    case MATFILE_BISYM: return bisym_size(dim);
+    case MATFILE_SYMMAT: return symmat_size(dim);
+    case MATFILE_TOEPLITZ: return toeplitz_size(dim);
+    default: return -1;
+  }
+
+}
+
+
+/*!
+ * Create a matrix file, to be filled with matfile_writer_append.
+ *
+ * \param[out]  w The writer.
+ * \param[in]  filename The file.
+ * \param[in]  type The type of matrix (MATFILE_SQUARE, ...).
+ * \param[in]  layout The layout (MATFILE_ROWMAJOR or MATFILE_DIAGMAJOR).
+ * \param[in]  dim The dimension.
+ * \retval 1 if the file was created, 0 otherwise.
+ */
+int matfile_writer_open(matfile_writer *w, const char *filename, int type, int layout, int dim)
+{
+
+  const long size = matfile_size(type, layout, dim);
+  memset(w, 0, sizeof(matfile_writer));
+  if( size < 0 )
+    return 0;
+  w->fp = fopen(filename, "wb");
+  if( w->fp == NULL )
+    return 0;
+  memcpy(w->header.magic, matfile_magic, sizeof(matfile_magic));
+  w->header.version = MATFILE_VERSION;
+  w->header.byteorder = MATFILE_BYTEORDER;
+  w->header.type = type;
+  w->header.layout = layout;
+  w->header.dtype = MATFILE_FLOAT64;
+  w->header.dim = dim;
+  w->header.size = size;
+  matfile_hash_init(&w->hash);
+
+  // Placeholder (zero magic) until the payload is complete
+  matfile_header blank;
+  memset(&blank, 0, sizeof(blank));
+  if( fwrite(&blank, sizeof(blank), 1, w->fp) != 1 ){
+    fclose(w->fp);
+    w->fp = NULL;
+    return 0;
+  }
+  return 1;
+
+}
+
+
+/*!
+ * Append a piece of the payload to a matrix file, in the order of its layout.
+ *
+ * \param[in]  w The writer.
+ * \param[in]  data The elements.
+ * \param[in]  n Their number.
+ * \retval 1 if they were written, 0 otherwise (write error, or more elements than the payload).
+ */
+int matfile_writer_append(matfile_writer *w, const double *data, long n)
+{
+
+  if( w->fp == NULL || n < 0 || w->written + n > w->header.size )
+    return 0;
+  if( n == 0 )
+    return 1;
+  if( fwrite(data, sizeof(double), n, w->fp) != (size_t)n )
+    return 0;
+  matfile_hash_update(&w->hash, data, n * sizeof(double));
+  w->written += n;
+  return 1;
+
+}
+
+
+/*!
+ * Complete a matrix file: write its header, and close it.
+ *
+ * \param[in]  w The writer.
+ * \retval 1 if the file is complete and valid, 0 otherwise (e.g. the payload is incomplete).
+ */
+int matfile_writer_close(matfile_writer *w)
+{
+
+  int res = 0;
+  if( w->fp == NULL )
+    return 0;
+  if( w->written == w->header.size ){
+    w->header.checksum = matfile_hash_digest(&w->hash);
+    res = fseek(w->fp, 0, SEEK_SET) == 0 && fwrite(&w->header, sizeof(matfile_header), 1, w->fp) == 1;
+  }
+  if( fclose(w->fp) != 0 )
+    res = 0;
+  w->fp = NULL;
+  return res;
+
+}
+
+
+/*!
+ * Write a matrix in compressed form to a file.
+ *
+ * \param[in]  filename The file.
+ * \param[in]  type The type of matrix (MATFILE_SQUARE, ...).
+ * \param[in]  layout The layout of mat (MATFILE_ROWMAJOR or MATFILE_DIAGMAJOR).
+ * \param[in]  dim The dimension.
+ * \param[in]  mat The matrix in compressed form.
+ * \retval 1 if the file was written, 0 otherwise.
+ */
+int matfile_write(const char *filename, int type, int layout, int dim, const double *mat)
+{
+
+  matfile_writer w;
+  if( matfile_writer_open(&w, filename, type, layout, dim) == 0 )
+    return 0;
+  if( matfile_writer_append(&w, mat, w.header.size) == 0 ){
+    matfile_writer_close(&w);
+    return 0;
+  }
+  return matfile_writer_close(&w);
+
+}
+
+
+/*!
+ * Check the header of a matrix file: magic, version, byte order and element type
+ * supported by this build, consistent dimension and size, and length of the file.
+ *
+ * \param[in]  h The header.
+ * \param[in]  filesize The length of the file (bytes).
+ * \retval 1 if the header is valid.
+ */
+int matfile_check_header(const matfile_header *h, size_t filesize)
+{
+
+  return memcmp(h->magic, matfile_magic, sizeof(matfile_magic)) == 0 && h->version == MATFILE_VERSION
+    && h->byteorder == MATFILE_BYTEORDER && h->dtype == MATFILE_FLOAT64
+    && h->dim >= 0 && h->dim <= INT32_MAX && h->size == matfile_size(h->type, h->layout, (int)h->dim)
+    && filesize == sizeof(matfile_header) + h->size * sizeof(double);
+
+}
+
+
+/*!
+ * Map a matrix file in memory. The payload is mapped read-only, so that it can be read by the
+ * kernels in place (mf->data) without reserving memory for it. With MATFILE_WRITABLE it is mapped
+ * privately instead (mf->writable): it can be written to without changing the file, the pages
+ * written being copied, but the whole mapping is then accounted as memory by the system and may
+ * not be granted under strict overcommit.
+ *
+ * \param[out]  mf The mapped file.
+ * \param[in]  filename The file.
+ * \param[in]  flags 0, or a combination of MATFILE_VERIFY to check the checksum (which reads the whole payload)
+ *   and MATFILE_WRITABLE for a writable copy-on-write view.
+ * \retval 1 if the file was mapped, 0 if it cannot be read or is not a valid matrix file.
+ */
+int matfile_open(matfile *mf, const char *filename, int flags)
+{
+
+  struct stat st;
+  memset(mf, 0, sizeof(matfile));
+  const int fd = open(filename, O_RDONLY);
+  if( fd < 0 )
+    return 0;
+  if( fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(matfile_header)
+      || read(fd, &mf->header, sizeof(matfile_header)) != (ssize_t)sizeof(matfile_header) ){
+    close(fd);
+    return 0;
+  }
+
+  if( matfile_check_header(&mf->header, st.st_size) == 0 ){
+    close(fd);
+    return 0;
+  }
+
+  mf->mapsize = st.st_size;
+  const int prot = (flags & MATFILE_WRITABLE) ? PROT_READ | PROT_WRITE : PROT_READ;
+  mf->map = mmap(NULL, mf->mapsize, prot, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if( mf->map == MAP_FAILED ){
+    memset(mf, 0, sizeof(matfile));
+    return 0;
+  }
+  mf->data = (const double*)((char*)mf->map + sizeof(matfile_header));
+  if( flags & MATFILE_WRITABLE )
+    mf->writable = (double*)((char*)mf->map + sizeof(matfile_header));
+  if( (flags & MATFILE_VERIFY) && matfile_verify(mf) == 0 ){
+    matfile_close(mf);
+    return 0;
+  }
+  return 1;
+
+}
+
+
+/*!
+ * Check the payload of a mapped matrix file against the checksum of its header.
+ *
+ * \param[in]  mf The mapped file.
+ * \retval 1 if the checksum matches.
+ */
+int matfile_verify(const matfile *mf)
+{
+
+  if( mf->data == NULL )
+    return 0;
+  return matfile_checksum(mf->data, mf->header.size * sizeof(double)) == mf->header.checksum;
+
+}
+
+
+/*!
+ * Unmap a matrix file. Its payload must not be used anymore.
+ *
+ * \param[in]  mf The mapped file.
+ * \retval none
+ */
+void matfile_close(matfile *mf)
+{
+
+  if( mf->map != NULL )
+    munmap(mf->map, mf->mapsize);
+  memset(mf, 0, sizeof(matfile));
+
+}
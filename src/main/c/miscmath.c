@@ -48,3 +48,96 @@ double ran2_dp(int idum) {
   if(iy < 1)iy=iy+IMM1;
   return (AM*iy < RPMX ? AM*iy : RPMX); // min(AM*iy,RPMX);
 }
+
+
+/*!
+ * Return the smallest power of two that is at least n (the sizes supported by fft_dp).
+ *
+ * \param[in]  n Minimal size.
+ * \retval The FFT size.
+ */
+int fft_size(int n)
+{
+  int size = 1;
+  while(size < n)
+    size *= 2;
+  return size;
+}
+
+
+/*!
+ * In-place complex FFT (iterative radix-2, decimation in time), unnormalised:
+ * X_k = sum_j x_j exp(sign * 2 i pi j k / n). The inverse transform is the one
+ * with the opposite sign, divided by n.
+ *
+ * \param[inout]  re Real parts.
+ * \param[inout]  im Imaginary parts.
+ * \param[in]  n Size of the transform (must be a power of two).
+ * \param[in]  sign Sign of the exponent (-1 for the forward transform, +1 for the inverse).
+ * \retval none
+ */
+void fft_dp(double *re, double *im, int n, int sign)
+{
+  fft_dp_ws(re, im, n, sign, NULL);
+}
+
+
+/*!
+ * Same as fft_dp, with the twiddle factors taken from a workspace (2*n doubles).
+ *
+ * \param[inout]  re Real parts.
+ * \param[inout]  im Imaginary parts.
+ * \param[in]  n Size of the transform (must be a power of two).
+ * \param[in]  sign Sign of the exponent (-1 for the forward transform, +1 for the inverse).
+ * \param[in]  ws The workspace (may be NULL).
+ * \retval none
+ */
+void fft_dp_ws(double *re, double *im, int n, int sign, workspace *ws)
+{
+  int i, j, k, len, half;
+  double tr, ti;
+
+  // Bit-reversal permutation
+  for(i = 1, j = 0; i < n; i++){
+    k = n >> 1;
+    for(; j & k; k >>= 1)
+      j ^= k;
+    j ^= k;
+    if(i < j){
+      tr = re[i]; re[i] = re[j]; re[j] = tr;
+      ti = im[i]; im[i] = im[j]; im[j] = ti;
+    }
+  }
+
+  // Twiddle factors computed once for the largest stage, then packed contiguously for each
+  // smaller stage (stage len starts at offset len/2 - 1), so that the butterflies read them in order
+  double *cosw = workspace_take(ws, 2 * (size_t)n);
+  double *sinw = cosw + n;
+  for(k = 0; k < n / 2; k++){
+    cosw[n/2-1+k] = cos(2.0 * M_PI * k / n);
+    sinw[n/2-1+k] = sign * sin(2.0 * M_PI * k / n);
+  }
+  for(len = n / 2; len >= 2; len /= 2)
+    for(k = 0; k < len / 2; k++){
+      cosw[len/2-1+k] = cosw[len-1+2*k];
+      sinw[len/2-1+k] = sinw[len-1+2*k];
+    }
+
+  for(len = 2; len <= n; len *= 2){
+    half = len / 2;
+    const double *cw = cosw + half - 1, *sw = sinw + half - 1;
+    for(i = 0; i < n; i += len){
+      double *r0 = re + i, *i0 = im + i, *r1 = re + i + half, *i1 = im + i + half;
+      for(k = 0; k < half; k++){
+        tr = cw[k] * r1[k] - sw[k] * i1[k];
+        ti = cw[k] * i1[k] + sw[k] * r1[k];
+        r1[k] = r0[k] - tr;
+        i1[k] = i0[k] - ti;
+        r0[k] += tr;
+        i0[k] += ti;
+      }
+    }
+  }
+
+  workspace_give(ws, cosw);
+}
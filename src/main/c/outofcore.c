@@ -0,0 +1,466 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#include "symtrx.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MAX(a,b) ((a) > (b) ? (a) : (b))
+#define MIN(a,b) ((a) > (b) ? (b) : (a))
+
+// Out-of-core products of centrosymmetric matrices stored in matrix files (see matfile.h).
+// The result is computed by stripes of rows: the rows of the first matrix that a stripe needs
+// are read once, and the second matrix is streamed through by panels of rows. Both are read by
+// helper threads into one buffer while the previous stripe or panel is multiplied from the other
+// (double buffering). A finished stripe is appended to the output file, so that no operand is
+// ever resident in full. Rows i0..i1 of a packed matrix, together with their mirrored rows
+// dim-i1..dim-i0 (for the elements above the diagonal), are two contiguous ranges of the file.
+// The budget sets the size of the stripes: the second matrix is read once per stripe.
+
+/*!
+ * Read request: the packed rows r0..r1 of a matrix file, and their mirrored rows.
+ */
+typedef struct {
+  int fd;
+  double *lo;             // Rows r0..r1
+  double *hi;             // Rows dim-r1..dim-r0
+  long lo0, nlo, hi0, nhi;
+  int status;
+} outofcore_request;
+
+/*!
+ * Read request running in a helper thread.
+ */
+typedef struct {
+  outofcore_request req;
+  pthread_t thread;
+  int running;
+} outofcore_prefetch;
+
+
+/*!
+ * Number of elements of the largest range of rows r0..r1 of a centrosymmetric matrix in compressed form,
+ * with r1-r0 = n (the last n rows).
+ *
+ * \param[in]  n The number of rows.
+ * \param[in]  dim The dimension.
+ * \retval The number of elements.
+ */
+static size_t outofcore_maxrows(int n, int dim)
+{
+
+  return centrosym_size(dim) - centrosym_size(dim - n);
+
+}
+
+
+/*!
+ * Number of bytes of the buffers of an out-of-core product, or of its panels only.
+ * The rows of the first matrix are double buffered unless the result is a single stripe.
+ *
+ * \param[in]  stripe Rows of the result per stripe (0 for the panels only).
+ * \param[in]  panel Rows of the second matrix per panel.
+ * \param[in]  dim The dimension.
+ * \retval The size in bytes.
+ */
+static size_t outofcore_bytes(int stripe, int panel, int dim)
+{
+
+  const int nbuf = stripe < dim ? 2 : 1;
+  return (2 * nbuf + 1) * workspace_bytes(outofcore_maxrows(stripe, dim))   // Rows and mirrored rows of the first matrix, stripe of the result
+    + 4 * workspace_bytes(outofcore_maxrows(panel, dim))       // Two buffers of rows and mirrored rows of the second matrix
+    + workspace_bytes((size_t)panel * dim)                     // Panel in dense form
+    + parallel_threads() * workspace_bytes((size_t)tiling_size() * panel);   // Tiles of the first matrix
+
+}
+
+
+/*!
+ * Plan an out-of-core product within a memory budget. The second matrix is read once per stripe:
+ * the panels get at most a quarter of the budget (one tile of rows at most, see tiling_size),
+ * and the stripes are made as large as the rest allows.
+ *
+ * \param[out]  plan The plan (stripe, panel, nstripes, memory; the other fields are set to zero).
+ * \param[in]  dim The dimension.
+ * \param[in]  budget The memory budget (bytes).
+ * \retval 1 if the product fits in the budget, 0 otherwise.
+ */
+int outofcore_plan(outofcore_stats *plan, int dim, size_t budget)
+{
+
+  int panel, lo, hi, mid;
+  memset(plan, 0, sizeof(outofcore_stats));
+  if( dim <= 0 )
+    return 0;
+  panel = MIN(tiling_size(), dim);
+  while( panel > 1 && outofcore_bytes(0, panel, dim) > budget / 4 )
+    panel /= 2;
+  if( outofcore_bytes(1, panel, dim) > budget )
+    return 0;
+  lo = hi = dim;
+  if( outofcore_bytes(dim, panel, dim) > budget )
+    for(lo = 1, hi = dim - 1; lo < hi; ){
+      mid = hi - (hi - lo) / 2;
+      if( outofcore_bytes(mid, panel, dim) > budget )
+        hi = mid - 1;
+      else
+        lo = mid;
+    }
+  plan->stripe = lo;
+  plan->panel = panel;
+  plan->nstripes = (dim + lo - 1) / lo;
+  plan->memory = outofcore_bytes(lo, panel, dim);
+  return 1;
+
+}
+
+
+/*!
+ * Read elements of the payload of a matrix file.
+ *
+ * \param[in]  fd The file.
+ * \param[out]  buf The elements.
+ * \param[in]  first Index of the first element.
+ * \param[in]  n Number of elements.
+ * \retval 1 if they were read, 0 otherwise.
+ */
+static int outofcore_pread(int fd, double *buf, long first, long n)
+{
+
+  char *p = (char*)buf;
+  size_t left = n * sizeof(double);
+  off_t offset = sizeof(matfile_header) + first * sizeof(double);
+  while( left > 0 ){
+    const ssize_t nread = pread(fd, p, left, offset);
+    if( nread < 0 && errno == EINTR )
+      continue;
+    if( nread <= 0 )
+      return 0;
+    p += nread;
+    left -= nread;
+    offset += nread;
+  }
+  return 1;
+
+}
+
+
+/*!
+ * Prepare the request of rows r0..r1 of a centrosymmetric matrix in compressed form, and of their mirrored rows.
+ *
+ * \param[out]  req The request.
+ * \param[in]  fd The file.
+ * \param[in]  lo The buffer of the rows.
+ * \param[in]  hi The buffer of the mirrored rows.
+ * \param[in]  r0 First row.
+ * \param[in]  r1 Last row (excluded).
+ * \param[in]  dim The dimension.
+ * \retval none
+ */
+static void outofcore_rows(outofcore_request *req, int fd, double *lo, double *hi, int r0, int r1, int dim)
+{
+
+  req->fd = fd;
+  req->lo = lo;
+  req->hi = hi;
+  req->lo0 = centrosym_ind(r0,0,dim);
+  req->nlo = centrosym_ind(r1,0,dim) - req->lo0;
+  req->hi0 = centrosym_ind(dim-r1,0,dim);
+  req->nhi = centrosym_ind(dim-r0,0,dim) - req->hi0;
+  req->status = 0;
+
+}
+
+
+/*!
+ * Execute a read request (entry point of the helper thread).
+ *
+ * \param[inout]  arg The request.
+ * \retval NULL
+ */
+static void *outofcore_fetch(void *arg)
+{
+
+  outofcore_request *req = (outofcore_request*)arg;
+  req->status = outofcore_pread(req->fd, req->lo, req->lo0, req->nlo)
+    && outofcore_pread(req->fd, req->hi, req->hi0, req->nhi);
+  return NULL;
+
+}
+
+
+/*!
+ * Start a read request in a helper thread (or execute it at once if no thread can be created).
+ *
+ * \param[out]  pf The prefetch.
+ * \param[in]  req The request.
+ * \retval none
+ */
+static void outofcore_prefetch_start(outofcore_prefetch *pf, const outofcore_request *req)
+{
+
+  pf->req = *req;
+  pf->running = pthread_create(&pf->thread, NULL, outofcore_fetch, &pf->req) == 0;
+  if( !pf->running )
+    outofcore_fetch(&pf->req);
+
+}
+
+
+/*!
+ * Wait for the end of a read request started with outofcore_prefetch_start.
+ *
+ * \param[in]  pf The prefetch.
+ * \retval 1 if the rows were read, 0 otherwise.
+ */
+static int outofcore_prefetch_wait(outofcore_prefetch *pf)
+{
+
+  if( pf->running )
+    pthread_join(pf->thread, NULL);
+  pf->running = 0;
+  return pf->req.status;
+
+}
+
+
+/*!
+ * Accumulate the contribution of a panel of the second matrix to rows r0..r1 of a stripe of the result
+ * (see centrosym_product_rows).
+ *
+ * \param[inout]  out The stripe of the result (packed rows i0..i1).
+ * \param[in]  alo The rows i0..i1 of the first matrix.
+ * \param[in]  ahi The rows dim-i1..dim-i0 of the first matrix.
+ * \param[in]  panel The rows k0..k1 of the second matrix, columns 0..i1, in dense form.
+ * \param[in]  r0 First row.
+ * \param[in]  r1 Last row (excluded).
+ * \param[in]  i0 First row of the stripe.
+ * \param[in]  i1 Last row of the stripe (excluded).
+ * \param[in]  k0 First row of the panel.
+ * \param[in]  k1 Last row of the panel (excluded).
+ * \param[in]  dim The dimension.
+ * \retval none
+ */
+static void outofcore_product_rows(double *out, const double *alo, const double *ahi, const double *panel,
+  int r0, int r1, int i0, int i1, int k0, int k1, int dim)
+{
+
+  int i, ii0, ii1, j0, j1;
+  const int tile = tiling_size(), nk = k1 - k0;
+  const long base = centrosym_ind(i0,0,dim), basehi = centrosym_ind(dim-i1,0,dim);
+  double *tile1 = workspace_calloc((size_t)tile * nk);
+
+  for(ii0 = r0; ii0 < r1; ii0 += tile){
+    ii1 = MIN(ii0 + tile, r1);
+
+    // Tile (ii0..ii1, k0..k1) of the first matrix, in dense form
+    for(i = ii0; i < ii1; i++)
+      centrosym_getrow_split(tile1 + (long)(i-ii0) * nk, alo + centrosym_ind(i,0,dim) - base,
+        ahi + centrosym_ind(dim-i-1,0,dim) - basehi, i, k0, k1, dim);
+
+    for(j0 = 0; j0 < ii1; j0 += tile){
+      j1 = MIN(j0 + tile, ii1);
+      for(i = MAX(ii0, j0); i < ii1; i++)
+        simd_vecmat(out + centrosym_ind(i,j0,dim) - base, tile1 + (long)(i-ii0) * nk,
+          panel + j0, i1, nk, MIN(j1, i+1) - j0);
+    }
+  }
+
+  free(tile1);
+
+}
+
+
+/*!
+ * Open a matrix file of a centrosymmetric matrix in compressed form (row by row) for reading.
+ *
+ * \param[in]  filename The file.
+ * \param[out]  dim Its dimension.
+ * \retval The file descriptor, or -1 if the file cannot be read or is not such a matrix file.
+ */
+static int outofcore_open(const char *filename, int *dim)
+{
+
+  struct stat st;
+  matfile_header h;
+  const int fd = open(filename, O_RDONLY);
+  if( fd < 0 )
+    return -1;
+  if( fstat(fd, &st) != 0 || pread(fd, &h, sizeof(h), 0) != (ssize_t)sizeof(h)
+      || matfile_check_header(&h, st.st_size) == 0
+      || h.type != MATFILE_CENTROSYM || h.layout != MATFILE_ROWMAJOR ){
+    close(fd);
+    return -1;
+  }
+  *dim = (int)h.dim;
+  return fd;
+
+}
+
+
+/*!
+ * Compute the product of two centrosymmetric matrices stored in matrix files (compressed form, row by row),
+ * with a bounded amount of memory, and write it to a matrix file.
+ * The first matrix is read once, the second one once per stripe (see outofcore_plan),
+ * and the reads of both are overlapped with the computation.
+ *
+ * \param[in]  outfile The file of the resulting matrix.
+ * \param[in]  file1 The file of the first matrix.
+ * \param[in]  file2 The file of the second matrix.
+ * \param[in]  budget The memory budget (bytes).
+ * \param[out]  stats The plan and statistics (may be NULL).
+ * \retval 1 if the product was written, 0 otherwise (unreadable or mismatched inputs, budget too small, I/O error).
+ */
+int outofcore_centrosym_product(const char *outfile, const char *file1, const char *file2, size_t budget, outofcore_stats *stats)
+{
+
+  int c, s, i0, i1, k0, k1, dim1 = 0, dim2 = 0, created = 0, res = 0;
+  long g;
+  double t0, t1;
+  outofcore_stats plan;
+  outofcore_request req;
+  outofcore_prefetch pf, pfa;
+  matfile_writer w;
+  double *alo[2] = { NULL, NULL }, *ahi[2] = { NULL, NULL }, *out = NULL;
+  double *blo[2] = { NULL, NULL }, *bhi[2] = { NULL, NULL }, *panel = NULL;
+
+  t0 = timer_now();
+  memset(&plan, 0, sizeof(plan));
+  memset(&pf, 0, sizeof(pf));
+  memset(&pfa, 0, sizeof(pfa));
+  memset(&w, 0, sizeof(w));
+  if( stats )
+    memset(stats, 0, sizeof(outofcore_stats));
+  const int fd1 = outofcore_open(file1, &dim1);
+  const int fd2 = outofcore_open(file2, &dim2);
+  const int dim = dim1;
+  if( fd1 < 0 || fd2 < 0 || dim1 != dim2 || outofcore_plan(&plan, dim, budget) == 0 )
+    goto cleanup;
+
+  const int npanels = (dim + plan.panel - 1) / plan.panel;
+  const int nabuf = plan.nstripes > 1 ? 2 : 1;
+  out = workspace_calloc(outofcore_maxrows(plan.stripe, dim));
+  panel = workspace_calloc((size_t)plan.panel * dim);
+  for(c = 0; c < nabuf; c++){
+    alo[c] = workspace_calloc(outofcore_maxrows(plan.stripe, dim));
+    ahi[c] = workspace_calloc(outofcore_maxrows(plan.stripe, dim));
+    if( !alo[c] || !ahi[c] )
+      goto cleanup;
+  }
+  for(c = 0; c < 2; c++){
+    blo[c] = workspace_calloc(outofcore_maxrows(plan.panel, dim));
+    bhi[c] = workspace_calloc(outofcore_maxrows(plan.panel, dim));
+  }
+  if( !out || !panel || !blo[0] || !bhi[0] || !blo[1] || !bhi[1] )
+    goto cleanup;
+  created = matfile_writer_open(&w, outfile, MATFILE_CENTROSYM, MATFILE_ROWMAJOR, dim);
+  if( created == 0 )
+    goto cleanup;
+
+  // The rows of the first matrix for the next stripe are read while the current stripe is computed.
+  // The panels of the second matrix do not depend on the stripe: they are read in a cycle,
+  // the next one (possibly the first one of the next stripe) while the current one is multiplied
+  outofcore_rows(&req, fd1, alo[0], ahi[0], 0, MIN(plan.stripe, dim), dim);
+  outofcore_prefetch_start(&pfa, &req);
+  plan.nread += (req.nlo + req.nhi) * sizeof(double);
+  outofcore_rows(&req, fd2, blo[0], bhi[0], 0, MIN(plan.panel, dim), dim);
+  outofcore_prefetch_start(&pf, &req);
+  plan.npanels = 1;
+  plan.nread += (req.nlo + req.nhi) * sizeof(double);
+
+  for(i0 = 0, s = 0, g = 0; i0 < dim; i0 = i1, s++){
+    i1 = MIN(i0 + plan.stripe, dim);
+    const long base = centrosym_ind(i0,0,dim), nout = centrosym_ind(i1,0,dim) - base;
+    const int acur = s % nabuf;
+
+    // Rows of the first matrix needed by the stripe, and those of the next stripe
+    t1 = timer_now();
+    const int astatus = outofcore_prefetch_wait(&pfa);
+    plan.twait += timer_now() - t1;
+    if( astatus == 0 )
+      goto cleanup;
+    if( i1 < dim ){
+      outofcore_rows(&req, fd1, alo[1-acur], ahi[1-acur], i1, MIN(i1 + plan.stripe, dim), dim);
+      outofcore_prefetch_start(&pfa, &req);
+      plan.nread += (req.nlo + req.nhi) * sizeof(double);
+    }
+    const double *a1 = alo[acur], *a2 = ahi[acur];
+    memset(out, 0, nout * sizeof(double));
+
+    for(c = 0; c < npanels; c++, g++){
+      k0 = c * plan.panel;
+      k1 = MIN(k0 + plan.panel, dim);
+      const int cur = (int)(g % 2);
+
+      t1 = timer_now();
+      const int status = outofcore_prefetch_wait(&pf);
+      plan.twait += timer_now() - t1;
+      if( status == 0 )
+        goto cleanup;
+      if( c + 1 < npanels || i1 < dim ){
+        const int kn0 = ((c + 1) % npanels) * plan.panel;
+        outofcore_rows(&req, fd2, blo[1-cur], bhi[1-cur], kn0, MIN(kn0 + plan.panel, dim), dim);
+        outofcore_prefetch_start(&pf, &req);
+        plan.npanels++;
+        plan.nread += (req.nlo + req.nhi) * sizeof(double);
+      }
+
+      // Rows k0..k1 of the second matrix (columns 0..i1), in dense form
+      const long bbase = centrosym_ind(k0,0,dim), bbasehi = centrosym_ind(dim-k1,0,dim);
+      int k;
+      for(k = k0; k < k1; k++)
+        centrosym_getrow_split(panel + (long)(k-k0) * i1, blo[cur] + centrosym_ind(k,0,dim) - bbase,
+          bhi[cur] + centrosym_ind(dim-k-1,0,dim) - bbasehi, k, 0, i1, dim);
+
+      const int nchunks = parallel_nchunks(i1 - i0, tiling_size());
+      int *bounds = (int*)calloc(nchunks + 1, sizeof(int));
+      parallel_partition(bounds, nchunks, i1 - i0, PARALLEL_UNIFORM);
+      int ch;
+      #pragma omp parallel for schedule(dynamic,1) num_threads(parallel_threads())
+      for(ch = 0; ch < nchunks; ch++)
+        outofcore_product_rows(out, a1, a2, panel, i0 + bounds[ch], i0 + bounds[ch+1], i0, i1, k0, k1, dim);
+      free(bounds);
+    }
+
+    if( matfile_writer_append(&w, out, nout) == 0 )
+      goto cleanup;
+    plan.nwritten += nout * sizeof(double);
+  }
+  res = matfile_writer_close(&w);
+
+ cleanup:
+  if( pf.running )
+    outofcore_prefetch_wait(&pf);
+  if( pfa.running )
+    outofcore_prefetch_wait(&pfa);
+  if( w.fp != NULL )
+    matfile_writer_close(&w);
+  if( res == 0 && created )
+    remove(outfile);
+  if( fd1 >= 0 )
+    close(fd1);
+  if( fd2 >= 0 )
+    close(fd2);
+  free(out);
+  free(panel);
+  for(c = 0; c < 2; c++){
+    free(alo[c]);
+    free(ahi[c]);
+    free(blo[c]);
+    free(bhi[c]);
+  }
+  plan.ttotal = timer_now() - t0;
+  if( stats )
+    *stats = plan;
+  return res;
+
+}
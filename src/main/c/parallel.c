@@ -0,0 +1,123 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#include "symtrx.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define MAX(a,b) ((a) > (b) ? (a) : (b))
+#define MIN(a,b) ((a) > (b) ? (b) : (a))
+
+// Number of chunks per thread, so that the dynamic scheduler can balance the load
+#define CHUNKS_PER_THREAD 4
+
+static int threads_current = 0;
+
+
+/*!
+ * Set the number of threads used by the parallel kernels.
+ *
+ * \param[in]  nthreads The number of threads (0 restores the OpenMP default).
+ * \retval none
+ */
+void parallel_set_threads(int nthreads)
+{
+
+  threads_current = MAX(nthreads, 0);
+
+}
+
+
+/*!
+ * Return the number of threads used by the parallel kernels.
+ *
+ * \retval The number of threads (1 without OpenMP).
+ */
+int parallel_threads(void)
+{
+
+#ifdef _OPENMP
+  return threads_current > 0 ? threads_current : omp_get_max_threads();
+#else
+  return 1;
+#endif
+
+}
+
+
+/*!
+ * Return the index of the calling thread in the current parallel region.
+ *
+ * \retval The index, from 0 to the number of threads of the region (0 outside of a region, or without OpenMP).
+ */
+int parallel_thread_num(void)
+{
+
+#ifdef _OPENMP
+  return omp_get_thread_num();
+#else
+  return 0;
+#endif
+
+}
+
+
+/*!
+ * Return the number of chunks a range of rows should be split into.
+ *
+ * \param[in]  nrows The number of rows.
+ * \param[in]  minrows The minimum number of rows per chunk (e.g. the tile size).
+ * \retval The number of chunks (at least 1).
+ */
+int parallel_nchunks(int nrows, int minrows)
+{
+
+  int nthreads = parallel_threads();
+  if( nthreads <= 1 )
+    return 1;
+  return MAX(1, MIN(CHUNKS_PER_THREAD * nthreads, nrows / MAX(minrows, 1)));
+
+}
+
+
+/*!
+ * Split a range of rows into chunks of equal work.
+ * With PARALLEL_TRIANGULAR the work of row i is proportional to i+1
+ * (rows of a packed triangle), with PARALLEL_UNIFORM all rows cost the same.
+ *
+ * \param[out]  bounds The chunk boundaries (nchunks+1 elements, chunk c is bounds[c]..bounds[c+1]).
+ * \param[in]  nchunks The number of chunks.
+ * \param[in]  nrows The number of rows.
+ * \param[in]  shape PARALLEL_UNIFORM or PARALLEL_TRIANGULAR.
+ * \retval none
+ */
+void parallel_partition(int *bounds, int nchunks, int nrows, int shape)
+{
+
+  int c, i;
+  double work, total;
+  if( shape == PARALLEL_TRIANGULAR ){
+    total = 0.5 * (double)nrows * (nrows + 1);
+    work = 0.0;
+    i = 0;
+    for(c = 0; c < nchunks; c++){
+      bounds[c] = i;
+      while( i < nrows && work + 0.5 * (i + 1) < total * (c + 1) / nchunks ){
+        work += i + 1;
+        i++;
+      }
+    }
+  } else {
+    for(c = 0; c < nchunks; c++)
+      bounds[c] = (int)((long)nrows * c / nchunks);
+  }
+  bounds[nchunks] = nrows;
+
+}
@@ -0,0 +1,162 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#include "symtrx.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Hardware performance counters (Linux perf_event_open), for the benchmarks.
+// Each event is opened on its own, so that the available ones are still counted when
+// others are not supported; in containers or with a restrictive perf_event_paranoid
+// none may be, and every value is then reported as NAN. The events count the calling
+// thread and the threads it creates after perfcount_open (user space), so they must be
+// opened before the first OpenMP parallel region for the workers to be included.
+
+static const char *perfcount_names[PERFCOUNT_NEVENTS] = {
+  "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses"
+};
+
+
+/*!
+ * Name of a counter.
+ *
+ * \param[in]  event The counter (PERFCOUNT_CYCLES, ...).
+ * \retval Its name.
+ */
+const char *perfcount_name(int event)
+{
+
+  if( event < 0 || event >= PERFCOUNT_NEVENTS )
+    return "unknown";
+  return perfcount_names[event];
+
+}
+
+
+#ifdef __linux__
+static int perfcount_open_event(unsigned int type, unsigned long long config)
+{
+
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = 1;
+  attr.inherit = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+
+}
+#endif
+
+
+/*!
+ * Open the counters of the calling thread.
+ *
+ * \param[out]  pc The counters.
+ * \retval The number of counters available (0 if none, e.g. in containers or on other systems).
+ */
+int perfcount_open(perfcount *pc)
+{
+
+  int k;
+  for(k = 0; k < PERFCOUNT_NEVENTS; k++)
+    pc->fd[k] = -1;
+  pc->navailable = 0;
+#ifdef __linux__
+  const unsigned long long l1dread = PERF_COUNT_HW_CACHE_L1D
+    | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  pc->fd[PERFCOUNT_CYCLES] = perfcount_open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+  pc->fd[PERFCOUNT_INSTRUCTIONS] = perfcount_open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+  pc->fd[PERFCOUNT_L1D_MISSES] = perfcount_open_event(PERF_TYPE_HW_CACHE, l1dread);
+  pc->fd[PERFCOUNT_LLC_MISSES] = perfcount_open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+  pc->fd[PERFCOUNT_BRANCH_MISSES] = perfcount_open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+  for(k = 0; k < PERFCOUNT_NEVENTS; k++)
+    if( pc->fd[k] >= 0 )
+      pc->navailable++;
+#endif
+  return pc->navailable;
+
+}
+
+
+/*!
+ * Reset and start the counters.
+ *
+ * \param[inout]  pc The counters.
+ * \retval none
+ */
+void perfcount_start(perfcount *pc)
+{
+
+#ifdef __linux__
+  int k;
+  for(k = 0; k < PERFCOUNT_NEVENTS; k++)
+    if( pc->fd[k] >= 0 ){
+      ioctl(pc->fd[k], PERF_EVENT_IOC_RESET, 0);
+      ioctl(pc->fd[k], PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+
+}
+
+
+/*!
+ * Stop the counters and read them.
+ *
+ * \param[inout]  pc The counters.
+ * \param[out]  values The counts since perfcount_start (PERFCOUNT_NEVENTS values, NAN if not available).
+ * \retval none
+ */
+void perfcount_stop(perfcount *pc, double *values)
+{
+
+  int k;
+  for(k = 0; k < PERFCOUNT_NEVENTS; k++)
+    values[k] = NAN;
+#ifdef __linux__
+  long long count;
+  for(k = 0; k < PERFCOUNT_NEVENTS; k++)
+    if( pc->fd[k] >= 0 ){
+      ioctl(pc->fd[k], PERF_EVENT_IOC_DISABLE, 0);
+      if( read(pc->fd[k], &count, sizeof(count)) == sizeof(count) )
+        values[k] = (double)count;
+    }
+#endif
+
+}
+
+
+/*!
+ * Close the counters.
+ *
+ * \param[inout]  pc The counters.
+ * \retval none
+ */
+void perfcount_close(perfcount *pc)
+{
+
+  int k;
+  for(k = 0; k < PERFCOUNT_NEVENTS; k++){
+#ifdef __linux__
+    if( pc->fd[k] >= 0 )
+      close(pc->fd[k]);
+#endif
+    pc->fd[k] = -1;
+  }
+  pc->navailable = 0;
+
+}
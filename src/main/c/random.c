@@ -0,0 +1,344 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#include "symtrx.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#define MAX(a,b) ((a) > (b) ? (a) : (b))
+#define MIN(a,b) ((a) > (b) ? (b) : (a))
+
+// Counter-based random numbers (Philox4x32-10, Salmon et al. 2011). The index-th number of
+// a stream is a pure function of (seed, stream, index): there is no state to share, so that
+// arrays are filled in parallel, in any order, with the same values for any number of threads.
+// Each block of the generator gives two doubles; the counter holds the block index (64 bits)
+// and the stream (64 bits), the key holds the seed.
+
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+#define PHILOX_ROUNDS 10
+#define PHILOX_LANES 8
+
+static uint64_t random_seed_current = RANDOM_SEED_DEFAULT;
+static uint64_t random_stream_current = 0;
+
+
+/*!
+ * Philox4x32-10 block function.
+ *
+ * \param[out]  out The four random words.
+ * \param[in]  ctr The counter (four words).
+ * \param[in]  key The key (two words).
+ * \retval none
+ */
+void random_philox4x32(uint32_t *out, const uint32_t *ctr, const uint32_t *key)
+{
+
+  int r;
+  uint32_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+  uint32_t k0 = key[0], k1 = key[1];
+  uint64_t p0, p1;
+  for(r = 0; r < PHILOX_ROUNDS; r++){
+    p0 = (uint64_t)PHILOX_M0 * c0;
+    p1 = (uint64_t)PHILOX_M1 * c2;
+    c0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+    c2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+    c1 = (uint32_t)p1;
+    c3 = (uint32_t)p0;
+    k0 += PHILOX_W0;
+    k1 += PHILOX_W1;
+  }
+  out[0] = c0;
+  out[1] = c1;
+  out[2] = c2;
+  out[3] = c3;
+
+}
+
+
+// 52 random bits to a double in (0,1), never 0 nor 1: the bits are the mantissa of 1 + m 2^-52,
+// from which 1 - 2^-53 is subtracted exactly, giving (2m+1) 2^-53 (vectorisable, unlike integer conversions)
+static inline double random_todouble(uint32_t lo, uint32_t hi)
+{
+
+  union { uint64_t u; double d; } bits;
+  bits.u = 0x3FF0000000000000ull | ((((uint64_t)hi << 32) | lo) >> 12);
+  return bits.d - (1.0 - 1.0 / 9007199254740992.0);
+
+}
+
+
+/*!
+ * Return one uniform random number in (0,1).
+ *
+ * \param[in]  seed The seed.
+ * \param[in]  stream The stream (independent sequences for a given seed).
+ * \param[in]  index The position in the stream.
+ * \retval The index-th number of the stream.
+ */
+double random_uniform(uint64_t seed, uint64_t stream, uint64_t index)
+{
+
+  uint32_t out[4];
+  const uint64_t block = index / 2;
+  const uint32_t ctr[4] = { (uint32_t)block, (uint32_t)(block >> 32), (uint32_t)stream, (uint32_t)(stream >> 32) };
+  const uint32_t key[2] = { (uint32_t)seed, (uint32_t)(seed >> 32) };
+  random_philox4x32(out, ctr, key);
+  return index % 2 == 0 ? random_todouble(out[0], out[1]) : random_todouble(out[2], out[3]);
+
+}
+
+
+// One Philox round on the lane held in c0..c3, with the round key (k0,k1)
+#define PHILOX_ROUND(k0, k1) do { \
+    const uint64_t p0 = (uint64_t)PHILOX_M0 * c0; \
+    const uint64_t p1 = (uint64_t)PHILOX_M1 * c2; \
+    c0 = (uint32_t)(p1 >> 32) ^ c1 ^ (k0); \
+    c2 = (uint32_t)(p0 >> 32) ^ c3 ^ (k1); \
+    c1 = (uint32_t)p1; \
+    c3 = (uint32_t)p0; \
+  } while(0)
+
+// Fill 2 * nblocks numbers from the block block0. The rounds are written out so that the loop
+// over the blocks is vectorised by the compiler (one block per lane); the body is inlined in
+// versions built for each instruction set.
+static inline __attribute__((always_inline)) void random_fill_blocks_body(double *x, uint64_t block0, long nblocks,
+  uint64_t seed, uint64_t stream)
+{
+
+  long b;
+  const uint32_t k0 = (uint32_t)seed, k1 = (uint32_t)(seed >> 32);
+  const uint32_t s0 = (uint32_t)stream, s1 = (uint32_t)(stream >> 32);
+  for(b = 0; b < nblocks; b++){
+    const uint64_t ctr = block0 + (uint64_t)b;
+    uint32_t c0 = (uint32_t)ctr, c1 = (uint32_t)(ctr >> 32), c2 = s0, c3 = s1;
+    PHILOX_ROUND(k0, k1);
+    PHILOX_ROUND(k0 + 1u * PHILOX_W0, k1 + 1u * PHILOX_W1);
+    PHILOX_ROUND(k0 + 2u * PHILOX_W0, k1 + 2u * PHILOX_W1);
+    PHILOX_ROUND(k0 + 3u * PHILOX_W0, k1 + 3u * PHILOX_W1);
+    PHILOX_ROUND(k0 + 4u * PHILOX_W0, k1 + 4u * PHILOX_W1);
+    PHILOX_ROUND(k0 + 5u * PHILOX_W0, k1 + 5u * PHILOX_W1);
+    PHILOX_ROUND(k0 + 6u * PHILOX_W0, k1 + 6u * PHILOX_W1);
+    PHILOX_ROUND(k0 + 7u * PHILOX_W0, k1 + 7u * PHILOX_W1);
+    PHILOX_ROUND(k0 + 8u * PHILOX_W0, k1 + 8u * PHILOX_W1);
+    PHILOX_ROUND(k0 + 9u * PHILOX_W0, k1 + 9u * PHILOX_W1);
+    x[2*b] = random_todouble(c0, c1);
+    x[2*b+1] = random_todouble(c2, c3);
+  }
+
+}
+
+static void random_fill_blocks_scalar(double *x, uint64_t block0, long nblocks, uint64_t seed, uint64_t stream)
+{
+  random_fill_blocks_body(x, block0, nblocks, seed, stream);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// Vectorised versions: one block per 64-bit lane, the four words of the blocks in the low halves
+// of four vectors, so that _mul_epu32 gives the full 64-bit products of a round. The high halves
+// are not cleared between rounds, since the multiplications ignore them and c1, c3 are products:
+// only c0 and c2 are masked at the end. The round keys are computed once.
+__attribute__((target("avx2")))
+static void random_fill_blocks_avx2(double *x, uint64_t block0, long nblocks, uint64_t seed, uint64_t stream)
+{
+
+  int r;
+  long b = 0;
+  const __m256i lo32 = _mm256_set1_epi64x(0xffffffffll);
+  const __m256i m0 = _mm256_set1_epi64x(PHILOX_M0), m1 = _mm256_set1_epi64x(PHILOX_M1);
+  const __m256i one = _mm256_set1_epi64x(0x3FF0000000000000ll);
+  const __m256d bias = _mm256_set1_pd(1.0 - 1.0 / 9007199254740992.0);
+  const __m256i s0 = _mm256_set1_epi64x((uint32_t)stream), s1 = _mm256_set1_epi64x((uint32_t)(stream >> 32));
+  __m256i kv0[PHILOX_ROUNDS], kv1[PHILOX_ROUNDS];
+  for(r = 0; r < PHILOX_ROUNDS; r++){
+    kv0[r] = _mm256_set1_epi64x((uint32_t)((uint32_t)seed + r * PHILOX_W0));
+    kv1[r] = _mm256_set1_epi64x((uint32_t)((uint32_t)(seed >> 32) + r * PHILOX_W1));
+  }
+  for(; b + 4 <= nblocks; b += 4){
+    const uint64_t ctr = block0 + (uint64_t)b;
+    __m256i c = _mm256_add_epi64(_mm256_set1_epi64x((long long)ctr), _mm256_set_epi64x(3, 2, 1, 0));
+    __m256i c0 = _mm256_and_si256(c, lo32), c1 = _mm256_srli_epi64(c, 32), c2 = s0, c3 = s1;
+    for(r = 0; r < PHILOX_ROUNDS; r++){
+      const __m256i p0 = _mm256_mul_epu32(m0, c0);
+      const __m256i p1 = _mm256_mul_epu32(m1, c2);
+      c0 = _mm256_xor_si256(_mm256_xor_si256(_mm256_srli_epi64(p1, 32), c1), kv0[r]);
+      c2 = _mm256_xor_si256(_mm256_xor_si256(_mm256_srli_epi64(p0, 32), c3), kv1[r]);
+      c1 = p1;
+      c3 = p0;
+    }
+    // 52 bits of (hi,lo) as the mantissa of 1 + m 2^-52, see random_todouble
+    c0 = _mm256_and_si256(c0, lo32);
+    c2 = _mm256_and_si256(c2, lo32);
+    const __m256i u0 = _mm256_or_si256(_mm256_srli_epi64(_mm256_or_si256(_mm256_slli_epi64(c1, 32), c0), 12), one);
+    const __m256i u1 = _mm256_or_si256(_mm256_srli_epi64(_mm256_or_si256(_mm256_slli_epi64(c3, 32), c2), 12), one);
+    const __m256d d0 = _mm256_sub_pd(_mm256_castsi256_pd(u0), bias);
+    const __m256d d1 = _mm256_sub_pd(_mm256_castsi256_pd(u1), bias);
+    const __m256d lo = _mm256_unpacklo_pd(d0, d1), hi = _mm256_unpackhi_pd(d0, d1);
+    _mm256_storeu_pd(x + 2*b, _mm256_permute2f128_pd(lo, hi, 0x20));
+    _mm256_storeu_pd(x + 2*b + 4, _mm256_permute2f128_pd(lo, hi, 0x31));
+  }
+  random_fill_blocks_body(x + 2*b, block0 + b, nblocks - b, seed, stream);
+
+}
+
+__attribute__((target("avx512f")))
+static void random_fill_blocks_avx512(double *x, uint64_t block0, long nblocks, uint64_t seed, uint64_t stream)
+{
+
+  int r;
+  long b = 0;
+  const __m512i lo32 = _mm512_set1_epi64(0xffffffffll);
+  const __m512i m0 = _mm512_set1_epi64(PHILOX_M0), m1 = _mm512_set1_epi64(PHILOX_M1);
+  const __m512i one = _mm512_set1_epi64(0x3FF0000000000000ll);
+  const __m512d bias = _mm512_set1_pd(1.0 - 1.0 / 9007199254740992.0);
+  const __m512i s0 = _mm512_set1_epi64((uint32_t)stream), s1 = _mm512_set1_epi64((uint32_t)(stream >> 32));
+  __m512i kv0[PHILOX_ROUNDS], kv1[PHILOX_ROUNDS];
+  for(r = 0; r < PHILOX_ROUNDS; r++){
+    kv0[r] = _mm512_set1_epi64((uint32_t)((uint32_t)seed + r * PHILOX_W0));
+    kv1[r] = _mm512_set1_epi64((uint32_t)((uint32_t)(seed >> 32) + r * PHILOX_W1));
+  }
+  const __m512i ilo = _mm512_set_epi64(11, 3, 10, 2, 9, 1, 8, 0), ihi = _mm512_set_epi64(15, 7, 14, 6, 13, 5, 12, 4);
+  for(; b + 8 <= nblocks; b += 8){
+    const uint64_t ctr = block0 + (uint64_t)b;
+    __m512i c = _mm512_add_epi64(_mm512_set1_epi64((long long)ctr), _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0));
+    __m512i c0 = _mm512_and_si512(c, lo32), c1 = _mm512_srli_epi64(c, 32), c2 = s0, c3 = s1;
+    for(r = 0; r < PHILOX_ROUNDS; r++){
+      const __m512i p0 = _mm512_mul_epu32(m0, c0);
+      const __m512i p1 = _mm512_mul_epu32(m1, c2);
+      // Three-way xor in one instruction
+      c0 = _mm512_ternarylogic_epi64(_mm512_srli_epi64(p1, 32), c1, kv0[r], 0x96);
+      c2 = _mm512_ternarylogic_epi64(_mm512_srli_epi64(p0, 32), c3, kv1[r], 0x96);
+      c1 = p1;
+      c3 = p0;
+    }
+    c0 = _mm512_and_si512(c0, lo32);
+    c2 = _mm512_and_si512(c2, lo32);
+    const __m512i u0 = _mm512_or_si512(_mm512_srli_epi64(_mm512_or_si512(_mm512_slli_epi64(c1, 32), c0), 12), one);
+    const __m512i u1 = _mm512_or_si512(_mm512_srli_epi64(_mm512_or_si512(_mm512_slli_epi64(c3, 32), c2), 12), one);
+    const __m512d d0 = _mm512_sub_pd(_mm512_castsi512_pd(u0), bias);
+    const __m512d d1 = _mm512_sub_pd(_mm512_castsi512_pd(u1), bias);
+    _mm512_storeu_pd(x + 2*b, _mm512_permutex2var_pd(d0, ilo, d1));
+    _mm512_storeu_pd(x + 2*b + 8, _mm512_permutex2var_pd(d0, ihi, d1));
+  }
+  random_fill_blocks_body(x + 2*b, block0 + b, nblocks - b, seed, stream);
+
+}
+#endif
+
+
+// Fill the numbers first..first+n-1 of a stream into x, for an even first
+static void random_fill_range(double *x, long n, uint64_t seed, uint64_t stream, uint64_t first)
+{
+
+  void (*fill)(double*, uint64_t, long, uint64_t, uint64_t) = random_fill_blocks_scalar;
+#if defined(__x86_64__) || defined(__i386__)
+  if( simd_level() >= SIMD_AVX512 )
+    fill = random_fill_blocks_avx512;
+  else if( simd_level() >= SIMD_AVX2 )
+    fill = random_fill_blocks_avx2;
+#endif
+  fill(x, first / 2, n / 2, seed, stream);
+  if( n % 2 )
+    x[n-1] = random_uniform(seed, stream, first + n - 1);
+
+}
+
+
+/*!
+ * Fill an array with uniform random numbers in (0,1): x[i] is the (offset+i)-th number of the stream.
+ * Threaded over chunks of the array, with the same result for any number of threads.
+ *
+ * \param[out]  x The array.
+ * \param[in]  n Its size.
+ * \param[in]  seed The seed.
+ * \param[in]  stream The stream.
+ * \param[in]  offset The position in the stream of the first number.
+ * \retval none
+ */
+void random_fill(double *x, long n, uint64_t seed, uint64_t stream, uint64_t offset)
+{
+
+  int c;
+  long b0, b1;
+  if( n <= 0 )
+    return;
+  // Align the start on a block of the generator
+  if( offset % 2 ){
+    x[0] = random_uniform(seed, stream, offset);
+    x++;
+    n--;
+    offset++;
+  }
+
+  // Four chunks per thread, each a whole number of groups of blocks;
+  // arrays of up to 2^16 numbers are filled by the calling thread alone
+  const long ngroups = (n + 2 * PHILOX_LANES - 1) / (2 * PHILOX_LANES);
+  const int nchunks = (int)MIN(ngroups, (long)parallel_threads() * 4);
+  #pragma omp parallel for schedule(dynamic,1) private(b0,b1) num_threads(parallel_threads()) if(nchunks > 1 && n > 65536)
+  for(c = 0; c < nchunks; c++){
+    b0 = ngroups * c / nchunks * 2 * PHILOX_LANES;
+    b1 = MIN(n, ngroups * (c+1) / nchunks * 2 * PHILOX_LANES);
+    if( b1 > b0 )
+      random_fill_range(x + b0, b1 - b0, seed, stream, offset + b0);
+  }
+
+}
+
+
+/*!
+ * Set the seed of the random matrices and vectors generated without an explicit seed
+ * (square_random, vector_random, *_full_random), and restart their streams.
+ *
+ * \param[in]  seed The seed.
+ * \retval none
+ */
+void random_set_seed(uint64_t seed)
+{
+
+  #pragma omp critical(random_stream)
+  {
+    random_seed_current = seed;
+    random_stream_current = 0;
+  }
+
+}
+
+
+/*!
+ * Return the seed of the random matrices and vectors generated without an explicit seed.
+ *
+ * \retval The seed.
+ */
+uint64_t random_seed(void)
+{
+
+  return random_seed_current;
+
+}
+
+
+/*!
+ * Reserve a new stream for a random matrix or vector generated without an explicit seed:
+ * successive calls give independent numbers, and the same ones from one run to the next.
+ *
+ * \retval The stream.
+ */
+uint64_t random_next_stream(void)
+{
+
+  uint64_t stream;
+  #pragma omp critical(random_stream)
+  stream = random_stream_current++;
+  return stream;
+
+}
@@ -0,0 +1,1823 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#include "symtrx.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86
+#include <immintrin.h>
+#endif
+
+// The kernels count in 32 bits: the public functions split longer vectors into chunks
+// (e.g. whole packed matrices of dimension above 65535), so that the loops stay 32-bit.
+#define SIMD_CHUNK (1 << 30)
+
+// Single precision kernels come in two flavours: _f computes in float (twice as many lanes
+// per vector), _fd converts the elements to double and accumulates in double (mixed precision).
+// Both read float storage, i.e. half the memory traffic of the double kernels.
+// SSE2 uses the scalar single precision kernels, except for dot2_f and dot2_fd.
+
+typedef struct {
+  int level;
+  double (*dot)(const double *x, const double *y, int n);
+  double (*dotrev)(const double *x, const double *y, int n);
+  void (*dot2)(double *res, const double *a, const double *x, const double *y, int n);
+  void (*dotfold)(double *res, const double *a, const double *b, const double *x0, const double *y0,
+    const double *x1, const double *y1, int n);
+  void (*copyrev)(double *y, const double *x, int n);
+  void (*muladd)(double *y, const double *a, const double *b, int n);
+  void (*vecmat)(double *y, const double *a, const double *x, int ldx, int nk, int n);
+  double (*dot_f)(const float *x, const float *y, int n);
+  double (*dot_fd)(const float *x, const float *y, int n);
+  double (*dotrev_f)(const float *x, const float *y, int n);
+  double (*dotrev_fd)(const float *x, const float *y, int n);
+  void (*dot2_f)(double *res, const float *a, const float *x, const float *y, int n);
+  void (*dot2_fd)(double *res, const float *a, const float *x, const float *y, int n);
+  void (*copyrev_f)(float *y, const float *x, int n);
+  void (*vecmat_f)(float *y, const float *a, const float *x, int ldx, int nk, int n);
+  void (*vecmat_fd)(double *y, const float *a, const float *x, int ldx, int nk, int n);
+  void (*dotfold_f)(double *res, const float *a, const float *b, const float *x0, const float *y0,
+    const float *x1, const float *y1, int n);
+  void (*dotfold_fd)(double *res, const float *a, const float *b, const double *x0, const double *y0,
+    const double *x1, const double *y1, int n);
+} simd_kernels;
+
+
+// ======================================== //
+// Scalar kernels
+
+static double dot_scalar(const double *x, const double *y, int n)
+{
+  int t;
+  double res = 0.0;
+  for(t = 0; t < n; t++)
+    res += x[t] * y[t];
+  return res;
+}
+
+static double dotrev_scalar(const double *x, const double *y, int n)
+{
+  int t;
+  double res = 0.0;
+  for(t = 0; t < n; t++)
+    res += x[t] * y[n-t-1];
+  return res;
+}
+
+static void dot2_scalar(double *res, const double *a, const double *x, const double *y, int n)
+{
+  int t;
+  double rx = 0.0, ry = 0.0;
+  for(t = 0; t < n; t++){
+    rx += a[t] * x[t];
+    ry += a[t] * y[t];
+  }
+  res[0] = rx;
+  res[1] = ry;
+}
+
+static void dotfold_scalar(double *res, const double *a, const double *b, const double *x0, const double *y0,
+  const double *x1, const double *y1, int n)
+{
+  int t;
+  double p, q, r0 = 0.0, r1 = 0.0, r2 = 0.0, r3 = 0.0;
+  for(t = 0; t < n; t++){
+    p = a[t] + b[t];
+    q = a[t] - b[t];
+    r0 += p * x0[t];
+    r1 += p * y0[t];
+    r2 += q * x1[t];
+    r3 += q * y1[t];
+  }
+  res[0] = r0;
+  res[1] = r1;
+  res[2] = r2;
+  res[3] = r3;
+}
+
+static void copyrev_scalar(double *y, const double *x, int n)
+{
+  int t;
+  for(t = 0; t < n; t++)
+    y[t] = x[n-t-1];
+}
+
+static void muladd_scalar(double *y, const double *a, const double *b, int n)
+{
+  int t;
+  for(t = 0; t < n; t++)
+    y[t] += a[t] * b[t];
+}
+
+static void vecmat_scalar(double *y, const double *a, const double *x, int ldx, int nk, int n)
+{
+  int j, k;
+  for(k = 0; k < nk; k++)
+    for(j = 0; j < n; j++)
+      y[j] += a[k] * x[(long)k*ldx+j];
+}
+
+static double dot_f_scalar(const float *x, const float *y, int n)
+{
+  int t;
+  float res = 0.0f;
+  for(t = 0; t < n; t++)
+    res += x[t] * y[t];
+  return res;
+}
+
+static double dot_fd_scalar(const float *x, const float *y, int n)
+{
+  int t;
+  double res = 0.0;
+  for(t = 0; t < n; t++)
+    res += (double)x[t] * y[t];
+  return res;
+}
+
+static double dotrev_f_scalar(const float *x, const float *y, int n)
+{
+  int t;
+  float res = 0.0f;
+  for(t = 0; t < n; t++)
+    res += x[t] * y[n-t-1];
+  return res;
+}
+
+static double dotrev_fd_scalar(const float *x, const float *y, int n)
+{
+  int t;
+  double res = 0.0;
+  for(t = 0; t < n; t++)
+    res += (double)x[t] * y[n-t-1];
+  return res;
+}
+
+static void dot2_f_scalar(double *res, const float *a, const float *x, const float *y, int n)
+{
+  int t;
+  float rx = 0.0f, ry = 0.0f;
+  for(t = 0; t < n; t++){
+    rx += a[t] * x[t];
+    ry += a[t] * y[t];
+  }
+  res[0] = rx;
+  res[1] = ry;
+}
+
+static void dot2_fd_scalar(double *res, const float *a, const float *x, const float *y, int n)
+{
+  int t;
+  double rx = 0.0, ry = 0.0;
+  for(t = 0; t < n; t++){
+    rx += (double)a[t] * x[t];
+    ry += (double)a[t] * y[t];
+  }
+  res[0] = rx;
+  res[1] = ry;
+}
+
+static void copyrev_f_scalar(float *y, const float *x, int n)
+{
+  int t;
+  for(t = 0; t < n; t++)
+    y[t] = x[n-t-1];
+}
+
+static void vecmat_f_scalar(float *y, const float *a, const float *x, int ldx, int nk, int n)
+{
+  int j, k;
+  for(k = 0; k < nk; k++)
+    for(j = 0; j < n; j++)
+      y[j] += a[k] * x[(long)k*ldx+j];
+}
+
+static void vecmat_fd_scalar(double *y, const float *a, const float *x, int ldx, int nk, int n)
+{
+  int j, k;
+  for(k = 0; k < nk; k++)
+    for(j = 0; j < n; j++)
+      y[j] += (double)a[k] * x[(long)k*ldx+j];
+}
+
+static void dotfold_f_scalar(double *res, const float *a, const float *b, const float *x0, const float *y0,
+  const float *x1, const float *y1, int n)
+{
+  int t;
+  float p, q, r0 = 0.0f, r1 = 0.0f, r2 = 0.0f, r3 = 0.0f;
+  for(t = 0; t < n; t++){
+    p = a[t] + b[t];
+    q = a[t] - b[t];
+    r0 += p * x0[t];
+    r1 += p * y0[t];
+    r2 += q * x1[t];
+    r3 += q * y1[t];
+  }
+  res[0] = r0;
+  res[1] = r1;
+  res[2] = r2;
+  res[3] = r3;
+}
+
+static void dotfold_fd_scalar(double *res, const float *a, const float *b, const double *x0, const double *y0,
+  const double *x1, const double *y1, int n)
+{
+  int t;
+  double p, q, r0 = 0.0, r1 = 0.0, r2 = 0.0, r3 = 0.0;
+  for(t = 0; t < n; t++){
+    p = (double)a[t] + b[t];
+    q = (double)a[t] - b[t];
+    r0 += p * x0[t];
+    r1 += p * y0[t];
+    r2 += q * x1[t];
+    r3 += q * y1[t];
+  }
+  res[0] = r0;
+  res[1] = r1;
+  res[2] = r2;
+  res[3] = r3;
+}
+
+#ifdef SIMD_X86
+
+// ======================================== //
+// SSE2 kernels
+
+__attribute__((target("sse2")))
+static double dot_sse2(const double *x, const double *y, int n)
+{
+  int t;
+  __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+  for(t = 0; t + 4 <= n; t += 4){
+    s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_loadu_pd(x+t), _mm_loadu_pd(y+t)));
+    s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_loadu_pd(x+t+2), _mm_loadu_pd(y+t+2)));
+  }
+  s0 = _mm_add_pd(s0, s1);
+  double buf[2];
+  _mm_storeu_pd(buf, s0);
+  double res = buf[0] + buf[1];
+  for(; t < n; t++)
+    res += x[t] * y[t];
+  return res;
+}
+
+__attribute__((target("sse2")))
+static double dotrev_sse2(const double *x, const double *y, int n)
+{
+  int t;
+  __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd(), v0, v1;
+  for(t = 0; t + 4 <= n; t += 4){
+    v0 = _mm_loadu_pd(y+n-t-2);
+    v1 = _mm_loadu_pd(y+n-t-4);
+    s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_loadu_pd(x+t), _mm_shuffle_pd(v0, v0, 1)));
+    s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_loadu_pd(x+t+2), _mm_shuffle_pd(v1, v1, 1)));
+  }
+  s0 = _mm_add_pd(s0, s1);
+  double buf[2];
+  _mm_storeu_pd(buf, s0);
+  double res = buf[0] + buf[1];
+  for(; t < n; t++)
+    res += x[t] * y[n-t-1];
+  return res;
+}
+
+__attribute__((target("sse2")))
+static void dot2_sse2(double *res, const double *a, const double *x, const double *y, int n)
+{
+  int t;
+  __m128d sx = _mm_setzero_pd(), sy = _mm_setzero_pd(), va;
+  for(t = 0; t + 2 <= n; t += 2){
+    va = _mm_loadu_pd(a+t);
+    sx = _mm_add_pd(sx, _mm_mul_pd(va, _mm_loadu_pd(x+t)));
+    sy = _mm_add_pd(sy, _mm_mul_pd(va, _mm_loadu_pd(y+t)));
+  }
+  double bufx[2], bufy[2];
+  _mm_storeu_pd(bufx, sx);
+  _mm_storeu_pd(bufy, sy);
+  res[0] = bufx[0] + bufx[1];
+  res[1] = bufy[0] + bufy[1];
+  for(; t < n; t++){
+    res[0] += a[t] * x[t];
+    res[1] += a[t] * y[t];
+  }
+}
+
+__attribute__((target("sse2")))
+static void dotfold_sse2(double *res, const double *a, const double *b, const double *x0, const double *y0,
+  const double *x1, const double *y1, int n)
+{
+  int t;
+  __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd(), s2 = _mm_setzero_pd(), s3 = _mm_setzero_pd(), va, vb, p, q;
+  for(t = 0; t + 2 <= n; t += 2){
+    va = _mm_loadu_pd(a+t);
+    vb = _mm_loadu_pd(b+t);
+    p = _mm_add_pd(va, vb);
+    q = _mm_sub_pd(va, vb);
+    s0 = _mm_add_pd(s0, _mm_mul_pd(p, _mm_loadu_pd(x0+t)));
+    s1 = _mm_add_pd(s1, _mm_mul_pd(p, _mm_loadu_pd(y0+t)));
+    s2 = _mm_add_pd(s2, _mm_mul_pd(q, _mm_loadu_pd(x1+t)));
+    s3 = _mm_add_pd(s3, _mm_mul_pd(q, _mm_loadu_pd(y1+t)));
+  }
+  double buf[8];
+  _mm_storeu_pd(buf, s0);
+  _mm_storeu_pd(buf+2, s1);
+  _mm_storeu_pd(buf+4, s2);
+  _mm_storeu_pd(buf+6, s3);
+  res[0] = buf[0] + buf[1];
+  res[1] = buf[2] + buf[3];
+  res[2] = buf[4] + buf[5];
+  res[3] = buf[6] + buf[7];
+  for(; t < n; t++){
+    res[0] += (a[t] + b[t]) * x0[t];
+    res[1] += (a[t] + b[t]) * y0[t];
+    res[2] += (a[t] - b[t]) * x1[t];
+    res[3] += (a[t] - b[t]) * y1[t];
+  }
+}
+
+__attribute__((target("sse2")))
+static void copyrev_sse2(double *y, const double *x, int n)
+{
+  int t;
+  __m128d v;
+  for(t = 0; t + 2 <= n; t += 2){
+    v = _mm_loadu_pd(x+n-t-2);
+    _mm_storeu_pd(y+t, _mm_shuffle_pd(v, v, 1));
+  }
+  for(; t < n; t++)
+    y[t] = x[n-t-1];
+}
+
+__attribute__((target("sse2")))
+static void muladd_sse2(double *y, const double *a, const double *b, int n)
+{
+  int t;
+  for(t = 0; t + 4 <= n; t += 4){
+    _mm_storeu_pd(y+t, _mm_add_pd(_mm_loadu_pd(y+t), _mm_mul_pd(_mm_loadu_pd(a+t), _mm_loadu_pd(b+t))));
+    _mm_storeu_pd(y+t+2, _mm_add_pd(_mm_loadu_pd(y+t+2), _mm_mul_pd(_mm_loadu_pd(a+t+2), _mm_loadu_pd(b+t+2))));
+  }
+  for(; t < n; t++)
+    y[t] += a[t] * b[t];
+}
+
+__attribute__((target("sse2")))
+static void vecmat_sse2(double *y, const double *a, const double *x, int ldx, int nk, int n)
+{
+  int j, k;
+  __m128d ak, c0, c1, c2, c3;
+  const double *xk;
+  for(j = 0; j + 8 <= n; j += 8){
+    c0 = _mm_loadu_pd(y+j);
+    c1 = _mm_loadu_pd(y+j+2);
+    c2 = _mm_loadu_pd(y+j+4);
+    c3 = _mm_loadu_pd(y+j+6);
+    for(k = 0; k < nk; k++){
+      ak = _mm_set1_pd(a[k]);
+      xk = x + (long)k*ldx + j;
+      c0 = _mm_add_pd(c0, _mm_mul_pd(ak, _mm_loadu_pd(xk)));
+      c1 = _mm_add_pd(c1, _mm_mul_pd(ak, _mm_loadu_pd(xk+2)));
+      c2 = _mm_add_pd(c2, _mm_mul_pd(ak, _mm_loadu_pd(xk+4)));
+      c3 = _mm_add_pd(c3, _mm_mul_pd(ak, _mm_loadu_pd(xk+6)));
+    }
+    _mm_storeu_pd(y+j, c0);
+    _mm_storeu_pd(y+j+2, c1);
+    _mm_storeu_pd(y+j+4, c2);
+    _mm_storeu_pd(y+j+6, c3);
+  }
+  for(; j + 2 <= n; j += 2){
+    c0 = _mm_loadu_pd(y+j);
+    for(k = 0; k < nk; k++)
+      c0 = _mm_add_pd(c0, _mm_mul_pd(_mm_set1_pd(a[k]), _mm_loadu_pd(x+(long)k*ldx+j)));
+    _mm_storeu_pd(y+j, c0);
+  }
+  for(; j < n; j++)
+    for(k = 0; k < nk; k++)
+      y[j] += a[k] * x[(long)k*ldx+j];
+}
+
+
+__attribute__((target("sse2")))
+static void dot2_f_sse2(double *res, const float *a, const float *x, const float *y, int n)
+{
+  int t;
+  __m128 sx = _mm_setzero_ps(), sy = _mm_setzero_ps(), tx = _mm_setzero_ps(), ty = _mm_setzero_ps(), va, vb;
+  // Two accumulators per sum, so that the additions are not bound by their latency
+  for(t = 0; t + 8 <= n; t += 8){
+    va = _mm_loadu_ps(a+t);
+    vb = _mm_loadu_ps(a+t+4);
+    sx = _mm_add_ps(sx, _mm_mul_ps(va, _mm_loadu_ps(x+t)));
+    sy = _mm_add_ps(sy, _mm_mul_ps(va, _mm_loadu_ps(y+t)));
+    tx = _mm_add_ps(tx, _mm_mul_ps(vb, _mm_loadu_ps(x+t+4)));
+    ty = _mm_add_ps(ty, _mm_mul_ps(vb, _mm_loadu_ps(y+t+4)));
+  }
+  float bufx[4], bufy[4];
+  _mm_storeu_ps(bufx, _mm_add_ps(sx, tx));
+  _mm_storeu_ps(bufy, _mm_add_ps(sy, ty));
+  float rx = (bufx[0] + bufx[1]) + (bufx[2] + bufx[3]);
+  float ry = (bufy[0] + bufy[1]) + (bufy[2] + bufy[3]);
+  for(; t < n; t++){
+    rx += a[t] * x[t];
+    ry += a[t] * y[t];
+  }
+  res[0] = rx;
+  res[1] = ry;
+}
+
+__attribute__((target("sse2")))
+static void dot2_fd_sse2(double *res, const float *a, const float *x, const float *y, int n)
+{
+  int t;
+  __m128d sx = _mm_setzero_pd(), sy = _mm_setzero_pd(), tx = _mm_setzero_pd(), ty = _mm_setzero_pd(), va, vb;
+  __m128 fa, fx, fy;
+  // Four floats per load, converted to double by halves: the low half goes into sx, sy
+  // and the high half into tx, ty
+  for(t = 0; t + 4 <= n; t += 4){
+    fa = _mm_loadu_ps(a+t);
+    fx = _mm_loadu_ps(x+t);
+    fy = _mm_loadu_ps(y+t);
+    va = _mm_cvtps_pd(fa);
+    vb = _mm_cvtps_pd(_mm_movehl_ps(fa, fa));
+    sx = _mm_add_pd(sx, _mm_mul_pd(va, _mm_cvtps_pd(fx)));
+    sy = _mm_add_pd(sy, _mm_mul_pd(va, _mm_cvtps_pd(fy)));
+    tx = _mm_add_pd(tx, _mm_mul_pd(vb, _mm_cvtps_pd(_mm_movehl_ps(fx, fx))));
+    ty = _mm_add_pd(ty, _mm_mul_pd(vb, _mm_cvtps_pd(_mm_movehl_ps(fy, fy))));
+  }
+  double bufx[2], bufy[2];
+  _mm_storeu_pd(bufx, _mm_add_pd(sx, tx));
+  _mm_storeu_pd(bufy, _mm_add_pd(sy, ty));
+  res[0] = bufx[0] + bufx[1];
+  res[1] = bufy[0] + bufy[1];
+  for(; t < n; t++){
+    res[0] += (double)a[t] * x[t];
+    res[1] += (double)a[t] * y[t];
+  }
+}
+
+
+// ======================================== //
+// AVX2 kernels
+
+__attribute__((target("avx2,fma")))
+static double hsum_avx2(__m256d v)
+{
+  __m128d s = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+  return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+}
+
+__attribute__((target("avx2,fma")))
+static double dot_avx2(const double *x, const double *y, int n)
+{
+  int t;
+  __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+  for(t = 0; t + 8 <= n; t += 8){
+    s0 = _mm256_fmadd_pd(_mm256_loadu_pd(x+t), _mm256_loadu_pd(y+t), s0);
+    s1 = _mm256_fmadd_pd(_mm256_loadu_pd(x+t+4), _mm256_loadu_pd(y+t+4), s1);
+  }
+  for(; t + 4 <= n; t += 4)
+    s0 = _mm256_fmadd_pd(_mm256_loadu_pd(x+t), _mm256_loadu_pd(y+t), s0);
+  double res = hsum_avx2(_mm256_add_pd(s0, s1));
+  for(; t < n; t++)
+    res += x[t] * y[t];
+  return res;
+}
+
+__attribute__((target("avx2,fma")))
+static double dotrev_avx2(const double *x, const double *y, int n)
+{
+  int t;
+  __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd(), v0, v1;
+  for(t = 0; t + 8 <= n; t += 8){
+    v0 = _mm256_permute4x64_pd(_mm256_loadu_pd(y+n-t-4), 0x1B);
+    v1 = _mm256_permute4x64_pd(_mm256_loadu_pd(y+n-t-8), 0x1B);
+    s0 = _mm256_fmadd_pd(_mm256_loadu_pd(x+t), v0, s0);
+    s1 = _mm256_fmadd_pd(_mm256_loadu_pd(x+t+4), v1, s1);
+  }
+  for(; t + 4 <= n; t += 4){
+    v0 = _mm256_permute4x64_pd(_mm256_loadu_pd(y+n-t-4), 0x1B);
+    s0 = _mm256_fmadd_pd(_mm256_loadu_pd(x+t), v0, s0);
+  }
+  double res = hsum_avx2(_mm256_add_pd(s0, s1));
+  for(; t < n; t++)
+    res += x[t] * y[n-t-1];
+  return res;
+}
+
+__attribute__((target("avx2,fma")))
+static void dot2_avx2(double *res, const double *a, const double *x, const double *y, int n)
+{
+  int t;
+  __m256d sx = _mm256_setzero_pd(), sy = _mm256_setzero_pd(), tx = _mm256_setzero_pd(), ty = _mm256_setzero_pd(), va, vb;
+  // Two accumulators per sum, so that the multiply-adds are not bound by their latency
+  for(t = 0; t + 8 <= n; t += 8){
+    va = _mm256_loadu_pd(a+t);
+    vb = _mm256_loadu_pd(a+t+4);
+    sx = _mm256_fmadd_pd(va, _mm256_loadu_pd(x+t), sx);
+    sy = _mm256_fmadd_pd(va, _mm256_loadu_pd(y+t), sy);
+    tx = _mm256_fmadd_pd(vb, _mm256_loadu_pd(x+t+4), tx);
+    ty = _mm256_fmadd_pd(vb, _mm256_loadu_pd(y+t+4), ty);
+  }
+  if( t + 4 <= n ){
+    va = _mm256_loadu_pd(a+t);
+    sx = _mm256_fmadd_pd(va, _mm256_loadu_pd(x+t), sx);
+    sy = _mm256_fmadd_pd(va, _mm256_loadu_pd(y+t), sy);
+    t += 4;
+  }
+  res[0] = hsum_avx2(_mm256_add_pd(sx, tx));
+  res[1] = hsum_avx2(_mm256_add_pd(sy, ty));
+  for(; t < n; t++){
+    res[0] += a[t] * x[t];
+    res[1] += a[t] * y[t];
+  }
+}
+
+__attribute__((target("avx2,fma")))
+static void dotfold_avx2(double *res, const double *a, const double *b, const double *x0, const double *y0,
+  const double *x1, const double *y1, int n)
+{
+  int t;
+  __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd(), s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd(), va, vb, p, q;
+  // One pass over both rows: their sum and difference are formed in registers
+  for(t = 0; t + 4 <= n; t += 4){
+    va = _mm256_loadu_pd(a+t);
+    vb = _mm256_loadu_pd(b+t);
+    p = _mm256_add_pd(va, vb);
+    q = _mm256_sub_pd(va, vb);
+    s0 = _mm256_fmadd_pd(p, _mm256_loadu_pd(x0+t), s0);
+    s1 = _mm256_fmadd_pd(p, _mm256_loadu_pd(y0+t), s1);
+    s2 = _mm256_fmadd_pd(q, _mm256_loadu_pd(x1+t), s2);
+    s3 = _mm256_fmadd_pd(q, _mm256_loadu_pd(y1+t), s3);
+  }
+  res[0] = hsum_avx2(s0);
+  res[1] = hsum_avx2(s1);
+  res[2] = hsum_avx2(s2);
+  res[3] = hsum_avx2(s3);
+  for(; t < n; t++){
+    res[0] += (a[t] + b[t]) * x0[t];
+    res[1] += (a[t] + b[t]) * y0[t];
+    res[2] += (a[t] - b[t]) * x1[t];
+    res[3] += (a[t] - b[t]) * y1[t];
+  }
+}
+
+__attribute__((target("avx2,fma")))
+static void copyrev_avx2(double *y, const double *x, int n)
+{
+  int t;
+  for(t = 0; t + 4 <= n; t += 4)
+    _mm256_storeu_pd(y+t, _mm256_permute4x64_pd(_mm256_loadu_pd(x+n-t-4), 0x1B));
+  for(; t < n; t++)
+    y[t] = x[n-t-1];
+}
+
+__attribute__((target("avx2,fma")))
+static void muladd_avx2(double *y, const double *a, const double *b, int n)
+{
+  int t;
+  for(t = 0; t + 8 <= n; t += 8){
+    _mm256_storeu_pd(y+t, _mm256_fmadd_pd(_mm256_loadu_pd(a+t), _mm256_loadu_pd(b+t), _mm256_loadu_pd(y+t)));
+    _mm256_storeu_pd(y+t+4, _mm256_fmadd_pd(_mm256_loadu_pd(a+t+4), _mm256_loadu_pd(b+t+4), _mm256_loadu_pd(y+t+4)));
+  }
+  for(; t + 4 <= n; t += 4)
+    _mm256_storeu_pd(y+t, _mm256_fmadd_pd(_mm256_loadu_pd(a+t), _mm256_loadu_pd(b+t), _mm256_loadu_pd(y+t)));
+  for(; t < n; t++)
+    y[t] += a[t] * b[t];
+}
+
+__attribute__((target("avx2,fma")))
+static void vecmat_avx2(double *y, const double *a, const double *x, int ldx, int nk, int n)
+{
+  int j, k;
+  __m256d ak, c0, c1, c2, c3;
+  const double *xk;
+  for(j = 0; j + 16 <= n; j += 16){
+    c0 = _mm256_loadu_pd(y+j);
+    c1 = _mm256_loadu_pd(y+j+4);
+    c2 = _mm256_loadu_pd(y+j+8);
+    c3 = _mm256_loadu_pd(y+j+12);
+    for(k = 0; k < nk; k++){
+      ak = _mm256_set1_pd(a[k]);
+      xk = x + (long)k*ldx + j;
+      c0 = _mm256_fmadd_pd(ak, _mm256_loadu_pd(xk), c0);
+      c1 = _mm256_fmadd_pd(ak, _mm256_loadu_pd(xk+4), c1);
+      c2 = _mm256_fmadd_pd(ak, _mm256_loadu_pd(xk+8), c2);
+      c3 = _mm256_fmadd_pd(ak, _mm256_loadu_pd(xk+12), c3);
+    }
+    _mm256_storeu_pd(y+j, c0);
+    _mm256_storeu_pd(y+j+4, c1);
+    _mm256_storeu_pd(y+j+8, c2);
+    _mm256_storeu_pd(y+j+12, c3);
+  }
+  for(; j + 4 <= n; j += 4){
+    c0 = _mm256_loadu_pd(y+j);
+    for(k = 0; k < nk; k++)
+      c0 = _mm256_fmadd_pd(_mm256_set1_pd(a[k]), _mm256_loadu_pd(x+(long)k*ldx+j), c0);
+    _mm256_storeu_pd(y+j, c0);
+  }
+  for(; j < n; j++)
+    for(k = 0; k < nk; k++)
+      y[j] += a[k] * x[(long)k*ldx+j];
+}
+
+
+__attribute__((target("avx2,fma")))
+static float hsum_ps_avx2(__m256 v)
+{
+  __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+  return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, 1)));
+}
+
+__attribute__((target("avx2,fma")))
+static double dot_f_avx2(const float *x, const float *y, int n)
+{
+  int t;
+  __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps();
+  for(t = 0; t + 16 <= n; t += 16){
+    s0 = _mm256_fmadd_ps(_mm256_loadu_ps(x+t), _mm256_loadu_ps(y+t), s0);
+    s1 = _mm256_fmadd_ps(_mm256_loadu_ps(x+t+8), _mm256_loadu_ps(y+t+8), s1);
+  }
+  for(; t + 8 <= n; t += 8)
+    s0 = _mm256_fmadd_ps(_mm256_loadu_ps(x+t), _mm256_loadu_ps(y+t), s0);
+  float res = hsum_ps_avx2(_mm256_add_ps(s0, s1));
+  for(; t < n; t++)
+    res += x[t] * y[t];
+  return res;
+}
+
+__attribute__((target("avx2,fma")))
+static double dot_fd_avx2(const float *x, const float *y, int n)
+{
+  int t;
+  __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+  for(t = 0; t + 8 <= n; t += 8){
+    s0 = _mm256_fmadd_pd(_mm256_cvtps_pd(_mm_loadu_ps(x+t)), _mm256_cvtps_pd(_mm_loadu_ps(y+t)), s0);
+    s1 = _mm256_fmadd_pd(_mm256_cvtps_pd(_mm_loadu_ps(x+t+4)), _mm256_cvtps_pd(_mm_loadu_ps(y+t+4)), s1);
+  }
+  for(; t + 4 <= n; t += 4)
+    s0 = _mm256_fmadd_pd(_mm256_cvtps_pd(_mm_loadu_ps(x+t)), _mm256_cvtps_pd(_mm_loadu_ps(y+t)), s0);
+  double res = hsum_avx2(_mm256_add_pd(s0, s1));
+  for(; t < n; t++)
+    res += (double)x[t] * y[t];
+  return res;
+}
+
+__attribute__((target("avx2,fma")))
+static double dotrev_f_avx2(const float *x, const float *y, int n)
+{
+  int t;
+  const __m256i rev = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+  __m256 s0 = _mm256_setzero_ps();
+  for(t = 0; t + 8 <= n; t += 8)
+    s0 = _mm256_fmadd_ps(_mm256_loadu_ps(x+t), _mm256_permutevar8x32_ps(_mm256_loadu_ps(y+n-t-8), rev), s0);
+  float res = hsum_ps_avx2(s0);
+  for(; t < n; t++)
+    res += x[t] * y[n-t-1];
+  return res;
+}
+
+__attribute__((target("avx2,fma")))
+static double dotrev_fd_avx2(const float *x, const float *y, int n)
+{
+  int t;
+  __m128 yv;
+  __m256d s0 = _mm256_setzero_pd();
+  for(t = 0; t + 4 <= n; t += 4){
+    yv = _mm_loadu_ps(y+n-t-4);
+    yv = _mm_shuffle_ps(yv, yv, _MM_SHUFFLE(0, 1, 2, 3));
+    s0 = _mm256_fmadd_pd(_mm256_cvtps_pd(_mm_loadu_ps(x+t)), _mm256_cvtps_pd(yv), s0);
+  }
+  double res = hsum_avx2(s0);
+  for(; t < n; t++)
+    res += (double)x[t] * y[n-t-1];
+  return res;
+}
+
+__attribute__((target("avx2,fma")))
+static void dot2_f_avx2(double *res, const float *a, const float *x, const float *y, int n)
+{
+  int t;
+  __m256 sx = _mm256_setzero_ps(), sy = _mm256_setzero_ps(), tx = _mm256_setzero_ps(), ty = _mm256_setzero_ps(), va, vb;
+  for(t = 0; t + 16 <= n; t += 16){
+    va = _mm256_loadu_ps(a+t);
+    vb = _mm256_loadu_ps(a+t+8);
+    sx = _mm256_fmadd_ps(va, _mm256_loadu_ps(x+t), sx);
+    sy = _mm256_fmadd_ps(va, _mm256_loadu_ps(y+t), sy);
+    tx = _mm256_fmadd_ps(vb, _mm256_loadu_ps(x+t+8), tx);
+    ty = _mm256_fmadd_ps(vb, _mm256_loadu_ps(y+t+8), ty);
+  }
+  if( t + 8 <= n ){
+    va = _mm256_loadu_ps(a+t);
+    sx = _mm256_fmadd_ps(va, _mm256_loadu_ps(x+t), sx);
+    sy = _mm256_fmadd_ps(va, _mm256_loadu_ps(y+t), sy);
+    t += 8;
+  }
+  float rx = hsum_ps_avx2(_mm256_add_ps(sx, tx));
+  float ry = hsum_ps_avx2(_mm256_add_ps(sy, ty));
+  for(; t < n; t++){
+    rx += a[t] * x[t];
+    ry += a[t] * y[t];
+  }
+  res[0] = rx;
+  res[1] = ry;
+}
+
+__attribute__((target("avx2,fma")))
+static void dot2_fd_avx2(double *res, const float *a, const float *x, const float *y, int n)
+{
+  int t;
+  __m256d sx = _mm256_setzero_pd(), sy = _mm256_setzero_pd(), tx = _mm256_setzero_pd(), ty = _mm256_setzero_pd(), va, vb;
+  for(t = 0; t + 8 <= n; t += 8){
+    va = _mm256_cvtps_pd(_mm_loadu_ps(a+t));
+    vb = _mm256_cvtps_pd(_mm_loadu_ps(a+t+4));
+    sx = _mm256_fmadd_pd(va, _mm256_cvtps_pd(_mm_loadu_ps(x+t)), sx);
+    sy = _mm256_fmadd_pd(va, _mm256_cvtps_pd(_mm_loadu_ps(y+t)), sy);
+    tx = _mm256_fmadd_pd(vb, _mm256_cvtps_pd(_mm_loadu_ps(x+t+4)), tx);
+    ty = _mm256_fmadd_pd(vb, _mm256_cvtps_pd(_mm_loadu_ps(y+t+4)), ty);
+  }
+  if( t + 4 <= n ){
+    va = _mm256_cvtps_pd(_mm_loadu_ps(a+t));
+    sx = _mm256_fmadd_pd(va, _mm256_cvtps_pd(_mm_loadu_ps(x+t)), sx);
+    sy = _mm256_fmadd_pd(va, _mm256_cvtps_pd(_mm_loadu_ps(y+t)), sy);
+    t += 4;
+  }
+  res[0] = hsum_avx2(_mm256_add_pd(sx, tx));
+  res[1] = hsum_avx2(_mm256_add_pd(sy, ty));
+  for(; t < n; t++){
+    res[0] += (double)a[t] * x[t];
+    res[1] += (double)a[t] * y[t];
+  }
+}
+
+__attribute__((target("avx2,fma")))
+static void copyrev_f_avx2(float *y, const float *x, int n)
+{
+  int t;
+  const __m256i rev = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+  for(t = 0; t + 8 <= n; t += 8)
+    _mm256_storeu_ps(y+t, _mm256_permutevar8x32_ps(_mm256_loadu_ps(x+n-t-8), rev));
+  for(; t < n; t++)
+    y[t] = x[n-t-1];
+}
+
+__attribute__((target("avx2,fma")))
+static void vecmat_f_avx2(float *y, const float *a, const float *x, int ldx, int nk, int n)
+{
+  int j, k;
+  __m256 ak, c0, c1, c2, c3;
+  const float *xk;
+  for(j = 0; j + 32 <= n; j += 32){
+    c0 = _mm256_loadu_ps(y+j);
+    c1 = _mm256_loadu_ps(y+j+8);
+    c2 = _mm256_loadu_ps(y+j+16);
+    c3 = _mm256_loadu_ps(y+j+24);
+    for(k = 0; k < nk; k++){
+      ak = _mm256_set1_ps(a[k]);
+      xk = x + (long)k*ldx + j;
+      c0 = _mm256_fmadd_ps(ak, _mm256_loadu_ps(xk), c0);
+      c1 = _mm256_fmadd_ps(ak, _mm256_loadu_ps(xk+8), c1);
+      c2 = _mm256_fmadd_ps(ak, _mm256_loadu_ps(xk+16), c2);
+      c3 = _mm256_fmadd_ps(ak, _mm256_loadu_ps(xk+24), c3);
+    }
+    _mm256_storeu_ps(y+j, c0);
+    _mm256_storeu_ps(y+j+8, c1);
+    _mm256_storeu_ps(y+j+16, c2);
+    _mm256_storeu_ps(y+j+24, c3);
+  }
+  for(; j + 8 <= n; j += 8){
+    c0 = _mm256_loadu_ps(y+j);
+    for(k = 0; k < nk; k++)
+      c0 = _mm256_fmadd_ps(_mm256_set1_ps(a[k]), _mm256_loadu_ps(x+(long)k*ldx+j), c0);
+    _mm256_storeu_ps(y+j, c0);
+  }
+  for(; j < n; j++)
+    for(k = 0; k < nk; k++)
+      y[j] += a[k] * x[(long)k*ldx+j];
+}
+
+__attribute__((target("avx2,fma")))
+static void vecmat_fd_avx2(double *y, const float *a, const float *x, int ldx, int nk, int n)
+{
+  int j, k;
+  __m256d ak, c0, c1, c2, c3;
+  const float *xk;
+  for(j = 0; j + 16 <= n; j += 16){
+    c0 = _mm256_loadu_pd(y+j);
+    c1 = _mm256_loadu_pd(y+j+4);
+    c2 = _mm256_loadu_pd(y+j+8);
+    c3 = _mm256_loadu_pd(y+j+12);
+    for(k = 0; k < nk; k++){
+      ak = _mm256_set1_pd(a[k]);
+      xk = x + (long)k*ldx + j;
+      c0 = _mm256_fmadd_pd(ak, _mm256_cvtps_pd(_mm_loadu_ps(xk)), c0);
+      c1 = _mm256_fmadd_pd(ak, _mm256_cvtps_pd(_mm_loadu_ps(xk+4)), c1);
+      c2 = _mm256_fmadd_pd(ak, _mm256_cvtps_pd(_mm_loadu_ps(xk+8)), c2);
+      c3 = _mm256_fmadd_pd(ak, _mm256_cvtps_pd(_mm_loadu_ps(xk+12)), c3);
+    }
+    _mm256_storeu_pd(y+j, c0);
+    _mm256_storeu_pd(y+j+4, c1);
+    _mm256_storeu_pd(y+j+8, c2);
+    _mm256_storeu_pd(y+j+12, c3);
+  }
+  for(; j + 4 <= n; j += 4){
+    c0 = _mm256_loadu_pd(y+j);
+    for(k = 0; k < nk; k++)
+      c0 = _mm256_fmadd_pd(_mm256_set1_pd(a[k]), _mm256_cvtps_pd(_mm_loadu_ps(x+(long)k*ldx+j)), c0);
+    _mm256_storeu_pd(y+j, c0);
+  }
+  for(; j < n; j++)
+    for(k = 0; k < nk; k++)
+      y[j] += (double)a[k] * x[(long)k*ldx+j];
+}
+
+__attribute__((target("avx2,fma")))
+static void dotfold_f_avx2(double *res, const float *a, const float *b, const float *x0, const float *y0,
+  const float *x1, const float *y1, int n)
+{
+  int t;
+  __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps(), s2 = _mm256_setzero_ps(), s3 = _mm256_setzero_ps(), va, vb, p, q;
+  for(t = 0; t + 8 <= n; t += 8){
+    va = _mm256_loadu_ps(a+t);
+    vb = _mm256_loadu_ps(b+t);
+    p = _mm256_add_ps(va, vb);
+    q = _mm256_sub_ps(va, vb);
+    s0 = _mm256_fmadd_ps(p, _mm256_loadu_ps(x0+t), s0);
+    s1 = _mm256_fmadd_ps(p, _mm256_loadu_ps(y0+t), s1);
+    s2 = _mm256_fmadd_ps(q, _mm256_loadu_ps(x1+t), s2);
+    s3 = _mm256_fmadd_ps(q, _mm256_loadu_ps(y1+t), s3);
+  }
+  float r0 = hsum_ps_avx2(s0), r1 = hsum_ps_avx2(s1), r2 = hsum_ps_avx2(s2), r3 = hsum_ps_avx2(s3);
+  for(; t < n; t++){
+    r0 += (a[t] + b[t]) * x0[t];
+    r1 += (a[t] + b[t]) * y0[t];
+    r2 += (a[t] - b[t]) * x1[t];
+    r3 += (a[t] - b[t]) * y1[t];
+  }
+  res[0] = r0;
+  res[1] = r1;
+  res[2] = r2;
+  res[3] = r3;
+}
+
+__attribute__((target("avx2,fma")))
+static void dotfold_fd_avx2(double *res, const float *a, const float *b, const double *x0, const double *y0,
+  const double *x1, const double *y1, int n)
+{
+  int t;
+  __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd(), s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd(), va, vb, p, q;
+  for(t = 0; t + 4 <= n; t += 4){
+    va = _mm256_cvtps_pd(_mm_loadu_ps(a+t));
+    vb = _mm256_cvtps_pd(_mm_loadu_ps(b+t));
+    p = _mm256_add_pd(va, vb);
+    q = _mm256_sub_pd(va, vb);
+    s0 = _mm256_fmadd_pd(p, _mm256_loadu_pd(x0+t), s0);
+    s1 = _mm256_fmadd_pd(p, _mm256_loadu_pd(y0+t), s1);
+    s2 = _mm256_fmadd_pd(q, _mm256_loadu_pd(x1+t), s2);
+    s3 = _mm256_fmadd_pd(q, _mm256_loadu_pd(y1+t), s3);
+  }
+  res[0] = hsum_avx2(s0);
+  res[1] = hsum_avx2(s1);
+  res[2] = hsum_avx2(s2);
+  res[3] = hsum_avx2(s3);
+  for(; t < n; t++){
+    res[0] += ((double)a[t] + b[t]) * x0[t];
+    res[1] += ((double)a[t] + b[t]) * y0[t];
+    res[2] += ((double)a[t] - b[t]) * x1[t];
+    res[3] += ((double)a[t] - b[t]) * y1[t];
+  }
+}
+
+// ======================================== //
+// AVX-512 kernels
+
+__attribute__((target("avx512f")))
+static double dot_avx512(const double *x, const double *y, int n)
+{
+  int t;
+  __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+  for(t = 0; t + 16 <= n; t += 16){
+    s0 = _mm512_fmadd_pd(_mm512_loadu_pd(x+t), _mm512_loadu_pd(y+t), s0);
+    s1 = _mm512_fmadd_pd(_mm512_loadu_pd(x+t+8), _mm512_loadu_pd(y+t+8), s1);
+  }
+  if( t + 8 <= n ){
+    s0 = _mm512_fmadd_pd(_mm512_loadu_pd(x+t), _mm512_loadu_pd(y+t), s0);
+    t += 8;
+  }
+  if( t < n ){
+    __mmask8 mask = (__mmask8)((1 << (n-t)) - 1);
+    s1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, x+t), _mm512_maskz_loadu_pd(mask, y+t), s1);
+  }
+  return _mm512_reduce_add_pd(_mm512_add_pd(s0, s1));
+}
+
+__attribute__((target("avx512f")))
+static double dotrev_avx512(const double *x, const double *y, int n)
+{
+  int t;
+  const __m512i rev = _mm512_set_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+  __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd(), v0, v1;
+  for(t = 0; t + 16 <= n; t += 16){
+    v0 = _mm512_permutexvar_pd(rev, _mm512_loadu_pd(y+n-t-8));
+    v1 = _mm512_permutexvar_pd(rev, _mm512_loadu_pd(y+n-t-16));
+    s0 = _mm512_fmadd_pd(_mm512_loadu_pd(x+t), v0, s0);
+    s1 = _mm512_fmadd_pd(_mm512_loadu_pd(x+t+8), v1, s1);
+  }
+  if( t + 8 <= n ){
+    v0 = _mm512_permutexvar_pd(rev, _mm512_loadu_pd(y+n-t-8));
+    s0 = _mm512_fmadd_pd(_mm512_loadu_pd(x+t), v0, s0);
+    t += 8;
+  }
+  double res = _mm512_reduce_add_pd(_mm512_add_pd(s0, s1));
+  for(; t < n; t++)
+    res += x[t] * y[n-t-1];
+  return res;
+}
+
+__attribute__((target("avx512f")))
+static void dot2_avx512(double *res, const double *a, const double *x, const double *y, int n)
+{
+  int t;
+  __m512d sx = _mm512_setzero_pd(), sy = _mm512_setzero_pd(), tx = _mm512_setzero_pd(), ty = _mm512_setzero_pd(), va, vb;
+  // Two accumulators per sum, so that the multiply-adds are not bound by their latency
+  for(t = 0; t + 16 <= n; t += 16){
+    va = _mm512_loadu_pd(a+t);
+    vb = _mm512_loadu_pd(a+t+8);
+    sx = _mm512_fmadd_pd(va, _mm512_loadu_pd(x+t), sx);
+    sy = _mm512_fmadd_pd(va, _mm512_loadu_pd(y+t), sy);
+    tx = _mm512_fmadd_pd(vb, _mm512_loadu_pd(x+t+8), tx);
+    ty = _mm512_fmadd_pd(vb, _mm512_loadu_pd(y+t+8), ty);
+  }
+  if( t + 8 <= n ){
+    va = _mm512_loadu_pd(a+t);
+    sx = _mm512_fmadd_pd(va, _mm512_loadu_pd(x+t), sx);
+    sy = _mm512_fmadd_pd(va, _mm512_loadu_pd(y+t), sy);
+    t += 8;
+  }
+  if( t < n ){
+    __mmask8 mask = (__mmask8)((1 << (n-t)) - 1);
+    va = _mm512_maskz_loadu_pd(mask, a+t);
+    sx = _mm512_fmadd_pd(va, _mm512_maskz_loadu_pd(mask, x+t), sx);
+    sy = _mm512_fmadd_pd(va, _mm512_maskz_loadu_pd(mask, y+t), sy);
+  }
+  res[0] = _mm512_reduce_add_pd(_mm512_add_pd(sx, tx));
+  res[1] = _mm512_reduce_add_pd(_mm512_add_pd(sy, ty));
+}
+
+__attribute__((target("avx512f")))
+static void dotfold_avx512(double *res, const double *a, const double *b, const double *x0, const double *y0,
+  const double *x1, const double *y1, int n)
+{
+  int t;
+  __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd(), s2 = _mm512_setzero_pd(), s3 = _mm512_setzero_pd(), va, vb, p, q;
+  __mmask8 mask;
+  // One pass over both rows: their sum and difference are formed in registers
+  for(t = 0; t < n; t += 8){
+    mask = n - t >= 8 ? (__mmask8)0xFF : (__mmask8)((1 << (n-t)) - 1);
+    va = _mm512_maskz_loadu_pd(mask, a+t);
+    vb = _mm512_maskz_loadu_pd(mask, b+t);
+    p = _mm512_add_pd(va, vb);
+    q = _mm512_sub_pd(va, vb);
+    s0 = _mm512_fmadd_pd(p, _mm512_maskz_loadu_pd(mask, x0+t), s0);
+    s1 = _mm512_fmadd_pd(p, _mm512_maskz_loadu_pd(mask, y0+t), s1);
+    s2 = _mm512_fmadd_pd(q, _mm512_maskz_loadu_pd(mask, x1+t), s2);
+    s3 = _mm512_fmadd_pd(q, _mm512_maskz_loadu_pd(mask, y1+t), s3);
+  }
+  res[0] = _mm512_reduce_add_pd(s0);
+  res[1] = _mm512_reduce_add_pd(s1);
+  res[2] = _mm512_reduce_add_pd(s2);
+  res[3] = _mm512_reduce_add_pd(s3);
+}
+
+__attribute__((target("avx512f")))
+static void copyrev_avx512(double *y, const double *x, int n)
+{
+  int t;
+  const __m512i rev = _mm512_set_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+  for(t = 0; t + 8 <= n; t += 8)
+    _mm512_storeu_pd(y+t, _mm512_permutexvar_pd(rev, _mm512_loadu_pd(x+n-t-8)));
+  for(; t < n; t++)
+    y[t] = x[n-t-1];
+}
+
+__attribute__((target("avx512f")))
+static void muladd_avx512(double *y, const double *a, const double *b, int n)
+{
+  int t;
+  for(t = 0; t + 8 <= n; t += 8)
+    _mm512_storeu_pd(y+t, _mm512_fmadd_pd(_mm512_loadu_pd(a+t), _mm512_loadu_pd(b+t), _mm512_loadu_pd(y+t)));
+  if( t < n ){
+    __mmask8 mask = (__mmask8)((1 << (n-t)) - 1);
+    _mm512_mask_storeu_pd(y+t, mask, _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, a+t),
+      _mm512_maskz_loadu_pd(mask, b+t), _mm512_maskz_loadu_pd(mask, y+t)));
+  }
+}
+
+__attribute__((target("avx512f")))
+static void vecmat_avx512(double *y, const double *a, const double *x, int ldx, int nk, int n)
+{
+  int j, k;
+  __m512d ak, c0, c1, c2, c3;
+  const double *xk;
+  for(j = 0; j + 32 <= n; j += 32){
+    c0 = _mm512_loadu_pd(y+j);
+    c1 = _mm512_loadu_pd(y+j+8);
+    c2 = _mm512_loadu_pd(y+j+16);
+    c3 = _mm512_loadu_pd(y+j+24);
+    for(k = 0; k < nk; k++){
+      ak = _mm512_set1_pd(a[k]);
+      xk = x + (long)k*ldx + j;
+      c0 = _mm512_fmadd_pd(ak, _mm512_loadu_pd(xk), c0);
+      c1 = _mm512_fmadd_pd(ak, _mm512_loadu_pd(xk+8), c1);
+      c2 = _mm512_fmadd_pd(ak, _mm512_loadu_pd(xk+16), c2);
+      c3 = _mm512_fmadd_pd(ak, _mm512_loadu_pd(xk+24), c3);
+    }
+    _mm512_storeu_pd(y+j, c0);
+    _mm512_storeu_pd(y+j+8, c1);
+    _mm512_storeu_pd(y+j+16, c2);
+    _mm512_storeu_pd(y+j+24, c3);
+  }
+  for(; j + 8 <= n; j += 8){
+    c0 = _mm512_loadu_pd(y+j);
+    for(k = 0; k < nk; k++)
+      c0 = _mm512_fmadd_pd(_mm512_set1_pd(a[k]), _mm512_loadu_pd(x+(long)k*ldx+j), c0);
+    _mm512_storeu_pd(y+j, c0);
+  }
+  if( j < n ){
+    __mmask8 mask = (__mmask8)((1 << (n-j)) - 1);
+    c0 = _mm512_maskz_loadu_pd(mask, y+j);
+    for(k = 0; k < nk; k++)
+      c0 = _mm512_fmadd_pd(_mm512_set1_pd(a[k]), _mm512_maskz_loadu_pd(mask, x+(long)k*ldx+j), c0);
+    _mm512_mask_storeu_pd(y+j, mask, c0);
+  }
+}
+
+
+__attribute__((target("avx512f")))
+static double dot_f_avx512(const float *x, const float *y, int n)
+{
+  int t;
+  __m512 s0 = _mm512_setzero_ps(), s1 = _mm512_setzero_ps();
+  for(t = 0; t + 32 <= n; t += 32){
+    s0 = _mm512_fmadd_ps(_mm512_loadu_ps(x+t), _mm512_loadu_ps(y+t), s0);
+    s1 = _mm512_fmadd_ps(_mm512_loadu_ps(x+t+16), _mm512_loadu_ps(y+t+16), s1);
+  }
+  for(; t + 16 <= n; t += 16)
+    s0 = _mm512_fmadd_ps(_mm512_loadu_ps(x+t), _mm512_loadu_ps(y+t), s0);
+  if( t < n ){
+    __mmask16 mask = (__mmask16)((1 << (n-t)) - 1);
+    s1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, x+t), _mm512_maskz_loadu_ps(mask, y+t), s1);
+  }
+  return _mm512_reduce_add_ps(_mm512_add_ps(s0, s1));
+}
+
+__attribute__((target("avx512f")))
+static double dot_fd_avx512(const float *x, const float *y, int n)
+{
+  int t;
+  __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+  for(t = 0; t + 16 <= n; t += 16){
+    s0 = _mm512_fmadd_pd(_mm512_cvtps_pd(_mm256_loadu_ps(x+t)), _mm512_cvtps_pd(_mm256_loadu_ps(y+t)), s0);
+    s1 = _mm512_fmadd_pd(_mm512_cvtps_pd(_mm256_loadu_ps(x+t+8)), _mm512_cvtps_pd(_mm256_loadu_ps(y+t+8)), s1);
+  }
+  for(; t + 8 <= n; t += 8)
+    s0 = _mm512_fmadd_pd(_mm512_cvtps_pd(_mm256_loadu_ps(x+t)), _mm512_cvtps_pd(_mm256_loadu_ps(y+t)), s0);
+  if( t < n ){
+    __mmask16 mask = (__mmask16)((1 << (n-t)) - 1);
+    s1 = _mm512_fmadd_pd(_mm512_cvtps_pd(_mm512_castps512_ps256(_mm512_maskz_loadu_ps(mask, x+t))),
+      _mm512_cvtps_pd(_mm512_castps512_ps256(_mm512_maskz_loadu_ps(mask, y+t))), s1);
+  }
+  return _mm512_reduce_add_pd(_mm512_add_pd(s0, s1));
+}
+
+__attribute__((target("avx512f")))
+static double dotrev_f_avx512(const float *x, const float *y, int n)
+{
+  int t;
+  const __m512i rev = _mm512_setr_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+  __m512 s0 = _mm512_setzero_ps();
+  for(t = 0; t + 16 <= n; t += 16)
+    s0 = _mm512_fmadd_ps(_mm512_loadu_ps(x+t), _mm512_permutexvar_ps(rev, _mm512_loadu_ps(y+n-t-16)), s0);
+  float res = _mm512_reduce_add_ps(s0);
+  for(; t < n; t++)
+    res += x[t] * y[n-t-1];
+  return res;
+}
+
+__attribute__((target("avx512f")))
+static double dotrev_fd_avx512(const float *x, const float *y, int n)
+{
+  int t;
+  const __m256i rev = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+  __m512d s0 = _mm512_setzero_pd();
+  for(t = 0; t + 8 <= n; t += 8)
+    s0 = _mm512_fmadd_pd(_mm512_cvtps_pd(_mm256_loadu_ps(x+t)),
+      _mm512_cvtps_pd(_mm256_permutevar8x32_ps(_mm256_loadu_ps(y+n-t-8), rev)), s0);
+  double res = _mm512_reduce_add_pd(s0);
+  for(; t < n; t++)
+    res += (double)x[t] * y[n-t-1];
+  return res;
+}
+
+__attribute__((target("avx512f")))
+static void dot2_f_avx512(double *res, const float *a, const float *x, const float *y, int n)
+{
+  int t;
+  __m512 sx = _mm512_setzero_ps(), sy = _mm512_setzero_ps(), tx = _mm512_setzero_ps(), ty = _mm512_setzero_ps(), va, vb;
+  for(t = 0; t + 32 <= n; t += 32){
+    va = _mm512_loadu_ps(a+t);
+    vb = _mm512_loadu_ps(a+t+16);
+    sx = _mm512_fmadd_ps(va, _mm512_loadu_ps(x+t), sx);
+    sy = _mm512_fmadd_ps(va, _mm512_loadu_ps(y+t), sy);
+    tx = _mm512_fmadd_ps(vb, _mm512_loadu_ps(x+t+16), tx);
+    ty = _mm512_fmadd_ps(vb, _mm512_loadu_ps(y+t+16), ty);
+  }
+  if( t + 16 <= n ){
+    va = _mm512_loadu_ps(a+t);
+    sx = _mm512_fmadd_ps(va, _mm512_loadu_ps(x+t), sx);
+    sy = _mm512_fmadd_ps(va, _mm512_loadu_ps(y+t), sy);
+    t += 16;
+  }
+  if( t < n ){
+    __mmask16 mask = (__mmask16)((1 << (n-t)) - 1);
+    va = _mm512_maskz_loadu_ps(mask, a+t);
+    tx = _mm512_fmadd_ps(va, _mm512_maskz_loadu_ps(mask, x+t), tx);
+    ty = _mm512_fmadd_ps(va, _mm512_maskz_loadu_ps(mask, y+t), ty);
+  }
+  res[0] = _mm512_reduce_add_ps(_mm512_add_ps(sx, tx));
+  res[1] = _mm512_reduce_add_ps(_mm512_add_ps(sy, ty));
+}
+
+__attribute__((target("avx512f")))
+static void dot2_fd_avx512(double *res, const float *a, const float *x, const float *y, int n)
+{
+  int t;
+  __m512d sx = _mm512_setzero_pd(), sy = _mm512_setzero_pd(), tx = _mm512_setzero_pd(), ty = _mm512_setzero_pd(), va, vb;
+  for(t = 0; t + 16 <= n; t += 16){
+    va = _mm512_cvtps_pd(_mm256_loadu_ps(a+t));
+    vb = _mm512_cvtps_pd(_mm256_loadu_ps(a+t+8));
+    sx = _mm512_fmadd_pd(va, _mm512_cvtps_pd(_mm256_loadu_ps(x+t)), sx);
+    sy = _mm512_fmadd_pd(va, _mm512_cvtps_pd(_mm256_loadu_ps(y+t)), sy);
+    tx = _mm512_fmadd_pd(vb, _mm512_cvtps_pd(_mm256_loadu_ps(x+t+8)), tx);
+    ty = _mm512_fmadd_pd(vb, _mm512_cvtps_pd(_mm256_loadu_ps(y+t+8)), ty);
+  }
+  if( t + 8 <= n ){
+    va = _mm512_cvtps_pd(_mm256_loadu_ps(a+t));
+    sx = _mm512_fmadd_pd(va, _mm512_cvtps_pd(_mm256_loadu_ps(x+t)), sx);
+    sy = _mm512_fmadd_pd(va, _mm512_cvtps_pd(_mm256_loadu_ps(y+t)), sy);
+    t += 8;
+  }
+  if( t < n ){
+    __mmask16 mask = (__mmask16)((1 << (n-t)) - 1);
+    va = _mm512_cvtps_pd(_mm512_castps512_ps256(_mm512_maskz_loadu_ps(mask, a+t)));
+    tx = _mm512_fmadd_pd(va, _mm512_cvtps_pd(_mm512_castps512_ps256(_mm512_maskz_loadu_ps(mask, x+t))), tx);
+    ty = _mm512_fmadd_pd(va, _mm512_cvtps_pd(_mm512_castps512_ps256(_mm512_maskz_loadu_ps(mask, y+t))), ty);
+  }
+  res[0] = _mm512_reduce_add_pd(_mm512_add_pd(sx, tx));
+  res[1] = _mm512_reduce_add_pd(_mm512_add_pd(sy, ty));
+}
+
+__attribute__((target("avx512f")))
+static void copyrev_f_avx512(float *y, const float *x, int n)
+{
+  int t;
+  const __m512i rev = _mm512_setr_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+  for(t = 0; t + 16 <= n; t += 16)
+    _mm512_storeu_ps(y+t, _mm512_permutexvar_ps(rev, _mm512_loadu_ps(x+n-t-16)));
+  for(; t < n; t++)
+    y[t] = x[n-t-1];
+}
+
+__attribute__((target("avx512f")))
+static void vecmat_f_avx512(float *y, const float *a, const float *x, int ldx, int nk, int n)
+{
+  int j, k;
+  __m512 ak, c0, c1, c2, c3;
+  const float *xk;
+  for(j = 0; j + 64 <= n; j += 64){
+    c0 = _mm512_loadu_ps(y+j);
+    c1 = _mm512_loadu_ps(y+j+16);
+    c2 = _mm512_loadu_ps(y+j+32);
+    c3 = _mm512_loadu_ps(y+j+48);
+    for(k = 0; k < nk; k++){
+      ak = _mm512_set1_ps(a[k]);
+      xk = x + (long)k*ldx + j;
+      c0 = _mm512_fmadd_ps(ak, _mm512_loadu_ps(xk), c0);
+      c1 = _mm512_fmadd_ps(ak, _mm512_loadu_ps(xk+16), c1);
+      c2 = _mm512_fmadd_ps(ak, _mm512_loadu_ps(xk+32), c2);
+      c3 = _mm512_fmadd_ps(ak, _mm512_loadu_ps(xk+48), c3);
+    }
+    _mm512_storeu_ps(y+j, c0);
+    _mm512_storeu_ps(y+j+16, c1);
+    _mm512_storeu_ps(y+j+32, c2);
+    _mm512_storeu_ps(y+j+48, c3);
+  }
+  for(; j + 16 <= n; j += 16){
+    c0 = _mm512_loadu_ps(y+j);
+    for(k = 0; k < nk; k++)
+      c0 = _mm512_fmadd_ps(_mm512_set1_ps(a[k]), _mm512_loadu_ps(x+(long)k*ldx+j), c0);
+    _mm512_storeu_ps(y+j, c0);
+  }
+  if( j < n ){
+    __mmask16 mask = (__mmask16)((1 << (n-j)) - 1);
+    c0 = _mm512_maskz_loadu_ps(mask, y+j);
+    for(k = 0; k < nk; k++)
+      c0 = _mm512_fmadd_ps(_mm512_set1_ps(a[k]), _mm512_maskz_loadu_ps(mask, x+(long)k*ldx+j), c0);
+    _mm512_mask_storeu_ps(y+j, mask, c0);
+  }
+}
+
+__attribute__((target("avx512f")))
+static void vecmat_fd_avx512(double *y, const float *a, const float *x, int ldx, int nk, int n)
+{
+  int j, k;
+  __m512d ak, c0, c1, c2, c3;
+  const float *xk;
+  for(j = 0; j + 32 <= n; j += 32){
+    c0 = _mm512_loadu_pd(y+j);
+    c1 = _mm512_loadu_pd(y+j+8);
+    c2 = _mm512_loadu_pd(y+j+16);
+    c3 = _mm512_loadu_pd(y+j+24);
+    for(k = 0; k < nk; k++){
+      ak = _mm512_set1_pd(a[k]);
+      xk = x + (long)k*ldx + j;
+      c0 = _mm512_fmadd_pd(ak, _mm512_cvtps_pd(_mm256_loadu_ps(xk)), c0);
+      c1 = _mm512_fmadd_pd(ak, _mm512_cvtps_pd(_mm256_loadu_ps(xk+8)), c1);
+      c2 = _mm512_fmadd_pd(ak, _mm512_cvtps_pd(_mm256_loadu_ps(xk+16)), c2);
+      c3 = _mm512_fmadd_pd(ak, _mm512_cvtps_pd(_mm256_loadu_ps(xk+24)), c3);
+    }
+    _mm512_storeu_pd(y+j, c0);
+    _mm512_storeu_pd(y+j+8, c1);
+    _mm512_storeu_pd(y+j+16, c2);
+    _mm512_storeu_pd(y+j+24, c3);
+  }
+  for(; j + 8 <= n; j += 8){
+    c0 = _mm512_loadu_pd(y+j);
+    for(k = 0; k < nk; k++)
+      c0 = _mm512_fmadd_pd(_mm512_set1_pd(a[k]), _mm512_cvtps_pd(_mm256_loadu_ps(x+(long)k*ldx+j)), c0);
+    _mm512_storeu_pd(y+j, c0);
+  }
+  if( j < n ){
+    __mmask8 mask = (__mmask8)((1 << (n-j)) - 1);
+    c0 = _mm512_maskz_loadu_pd(mask, y+j);
+    for(k = 0; k < nk; k++)
+      c0 = _mm512_fmadd_pd(_mm512_set1_pd(a[k]),
+        _mm512_cvtps_pd(_mm512_castps512_ps256(_mm512_maskz_loadu_ps((__mmask16)mask, x+(long)k*ldx+j))), c0);
+    _mm512_mask_storeu_pd(y+j, mask, c0);
+  }
+}
+
+__attribute__((target("avx512f")))
+static void dotfold_f_avx512(double *res, const float *a, const float *b, const float *x0, const float *y0,
+  const float *x1, const float *y1, int n)
+{
+  int t;
+  __m512 s0 = _mm512_setzero_ps(), s1 = _mm512_setzero_ps(), s2 = _mm512_setzero_ps(), s3 = _mm512_setzero_ps(), va, vb, p, q;
+  __mmask16 mask;
+  for(t = 0; t < n; t += 16){
+    mask = n - t >= 16 ? (__mmask16)0xFFFF : (__mmask16)((1 << (n-t)) - 1);
+    va = _mm512_maskz_loadu_ps(mask, a+t);
+    vb = _mm512_maskz_loadu_ps(mask, b+t);
+    p = _mm512_add_ps(va, vb);
+    q = _mm512_sub_ps(va, vb);
+    s0 = _mm512_fmadd_ps(p, _mm512_maskz_loadu_ps(mask, x0+t), s0);
+    s1 = _mm512_fmadd_ps(p, _mm512_maskz_loadu_ps(mask, y0+t), s1);
+    s2 = _mm512_fmadd_ps(q, _mm512_maskz_loadu_ps(mask, x1+t), s2);
+    s3 = _mm512_fmadd_ps(q, _mm512_maskz_loadu_ps(mask, y1+t), s3);
+  }
+  res[0] = _mm512_reduce_add_ps(s0);
+  res[1] = _mm512_reduce_add_ps(s1);
+  res[2] = _mm512_reduce_add_ps(s2);
+  res[3] = _mm512_reduce_add_ps(s3);
+}
+
+__attribute__((target("avx512f")))
+static void dotfold_fd_avx512(double *res, const float *a, const float *b, const double *x0, const double *y0,
+  const double *x1, const double *y1, int n)
+{
+  int t;
+  __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd(), s2 = _mm512_setzero_pd(), s3 = _mm512_setzero_pd(), va, vb, p, q;
+  __mmask8 mask;
+  for(t = 0; t < n; t += 8){
+    mask = n - t >= 8 ? (__mmask8)0xFF : (__mmask8)((1 << (n-t)) - 1);
+    va = _mm512_cvtps_pd(_mm512_castps512_ps256(_mm512_maskz_loadu_ps((__mmask16)mask, a+t)));
+    vb = _mm512_cvtps_pd(_mm512_castps512_ps256(_mm512_maskz_loadu_ps((__mmask16)mask, b+t)));
+    p = _mm512_add_pd(va, vb);
+    q = _mm512_sub_pd(va, vb);
+    s0 = _mm512_fmadd_pd(p, _mm512_maskz_loadu_pd(mask, x0+t), s0);
+    s1 = _mm512_fmadd_pd(p, _mm512_maskz_loadu_pd(mask, y0+t), s1);
+    s2 = _mm512_fmadd_pd(q, _mm512_maskz_loadu_pd(mask, x1+t), s2);
+    s3 = _mm512_fmadd_pd(q, _mm512_maskz_loadu_pd(mask, y1+t), s3);
+  }
+  res[0] = _mm512_reduce_add_pd(s0);
+  res[1] = _mm512_reduce_add_pd(s1);
+  res[2] = _mm512_reduce_add_pd(s2);
+  res[3] = _mm512_reduce_add_pd(s3);
+}
+
+#endif
+
+
+// ======================================== //
+// Dispatch
+
+static const simd_kernels kernels_scalar = { SIMD_SCALAR, dot_scalar, dotrev_scalar, dot2_scalar, dotfold_scalar, copyrev_scalar, muladd_scalar, vecmat_scalar,
+  dot_f_scalar, dot_fd_scalar, dotrev_f_scalar, dotrev_fd_scalar,
+  dot2_f_scalar, dot2_fd_scalar, copyrev_f_scalar, vecmat_f_scalar, vecmat_fd_scalar,
+  dotfold_f_scalar, dotfold_fd_scalar };
+#ifdef SIMD_X86
+static const simd_kernels kernels_sse2 = { SIMD_SSE2, dot_sse2, dotrev_sse2, dot2_sse2, dotfold_sse2, copyrev_sse2, muladd_sse2, vecmat_sse2,
+  dot_f_scalar, dot_fd_scalar, dotrev_f_scalar, dotrev_fd_scalar,
+  dot2_f_sse2, dot2_fd_sse2, copyrev_f_scalar, vecmat_f_scalar, vecmat_fd_scalar,
+  dotfold_f_scalar, dotfold_fd_scalar };
+static const simd_kernels kernels_avx2 = { SIMD_AVX2, dot_avx2, dotrev_avx2, dot2_avx2, dotfold_avx2, copyrev_avx2, muladd_avx2, vecmat_avx2,
+  dot_f_avx2, dot_fd_avx2, dotrev_f_avx2, dotrev_fd_avx2,
+  dot2_f_avx2, dot2_fd_avx2, copyrev_f_avx2, vecmat_f_avx2, vecmat_fd_avx2,
+  dotfold_f_avx2, dotfold_fd_avx2 };
+static const simd_kernels kernels_avx512 = { SIMD_AVX512, dot_avx512, dotrev_avx512, dot2_avx512, dotfold_avx512, copyrev_avx512, muladd_avx512, vecmat_avx512,
+  dot_f_avx512, dot_fd_avx512, dotrev_f_avx512, dotrev_fd_avx512,
+  dot2_f_avx512, dot2_fd_avx512, copyrev_f_avx512, vecmat_f_avx512, vecmat_fd_avx512,
+  dotfold_f_avx512, dotfold_fd_avx512 };
+#endif
+
+static simd_kernels kernels = { SIMD_SCALAR, dot_scalar, dotrev_scalar, dot2_scalar, dotfold_scalar, copyrev_scalar, muladd_scalar, vecmat_scalar,
+  dot_f_scalar, dot_fd_scalar, dotrev_f_scalar, dotrev_fd_scalar,
+  dot2_f_scalar, dot2_fd_scalar, copyrev_f_scalar, vecmat_f_scalar, vecmat_fd_scalar,
+  dotfold_f_scalar, dotfold_fd_scalar };
+
+
+/*!
+ * Return the best instruction set supported by the CPU.
+ *
+ * \retval One of SIMD_SCALAR, SIMD_SSE2, SIMD_AVX2, SIMD_AVX512.
+ */
+int simd_detect(void)
+{
+
+#ifdef SIMD_X86
+  __builtin_cpu_init();
+  if( __builtin_cpu_supports("avx512f") )
+    return SIMD_AVX512;
+  if( __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") )
+    return SIMD_AVX2;
+  if( __builtin_cpu_supports("sse2") )
+    return SIMD_SSE2;
+#endif
+  return SIMD_SCALAR;
+
+}
+
+
+/*!
+ * Select the kernels for a given instruction set.
+ *
+ * \param[in]  level One of SIMD_SCALAR, SIMD_SSE2, SIMD_AVX2, SIMD_AVX512.
+ * \retval 1 if the instruction set is supported (and selected), 0 otherwise.
+ */
+int simd_set(int level)
+{
+
+  if( level < SIMD_SCALAR || level > simd_detect() )
+    return 0;
+  switch( level ){
+#ifdef SIMD_X86
+    case SIMD_AVX512: kernels = kernels_avx512; break;
+    case SIMD_AVX2: kernels = kernels_avx2; break;
+    case SIMD_SSE2: kernels = kernels_sse2; break;
+#endif
+    default: kernels = kernels_scalar; break;
+  }
+  return 1;
+
+}
+
+
+/*!
+ * Return the instruction set currently used by the kernels.
+ *
+ * \retval One of SIMD_SCALAR, SIMD_SSE2, SIMD_AVX2, SIMD_AVX512.
+ */
+int simd_level(void)
+{
+
+  return kernels.level;
+
+}
+
+
+/*!
+ * Return the name of an instruction set.
+ *
+ * \param[in]  level One of SIMD_SCALAR, SIMD_SSE2, SIMD_AVX2, SIMD_AVX512.
+ * \retval Its name.
+ */
+const char *simd_name(int level)
+{
+
+  switch( level ){
+    case SIMD_AVX512: return "avx512";
+    case SIMD_AVX2: return "avx2";
+    case SIMD_SSE2: return "sse2";
+    default: return "scalar";
+  }
+
+}
+
+
+/*!
+ * Select the best kernels when the library is loaded.
+ */
+__attribute__((constructor))
+static void simd_init(void)
+{
+
+  simd_set(simd_detect());
+
+}
+
+
+/*!
+ * Compute the dot product of two vectors.
+ *
+ * \param[in]  x The first vector.
+ * \param[in]  y The second vector.
+ * \param[in]  n Their dimension.
+ * \retval sum_t x[t] * y[t].
+ */
+double simd_dot(const double *x, const double *y, long n)
+{
+
+  double res = 0.0;
+  for(; n > SIMD_CHUNK; n -= SIMD_CHUNK, x += SIMD_CHUNK, y += SIMD_CHUNK)
+    res += kernels.dot(x, y, SIMD_CHUNK);
+  return res + kernels.dot(x, y, (int)n);
+
+}
+
+
+/*!
+ * Compute the dot product of a vector with another one read backwards.
+ *
+ * \param[in]  x The first vector.
+ * \param[in]  y The second vector (read backwards).
+ * \param[in]  n Their dimension.
+ * \retval sum_t x[t] * y[n-t-1].
+ */
+double simd_dotrev(const double *x, const double *y, long n)
+{
+
+  double res = 0.0;
+  // The first elements of x meet the last ones of y
+  for(; n > SIMD_CHUNK; n -= SIMD_CHUNK, x += SIMD_CHUNK)
+    res += kernels.dotrev(x, y + n - SIMD_CHUNK, SIMD_CHUNK);
+  return res + kernels.dotrev(x, y, (int)n);
+
+}
+
+
+/*!
+ * Compute the dot products of one vector with two others, reading it once.
+ *
+ * \param[out]  res The two dot products.
+ * \param[in]  a The shared vector.
+ * \param[in]  x The first vector.
+ * \param[in]  y The second vector.
+ * \param[in]  n Their dimension.
+ * \retval none (res[0] = sum_t a[t] * x[t], res[1] = sum_t a[t] * y[t]).
+ */
+void simd_dot2(double *res, const double *a, const double *x, const double *y, long n)
+{
+
+  double part[2];
+  res[0] = res[1] = 0.0;
+  for(; n > SIMD_CHUNK; n -= SIMD_CHUNK, a += SIMD_CHUNK, x += SIMD_CHUNK, y += SIMD_CHUNK){
+    kernels.dot2(part, a, x, y, SIMD_CHUNK);
+    res[0] += part[0];
+    res[1] += part[1];
+  }
+  kernels.dot2(part, a, x, y, (int)n);
+  res[0] += part[0];
+  res[1] += part[1];
+
+}
+
+
+
+/*!
+ * Compute the dot products of the sum and of the difference of two vectors with two vectors each,
+ * reading them once (e.g. a pair of mirrored rows of a bisymmetric matrix).
+ *
+ * \param[out]  res The four dot products.
+ * \param[in]  a The first vector.
+ * \param[in]  b The second vector.
+ * \param[in]  x0 The first vector multiplied with a + b.
+ * \param[in]  y0 The second vector multiplied with a + b.
+ * \param[in]  x1 The first vector multiplied with a - b.
+ * \param[in]  y1 The second vector multiplied with a - b.
+ * \param[in]  n Their dimension (at most 2^30, e.g. a row).
+ * \retval none (res[0] = (a+b).x0, res[1] = (a+b).y0, res[2] = (a-b).x1, res[3] = (a-b).y1).
+ */
+void simd_dotfold(double *res, const double *a, const double *b, const double *x0, const double *y0,
+  const double *x1, const double *y1, int n)
+{
+
+  kernels.dotfold(res, a, b, x0, y0, x1, y1, n);
+
+}
+
+/*!
+ * Copy a vector in reverse order.
+ *
+ * \param[out]  y The output vector.
+ * \param[in]  x The input vector.
+ * \param[in]  n Their dimension.
+ * \retval none (y[t] = x[n-t-1]).
+ */
+void simd_copyrev(double *y, const double *x, long n)
+{
+
+  for(; n > SIMD_CHUNK; n -= SIMD_CHUNK, y += SIMD_CHUNK)
+    kernels.copyrev(y, x + n - SIMD_CHUNK, SIMD_CHUNK);
+  kernels.copyrev(y, x, (int)n);
+
+}
+
+
+/*!
+ * Accumulate the element-wise product of two vectors: y += a .* b.
+ *
+ * \param[inout]  y The output vector.
+ * \param[in]  a The first vector.
+ * \param[in]  b The second vector.
+ * \param[in]  n Their dimension.
+ * \retval none (y[t] += a[t] * b[t]).
+ */
+void simd_muladd(double *y, const double *a, const double *b, long n)
+{
+
+  for(; n > SIMD_CHUNK; n -= SIMD_CHUNK, y += SIMD_CHUNK, a += SIMD_CHUNK, b += SIMD_CHUNK)
+    kernels.muladd(y, a, b, SIMD_CHUNK);
+  kernels.muladd(y, a, b, (int)n);
+
+}
+
+
+/*!
+ * Accumulate the product of a vector and a (strided) matrix: y += a^t * x.
+ *
+ * \param[inout]  y The output vector (n elements).
+ * \param[in]  a The input vector (nk elements).
+ * \param[in]  x The matrix (nk rows of n elements, separated by ldx).
+ * \param[in]  ldx The distance between two rows of x.
+ * \param[in]  nk The number of rows of x.
+ * \param[in]  n The number of columns of x.
+ * \retval none (y[j] += sum_k a[k] * x[k*ldx+j]).
+ */
+void simd_vecmat(double *y, const double *a, const double *x, int ldx, int nk, int n)
+{
+
+  kernels.vecmat(y, a, x, ldx, nk, n);
+
+}
+
+
+/*!
+ * Compute the dot product of two single precision vectors, accumulated in single precision.
+ *
+ * \param[in]  x The first vector.
+ * \param[in]  y The second vector.
+ * \param[in]  n Their dimension.
+ * \retval sum_t x[t] * y[t].
+ */
+double simd_dot_f(const float *x, const float *y, long n)
+{
+
+  double res = 0.0;
+  for(; n > SIMD_CHUNK; n -= SIMD_CHUNK, x += SIMD_CHUNK, y += SIMD_CHUNK)
+    res += kernels.dot_f(x, y, SIMD_CHUNK);
+  return res + kernels.dot_f(x, y, (int)n);
+
+}
+
+
+/*!
+ * Compute the dot product of two single precision vectors, accumulated in double precision.
+ *
+ * \param[in]  x The first vector.
+ * \param[in]  y The second vector.
+ * \param[in]  n Their dimension.
+ * \retval sum_t x[t] * y[t].
+ */
+double simd_dot_fd(const float *x, const float *y, long n)
+{
+
+  double res = 0.0;
+  for(; n > SIMD_CHUNK; n -= SIMD_CHUNK, x += SIMD_CHUNK, y += SIMD_CHUNK)
+    res += kernels.dot_fd(x, y, SIMD_CHUNK);
+  return res + kernels.dot_fd(x, y, (int)n);
+
+}
+
+
+/*!
+ * Compute the dot product of a single precision vector with another one read backwards,
+ * accumulated in single precision.
+ *
+ * \param[in]  x The first vector.
+ * \param[in]  y The second vector (read backwards).
+ * \param[in]  n Their dimension.
+ * \retval sum_t x[t] * y[n-t-1].
+ */
+double simd_dotrev_f(const float *x, const float *y, long n)
+{
+
+  double res = 0.0;
+  for(; n > SIMD_CHUNK; n -= SIMD_CHUNK, x += SIMD_CHUNK)
+    res += kernels.dotrev_f(x, y + n - SIMD_CHUNK, SIMD_CHUNK);
+  return res + kernels.dotrev_f(x, y, (int)n);
+
+}
+
+
+/*!
+ * Compute the dot product of a single precision vector with another one read backwards,
+ * accumulated in double precision.
+ *
+ * \param[in]  x The first vector.
+ * \param[in]  y The second vector (read backwards).
+ * \param[in]  n Their dimension.
+ * \retval sum_t x[t] * y[n-t-1].
+ */
+double simd_dotrev_fd(const float *x, const float *y, long n)
+{
+
+  double res = 0.0;
+  for(; n > SIMD_CHUNK; n -= SIMD_CHUNK, x += SIMD_CHUNK)
+    res += kernels.dotrev_fd(x, y + n - SIMD_CHUNK, SIMD_CHUNK);
+  return res + kernels.dotrev_fd(x, y, (int)n);
+
+}
+
+
+/*!
+ * Compute the dot products of one single precision vector with two others (see simd_dot2),
+ * accumulated in single precision.
+ *
+ * \param[out]  res The two dot products.
+ * \param[in]  a The shared vector.
+ * \param[in]  x The first vector.
+ * \param[in]  y The second vector.
+ * \param[in]  n Their dimension.
+ * \retval none (res[0] = sum_t a[t] * x[t], res[1] = sum_t a[t] * y[t]).
+ */
+void simd_dot2_f(double *res, const float *a, const float *x, const float *y, long n)
+{
+
+  double part[2];
+  res[0] = res[1] = 0.0;
+  for(; n > SIMD_CHUNK; n -= SIMD_CHUNK, a += SIMD_CHUNK, x += SIMD_CHUNK, y += SIMD_CHUNK){
+    kernels.dot2_f(part, a, x, y, SIMD_CHUNK);
+    res[0] += part[0];
+    res[1] += part[1];
+  }
+  kernels.dot2_f(part, a, x, y, (int)n);
+  res[0] += part[0];
+  res[1] += part[1];
+
+}
+
+
+/*!
+ * Compute the dot products of one single precision vector with two others (see simd_dot2),
+ * accumulated in double precision.
+ *
+ * \param[out]  res The two dot products.
+ * \param[in]  a The shared vector.
+ * \param[in]  x The first vector.
+ * \param[in]  y The second vector.
+ * \param[in]  n Their dimension.
+ * \retval none (res[0] = sum_t a[t] * x[t], res[1] = sum_t a[t] * y[t]).
+ */
+void simd_dot2_fd(double *res, const float *a, const float *x, const float *y, long n)
+{
+
+  double part[2];
+  res[0] = res[1] = 0.0;
+  for(; n > SIMD_CHUNK; n -= SIMD_CHUNK, a += SIMD_CHUNK, x += SIMD_CHUNK, y += SIMD_CHUNK){
+    kernels.dot2_fd(part, a, x, y, SIMD_CHUNK);
+    res[0] += part[0];
+    res[1] += part[1];
+  }
+  kernels.dot2_fd(part, a, x, y, (int)n);
+  res[0] += part[0];
+  res[1] += part[1];
+
+}
+
+
+
+/*!
+ * Compute the dot products of the sum and of the difference of two single precision vectors
+ * with two vectors each (see simd_dotfold), in single precision.
+ *
+ * \param[out]  res The four dot products.
+ * \param[in]  a The first vector.
+ * \param[in]  b The second vector.
+ * \param[in]  x0 The first vector multiplied with a + b.
+ * \param[in]  y0 The second vector multiplied with a + b.
+ * \param[in]  x1 The first vector multiplied with a - b.
+ * \param[in]  y1 The second vector multiplied with a - b.
+ * \param[in]  n Their dimension (at most 2^30).
+ * \retval none (res[0] = (a+b).x0, res[1] = (a+b).y0, res[2] = (a-b).x1, res[3] = (a-b).y1).
+ */
+void simd_dotfold_f(double *res, const float *a, const float *b, const float *x0, const float *y0,
+  const float *x1, const float *y1, int n)
+{
+
+  kernels.dotfold_f(res, a, b, x0, y0, x1, y1, n);
+
+}
+
+
+/*!
+ * Compute the dot products of the sum and of the difference of two single precision vectors
+ * with two double precision vectors each (see simd_dotfold), in double precision.
+ *
+ * \param[out]  res The four dot products.
+ * \param[in]  a The first vector.
+ * \param[in]  b The second vector.
+ * \param[in]  x0 The first vector multiplied with a + b.
+ * \param[in]  y0 The second vector multiplied with a + b.
+ * \param[in]  x1 The first vector multiplied with a - b.
+ * \param[in]  y1 The second vector multiplied with a - b.
+ * \param[in]  n Their dimension (at most 2^30).
+ * \retval none (res[0] = (a+b).x0, res[1] = (a+b).y0, res[2] = (a-b).x1, res[3] = (a-b).y1).
+ */
+void simd_dotfold_fd(double *res, const float *a, const float *b, const double *x0, const double *y0,
+  const double *x1, const double *y1, int n)
+{
+
+  kernels.dotfold_fd(res, a, b, x0, y0, x1, y1, n);
+
+}
+
+/*!
+ * Copy a single precision vector in reverse order.
+ *
+ * \param[out]  y The output vector.
+ * \param[in]  x The input vector.
+ * \param[in]  n Their dimension.
+ * \retval none (y[t] = x[n-t-1]).
+ */
+void simd_copyrev_f(float *y, const float *x, long n)
+{
+
+  for(; n > SIMD_CHUNK; n -= SIMD_CHUNK, y += SIMD_CHUNK)
+    kernels.copyrev_f(y, x + n - SIMD_CHUNK, SIMD_CHUNK);
+  kernels.copyrev_f(y, x, (int)n);
+
+}
+
+
+/*!
+ * Accumulate the product of a single precision vector and a (strided) matrix, in single precision: y += a^t * x.
+ *
+ * \param[inout]  y The output vector (n elements).
+ * \param[in]  a The input vector (nk elements).
+ * \param[in]  x The matrix (nk rows of n elements, separated by ldx).
+ * \param[in]  ldx The distance between two rows of x.
+ * \param[in]  nk The number of rows of x.
+ * \param[in]  n The number of columns of x.
+ * \retval none (y[j] += sum_k a[k] * x[k*ldx+j]).
+ */
+void simd_vecmat_f(float *y, const float *a, const float *x, int ldx, int nk, int n)
+{
+
+  kernels.vecmat_f(y, a, x, ldx, nk, n);
+
+}
+
+
+/*!
+ * Accumulate the product of a single precision vector and a (strided) matrix in a double precision vector: y += a^t * x.
+ * The matrix is widened at every call: the mixed precision products, which reuse it for many vectors,
+ * widen their panels once instead, and call simd_vecmat.
+ *
+ * \param[inout]  y The output vector (n elements, double precision).
+ * \param[in]  a The input vector (nk elements).
+ * \param[in]  x The matrix (nk rows of n elements, separated by ldx).
+ * \param[in]  ldx The distance between two rows of x.
+ * \param[in]  nk The number of rows of x.
+ * \param[in]  n The number of columns of x.
+ * \retval none (y[j] += sum_k a[k] * x[k*ldx+j]).
+ */
+void simd_vecmat_fd(double *y, const float *a, const float *x, int ldx, int nk, int n)
+{
+
+  kernels.vecmat_fd(y, a, x, ldx, nk, n);
+
+}
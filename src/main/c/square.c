@@ -9,6 +9,10 @@
 #include <math.h>
 #include <time.h>
 
+#define MAX(a,b) ((a) > (b) ? (a) : (b))
+#define MIN(a,b) ((a) > (b) ? (b) : (a))
+#define ROUNDUP(n,m) (((n) + (m) - 1) / (m) * (m))
+
 /*!
  * Allocate space for square matrix.
  *
@@ -16,16 +20,32 @@
  * \param[in]  dim Its dimension.
  * \retval none
  */
- void square_alloc(double **mat, int dim)
+void square_alloc(double **mat, int dim)
+{
+
+  *mat = workspace_calloc((size_t)dim * dim);
+
+}
+
+
+/*!
+ * Take space for a square matrix from a workspace (see workspace_take).
+ *
+ * \param[out]  mat The matrix, to be given back with workspace_give.
+ * \param[in]  dim Its dimension.
+ * \param[in]  ws The workspace (may be NULL).
+ * \retval none
+ */
+void square_alloc_ws(double **mat, int dim, workspace *ws)
 {
 
-  *mat = (double*)calloc(dim * dim, sizeof(double));
+  *mat = workspace_take(ws, (size_t)dim * dim);
 
 }
 
 
 /*!
- * Create random square matrix.
+ * Create random square matrix, from the next stream of the default seed (see random_set_seed).
  *
  * \param[out]  mat The matrix.
  * \param[in]  dim Its dimension.
@@ -34,10 +54,7 @@
 void square_random(double *mat, int dim)
 {
 
-  const int seed = (int) (10000.0 * (double) clock() / (double) CLOCKS_PER_SEC);
-  int i;
-  for (i = 0; i < dim * dim; i++)
-    mat[i] = ran2_dp(seed);
+  random_fill(mat, (long)dim * dim, random_seed(), random_next_stream(), 0);
 
 }
 
@@ -59,19 +76,6 @@ void square_symmetrise(double *mat, int dim)
 }
 
 
-/*!
- * Return index for the (i,j)th elements of a square matrix.
- *
- * \param[in]  i Row index.
- * \param[in]  j Column index.
- * \param[in]  dim Matrix dimension.
- * \retval The index of the j-th element of the i-th row.
- */
-int square_ind(int i, int j, int dim){
-  return i * dim + j;
-}
-
-
 /*!
  * Print a square matrix.
  *
@@ -79,7 +83,7 @@ int square_ind(int i, int j, int dim){
  * \param[in]  dim Its dimension.
  * \retval none
  */
-void square_print(double *mat, int dim)
+void square_print(const double *mat, int dim)
 {
 
   int i, j;
@@ -93,94 +97,433 @@ void square_print(double *mat, int dim)
 }
 
 
+// Products, trace-products and quadratic forms, in double, single and mixed precision
+#define PREC_FILE "square_prec.inc"
+#include "prec.inc"
+#undef PREC_FILE
+
+
+/*!
+ * Compute the trace of a square matrix.
+ *
+ * \param[in]  mat The input matrix.
+ * \param[in]  dim Its dimensions.
+ * \retval The trace of the matrix.
+ */
+double square_trace(const double *mat, int dim)
+{
+
+  int i;
+  double res = 0.0;
+  for(i = 0; i < dim; i++){
+    res += mat[ square_ind(i,i,dim) ];
+  }
+  return res;
+
+}
+
+
 /*!
- * Compute the product of two square matrices.
+ * Compute the product of a square matrix and a dense panel of vectors (Y = A * X).
  *
- * \param[out]  outmat The resulting matrix.
- * \param[in]  mat1 The first matrix.
- * \param[in]  mat2 The second matrix.
- * \param[in]  dim Their dimensions.
+ * \param[out]  y The output panel (dim rows of nvec elements).
+ * \param[in]  mat The square matrix.
+ * \param[in]  x The input panel (dim rows of nvec elements).
+ * \param[in]  nvec The number of vectors (columns of the panels).
+ * \param[in]  dim The dimension of the matrix.
  * \retval none
  */
-void square_product(double *outmat, double *mat1, double *mat2, int dim)
+void square_matmat(double *y, const double *mat, const double *x, int nvec, int dim)
+{
+
+  int i;
+  memset(y, 0, (size_t)dim * nvec * sizeof(double));
+  for(i = 0; i < dim; i++)
+    simd_vecmat(y + (size_t)i * nvec, mat + square_ind(i,0,dim), x, nvec, dim, nvec);
+
+}
+
+
+/*!
+ * Compute the Cholesky factorisation of a symmetric positive-definite square matrix (in place).
+ * Only the lower triangle is read, and it is overwritten by L such that mat = L * L^t.
+ *
+ * \param[inout]  mat The matrix, then its Cholesky factor.
+ * \param[in]  dim Its dimension.
+ * \retval 1 if the matrix is positive definite, 0 otherwise.
+ */
+int square_cholesky(double *mat, int dim)
 {
 
-  int i, j, k;
+  int i, j;
+  double sum, *rowi, *rowj;
   for(i = 0; i < dim; i++){
-    for (j = 0; j < dim; j++){
-      outmat[ square_ind(i,j,dim) ] = 0.0;
-      for (k = 0; k < dim; k++){
-        outmat[ square_ind(i,j,dim) ] += 
-          mat1[ square_ind(i,k,dim) ] * mat2[ square_ind(k,j,dim) ];
-      }
+    rowi = mat + square_ind(i,0,dim);
+    for(j = 0; j <= i; j++){
+      rowj = mat + square_ind(j,0,dim);
+      sum = rowi[j] - simd_dot(rowi, rowj, j);
+      if( j < i )
+        rowi[j] = sum / rowj[j];
+      else if( sum > 0.0 )
+        rowi[i] = sqrt(sum);
+      else
+        return 0;
     }
+    for(j = i+1; j < dim; j++)
+      rowi[j] = 0.0;
   }
+  return 1;
 
 }
 
 
 /*!
- * Compute the trace of a square matrix.
+ * Solve L * L^t * x = b for several right-hand sides, given a Cholesky factor.
  *
- * \param[in]  mat The input matrix.
- * \param[in]  dim Its dimensions.
- * \retval The trace of the matrix.
+ * \param[out]  x The solutions (square form, dim x nrhs; can be the same as b).
+ * \param[in]  chol The Cholesky factor (see square_cholesky).
+ * \param[in]  b The right-hand sides (dim x nrhs).
+ * \param[in]  nrhs The number of right-hand sides.
+ * \param[in]  dim The dimension.
+ * \retval none
  */
-double square_trace(double *mat, int dim)
+void square_cholesky_solve(double *x, const double *chol, const double *b, int nrhs, int dim)
 {
 
-  int i;
-  double res = 0.0;
+  int i, k, r;
+  double l, *rowx, *rowk;
+  if( x != b )
+    memcpy(x, b, (size_t)dim * nrhs * sizeof(double));
+  // Forward substitution, L * y = b
   for(i = 0; i < dim; i++){
-    res += mat[ square_ind(i,i,dim) ];
+    rowx = x + (size_t)i * nrhs;
+    for(k = 0; k < i; k++){
+      l = chol[ square_ind(i,k,dim) ];
+      rowk = x + (size_t)k * nrhs;
+      for(r = 0; r < nrhs; r++)
+        rowx[r] -= l * rowk[r];
+    }
+    l = 1.0 / chol[ square_ind(i,i,dim) ];
+    for(r = 0; r < nrhs; r++)
+      rowx[r] *= l;
+  }
+  // Backward substitution, L^t * x = y
+  for(i = dim-1; i >= 0; i--){
+    rowx = x + (size_t)i * nrhs;
+    l = 1.0 / chol[ square_ind(i,i,dim) ];
+    for(r = 0; r < nrhs; r++)
+      rowx[r] *= l;
+    for(k = 0; k < i; k++){
+      l = chol[ square_ind(i,k,dim) ];
+      rowk = x + (size_t)k * nrhs;
+      for(r = 0; r < nrhs; r++)
+        rowk[r] -= l * rowx[r];
+    }
   }
-  return res;
 
 }
 
 
 /*!
- * Compute the trace of the product of two square matrices.
+ * Compute the LU factorisation of a square matrix with partial pivoting (in place).
+ * The matrix is overwritten by L (unit diagonal, not stored) and U.
  *
- * \param[in]  mat1 The first matrix.
- * \param[in]  mat2 The second matrix.
- * \param[in]  dim Their dimensions.
- * \retval The trace of mat1  *mat2.
+ * \param[inout]  mat The matrix, then its LU factors.
+ * \param[out]  piv The pivots (row i was swapped with row piv[i]).
+ * \param[in]  dim Its dimension.
+ * \retval 1 if the matrix is invertible, 0 if it is singular.
  */
-double square_traceprod(double *mat1, double *mat2, int dim)
+int square_lu(double *mat, int *piv, int dim)
 {
 
-  int i, j;
-  double res = 0;
-  for (i = 0; i < dim; i++){
-    for (j = 0; j < dim; j++){
-      res += mat1[ square_ind(i,j,dim) ] * mat2[ square_ind(j,i,dim) ];
+  int i, j, k, p;
+  double l, tmp, *rowi, *rowk;
+  for(k = 0; k < dim; k++){
+    p = k;
+    for(i = k+1; i < dim; i++)
+      if( fabs(mat[ square_ind(i,k,dim) ]) > fabs(mat[ square_ind(p,k,dim) ]) )
+        p = i;
+    piv[k] = p;
+    if( mat[ square_ind(p,k,dim) ] == 0.0 )
+      return 0;
+    rowk = mat + square_ind(k,0,dim);
+    if( p != k ){
+      rowi = mat + square_ind(p,0,dim);
+      for(j = 0; j < dim; j++){
+        tmp = rowk[j]; rowk[j] = rowi[j]; rowi[j] = tmp;
+      }
+    }
+    for(i = k+1; i < dim; i++){
+      rowi = mat + square_ind(i,0,dim);
+      l = rowi[k] / rowk[k];
+      rowi[k] = l;
+      for(j = k+1; j < dim; j++)
+        rowi[j] -= l * rowk[j];
     }
   }
-  return res;
+  return 1;
 
 }
 
 
 /*!
- * Compute the quadratic form of a square matrix and two vectors (x^t * A * y).
+ * Solve A * x = b for several right-hand sides, given the LU factors of A.
  *
- * \param[in]  x The first vector.
- * \param[in]  mat2 The square matrix.
- * \param[in]  y The second vector.
- * \param[in]  dim Their dimensions.
- * \retval The quadratic form (x^t * A * y).
+ * \param[out]  x The solutions (square form, dim x nrhs; can be the same as b).
+ * \param[in]  lu The LU factors (see square_lu).
+ * \param[in]  piv The pivots (see square_lu).
+ * \param[in]  b The right-hand sides (dim x nrhs).
+ * \param[in]  nrhs The number of right-hand sides.
+ * \param[in]  dim The dimension.
+ * \retval none
  */
-double square_quadform(double *x, double *mat, double *y, int dim)
+void square_lu_solve(double *x, const double *lu, const int *piv, const double *b, int nrhs, int dim)
 {
 
-  int i, j;
-  double res = 0.0;
+  int i, k, r;
+  double l, tmp, *rowx, *rowk;
+  if( x != b )
+    memcpy(x, b, (size_t)dim * nrhs * sizeof(double));
+  // Row swaps, then L * y = P * b
   for(i = 0; i < dim; i++){
-    for (j = 0; j < dim; j++){
-      res += x[i] * y[j] * mat[ square_ind(i,j,dim) ] ;
+    rowx = x + (size_t)i * nrhs;
+    if( piv[i] != i ){
+      rowk = x + (size_t)piv[i] * nrhs;
+      for(r = 0; r < nrhs; r++){
+        tmp = rowx[r]; rowx[r] = rowk[r]; rowk[r] = tmp;
+      }
     }
   }
-  return res;
+  for(i = 0; i < dim; i++){
+    rowx = x + (size_t)i * nrhs;
+    for(k = 0; k < i; k++){
+      l = lu[ square_ind(i,k,dim) ];
+      rowk = x + (size_t)k * nrhs;
+      for(r = 0; r < nrhs; r++)
+        rowx[r] -= l * rowk[r];
+    }
+  }
+  // U * x = y
+  for(i = dim-1; i >= 0; i--){
+    rowx = x + (size_t)i * nrhs;
+    for(k = i+1; k < dim; k++){
+      l = lu[ square_ind(i,k,dim) ];
+      rowk = x + (size_t)k * nrhs;
+      for(r = 0; r < nrhs; r++)
+        rowx[r] -= l * rowk[r];
+    }
+    l = 1.0 / lu[ square_ind(i,i,dim) ];
+    for(r = 0; r < nrhs; r++)
+      rowx[r] *= l;
+  }
 
 }
+
+
+/*!
+ * Compute the eigenvalues and eigenvectors of a symmetric square matrix (in place).
+ * Householder reduction to tridiagonal form followed by the QL algorithm
+ * with implicit shifts. Without eigenvectors, the accumulation of the
+ * transformations is skipped, which is much faster.
+ *
+ * \param[out]  eigval The eigenvalues, in increasing order.
+ * \param[inout]  mat The matrix (destroyed); if eigenvectors are wanted, row k becomes the k-th eigenvector.
+ * \param[in]  wantvec 1 to compute the eigenvectors, 0 for the eigenvalues only.
+ * \param[in]  dim Its dimension.
+ * \retval 1 if the QL iterations converged, 0 otherwise.
+ */
+int square_symeig(double *eigval, double *mat, int wantvec, int dim)
+{
+
+  int i, j, k, l, m, iter;
+  double scale, hh, h, g, f, s, r, p, dd, c, b, tmp;
+  double *d = eigval, *a = mat, *rowi, *rowj;
+  double *e = (double*)calloc(dim + 1, sizeof(double));
+  double *w = (double*)calloc(dim + 1, sizeof(double));
+
+  // Householder reduction to tridiagonal form (diagonal d, off-diagonal e)
+  for(i = dim-1; i >= 1; i--){
+    l = i - 1;
+    h = scale = 0.0;
+    rowi = a + square_ind(i,0,dim);
+    if( l > 0 ){
+      for(k = 0; k <= l; k++)
+        scale += fabs(rowi[k]);
+      if( scale == 0.0 )
+        e[i] = rowi[l];
+      else {
+        for(k = 0; k <= l; k++){
+          rowi[k] /= scale;
+          h += rowi[k] * rowi[k];
+        }
+        f = rowi[l];
+        g = ( f >= 0.0 ? -sqrt(h) : sqrt(h) );
+        e[i] = scale * g;
+        h -= f * g;
+        rowi[l] = f - g;
+        // e = A * u / h, with A stored in the lower triangle (read row by row)
+        for(j = 0; j <= l; j++)
+          e[j] = 0.0;
+        for(j = 0; j <= l; j++){
+          rowj = a + square_ind(j,0,dim);
+          if( wantvec )
+            rowj[i] = rowi[j] / h;
+          e[j] += simd_dot(rowj, rowi, j+1);
+          for(k = 0; k < j; k++)
+            e[k] += rowj[k] * rowi[j];
+        }
+        f = 0.0;
+        for(j = 0; j <= l; j++){
+          e[j] /= h;
+          f += e[j] * rowi[j];
+        }
+        hh = f / (h + h);
+        for(j = 0; j <= l; j++){
+          rowj = a + square_ind(j,0,dim);
+          f = rowi[j];
+          e[j] = g = e[j] - hh * f;
+          for(k = 0; k <= j; k++)
+            rowj[k] -= (f * e[k] + g * rowi[k]);
+        }
+      }
+    } else
+      e[i] = rowi[l];
+    d[i] = h;
+  }
+
+  // Accumulation of the transformations (the columns of mat become the basis)
+  if( dim > 0 ){
+    d[0] = 0.0;
+    e[0] = 0.0;
+  }
+  for(i = 0; i < dim; i++){
+    rowi = a + square_ind(i,0,dim);
+    if( wantvec ){
+      if( d[i] != 0.0 ){
+        // w = u^t * Q, then Q -= (Q column i) * w^t, row by row
+        for(j = 0; j < i; j++)
+          w[j] = 0.0;
+        simd_vecmat(w, rowi, a, dim, i, i);
+        for(k = 0; k < i; k++){
+          rowj = a + square_ind(k,0,dim);
+          g = rowj[i];
+          for(j = 0; j < i; j++)
+            rowj[j] -= g * w[j];
+        }
+      }
+      d[i] = rowi[i];
+      rowi[i] = 1.0;
+      for(j = 0; j < i; j++)
+        a[ square_ind(j,i,dim) ] = rowi[j] = 0.0;
+    } else
+      d[i] = rowi[i];
+  }
+
+  // Transpose, so that the rotations of the QL algorithm act on rows
+  if( wantvec )
+    for(i = 0; i < dim; i++)
+      for(j = 0; j < i; j++){
+        tmp = a[ square_ind(i,j,dim) ];
+        a[ square_ind(i,j,dim) ] = a[ square_ind(j,i,dim) ];
+        a[ square_ind(j,i,dim) ] = tmp;
+      }
+
+  // QL algorithm with implicit shifts
+  for(i = 1; i < dim; i++)
+    e[i-1] = e[i];
+  if( dim > 0 )
+    e[dim-1] = 0.0;
+  for(l = 0; l < dim; l++){
+    iter = 0;
+    do {
+      for(m = l; m < dim-1; m++){
+        dd = fabs(d[m]) + fabs(d[m+1]);
+        if( fabs(e[m]) + dd == dd ) break;
+      }
+      if( m != l ){
+        if( iter++ == 60 ){
+          free(e);
+          free(w);
+          return 0;
+        }
+        g = (d[l+1] - d[l]) / (2.0 * e[l]);
+        r = hypot(g, 1.0);
+        g = d[m] - d[l] + e[l] / (g + (g >= 0.0 ? fabs(r) : -fabs(r)));
+        s = c = 1.0;
+        p = 0.0;
+        for(i = m-1; i >= l; i--){
+          f = s * e[i];
+          b = c * e[i];
+          e[i+1] = (r = hypot(f, g));
+          if( r == 0.0 ){
+            d[i+1] -= p;
+            e[m] = 0.0;
+            break;
+          }
+          s = f / r;
+          c = g / r;
+          g = d[i+1] - p;
+          r = (d[i] - g) * s + 2.0 * c * b;
+          d[i+1] = g + (p = s * r);
+          g = c * r - b;
+          if( wantvec ){
+            rowi = a + square_ind(i,0,dim);
+            rowj = a + square_ind(i+1,0,dim);
+            for(k = 0; k < dim; k++){
+              f = rowj[k];
+              rowj[k] = s * rowi[k] + c * f;
+              rowi[k] = c * rowi[k] - s * f;
+            }
+          }
+        }
+        if( r == 0.0 && i >= l ) continue;
+        d[l] -= p;
+        e[l] = g;
+        e[m] = 0.0;
+      }
+    } while( m != l );
+  }
+
+  // Sort by increasing eigenvalue
+  for(i = 0; i < dim-1; i++){
+    k = i;
+    for(j = i+1; j < dim; j++)
+      if( d[j] < d[k] ) k = j;
+    if( k != i ){
+      tmp = d[k]; d[k] = d[i]; d[i] = tmp;
+      if( wantvec ){
+        rowi = a + square_ind(i,0,dim);
+        rowj = a + square_ind(k,0,dim);
+        for(j = 0; j < dim; j++){
+          tmp = rowi[j]; rowi[j] = rowj[j]; rowj[j] = tmp;
+        }
+      }
+    }
+  }
+
+  free(e);
+  free(w);
+  return 1;
+
+}
+
+
+// ======================================== //
+// Single precision: float storage, with float (_f) or double (_fd) accumulation (see simd.h).
+// The kernels are instantiated from square_prec.inc with the double precision ones.
+
+/*!
+ * Allocate space for square matrix in single precision (see vector_to_float to fill it).
+ *
+ * \param[out]  mat The matrix.
+ * \param[in]  dim Its dimension.
+ * \retval none
+ */
+void square_alloc_f(float **mat, int dim)
+{
+
+  *mat = workspace_calloc_f((size_t)dim * dim);
+
+}
+
+
@@ -0,0 +1,501 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#include "symtrx.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#define PRECISION 1e-12
+#define MAX(a,b) ((a) > (b) ? (a) : (b))
+#define MIN(a,b) ((a) > (b) ? (b) : (a))
+#define ROUNDUP(n,m) (((n) + (m) - 1) / (m) * (m))
+
+/*!
+ * Compute the actual size of a symmetric square matrix in compressed form.
+ *
+ * \param[in]  dim The dimensions.
+ * \retval Its size in memory.
+ */
+long symmat_size(int dim)
+{
+
+  return (long)dim * (dim+1) / 2;
+
+}
+
+
+/*!
+ * Allocate space for symmetric square matrix (compressed form, lower triangle).
+ *
+ * \param[out]  mat The matrix.
+ * \param[in]  dim Its dimension.
+ * \retval none
+ */
+void symmat_alloc(double **mat, int dim)
+{
+
+  *mat = workspace_calloc(symmat_size(dim));
+
+}
+
+
+/*!
+ * Take space for a symmetric square matrix (compressed form) from a workspace (see workspace_take).
+ *
+ * \param[out]  mat The matrix, to be given back with workspace_give.
+ * \param[in]  dim Its dimension.
+ * \param[in]  ws The workspace (may be NULL).
+ * \retval none
+ */
+void symmat_alloc_ws(double **mat, int dim, workspace *ws)
+{
+
+  *mat = workspace_take(ws, symmat_size(dim));
+
+}
+
+
+/*!
+ * Create random symmetric square matrix (compressed form), written directly in packed storage.
+ * Same result for any number of threads.
+ *
+ * \param[out]  mat The matrix in compressed form.
+ * \param[in]  dim Its dimension.
+ * \param[in]  seed The seed.
+ * \param[in]  stream The stream (see random_fill).
+ * \retval none
+ */
+void symmat_random(double *mat, int dim, uint64_t seed, uint64_t stream)
+{
+
+  random_fill(mat, symmat_size(dim), seed, stream, 0);
+
+}
+
+
+/*!
+ * Create random symmetric square matrix (full form, full square matrix),
+ * from the next stream of the default seed (see random_set_seed).
+ *
+ * \param[out]  mat The matrix.
+ * \param[in]  dim Its dimension.
+ * \retval none
+ */
+void symmat_full_random(double *mat, int dim)
+{
+
+  double *matcomp;
+  symmat_alloc(&matcomp, dim);
+  symmat_random(matcomp, dim, random_seed(), random_next_stream());
+  symmat_comp_expandfull(mat, matcomp, dim);
+  free(matcomp);
+
+}
+
+
+/*!
+ * Extract the compressed form of a symmetric matrix from its square form.
+ *
+ * \param[out]  matcomp The matrix in compressed form (lower triangle).
+ * \param[in]  matfull The matrix in full form (square matrix).
+ * \param[in]  dim Its dimension.
+ * \retval none
+ */
+void symmat_full_extractcomp(double *matcomp, const double *matfull, int dim)
+{
+
+  int i;
+  double *row = matcomp;
+  for(i = 0; i < dim; i++){
+    memcpy(row, matfull + square_ind(i,0,dim), (i + 1) * sizeof(double));
+    row += i + 1;
+  }
+
+}
+
+
+/*!
+ * Expand the full form of a symmetric matrix from its compressed form.
+ *
+ * \param[out]  matfull The matrix in full form (square matrix).
+ * \param[in]  matcomp The matrix in compressed form (lower triangle).
+ * \param[in]  dim Its dimension.
+ * \retval none
+ */
+void symmat_comp_expandfull(double *matfull, const double *matcomp, int dim)
+{
+
+  int i;
+  for(i = 0; i < dim; i++)
+    symmat_getrow(matfull + square_ind(i,0,dim), matcomp, i, 0, dim, dim);
+
+}
+
+
+/*!
+ * Assert equality of two symmetric matrices in compressed form.
+ *
+ * \param[in]  matcomp1 The first matrix.
+ * \param[in]  matcomp2 The secont matrix.
+ * \param[in]  dim Their dimensions.
+ * \retval 1 if they are equal.
+ */
+int symmat_assertequal(const double *matcomp1, const double *matcomp2, int dim)
+{
+
+  long t;
+  const long size = symmat_size(dim);
+  for(t = 0; t < size; t++)
+    if( fabs(matcomp1[t] - matcomp2[t]) > PRECISION )
+      return 0;
+  return 1;
+
+}
+
+
+/*!
+ * Print a symmetric square matrix in compressed form.
+ *
+ * \param[in]  mat The matrix.
+ * \param[in]  dim Its dimension.
+ * \retval none
+ */
+void symmat_print(const double *mat, int dim)
+{
+  int i, j;
+  for(i = 0; i < dim; i++){
+    for(j = 0; j <= i; j++){
+      printf(" %2.1f ", mat[ symmat_ind(i,j,dim) ]);
+    }
+    printf("\n");
+  }
+}
+
+
+/*!
+ * Extract the elements j0..j1 of the i-th row of a symmetric matrix in compressed form.
+ * The elements up to the diagonal are contiguous; the others are read down
+ * the i-th column of the compressed form, by stepping a cursor over the rows.
+ *
+ * \param[out]  row The elements (j1-j0 elements).
+ * \param[in]  mat The matrix in compressed form.
+ * \param[in]  i Row index.
+ * \param[in]  j0 First column.
+ * \param[in]  j1 Last column (excluded).
+ * \param[in]  dim Its dimension.
+ * \retval none
+ */
+void symmat_getrow(double *row, const double *mat, int i, int j0, int j1, int dim)
+{
+
+  int j;
+  long t;
+  const double *rowlo = mat + symmat_ind(i,0,dim);
+  for(j = j0; j < MIN(j1, i+1); j++)
+    row[j-j0] = rowlo[j];
+  j = MAX(j0, i+1);
+  if( j < j1 ){
+    t = symmat_ind(j,i,dim);
+    for(; j < j1; j++){
+      row[j-j0] = mat[t];
+      t += j + 1;
+    }
+  }
+
+}
+
+
+/*!
+ * Compute rows r0..r1 of the product of two symmetric square matrices in compressed form.
+ * Blocked: panels of rows of the second matrix and tiles of the first one
+ * are unpacked in dense form (see tiling_size), so that the inner loop is
+ * contiguous and vectorised (see simd_vecmat).
+ *
+ * \param[out]  outmat The resulting matrix (full form).
+ * \param[in]  mat1 The first matrix.
+ * \param[in]  mat2 The second matrix.
+ * \param[in]  r0 First row.
+ * \param[in]  r1 Last row (excluded).
+ * \param[in]  dim Their dimensions.
+ * \param[in]  panel Scratch space for the panel (tile * dim elements).
+ * \param[in]  tile1 Scratch space for the tile (tile * tile elements).
+ * \retval none
+ */
+static void symmat_product_rows(double *outmat, const double *mat1, const double *mat2, int r0, int r1, int dim, double *panel, double *tile1)
+{
+
+  int i, k, i0, k0, i1, k1;
+  const int tile = tiling_size();
+
+  memset(outmat + square_ind(r0,0,dim), 0, (size_t)(r1 - r0) * dim * sizeof(double));
+
+  for(k0 = 0; k0 < dim; k0 += tile){
+    k1 = MIN(k0 + tile, dim);
+
+    // Rows k0..k1 of the second matrix, in dense form
+    for(k = k0; k < k1; k++)
+      symmat_getrow(panel + square_ind(k-k0,0,dim), mat2, k, 0, dim, dim);
+
+    for(i0 = r0; i0 < r1; i0 += tile){
+      i1 = MIN(i0 + tile, r1);
+
+      // Tile (i0..i1, k0..k1) of the first matrix, in dense form
+      for(i = i0; i < i1; i++)
+        symmat_getrow(tile1 + square_ind(i-i0,0,tile), mat1, i, k0, k1, dim);
+
+      for(i = i0; i < i1; i++)
+        simd_vecmat(outmat + square_ind(i,0,dim), tile1 + square_ind(i-i0,0,tile),
+          panel, dim, k1 - k0, dim);
+    }
+  }
+
+}
+
+
+/*!
+ * Compute the product of two symmetric square matrices in compressed form.
+ * The product is not symmetric in general: it is written in full form.
+ * Threaded over chunks of rows (see parallel_partition).
+ *
+ * \param[out]  outmat The resulting matrix (full form, square matrix).
+ * \param[in]  mat1 The first matrix.
+ * \param[in]  mat2 The second matrix.
+ * \param[in]  dim Their dimensions.
+ * \retval none
+ */
+void symmat_product(double *outmat, const double *mat1, const double *mat2, int dim)
+{
+
+  symmat_product_ws(outmat, mat1, mat2, dim, NULL);
+
+}
+
+
+/*!
+ * Same as symmat_product, with the scratch space taken from a workspace: a panel and a tile
+ * for each thread (tile * (dim + tile) doubles, see tiling_size), and the chunk boundaries of the threads.
+ *
+ * \param[out]  outmat The resulting matrix (full form, square matrix).
+ * \param[in]  mat1 The first matrix.
+ * \param[in]  mat2 The second matrix.
+ * \param[in]  dim Their dimensions.
+ * \param[in]  ws The workspace (may be NULL).
+ * \retval none
+ */
+void symmat_product_ws(double *outmat, const double *mat1, const double *mat2, int dim, workspace *ws)
+{
+
+  int c;
+  const int tile = tiling_size(), nthreads = parallel_threads();
+  const int nchunks = parallel_nchunks(dim, tile);
+  int *bounds = (int*)workspace_take_bytes(ws, (nchunks + 1) * sizeof(int));
+  parallel_partition(bounds, nchunks, dim, PARALLEL_UNIFORM);
+  // Scratch space of each thread, rounded up to the alignment
+  const size_t nscratch = ROUNDUP((size_t)tile * (dim + tile), WORKSPACE_ALIGN / sizeof(double));
+  double *scratch = workspace_take(ws, nthreads * nscratch);
+
+  #pragma omp parallel for schedule(dynamic,1) num_threads(nthreads)
+  for(c = 0; c < nchunks; c++){
+    double *panel = scratch + parallel_thread_num() * nscratch;
+    symmat_product_rows(outmat, mat1, mat2, bounds[c], bounds[c+1], dim, panel, panel + (size_t)tile * dim);
+  }
+
+  workspace_give(ws, scratch);
+  workspace_give_bytes(ws, bounds);
+
+}
+
+
+/*!
+ * Compute the product of a symmetric matrix in compressed form and a vector (y = A * x).
+ * Each stored row is used twice: as a row (dot product with x) and as a column
+ * (accumulated into y, scaled by x[i]), so every element is loaded once.
+ *
+ * \param[out]  y The output vector.
+ * \param[in]  mat The matrix in compressed form.
+ * \param[in]  x The input vector.
+ * \param[in]  dim Their dimensions.
+ * \retval none
+ */
+void symmat_matvec(double *y, const double *mat, const double *x, int dim)
+{
+
+  int i;
+  const double *row = mat;
+  memset(y, 0, dim * sizeof(double));
+  for(i = 0; i < dim; i++){
+    simd_vecmat(y, x + i, row, 0, 1, i);
+    y[i] += simd_dot(row, x, i+1);
+    row += i + 1;
+  }
+
+}
+
+
+/*!
+ * Compute the rows r0..r1 of the product of a symmetric matrix and a dense panel, for the columns j0..j1.
+ * row is scratch space (dim elements).
+ */
+static void symmat_matmat_rows(double *y, const double *mat, const double *x, int nvec, int r0, int r1, int j0, int j1, int dim, double *row)
+{
+
+  int i;
+  for(i = r0; i < r1; i++){
+    symmat_getrow(row, mat, i, 0, dim, dim);
+    memset(y + (size_t)i * nvec + j0, 0, (j1 - j0) * sizeof(double));
+    simd_vecmat(y + (size_t)i * nvec + j0, row, x + j0, nvec, dim, j1 - j0);
+  }
+
+}
+
+
+/*!
+ * Compute the product of a symmetric matrix in compressed form and a dense panel of vectors (Y = A * X).
+ * Each row of the matrix is unpacked once per block of columns of the panel, which are
+ * small enough to stay in cache across the rows. Threaded over chunks of rows.
+ *
+ * \param[out]  y The output panel (dim rows of nvec elements).
+ * \param[in]  mat The matrix in compressed form.
+ * \param[in]  x The input panel (dim rows of nvec elements).
+ * \param[in]  nvec The number of vectors (columns of the panels).
+ * \param[in]  dim The dimension of the matrix.
+ * \retval none
+ */
+void symmat_matmat(double *y, const double *mat, const double *x, int nvec, int dim)
+{
+
+  symmat_matmat_ws(y, mat, x, nvec, dim, NULL);
+
+}
+
+
+/*!
+ * Same as symmat_matmat, with the scratch space taken from a workspace: a row for each thread
+ * (dim doubles), and the chunk boundaries of the threads.
+ *
+ * \param[out]  y The output panel (dim rows of nvec elements).
+ * \param[in]  mat The matrix in compressed form.
+ * \param[in]  x The input panel (dim rows of nvec elements).
+ * \param[in]  nvec The number of vectors (columns of the panels).
+ * \param[in]  dim The dimension of the matrix.
+ * \param[in]  ws The workspace (may be NULL).
+ * \retval none
+ */
+void symmat_matmat_ws(double *y, const double *mat, const double *x, int nvec, int dim, workspace *ws)
+{
+
+  int c, j0;
+  const int nb = MAX(8, tiling_size()), nthreads = parallel_threads();
+  const int nchunks = parallel_nchunks(dim, tiling_size());
+  int *bounds = (int*)workspace_take_bytes(ws, (nchunks + 1) * sizeof(int));
+  parallel_partition(bounds, nchunks, dim, PARALLEL_UNIFORM);
+  const size_t nrow = ROUNDUP((size_t)dim, WORKSPACE_ALIGN / sizeof(double));
+  double *rows = workspace_take(ws, nthreads * nrow);
+
+  for(j0 = 0; j0 < nvec; j0 += nb){
+    #pragma omp parallel for schedule(dynamic,1) num_threads(nthreads)
+    for(c = 0; c < nchunks; c++)
+      symmat_matmat_rows(y, mat, x, nvec, bounds[c], bounds[c+1], j0, MIN(j0 + nb, nvec), dim, rows + parallel_thread_num() * nrow);
+  }
+
+  workspace_give(ws, rows);
+  workspace_give_bytes(ws, bounds);
+
+}
+
+
+/*!
+ * Check that a square matrix is symmetric.
+ *
+ * \param[in]  mat The matrix in full form (square matrix).
+ * \param[in]  dim Its dimension.
+ * \retval 1 if the matrix is symmetric.
+ */
+int symmat_isvalid(const double *mat, int dim)
+{
+
+  int i, j;
+  for(i = 0; i < dim; i++)
+    for(j = 0; j < i; j++)
+      if( fabs(mat[ square_ind(i,j,dim) ] - mat[ square_ind(j,i,dim) ]) > PRECISION )
+        return 0;
+  return 1;
+
+}
+
+
+/*!
+ * Compute the trace of a symmetric square matrix in compressed form.
+ *
+ * \param[in]  mat The input matrix.
+ * \param[in]  dim Its dimensions.
+ * \retval The trace of the matrix.
+ */
+double symmat_trace(const double *mat, int dim)
+{
+
+  int i;
+  long diag = 0;
+  double res = 0.0;
+  for(i = 0; i < dim; i++){
+    res += mat[diag];
+    diag += i + 2;
+  }
+  return res;
+
+}
+
+
+/*!
+ * Compute the trace of the product of two symmetric square matrices in compressed form.
+ * Since B is symmetric, Tr(AB) = sum_ij A(i,j) B(i,j): one dot product over the whole storage,
+ * counted twice, minus the diagonal counted once.
+ *
+ * \param[in]  mat1 The first matrix.
+ * \param[in]  mat2 The second matrix.
+ * \param[in]  dim Their dimensions.
+ * \retval The trace of mat1 * mat2.
+ */
+double symmat_traceprod(const double *mat1, const double *mat2, int dim)
+{
+
+  int i;
+  long diag = 0;
+  double res = 2.0 * simd_dot(mat1, mat2, symmat_size(dim));
+  for(i = 0; i < dim; i++){
+    res -= mat1[diag] * mat2[diag];
+    diag += i + 2;
+  }
+  return res;
+
+}
+
+
+/*!
+ * Compute the quadratic form of a symmetric square matrix in compressed form and two vectors (x^t * A * y).
+ * Row i below the diagonal contributes x_i (a.y) + y_i (a.x), with one shared-operand dot product.
+ *
+ * \param[in]  x The first vector.
+ * \param[in]  mat The square matrix.
+ * \param[in]  y The second vector.
+ * \param[in]  dim Their dimensions.
+ * \retval The quadratic form (x^t * A * y).
+ */
+double symmat_quadform(const double *x, const double *mat, const double *y, int dim)
+{
+
+  int i;
+  double d[2], res = 0.0;
+  const double *row = mat;
+  for(i = 0; i < dim; i++){
+    simd_dot2(d, row, y, x, i);
+    res += x[i] * d[0] + y[i] * d[1] + row[i] * x[i] * y[i];
+    row += i + 1;
+  }
+  return res;
+
+}
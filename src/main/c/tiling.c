@@ -0,0 +1,75 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#include "symtrx.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+
+// Tile size fixed at build time (e.g. -DSYMTRX_TILE=64); 0 means probed at runtime.
+#ifndef SYMTRX_TILE
+#define SYMTRX_TILE 0
+#endif
+
+#define TILE_DEFAULT 64
+#define TILE_MIN 8
+#define TILE_MAX 512
+
+static int tile_current = 0;
+
+
+/*!
+ * Probe the L1 data cache and return a tile size such that two square tiles of doubles fit in it.
+ *
+ * \retval The tile size (a multiple of 8).
+ */
+int tiling_probe(void)
+{
+
+  long l1size = -1;
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+  l1size = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+#endif
+  if( l1size <= 0 )
+    return TILE_DEFAULT;
+
+  int tile = (int)sqrt( (double)l1size / (2.0 * sizeof(double)) );
+  tile -= tile % 8;
+  if( tile < TILE_MIN ) tile = TILE_MIN;
+  if( tile > TILE_MAX ) tile = TILE_MAX;
+  return tile;
+
+}
+
+
+/*!
+ * Return the tile size used by the blocked kernels.
+ *
+ * \retval The tile size (build-time value if set, probed otherwise).
+ */
+int tiling_size(void)
+{
+
+  if( tile_current <= 0 )
+    tile_current = SYMTRX_TILE > 0 ? SYMTRX_TILE : tiling_probe();
+  return tile_current;
+
+}
+
+
+/*!
+ * Set the tile size used by the blocked kernels.
+ *
+ * \param[in]  tile The tile size (0 restores the default).
+ * \retval none
+ */
+void tiling_set(int tile)
+{
+
+  tile_current = tile;
+
+}
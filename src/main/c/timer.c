@@ -0,0 +1,44 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#include "symtrx.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+// Wall-clock timing for the tests and benchmarks. Unlike clock(), which sums the CPU time
+// of all threads, the monotonic clock measures the elapsed time of threaded kernels and
+// is not affected by changes of the system time.
+
+
+/*!
+ * Read the monotonic wall clock.
+ *
+ * \retval The current time in seconds, from an arbitrary origin.
+ */
+double timer_now(void)
+{
+
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+
+}
+
+
+/*!
+ * Resolution of the monotonic wall clock.
+ *
+ * \retval The resolution in seconds.
+ */
+double timer_resolution(void)
+{
+
+  struct timespec ts;
+  clock_getres(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+
+}
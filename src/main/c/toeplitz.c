@@ -0,0 +1,495 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#include "symtrx.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#define PRECISION 1e-12
+#define MAX(a,b) ((a) > (b) ? (a) : (b))
+#define MIN(a,b) ((a) > (b) ? (b) : (a))
+
+// A symmetric Toeplitz matrix, A(i,j) = t(|i-j|), is entirely described by its first row t,
+// which is the compressed form used here. It is bisymmetric, so it converts to bisym storage.
+
+/*!
+ * Compute the actual size of a symmetric Toeplitz matrix in compressed form.
+ *
+ * \param[in]  dim The dimensions.
+ * \retval Its size in memory (the first row).
+ */
+long toeplitz_size(int dim)
+{
+
+  return dim;
+
+}
+
+
+/*!
+ * Allocate space for a symmetric Toeplitz matrix (compressed form, first row).
+ *
+ * \param[out]  mat The matrix.
+ * \param[in]  dim Its dimension.
+ * \retval none
+ */
+void toeplitz_alloc(double **mat, int dim)
+{
+
+  *mat = workspace_calloc(toeplitz_size(dim));
+
+}
+
+
+/*!
+ * Take space for a symmetric Toeplitz matrix (compressed form) from a workspace (see workspace_take).
+ *
+ * \param[out]  mat The matrix, to be given back with workspace_give.
+ * \param[in]  dim Its dimension.
+ * \param[in]  ws The workspace (may be NULL).
+ * \retval none
+ */
+void toeplitz_alloc_ws(double **mat, int dim, workspace *ws)
+{
+
+  *mat = workspace_take(ws, toeplitz_size(dim));
+
+}
+
+
+/*!
+ * Create random symmetric Toeplitz matrix (compressed form, first row).
+ *
+ * \param[out]  mat The matrix in compressed form.
+ * \param[in]  dim Its dimension.
+ * \param[in]  seed The seed.
+ * \param[in]  stream The stream (see random_fill).
+ * \retval none
+ */
+void toeplitz_random(double *mat, int dim, uint64_t seed, uint64_t stream)
+{
+
+  random_fill(mat, toeplitz_size(dim), seed, stream, 0);
+
+}
+
+
+/*!
+ * Create random symmetric Toeplitz matrix (full form, full square matrix),
+ * from the next stream of the default seed (see random_set_seed).
+ *
+ * \param[out]  mat The matrix.
+ * \param[in]  dim Its dimension.
+ * \retval none
+ */
+void toeplitz_full_random(double *mat, int dim)
+{
+
+  double *matcomp;
+  toeplitz_alloc(&matcomp, dim);
+  toeplitz_random(matcomp, dim, random_seed(), random_next_stream());
+  toeplitz_comp_expandfull(mat, matcomp, dim);
+  free(matcomp);
+
+}
+
+
+/*!
+ * Extract the compressed form of a symmetric Toeplitz matrix from its square form.
+ *
+ * \param[out]  matcomp The matrix in compressed form (first row).
+ * \param[in]  matfull The matrix in full form (square matrix).
+ * \param[in]  dim Its dimension.
+ * \retval none
+ */
+void toeplitz_full_extractcomp(double *matcomp, double *matfull, int dim)
+{
+
+  memcpy(matcomp, matfull, dim * sizeof(double));
+
+}
+
+
+/*!
+ * Expand the full form of a symmetric Toeplitz matrix from its compressed form.
+ *
+ * \param[out]  matfull The matrix in full form (square matrix).
+ * \param[in]  matcomp The matrix in compressed form (first row).
+ * \param[in]  dim Its dimension.
+ * \retval none
+ */
+void toeplitz_comp_expandfull(double *matfull, double *matcomp, int dim)
+{
+
+  int i;
+  double *rev = (double*)calloc(dim, sizeof(double));
+  simd_copyrev(rev, matcomp, dim);
+  // Row i is t(i..1) followed by t(0..dim-i-1)
+  for(i = 0; i < dim; i++){
+    memcpy(matfull + square_ind(i,0,dim), rev + dim - i - 1, i * sizeof(double));
+    memcpy(matfull + square_ind(i,i,dim), matcomp, (dim - i) * sizeof(double));
+  }
+  free(rev);
+
+}
+
+
+/*!
+ * Convert a symmetric Toeplitz matrix to the compressed form of bisymmetric matrices.
+ *
+ * \param[out]  matbisym The matrix in bisymmetric compressed form.
+ * \param[in]  mat The matrix in Toeplitz compressed form (first row).
+ * \param[in]  dim Its dimension.
+ * \retval none
+ */
+void toeplitz_to_bisym(double *matbisym, double *mat, int dim)
+{
+
+  int i, len;
+  long j;
+  double *rev = (double*)calloc(dim, sizeof(double));
+  simd_copyrev(rev, mat, dim);
+  // Row i of the bisymmetric storage holds A(i,0..len-1) = t(i..i-len+1)
+  for(i = 0; i < dim; i++){
+    len = MIN(i, dim-i-1) + 1;
+    j = bisym_ind(i,0,dim);
+    memcpy(matbisym + j, rev + dim - i - 1, len * sizeof(double));
+  }
+  free(rev);
+
+}
+
+
+/*!
+ * Extract a symmetric Toeplitz matrix from the compressed form of bisymmetric matrices.
+ * Only the first column is read, the matrix is assumed to be Toeplitz.
+ *
+ * \param[out]  mat The matrix in Toeplitz compressed form (first row).
+ * \param[in]  matbisym The matrix in bisymmetric compressed form.
+ * \param[in]  dim Its dimension.
+ * \retval none
+ */
+void toeplitz_from_bisym(double *mat, double *matbisym, int dim)
+{
+
+  int i;
+  for(i = 0; i < dim; i++)
+    mat[i] = matbisym[ bisym_ind(i,0,dim) ];
+
+}
+
+
+/*!
+ * Check that a square matrix is symmetric and Toeplitz.
+ *
+ * \param[in]  mat The matrix in full form (square matrix).
+ * \param[in]  dim Its dimension.
+ * \retval 1 if the matrix is symmetric Toeplitz.
+ */
+int toeplitz_isvalid(double *mat, int dim)
+{
+
+  int i, j;
+  for(i = 0; i < dim; i++)
+    for(j = 0; j < dim; j++)
+      if( fabs(mat[ square_ind(i,j,dim) ] - mat[ toeplitz_ind(i,j,dim) ]) > PRECISION )
+        return 0;
+  return 1;
+
+}
+
+
+/*!
+ * Compute the product of a symmetric Toeplitz matrix and a vector (y = A * x) in O(dim log dim).
+ * The matrix is embedded in a circulant matrix of size N >= 2*dim-1, whose product is a circular
+ * convolution computed with FFTs. The first column c of the circulant is real and even, so that its
+ * spectrum is real: c and x are transformed together as c + i*x, and the spectrum of x is recovered
+ * from the same transform. The whole product thus costs one forward and one inverse complex FFT.
+ *
+ * \param[out]  y The output vector.
+ * \param[in]  mat The matrix in compressed form (first row).
+ * \param[in]  x The input vector.
+ * \param[in]  dim Their dimension.
+ * \retval none
+ */
+void toeplitz_matvec(double *y, double *mat, double *x, int dim)
+{
+
+  toeplitz_matvec_ws(y, mat, x, dim, NULL);
+
+}
+
+
+/*!
+ * Same as toeplitz_matvec, with the transforms and the twiddle factors taken from a workspace
+ * (4*n doubles, n = fft_size(2*dim-1)).
+ *
+ * \param[out]  y The output vector.
+ * \param[in]  mat The matrix in compressed form (first row).
+ * \param[in]  x The input vector.
+ * \param[in]  dim Their dimension.
+ * \param[in]  ws The workspace (may be NULL).
+ * \retval none
+ */
+void toeplitz_matvec_ws(double *y, double *mat, double *x, int dim, workspace *ws)
+{
+
+  int j, k, kk;
+  double c, rek, imk, rekk, imkk;
+  const int n = fft_size(2 * dim - 1);
+  double *re = workspace_take(ws, 2 * (size_t)n);
+  double *im = re + n;
+  memcpy(re, mat, dim * sizeof(double));
+  simd_copyrev(re + n - dim + 1, mat + 1, dim - 1);
+  memcpy(im, x, dim * sizeof(double));
+
+  fft_dp_ws(re, im, n, -1, ws);
+
+  // Z = C + i X with C real: C_k = Re(Z_k + Z_{n-k}) / 2, and Y = C X = -i C (Z - C)
+  for(k = 0; k <= n / 2; k++){
+    kk = (n - k) % n;
+    c = 0.5 * (re[k] + re[kk]);
+    rek = re[k]; imk = im[k]; rekk = re[kk]; imkk = im[kk];
+    re[k] = c * imk;
+    im[k] = - c * (rek - c);
+    re[kk] = c * imkk;
+    im[kk] = - c * (rekk - c);
+  }
+
+  fft_dp_ws(re, im, n, +1, ws);
+  for(j = 0; j < dim; j++)
+    y[j] = re[j] / n;
+  workspace_give(ws, re);
+
+}
+
+
+/*!
+ * Compute the trace of a symmetric Toeplitz matrix in compressed form.
+ *
+ * \param[in]  mat The input matrix.
+ * \param[in]  dim Its dimensions.
+ * \retval The trace of the matrix.
+ */
+double toeplitz_trace(double *mat, int dim)
+{
+
+  return dim * mat[0];
+
+}
+
+
+/*!
+ * Compute the trace of the product of two symmetric Toeplitz matrices in compressed form.
+ * Tr(AB) = sum_ij a(|i-j|) b(|i-j|), where the k-th diagonal has dim-k elements on each side.
+ *
+ * \param[in]  mat1 The first matrix.
+ * \param[in]  mat2 The second matrix.
+ * \param[in]  dim Their dimensions.
+ * \retval The trace of mat1 * mat2.
+ */
+double toeplitz_traceprod(double *mat1, double *mat2, int dim)
+{
+
+  int k;
+  double res = 0.0;
+  for(k = 1; k < dim; k++)
+    res += (dim - k) * mat1[k] * mat2[k];
+  return 2.0 * res + dim * mat1[0] * mat2[0];
+
+}
+
+
+/*!
+ * Compute the quadratic form of a symmetric Toeplitz matrix in compressed form and two vectors (x^t * A * y).
+ *
+ * \param[in]  x The first vector.
+ * \param[in]  mat The matrix in compressed form (first row).
+ * \param[in]  y The second vector.
+ * \param[in]  dim Their dimensions.
+ * \retval The quadratic form (x^t * A * y).
+ */
+double toeplitz_quadform(double *x, double *mat, double *y, int dim)
+{
+
+  return toeplitz_quadform_ws(x, mat, y, dim, NULL);
+
+}
+
+
+/*!
+ * Same as toeplitz_quadform, with the product taken from a workspace (dim doubles, and see toeplitz_matvec_ws).
+ *
+ * \param[in]  x The first vector.
+ * \param[in]  mat The matrix in compressed form (first row).
+ * \param[in]  y The second vector.
+ * \param[in]  dim Their dimensions.
+ * \param[in]  ws The workspace (may be NULL).
+ * \retval The quadratic form (x^t * A * y).
+ */
+double toeplitz_quadform_ws(double *x, double *mat, double *y, int dim, workspace *ws)
+{
+
+  double res;
+  double *z = workspace_take(ws, dim);
+  toeplitz_matvec_ws(z, mat, y, dim, ws);
+  res = simd_dot(x, z, dim);
+  workspace_give(ws, z);
+  return res;
+
+}
+
+
+/*!
+ * Update the solution y of the Yule-Walker equations of order k to order k+1 (Durbin step).
+ * Returns the new reflection coefficient alpha; y(0..k) = y(0..k-1) + alpha * rev(y(0..k-1)), alpha.
+ */
+static double toeplitz_durbin_step(double *y, double *r, double beta, int k)
+{
+
+  int i;
+  double a, b;
+  const double alpha = - (r[k] + simd_dotrev(r, y, k)) / beta;
+  for(i = 0; i < k - i - 1; i++){
+    a = y[i];
+    b = y[k-i-1];
+    y[i] = a + alpha * b;
+    y[k-i-1] = b + alpha * a;
+  }
+  if( i == k - i - 1 )
+    y[i] *= 1.0 + alpha;
+  y[k] = alpha;
+  return alpha;
+
+}
+
+
+/*!
+ * Solve a symmetric Toeplitz linear system (mat * x = b) with the Levinson algorithm, in O(dim^2)
+ * operations and O(dim) memory. The matrix must be strongly nonsingular (all its leading
+ * principal submatrices invertible), which is the case of positive-definite matrices.
+ *
+ * \param[out]  x The solution (can be the same as b).
+ * \param[in]  mat The matrix in compressed form (first row).
+ * \param[in]  b The right-hand side.
+ * \param[in]  dim The dimension.
+ * \retval 1 if the system was solved (or is empty), 0 if a leading submatrix is singular.
+ */
+int toeplitz_solve(double *x, double *mat, double *b, int dim)
+{
+
+  return toeplitz_solve_ws(x, mat, b, dim, NULL);
+
+}
+
+
+/*!
+ * Same as toeplitz_solve, with the temporary vectors taken from a workspace (2*dim doubles).
+ *
+ * \param[out]  x The solution (can be the same as b).
+ * \param[in]  mat The matrix in compressed form (first row).
+ * \param[in]  b The right-hand side.
+ * \param[in]  dim The dimension.
+ * \param[in]  ws The workspace (may be NULL).
+ * \retval 1 if the system was solved, 0 if a leading submatrix is singular.
+ */
+int toeplitz_solve_ws(double *x, double *mat, double *b, int dim, workspace *ws)
+{
+
+  int i, k;
+  double alpha, beta = 1.0, mu;
+  if( dim < 1 )
+    return 1;
+  // The recursion is invariant under scaling, so only a vanishing (or non-finite) t0 is singular
+  const double t0 = mat[0];
+  if( t0 == 0.0 || !isfinite(t0) )
+    return 0;
+  x[0] = b[0] / t0;
+  if( dim == 1 )
+    return 1;
+
+  // Work on the matrix normalised by t0, r holding its first row from the first superdiagonal
+  double *r = workspace_take(ws, 2 * (size_t)dim);
+  double *y = r + dim;
+  for(k = 1; k < dim; k++)
+    r[k-1] = mat[k] / t0;
+  y[0] = alpha = - r[0];
+
+  for(k = 1; k < dim; k++){
+    beta *= 1.0 - alpha * alpha;
+    if( fabs(beta) <= PRECISION ){
+      workspace_give(ws, r);
+      return 0;
+    }
+    mu = (b[k] / t0 - simd_dotrev(r, x, k)) / beta;
+    for(i = 0; i < k; i++)
+      x[i] += mu * y[k-i-1];
+    x[k] = mu;
+    if( k < dim - 1 )
+      alpha = toeplitz_durbin_step(y, r, beta, k);
+  }
+
+  workspace_give(ws, r);
+  return 1;
+
+}
+
+
+/*!
+ * Compute the logarithm of the absolute value of the determinant of a symmetric Toeplitz matrix,
+ * with the Durbin recursion in O(dim^2) operations and O(dim) memory: det(A) = t0^dim prod_k beta_k,
+ * beta_k being the successive prediction-error variances (normalised by t0).
+ *
+ * \param[in]  mat The matrix in compressed form (first row).
+ * \param[in]  dim Its dimension.
+ * \retval log |det(A)|, or -INFINITY if a leading submatrix is singular.
+ */
+double toeplitz_logdet(double *mat, int dim)
+{
+
+  return toeplitz_logdet_ws(mat, dim, NULL);
+
+}
+
+
+/*!
+ * Same as toeplitz_logdet, with the temporary vectors taken from a workspace (2*dim doubles).
+ *
+ * \param[in]  mat The matrix in compressed form (first row).
+ * \param[in]  dim Its dimension.
+ * \param[in]  ws The workspace (may be NULL).
+ * \retval log |det(A)|, or -INFINITY if a leading submatrix is singular.
+ */
+double toeplitz_logdet_ws(double *mat, int dim, workspace *ws)
+{
+
+  int k;
+  double alpha, beta = 1.0;
+  const double t0 = mat[0];
+  double res = dim * log(fabs(t0));
+  if( dim == 1 || t0 == 0.0 )
+    return res;
+
+  double *r = workspace_take(ws, 2 * (size_t)dim);
+  double *y = r + dim;
+  for(k = 1; k < dim; k++)
+    r[k-1] = mat[k] / t0;
+  y[0] = alpha = - r[0];
+
+  for(k = 1; k < dim; k++){
+    beta *= 1.0 - alpha * alpha;
+    res += log(fabs(beta));
+    if( beta == 0.0 )
+      break;
+    if( k < dim - 1 )
+      alpha = toeplitz_durbin_step(y, r, beta, k);
+  }
+
+  workspace_give(ws, r);
+  return res;
+
+}
@@ -10,7 +10,7 @@
 #include <time.h>
 
 /*!
- * Create random vector.
+ * Create random vector, from the next stream of the default seed (see random_set_seed).
  *
  * \param[out]  mat The vector.
  * \param[in]  dim Its dimension.
@@ -18,8 +18,37 @@
  */
 void vector_random(double *x, int dim)
 {
-  const int seed = (int)(10000.0*(double)clock()/(double)CLOCKS_PER_SEC);
-  int i;
-  for(i = 0; i < dim; i++)
-    x[i] = ran2_dp(seed);
+  random_fill(x, dim, random_seed(), random_next_stream(), 0);
+}
+
+
+/*!
+ * Round a vector (or a matrix in any form) to single precision.
+ *
+ * \param[out]  y The vector in single precision.
+ * \param[in]  x The vector.
+ * \param[in]  n Its number of elements.
+ * \retval none
+ */
+void vector_to_float(float *y, const double *x, long n)
+{
+  long t;
+  for(t = 0; t < n; t++)
+    y[t] = (float)x[t];
+}
+
+
+/*!
+ * Convert a single precision vector (or a matrix in any form) to double precision.
+ *
+ * \param[out]  y The vector.
+ * \param[in]  x The vector in single precision.
+ * \param[in]  n Its number of elements.
+ * \retval none
+ */
+void vector_to_double(double *y, const float *x, long n)
+{
+  long t;
+  for(t = 0; t < n; t++)
+    y[t] = x[t];
 }
@@ -0,0 +1,319 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#include "symtrx.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#define MAX(a,b) ((a) > (b) ? (a) : (b))
+
+// Workspaces: a pool allocated once, from which the kernels take their scratch buffers
+// (and the caller its matrices) with a pointer bump, and give them back in stack order.
+// Every buffer starts on a WORKSPACE_ALIGN boundary, i.e. a cache line and an AVX-512 vector.
+// A buffer that does not fit in the pool, or taken from no pool (NULL workspace), is allocated
+// on the heap instead, and freed when it is given back: the kernels thus accept an optional
+// workspace, and repeated calls with a large enough one do not allocate at all.
+
+#define WORKSPACE_HUGEPAGE_SIZE (2UL << 20)
+
+static long workspace_heap_nalloc = 0;
+static double workspace_heap_nbytes = 0.0;
+
+
+/*!
+ * Number of bytes taken in a workspace by a buffer of n doubles (rounded up to the alignment).
+ *
+ * \param[in]  n Number of doubles.
+ * \retval The size in bytes.
+ */
+size_t workspace_bytes(size_t n)
+{
+
+  return (n * sizeof(double) + WORKSPACE_ALIGN - 1) / WORKSPACE_ALIGN * WORKSPACE_ALIGN;
+
+}
+
+
+/*!
+ * Allocate a zeroed buffer on the heap, aligned on WORKSPACE_ALIGN bytes.
+ * The buffer can be released with free.
+ *
+ * \param[in]  nbytes Number of bytes.
+ * \retval The buffer, or NULL if the allocation failed.
+ */
+static void *workspace_calloc_bytes(size_t nbytes)
+{
+
+  void *buf = NULL;
+  nbytes = (MAX(nbytes, 1) + WORKSPACE_ALIGN - 1) / WORKSPACE_ALIGN * WORKSPACE_ALIGN;
+  if( posix_memalign(&buf, WORKSPACE_ALIGN, nbytes) != 0 )
+    return NULL;
+  memset(buf, 0, nbytes);
+  #pragma omp atomic
+  workspace_heap_nalloc++;
+  #pragma omp atomic
+  workspace_heap_nbytes += nbytes;
+  return buf;
+
+}
+
+
+/*!
+ * Allocate a zeroed buffer of doubles on the heap, aligned on WORKSPACE_ALIGN bytes.
+ * The buffer can be released with free.
+ *
+ * \param[in]  n Number of doubles.
+ * \retval The buffer, or NULL if the allocation failed.
+ */
+double *workspace_calloc(size_t n)
+{
+
+  return (double*)workspace_calloc_bytes(n * sizeof(double));
+
+}
+
+
+/*!
+ * Allocate a zeroed buffer of floats on the heap, aligned on WORKSPACE_ALIGN bytes (see workspace_calloc).
+ *
+ * \param[in]  n Number of floats.
+ * \retval The buffer, or NULL if the allocation failed.
+ */
+float *workspace_calloc_f(size_t n)
+{
+
+  return (float*)workspace_calloc_bytes(n * sizeof(float));
+
+}
+
+
+/*!
+ * Statistics of the aligned heap allocations (workspace_calloc, and all the *_alloc functions).
+ *
+ * \param[out]  nalloc Number of allocations (may be NULL).
+ * \param[out]  nbytes Total number of bytes allocated (may be NULL).
+ * \retval none
+ */
+void workspace_heap_stats(long *nalloc, double *nbytes)
+{
+
+  if( nalloc )
+    *nalloc = workspace_heap_nalloc;
+  if( nbytes )
+    *nbytes = workspace_heap_nbytes;
+
+}
+
+
+/*!
+ * Allocate the pool of a workspace.
+ * With WORKSPACE_HUGEPAGES the pool is mapped with explicit huge pages (Linux MAP_HUGETLB) if some
+ * are reserved, and otherwise on 2MB boundaries with a transparent huge page hint (madvise);
+ * hugepages is set in the first case only, the second depending on the system settings.
+ *
+ * \param[out]  ws The workspace.
+ * \param[in]  nbytes Size of the pool (see workspace_bytes).
+ * \param[in]  flags 0, or WORKSPACE_HUGEPAGES.
+ * \retval 1 if the pool was allocated, 0 otherwise (the workspace is then empty, and still usable).
+ */
+int workspace_init(workspace *ws, size_t nbytes, int flags)
+{
+
+  void *base = NULL;
+  memset(ws, 0, sizeof(workspace));
+  nbytes = (nbytes + WORKSPACE_ALIGN - 1) / WORKSPACE_ALIGN * WORKSPACE_ALIGN;
+  if( nbytes == 0 )
+    return 1;
+
+#ifdef __linux__
+  if( flags & WORKSPACE_HUGEPAGES ){
+    const size_t mapsize = (nbytes + WORKSPACE_HUGEPAGE_SIZE - 1) / WORKSPACE_HUGEPAGE_SIZE * WORKSPACE_HUGEPAGE_SIZE;
+#ifdef MAP_HUGETLB
+    base = mmap(NULL, mapsize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if( base != MAP_FAILED ){
+      ws->hugepages = 1;
+    } else
+#endif
+    {
+      base = mmap(NULL, mapsize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+#ifdef MADV_HUGEPAGE
+      if( base != MAP_FAILED )
+        madvise(base, mapsize, MADV_HUGEPAGE);
+#endif
+    }
+    if( base == MAP_FAILED )
+      return 0;
+    ws->mapped = 1;
+    ws->base = (char*)base;
+    ws->capacity = mapsize;
+    return 1;
+  }
+#endif
+
+  if( posix_memalign(&base, WORKSPACE_ALIGN, nbytes) != 0 )
+    return 0;
+  ws->base = (char*)base;
+  ws->capacity = nbytes;
+  return 1;
+
+}
+
+
+/*!
+ * Release the pool of a workspace. The buffers taken from it must not be used anymore.
+ *
+ * \param[in]  ws The workspace.
+ * \retval none
+ */
+void workspace_free(workspace *ws)
+{
+
+#ifdef __linux__
+  if( ws->mapped ){
+    munmap(ws->base, ws->capacity);
+    memset(ws, 0, sizeof(workspace));
+    return;
+  }
+#endif
+  free(ws->base);
+  memset(ws, 0, sizeof(workspace));
+
+}
+
+
+/*!
+ * Give back all the buffers of a workspace at once, and reset its statistics.
+ *
+ * \param[in]  ws The workspace.
+ * \retval none
+ */
+void workspace_reset(workspace *ws)
+{
+
+  ws->used = 0;
+  ws->peak = 0;
+  ws->ntake = 0;
+  ws->nheap = 0;
+
+}
+
+
+/*!
+ * Take a zeroed buffer of any type from a workspace, aligned on WORKSPACE_ALIGN bytes.
+ * If the workspace is NULL or too small, the buffer is allocated on the heap.
+ *
+ * \param[in]  ws The workspace (may be NULL).
+ * \param[in]  nbytes Number of bytes.
+ * \retval The buffer, to be given back with workspace_give_bytes.
+ */
+void *workspace_take_bytes(workspace *ws, size_t nbytes)
+{
+
+  if( ws == NULL )
+    return workspace_calloc_bytes(nbytes);
+  nbytes = (nbytes + WORKSPACE_ALIGN - 1) / WORKSPACE_ALIGN * WORKSPACE_ALIGN;
+  if( ws->capacity - ws->used < nbytes ){
+    ws->nheap++;
+    return workspace_calloc_bytes(nbytes);
+  }
+  char *buf = ws->base + ws->used;
+  memset(buf, 0, nbytes);
+  ws->used += nbytes;
+  ws->ntake++;
+  if( ws->used > ws->peak )
+    ws->peak = ws->used;
+  return buf;
+
+}
+
+
+/*!
+ * Give back a buffer taken from a workspace. Buffers from the pool are given back in stack order:
+ * giving back one also gives back all the buffers taken after it.
+ *
+ * \param[in]  ws The workspace (may be NULL).
+ * \param[in]  buf The buffer (may be NULL).
+ * \retval none
+ */
+void workspace_give_bytes(workspace *ws, void *buf)
+{
+
+  char *p = (char*)buf;
+  if( buf == NULL )
+    return;
+  if( ws != NULL && p >= ws->base && p < ws->base + ws->capacity ){
+    if( (size_t)(p - ws->base) < ws->used )
+      ws->used = p - ws->base;
+    return;
+  }
+  free(buf);
+
+}
+
+
+/*!
+ * Take a zeroed buffer of doubles from a workspace (see workspace_take_bytes).
+ *
+ * \param[in]  ws The workspace (may be NULL).
+ * \param[in]  n Number of doubles.
+ * \retval The buffer, to be given back with workspace_give.
+ */
+double *workspace_take(workspace *ws, size_t n)
+{
+
+  return (double*)workspace_take_bytes(ws, n * sizeof(double));
+
+}
+
+
+/*!
+ * Give back a buffer of doubles taken from a workspace (see workspace_give_bytes).
+ *
+ * \param[in]  ws The workspace (may be NULL).
+ * \param[in]  buf The buffer (may be NULL).
+ * \retval none
+ */
+void workspace_give(workspace *ws, double *buf)
+{
+
+  workspace_give_bytes(ws, buf);
+
+}
+
+
+/*!
+ * Take a zeroed buffer of floats from a workspace (see workspace_take_bytes).
+ *
+ * \param[in]  ws The workspace (may be NULL).
+ * \param[in]  n Number of floats.
+ * \retval The buffer, to be given back with workspace_give_f.
+ */
+float *workspace_take_f(workspace *ws, size_t n)
+{
+
+  return (float*)workspace_take_bytes(ws, n * sizeof(float));
+
+}
+
+
+/*!
+ * Give back a buffer of floats taken from a workspace (see workspace_give_bytes).
+ *
+ * \param[in]  ws The workspace (may be NULL).
+ * \param[in]  buf The buffer (may be NULL).
+ * \retval none
+ */
+void workspace_give_f(workspace *ws, float *buf)
+{
+
+  workspace_give_bytes(ws, buf);
+
+}
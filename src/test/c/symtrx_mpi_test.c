@@ -0,0 +1,131 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#include "symtrx.h"
+#include "distrib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#define MAX(a,b) ((a) > (b) ? (a) : (b))
+#define MIN(a,b) ((a) > (b) ? (b) : (a))
+
+void test_distrib(const distrib_grid *grid, int dim, int nb)
+{
+  int rank, nprocs;
+  double t1, t2, tdist, tserial = 0.0, tr = 0.0, trdist;
+  double *mat1 = NULL, *mat2 = NULL, *matprod = NULL, *matres = NULL, *matfull = NULL;
+  distrib_centrosym dmat1, dmat2, dmatprod, dmatcopy;
+  MPI_Comm_rank(grid->comm, &rank);
+  MPI_Comm_size(grid->comm, &nprocs);
+
+  if( rank == 0 ){
+    printf("\n==============================================\n");
+    printf("Testing distributed centrosymmetric matrices\n");
+    printf("----------------------------------------------\n");
+    printf("Dimension %i, blocks of %i, grid of %i x %i processes\n", dim, nb, grid->nprow, grid->npcol);
+  }
+
+  distrib_centrosym_alloc(&dmat1, dim, nb, grid);
+  distrib_centrosym_alloc(&dmat2, dim, nb, grid);
+  distrib_centrosym_alloc(&dmatprod, dim, nb, grid);
+  distrib_centrosym_alloc(&dmatcopy, dim, nb, grid);
+  distrib_centrosym_random(&dmat1, 1, 31);
+  distrib_centrosym_random(&dmat2, 1, 32);
+
+  // Reference: the same matrices in serial (every process, for the extractions)
+  centrosym_alloc(&mat1, dim);
+  centrosym_alloc(&mat2, dim);
+  square_alloc(&matfull, dim);
+  centrosym_random(mat1, dim, 1, 31);
+  centrosym_random(mat2, dim, 1, 32);
+  centrosym_comp_expandfull(matfull, mat1, dim);
+
+  // Extractions from the full and compressed forms give the same local parts
+  distrib_centrosym_full_extractcomp(&dmatcopy, matfull);
+  if( memcmp(dmatcopy.plus.data, dmat1.plus.data, (size_t)dmat1.plus.mloc * dmat1.plus.nloc * sizeof(double)) != 0
+      || memcmp(dmatcopy.minus.data, dmat1.minus.data, (size_t)dmat1.minus.mloc * dmat1.minus.nloc * sizeof(double)) != 0 )
+    printf("distrib_centrosym_full_extractcomp is wrong (rank %i)\n", rank);
+  distrib_centrosym_comp_extract(&dmatcopy, mat2);
+  if( memcmp(dmatcopy.plus.data, dmat2.plus.data, (size_t)dmat2.plus.mloc * dmat2.plus.nloc * sizeof(double)) != 0
+      || memcmp(dmatcopy.minus.data, dmat2.minus.data, (size_t)dmat2.minus.mloc * dmat2.minus.nloc * sizeof(double)) != 0 )
+    printf("distrib_centrosym_comp_extract is wrong (rank %i)\n", rank);
+
+  if( rank == 0 ){
+    centrosym_alloc(&matprod, dim);
+    centrosym_alloc(&matres, dim);
+    fflush(NULL); t1 = timer_now();
+    centrosym_product(matprod, mat1, mat2, dim);
+    fflush(NULL); t2 = timer_now();
+    tserial = t2 - t1;
+    tr = centrosym_traceprod(mat1, mat2, dim);
+  }
+
+  // Gathered matrix
+  distrib_centrosym_gather(matres, &dmat1, 0);
+  if( rank == 0 && centrosym_assertequal(matres, mat1, dim) == 0 )
+    printf("distrib_centrosym_gather is wrong\n");
+
+  // Product
+  MPI_Barrier(grid->comm);
+  t1 = timer_now();
+  if( distrib_centrosym_product(&dmatprod, &dmat1, &dmat2) == 0 )
+    printf("distrib_centrosym_product failed (rank %i)\n", rank);
+  MPI_Barrier(grid->comm);
+  t2 = timer_now();
+  tdist = t2 - t1;
+  distrib_centrosym_gather(matres, &dmatprod, 0);
+  if( rank == 0 && centrosym_assertequal(matres, matprod, dim) == 0 )
+    printf("distrib_centrosym_product is wrong\n");
+  if( distrib_centrosym_product(&dmat1, &dmat1, &dmat2) != 0 )
+    printf("distrib_centrosym_product accepts an aliased result (rank %i)\n", rank);
+
+  // Trace-product
+  trdist = distrib_centrosym_traceprod(&dmat1, &dmat2);
+  if( rank == 0 && fabs(trdist - tr) > 1e-10 * MAX(1.0, fabs(tr)) )
+    printf("distrib_centrosym_traceprod is wrong : %e vs %e\n", trdist, tr);
+
+  if( rank == 0 ){
+    printf("> Elements per process over the compressed form : %2.2f \n",
+      (double)distrib_centrosym_localsize(&dmat1) / centrosym_size(dim));
+    printf("> Acceleration factor of the product on %i processes : %2.2f \n", nprocs, tserial / tdist);
+    printf("----------------------------------------------\n");
+  }
+
+  distrib_centrosym_free(&dmat1);
+  distrib_centrosym_free(&dmat2);
+  distrib_centrosym_free(&dmatprod);
+  distrib_centrosym_free(&dmatcopy);
+  free(mat1);
+  free(mat2);
+  free(matfull);
+  free(matprod);
+  free(matres);
+
+}
+
+
+int main(int argc, char *argv[])
+{
+
+  distrib_grid grid;
+  MPI_Init(&argc, &argv);
+  if( distrib_grid_init(&grid, MPI_COMM_WORLD) == 0 ){
+    printf("distrib_grid_init failed\n");
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+
+  // Even and odd dimensions (central row of the plus block), blocks that do not divide them
+  test_distrib(&grid, 256, 16);
+  test_distrib(&grid, 255, 7);
+  test_distrib(&grid, 9, 2);
+  test_distrib(&grid, 1, 4);
+
+  distrib_grid_free(&grid);
+  MPI_Finalize();
+  return 0;
+
+}
@@ -4,27 +4,860 @@
 
 #include "symtrx.h"
 #include <assert.h>
+#include <float.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
 #include <time.h>
 
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
 #define MAX(a,b) ((a) > (b) ? (a) : (b))
 #define MIN(a,b) ((a) > (b) ? (b) : (a))
 
+void test_simd(int dim)
+{
+  int level, n, k, nk = 5;
+  double dotref, dotrevref, dot2ref[2], dot2res[2], foldref[4], foldres[4], *yref, *revref;
+  double *x = (double*)calloc(nk * dim, sizeof(double));
+  double *y = (double*)calloc(dim, sizeof(double));
+  double *a = (double*)calloc(nk, sizeof(double));
+  double *z = (double*)calloc(nk * dim, sizeof(double));
+  float *xf = (float*)calloc(nk * dim, sizeof(float));
+  float *yf = (float*)calloc(dim, sizeof(float));
+  float *af = (float*)calloc(nk, sizeof(float));
+  float *zf = (float*)calloc(dim, sizeof(float));
+  yref = (double*)calloc(dim, sizeof(double));
+  revref = (double*)calloc(dim, sizeof(double));
+  vector_random(x, nk * dim);
+  vector_random(y, dim);
+  vector_random(a, nk);
+
+  printf("\n==============================================\n");
+  printf("Testing vectorised kernels\n");
+  printf("----------------------------------------------\n");
+  printf("> Instruction set selected at load time : %s\n", simd_name(simd_level()));
+
+  for( level = SIMD_SSE2; level <= SIMD_AVX512; level++ ){
+    if( simd_set(level) == 0 ) continue;
+    printf("> Checking %s kernels against scalar kernels\n", simd_name(level));
+    // Odd lengths exercise the remainder loops
+    for( n = 1; n <= dim; n += 7 ){
+      simd_set(SIMD_SCALAR);
+      dotref = simd_dot(x, y, n);
+      dotrevref = simd_dotrev(x, y, n);
+      simd_dot2(dot2ref, x, y, x + dim, n);
+      simd_dotfold(foldref, x, x + dim, x + 2 * dim, x + 3 * dim, x + 4 * dim, y, n);
+      simd_copyrev(revref, x, n);
+      memcpy(yref, y, n * sizeof(double));
+      simd_muladd(yref, x, x + dim, n);
+      memcpy(z, y, n * sizeof(double));
+      simd_set(level);
+      simd_muladd(z, x, x + dim, n);
+      for( k = 0; k < n; k++ )
+        if( fabs(z[k] - yref[k]) > 1e-12 ){
+          printf("simd_muladd is wrong for n = %i\n", n);
+          break;
+        }
+      simd_set(SIMD_SCALAR);
+      memcpy(yref, y, n * sizeof(double));
+      simd_vecmat(yref, a, x, n, nk, n);
+      simd_set(level);
+      if( fabs(simd_dot(x, y, n) - dotref) > 1e-12 * n ) printf("simd_dot is wrong for n = %i\n", n);
+      if( fabs(simd_dotrev(x, y, n) - dotrevref) > 1e-12 * n ) printf("simd_dotrev is wrong for n = %i\n", n);
+      simd_dot2(dot2res, x, y, x + dim, n);
+      if( fabs(dot2res[0] - dot2ref[0]) > 1e-12 * n || fabs(dot2res[1] - dot2ref[1]) > 1e-12 * n ) printf("simd_dot2 is wrong for n = %i\n", n);
+      simd_dotfold(foldres, x, x + dim, x + 2 * dim, x + 3 * dim, x + 4 * dim, y, n);
+      for( k = 0; k < 4; k++ )
+        if( fabs(foldres[k] - foldref[k]) > 1e-12 * n ){
+          printf("simd_dotfold is wrong for n = %i\n", n);
+          break;
+        }
+      simd_copyrev(z, x, n);
+      if( memcmp(z, revref, n * sizeof(double)) != 0 ) printf("simd_copyrev is wrong for n = %i\n", n);
+      memcpy(z, y, n * sizeof(double));
+      simd_vecmat(z, a, x, n, nk, n);
+      for( k = 0; k < n; k++ )
+        if( fabs(z[k] - yref[k]) > 1e-12 * nk ){
+          printf("simd_vecmat is wrong for n = %i\n", n);
+          break;
+        }
+      // Single precision kernels, on the rounded vectors
+      vector_to_float(xf, x, nk * dim);
+      vector_to_float(yf, y, dim);
+      vector_to_float(af, a, nk);
+      vector_to_double(z, xf, nk * dim);
+      vector_to_double(yref, yf, dim);
+      dotref = simd_dot(z, yref, n);
+      dotrevref = simd_dotrev(z, yref, n);
+      if( fabs(simd_dot_f(xf, yf, n) - dotref) > FLT_EPSILON * n * dotref ) printf("simd_dot_f is wrong for n = %i\n", n);
+      if( fabs(simd_dot_fd(xf, yf, n) - dotref) > 1e-12 * n ) printf("simd_dot_fd is wrong for n = %i\n", n);
+      if( fabs(simd_dotrev_f(xf, yf, n) - dotrevref) > FLT_EPSILON * n * dotrevref ) printf("simd_dotrev_f is wrong for n = %i\n", n);
+      if( fabs(simd_dotrev_fd(xf, yf, n) - dotrevref) > 1e-12 * n ) printf("simd_dotrev_fd is wrong for n = %i\n", n);
+      simd_dot2(dot2ref, z, yref, z + dim, n);
+      simd_dot2_f(dot2res, xf, yf, xf + dim, n);
+      if( fabs(dot2res[0] - dot2ref[0]) > 4 * FLT_EPSILON * n || fabs(dot2res[1] - dot2ref[1]) > 4 * FLT_EPSILON * n ) printf("simd_dot2_f is wrong for n = %i\n", n);
+      simd_dot2_fd(dot2res, xf, yf, xf + dim, n);
+      if( fabs(dot2res[0] - dot2ref[0]) > 1e-12 * n || fabs(dot2res[1] - dot2ref[1]) > 1e-12 * n ) printf("simd_dot2_fd is wrong for n = %i\n", n);
+      simd_dotfold(foldref, z, z + dim, z + 2 * dim, z + 3 * dim, z + 4 * dim, yref, n);
+      simd_dotfold_f(foldres, xf, xf + dim, xf + 2 * dim, xf + 3 * dim, xf + 4 * dim, yf, n);
+      for( k = 0; k < 4; k++ )
+        if( fabs(foldres[k] - foldref[k]) > 4 * FLT_EPSILON * n ){
+          printf("simd_dotfold_f is wrong for n = %i\n", n);
+          break;
+        }
+      simd_dotfold_fd(foldres, xf, xf + dim, z + 2 * dim, z + 3 * dim, z + 4 * dim, yref, n);
+      for( k = 0; k < 4; k++ )
+        if( fabs(foldres[k] - foldref[k]) > 1e-12 * n ){
+          printf("simd_dotfold_fd is wrong for n = %i\n", n);
+          break;
+        }
+      simd_copyrev_f(zf, xf, n);
+      for( k = 0; k < n; k++ )
+        if( zf[k] != xf[n-k-1] ){
+          printf("simd_copyrev_f is wrong for n = %i\n", n);
+          break;
+        }
+      memset(zf, 0, n * sizeof(float));
+      memset(yref, 0, n * sizeof(double));
+      simd_vecmat_f(zf, af, xf, n, nk, n);
+      simd_vecmat_fd(yref, af, xf, n, nk, n);
+      for( k = 0; k < n; k++ )
+        if( fabs(zf[k] - yref[k]) > FLT_EPSILON * nk * yref[k] ){
+          printf("simd_vecmat_f is wrong for n = %i\n", n);
+          break;
+        }
+    }
+  }
+  simd_set(simd_detect());
+
+  free(x);
+  free(y);
+  free(a);
+  free(z);
+  free(yref);
+  free(revref);
+  free(xf);
+  free(yf);
+  free(af);
+  free(zf);
+
+  printf("----------------------------------------------");
+
+}
+
+
+void test_random(int dim)
+{
+  int i, nthreads;
+  long n;
+  double t1, t2, tran2, tfill, mean;
+  const uint32_t ctr0[4] = { 0, 0, 0, 0 }, key0[2] = { 0, 0 };
+  const uint32_t ctr1[4] = { 0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu }, key1[2] = { 0xffffffffu, 0xffffffffu };
+  const uint32_t ref0[4] = { 0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u };
+  const uint32_t ref1[4] = { 0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu };
+  uint32_t out[4];
+
+  printf("\n==============================================\n");
+  printf("Testing counter-based random numbers\n");
+  printf("----------------------------------------------\n");
+
+  // Known-answer tests of the Philox4x32-10 block function
+  random_philox4x32(out, ctr0, key0);
+  if( memcmp(out, ref0, sizeof(out)) != 0 ) printf("philox4x32 is wrong for a zero counter and key\n");
+  random_philox4x32(out, ctr1, key1);
+  if( memcmp(out, ref1, sizeof(out)) != 0 ) printf("philox4x32 is wrong for a full counter and key\n");
+
+  // Same numbers for any number of threads, any offset, and one at a time
+  n = (long)dim * dim + 3;
+  double *x = (double*)calloc(n, sizeof(double));
+  double *y = (double*)calloc(n, sizeof(double));
+  parallel_set_threads(1);
+  random_fill(x, n, 42, 7, 0);
+  for( nthreads = 2; nthreads <= 5; nthreads++ ){
+    parallel_set_threads(nthreads);
+    random_fill(y, n, 42, 7, 0);
+    if( memcmp(x, y, n * sizeof(double)) != 0 ) printf("random_fill depends on the number of threads (%i)\n", nthreads);
+  }
+  parallel_set_threads(0);
+  random_fill(y, n - 5, 42, 7, 5);
+  if( memcmp(x + 5, y, (n - 5) * sizeof(double)) != 0 ) printf("random_fill is wrong with an offset\n");
+  for( i = 0; i < 20; i++ )
+    if( random_uniform(42, 7, i) != x[i] ){
+      printf("random_uniform is not equal to random_fill\n");
+      break;
+    }
+  random_fill(y, n, 42, 8, 0);
+  if( memcmp(x, y, n * sizeof(double)) == 0 ) printf("random streams are not independent\n");
+  mean = 0.0;
+  for( i = 0; i < n; i++ ){
+    if( x[i] <= 0.0 || x[i] >= 1.0 ){
+      printf("random_fill is out of (0,1)\n");
+      break;
+    }
+    mean += x[i];
+  }
+  if( fabs(mean / n - 0.5) > 5.0 / sqrt(12.0 * n) ) printf("random_fill has a wrong mean (%f)\n", mean / n);
+
+  // Reproducible matrices without an explicit seed, and valid packed generators
+  double *matfull1, *matfull2, *matcomp;
+  square_alloc(&matfull1, dim);
+  square_alloc(&matfull2, dim);
+  random_set_seed(7);
+  square_random(matfull1, dim);
+  random_set_seed(7);
+  square_random(matfull2, dim);
+  if( memcmp(matfull1, matfull2, dim * dim * sizeof(double)) != 0 ) printf("square_random is not reproducible\n");
+  random_set_seed(RANDOM_SEED_DEFAULT);
+  centrosym_alloc(&matcomp, dim);
+  centrosym_random(matcomp, dim, 1, 2);
+  centrosym_comp_expandfull(matfull1, matcomp, dim);
+  if( centrosym_isvalid(matfull1, dim) == 0 ) printf("centrosym_random is not centrosymmetric\n");
+  free(matcomp);
+  bisym_alloc(&matcomp, dim);
+  bisym_random(matcomp, dim, 1, 2);
+  bisym_comp_expandfull(matfull1, matcomp, dim);
+  if( bisym_isvalid(matfull1, dim) == 0 ) printf("bisym_random is not bisymmetric\n");
+  free(matcomp);
+
+  // Benchmark the bulk fill against the former generator
+  fflush(NULL); t1 = timer_now();
+  for( i = 0; i < n; i++ )
+    y[i] = ran2_dp(1);
+  fflush(NULL); t2 = timer_now();
+  tran2 = t2 - t1;
+  fflush(NULL); t1 = timer_now();
+  random_fill(y, n, 42, 7, 0);
+  fflush(NULL); t2 = timer_now();
+  tfill = t2 - t1;
+  printf("> Bulk fill acceleration factor over ran2_dp : %2.2f (%2.2f ns per number)\n", tran2 / tfill, 1e9 * tfill / n);
+
+  free(x);
+  free(y);
+  free(matfull1);
+  free(matfull2);
+
+  printf("----------------------------------------------");
+
+}
+
+
+void test_workspace(int dim)
+{
+  int i;
+  const int NCALL = 1000, dimsmall = 64;
+  long nalloc0, nalloc1;
+  double t1, t2, tmean_heap, tmean_ws, res1, res2;
+  workspace ws;
+
+  printf("\n==============================================\n");
+  printf("Testing workspaces\n");
+  printf("----------------------------------------------\n");
+
+  // Aligned, zeroed buffers, given back in stack order, and heap fallback when full
+  if( workspace_init(&ws, 3 * workspace_bytes(100), 0) == 0 ) printf("workspace_init failed\n");
+  double *a = workspace_take(&ws, 100);
+  double *b = workspace_take(&ws, 3);
+  double *c = workspace_take(&ws, 100);
+  if( ((size_t)a | (size_t)b | (size_t)c) % WORKSPACE_ALIGN != 0 ) printf("workspace buffers are not aligned\n");
+  for( i = 0; i < 100; i++ )
+    if( a[i] != 0.0 || c[i] != 0.0 ){
+      printf("workspace buffers are not zeroed\n");
+      break;
+    }
+  a[0] = c[99] = 1.0;
+  double *d = workspace_take(&ws, 100);
+  if( ws.ntake != 3 || ws.nheap != 1 ) printf("workspace_take does not fall back on the heap\n");
+  workspace_give(&ws, d);
+  workspace_give(&ws, b);
+  if( ws.used != workspace_bytes(100) || ws.peak != 2 * workspace_bytes(100) + workspace_bytes(3) ) printf("workspace_give is wrong\n");
+  c = workspace_take(&ws, 100);
+  if( c[0] != 0.0 ) printf("workspace buffers are not zeroed after being given back\n");
+  int *bounds = (int*)workspace_take_bytes(&ws, 5 * sizeof(int));
+  if( (size_t)bounds % WORKSPACE_ALIGN != 0 || bounds[4] != 0 || ws.used != 2 * workspace_bytes(100) + WORKSPACE_ALIGN ) printf("workspace_take_bytes is wrong\n");
+  workspace_give_bytes(&ws, bounds);
+  workspace_give(&ws, a);
+  if( ws.used != 0 ) printf("workspace_give is wrong\n");
+  workspace_free(&ws);
+  a = workspace_take(NULL, 100);
+  if( (size_t)a % WORKSPACE_ALIGN != 0 ) printf("heap buffers are not aligned\n");
+  workspace_give(NULL, a);
+
+  // Huge pages (reported only, they depend on the system)
+  if( workspace_init(&ws, 4UL << 20, WORKSPACE_HUGEPAGES) == 0 ) printf("workspace_init failed with huge pages\n");
+  a = workspace_take(&ws, 1 << 19);
+  a[(1 << 19) - 1] = 1.0;
+  printf("> Huge page backed workspace : %s\n", ws.hugepages ? "yes" : "no (transparent huge pages hint)");
+  workspace_free(&ws);
+
+  // Same results with or without a workspace, and no allocation once it is large enough
+  double *matfull, *matcomp1, *matcomp2, *matcomp3, *matcomp4, *bisym1, *bisym2, *toep, *x, *y, *z;
+  double *dense1, *dense2, *sym1, *diag1, trmat1[4], trmat2[4];
+  double *mats[2];
+  float *centro1f, *centro2f, *centro3f, *centro4f, *bisym1f, *bisym2f;
+  square_alloc(&matfull, dimsmall);
+  square_alloc(&dense1, dimsmall);
+  square_alloc(&dense2, dimsmall);
+  symmat_alloc(&sym1, dimsmall);
+  centrosym_alloc(&matcomp1, dimsmall);
+  centrosym_alloc(&matcomp2, dimsmall);
+  centrosym_alloc(&matcomp3, dimsmall);
+  centrosym_alloc(&matcomp4, dimsmall);
+  bisym_alloc(&bisym1, dimsmall);
+  bisym_alloc(&bisym2, dimsmall);
+  toeplitz_alloc(&toep, dimsmall);
+  x = workspace_calloc(3 * dimsmall);
+  y = x + dimsmall;
+  z = y + dimsmall;
+  bisym_full_random(matfull, dimsmall);
+  centrosym_full_extractcomp(matcomp1, matfull, dimsmall);
+  bisym_full_extractcomp(bisym1, matfull, dimsmall);
+  toeplitz_full_extractcomp(toep, matfull, dimsmall);
+  toep[0] += 2 * dimsmall;
+  bisym_full_random(matfull, dimsmall);
+  centrosym_full_extractcomp(matcomp2, matfull, dimsmall);
+  bisym_full_extractcomp(bisym2, matfull, dimsmall);
+  vector_random(x, dimsmall);
+  vector_random(y, dimsmall);
+
+  symmat_full_extractcomp(sym1, matfull, dimsmall);
+  centrodiag_alloc(&diag1, dimsmall);
+  centrodiag_from_centrosym(diag1, matcomp2, dimsmall);
+  mats[0] = matcomp1;
+  mats[1] = matcomp2;
+  centrosym_alloc_f(&centro1f, dimsmall);
+  centrosym_alloc_f(&centro2f, dimsmall);
+  centrosym_alloc_f(&centro3f, dimsmall);
+  centrosym_alloc_f(&centro4f, dimsmall);
+  bisym_alloc_f(&bisym1f, dimsmall);
+  bisym_alloc_f(&bisym2f, dimsmall);
+  vector_to_float(centro1f, matcomp1, centrosym_size(dimsmall));
+  vector_to_float(centro2f, matcomp2, centrosym_size(dimsmall));
+  vector_to_float(bisym1f, bisym1, bisym_size(dimsmall));
+  vector_to_float(bisym2f, bisym2, bisym_size(dimsmall));
+
+  workspace_init(&ws, 16 * workspace_bytes(centrosym_size(dimsmall)) + 2 * workspace_bytes((size_t)dimsmall * (dimsmall + 16))
+    + parallel_threads() * workspace_bytes((size_t)(tiling_size() + 1) * 4 * dimsmall + centrosym_size(dimsmall)), 0);
+  if( centrosym_traceprod_ws(matcomp1, matcomp2, dimsmall, &ws) != centrosym_traceprod(matcomp1, matcomp2, dimsmall) ) printf("centrosym_traceprod_ws is wrong\n");
+  if( centrosym_traceprod2_ws(matcomp1, matcomp2, dimsmall, &ws) != centrosym_traceprod2(matcomp1, matcomp2, dimsmall) ) printf("centrosym_traceprod2_ws is wrong\n");
+  centrosym_product(matcomp3, matcomp1, matcomp2, dimsmall);
+  centrosym_product_ws(matcomp4, matcomp1, matcomp2, dimsmall, &ws);
+  if( centrosym_assertequal(matcomp4, matcomp3, dimsmall) == 0 ) printf("centrosym_product_ws is wrong\n");
+  centrosym_matvec(z, matcomp1, x, dimsmall);
+  centrosym_matvec_ws(y, matcomp1, x, dimsmall, &ws);
+  if( memcmp(y, z, dimsmall * sizeof(double)) != 0 ) printf("centrosym_matvec_ws is wrong\n");
+  vector_random(y, dimsmall);
+  centrosym_times_dense(dense1, matcomp1, matfull, dimsmall, dimsmall);
+  centrosym_times_dense_ws(dense2, matcomp1, matfull, dimsmall, dimsmall, &ws);
+  if( memcmp(dense1, dense2, (size_t)dimsmall * dimsmall * sizeof(double)) != 0 ) printf("centrosym_times_dense_ws is wrong\n");
+  dense_times_centrosym(dense1, matfull, matcomp1, dimsmall, dimsmall);
+  dense_times_centrosym_ws(dense2, matfull, matcomp1, dimsmall, dimsmall, &ws);
+  if( memcmp(dense1, dense2, (size_t)dimsmall * dimsmall * sizeof(double)) != 0 ) printf("dense_times_centrosym_ws is wrong\n");
+  centrosym_traceprod_batch(trmat1, mats, 2, mats, 2, dimsmall);
+  centrosym_traceprod_batch_ws(trmat2, mats, 2, mats, 2, dimsmall, &ws);
+  if( memcmp(trmat1, trmat2, sizeof(trmat1)) != 0 ) printf("centrosym_traceprod_batch_ws is wrong\n");
+  symmat_product(dense1, sym1, sym1, dimsmall);
+  symmat_product_ws(dense2, sym1, sym1, dimsmall, &ws);
+  if( memcmp(dense1, dense2, (size_t)dimsmall * dimsmall * sizeof(double)) != 0 ) printf("symmat_product_ws is wrong\n");
+  symmat_matmat(dense1, sym1, matfull, dimsmall, dimsmall);
+  symmat_matmat_ws(dense2, sym1, matfull, dimsmall, dimsmall, &ws);
+  if( memcmp(dense1, dense2, (size_t)dimsmall * dimsmall * sizeof(double)) != 0 ) printf("symmat_matmat_ws is wrong\n");
+  if( square_traceprod_ws(matfull, dense1, dimsmall, &ws) != square_traceprod(matfull, dense1, dimsmall) ) printf("square_traceprod_ws is wrong\n");
+  // Mixed precision products, accumulated in double precision buffers
+  centrosym_product_fd(centro3f, centro1f, centro2f, dimsmall);
+  centrosym_product_ws_fd(centro4f, centro1f, centro2f, dimsmall, &ws);
+  if( memcmp(centro3f, centro4f, centrosym_size(dimsmall) * sizeof(float)) != 0 ) printf("centrosym_product_ws_fd is wrong\n");
+  bisym_product_fd(centro3f, bisym1f, bisym2f, dimsmall);
+  bisym_product_ws_fd(centro4f, bisym1f, bisym2f, dimsmall, &ws);
+  if( memcmp(centro3f, centro4f, centrosym_size(dimsmall) * sizeof(float)) != 0 ) printf("bisym_product_ws_fd is wrong\n");
+  square_product_ws_fd(centro4f, centro1f, centro2f, dimsmall / 2, &ws);
+  square_product_fd(centro3f, centro1f, centro2f, dimsmall / 2);
+  if( memcmp(centro3f, centro4f, (size_t)(dimsmall / 2) * (dimsmall / 2) * sizeof(float)) != 0 ) printf("square_product_ws_fd is wrong\n");
+  if( bisym_quadform_ws(x, bisym1, y, dimsmall, &ws) != bisym_quadform(x, bisym1, y, dimsmall) ) printf("bisym_quadform_ws is wrong\n");
+  bisym_matvec(z, bisym1, x, dimsmall);
+  bisym_matvec_ws(y, bisym1, x, dimsmall, &ws);
+  if( memcmp(y, z, dimsmall * sizeof(double)) != 0 ) printf("bisym_matvec_ws is wrong\n");
+  centrodiag_matvec(z, diag1, x, dimsmall);
+  centrodiag_matvec_ws(y, diag1, x, dimsmall, &ws);
+  if( memcmp(y, z, dimsmall * sizeof(double)) != 0 ) printf("centrodiag_matvec_ws is wrong\n");
+  vector_random(y, dimsmall);
+  if( toeplitz_quadform_ws(x, toep, y, dimsmall, &ws) != toeplitz_quadform(x, toep, y, dimsmall) ) printf("toeplitz_quadform_ws is wrong\n");
+  if( toeplitz_logdet_ws(toep, dimsmall, &ws) != toeplitz_logdet(toep, dimsmall) ) printf("toeplitz_logdet_ws is wrong\n");
+  toeplitz_solve(z, toep, x, dimsmall);
+  toeplitz_solve_ws(y, toep, x, dimsmall, &ws);
+  if( memcmp(y, z, dimsmall * sizeof(double)) != 0 ) printf("toeplitz_solve_ws is wrong\n");
+  centrosym_product_blockdiag(matcomp3, matcomp1, matcomp2, dimsmall);
+  centrosym_product_blockdiag_ws(matcomp1, matcomp1, matcomp2, dimsmall, &ws);
+  if( centrosym_assertequal(matcomp1, matcomp3, dimsmall) == 0 ) printf("centrosym_product_blockdiag_ws is wrong\n");
+  bisym_product(matcomp3, bisym1, bisym2, dimsmall);
+  bisym_product_ws(matcomp1, bisym1, bisym2, dimsmall, &ws);
+  if( centrosym_assertequal(matcomp1, matcomp3, dimsmall) == 0 ) printf("bisym_product_ws is wrong\n");
+  if( ws.used != 0 ) printf("a kernel did not give back its workspace\n");
+
+  workspace_heap_stats(&nalloc0, NULL);
+  for( i = 0; i < 10; i++ ){
+    centrosym_traceprod_ws(matcomp1, matcomp2, dimsmall, &ws);
+    centrosym_traceprod2_ws(matcomp1, matcomp2, dimsmall, &ws);
+    centrosym_product_ws(matcomp4, matcomp1, matcomp2, dimsmall, &ws);
+    centrosym_matvec_ws(z, matcomp1, x, dimsmall, &ws);
+    centrosym_times_dense_ws(dense2, matcomp1, matfull, dimsmall, dimsmall, &ws);
+    dense_times_centrosym_ws(dense2, matfull, matcomp1, dimsmall, dimsmall, &ws);
+    centrosym_traceprod_batch_ws(trmat2, mats, 2, mats, 2, dimsmall, &ws);
+    symmat_product_ws(dense2, sym1, sym1, dimsmall, &ws);
+    symmat_matmat_ws(dense2, sym1, matfull, dimsmall, dimsmall, &ws);
+    square_traceprod_ws(matfull, dense1, dimsmall, &ws);
+    centrosym_product_ws_fd(centro4f, centro1f, centro2f, dimsmall, &ws);
+    bisym_product_ws_fd(centro4f, bisym1f, bisym2f, dimsmall, &ws);
+    square_product_ws_fd(centro4f, centro1f, centro2f, dimsmall / 2, &ws);
+    bisym_quadform_ws(x, bisym1, y, dimsmall, &ws);
+    bisym_matvec_ws(z, bisym1, x, dimsmall, &ws);
+    centrodiag_matvec_ws(z, diag1, x, dimsmall, &ws);
+    toeplitz_quadform_ws(x, toep, y, dimsmall, &ws);
+    toeplitz_solve_ws(z, toep, x, dimsmall, &ws);
+    toeplitz_logdet_ws(toep, dimsmall, &ws);
+    centrosym_product_blockdiag_ws(matcomp3, matcomp1, matcomp2, dimsmall, &ws);
+    bisym_product_ws(matcomp3, bisym1, bisym2, dimsmall, &ws);
+  }
+  workspace_heap_stats(&nalloc1, NULL);
+  if( nalloc1 != nalloc0 || ws.nheap != 0 ) printf("kernels with a workspace still allocate (%li)\n", nalloc1 - nalloc0);
+  printf("> Workspace peak for dimension %i : %.1f kB in %li buffers\n", dimsmall, ws.peak / 1024.0, ws.ntake);
+  workspace_free(&ws);
+
+  // Benchmark repeated small calls with and without a workspace
+  res1 = res2 = 0.0;
+  workspace_init(&ws, 8 * workspace_bytes(fft_size(2 * dimsmall)), 0);
+  fflush(NULL); t1 = timer_now();
+  for( i = 0; i < NCALL; i++ )
+    res1 += toeplitz_quadform(x, toep, y, dimsmall) + centrosym_traceprod(matcomp1, matcomp2, dimsmall);
+  fflush(NULL); t2 = timer_now();
+  tmean_heap = (t2 - t1) / NCALL;
+  fflush(NULL); t1 = timer_now();
+  for( i = 0; i < NCALL; i++ )
+    res2 += toeplitz_quadform_ws(x, toep, y, dimsmall, &ws) + centrosym_traceprod_ws(matcomp1, matcomp2, dimsmall, &ws);
+  fflush(NULL); t2 = timer_now();
+  tmean_ws = (t2 - t1) / NCALL;
+  if( res1 != res2 ) printf("kernels with a workspace are wrong\n");
+  printf("> Workspace acceleration factor (dimension %i) : %2.2f \n", dimsmall, tmean_heap / tmean_ws);
+  workspace_free(&ws);
+
+  free(matfull);
+  free(diag1);
+  free(matcomp1);
+  free(matcomp2);
+  free(matcomp3);
+  free(matcomp4);
+  free(dense1);
+  free(dense2);
+  free(sym1);
+  free(centro1f);
+  free(centro2f);
+  free(centro3f);
+  free(centro4f);
+  free(bisym1f);
+  free(bisym2f);
+  free(bisym1);
+  free(bisym2);
+  free(toep);
+  free(x);
+
+  printf("----------------------------------------------");
+
+}
+
+
+void test_indexing(void)
+{
+  int k, dim;
+  long i, n;
+  int failed = 0;
+  double t1, t2;
+  const int dims[5] = { 46341, 65535, 65536, 70001, 1000001 };
+
+  printf("\n==============================================\n");
+  printf("Testing 64-bit indexing\n");
+  printf("----------------------------------------------\n");
+
+  // Last elements and row lengths of every format, past the 32-bit boundaries
+  // (dim*dim > 2^31 from 46341, dim*(dim+1)/2 > 2^31 from 65536)
+  for( k = 0; k < 5; k++ ){
+    dim = dims[k];
+    const double sq = (double)dim * dim, tri = (double)dim * (dim + 1) / 2;
+    const double bi = dim % 2 == 0 ? (double)dim * (dim + 2) / 4 : (double)(dim / 2) * (dim / 2 + 2) + 1;
+    if( square_ind(dim-1,dim-1,dim) != (long)sq - 1 ) failed++;
+    if( centrosym_size(dim) != (long)tri || centrosym_ind(dim-1,dim-1,dim) != (long)tri - 1 ) failed++;
+    if( centrosym_ind2(dim-1,0,dim) != (long)tri - 1 || centrodiag_ind(dim-1,0,dim) != (long)tri - 1 ) failed++;
+    if( centrodiag_size(dim) != (long)tri || centrodiag_diag(dim-1,dim) != (long)tri - 1 ) failed++;
+    if( symmat_size(dim) != (long)tri || symmat_ind(dim-1,dim-1,dim) != (long)tri - 1 ) failed++;
+    if( bisym_size(dim) != (long)bi || bisym_ind(dim-1,0,dim) != (long)bi - 1 ) failed++;
+    if( centrosym_ind(dim-1,0,dim) - centrosym_ind(dim-2,0,dim) != dim - 1 ) failed++;
+    if( bisym_ind(dim/2+1,0,dim) - bisym_ind(dim/2,0,dim) != MIN(dim/2, dim-dim/2-1) + 1 ) failed++;
+  }
+  if( failed ) printf("64-bit indexing is wrong (%i failures)\n", failed);
+
+#ifdef __linux__
+  // Rows of a packed matrix of 19.6 GB, in a sparse mapping: only the pages written are allocated
+  double *row, *mat;
+  dim = 70001;
+  n = centrosym_size(dim);
+  mat = (double*)mmap(NULL, n * sizeof(double), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if( mat != MAP_FAILED ){
+    row = (double*)calloc(dim, sizeof(double));
+    for( i = 0; i < dim; i++ )
+      mat[ centrosym_ind(dim-1,i,dim) ] = i + 1;
+    // A(0,j) = A(dim-1,dim-j-1) for j > 0
+    centrosym_getrow(row, mat, 0, 1, dim, dim);
+    for( i = 1; i < dim; i++ )
+      if( row[i-1] != dim - i ){
+        printf("centrosym_getrow is wrong past 2^31 elements\n");
+        break;
+      }
+    symmat_getrow(row, mat, dim-1, 0, dim, dim);
+    for( i = 0; i < dim; i++ )
+      if( row[i] != i + 1 ){
+        printf("symmat_getrow is wrong past 2^31 elements\n");
+        break;
+      }
+    free(row);
+    munmap(mat, n * sizeof(double));
+  } else {
+    printf("> Sparse mapping of %.1f GB not available, skipped\n", n * sizeof(double) / 1e9);
+  }
+
+  // Vectorised kernels over more than 2^30 elements (split in 32-bit chunks), with
+  // nonzero elements on both sides of the boundary
+  n = (1L << 30) + 100;
+  mat = (double*)mmap(NULL, 2 * n * sizeof(double), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if( mat != MAP_FAILED ){
+    double *x = mat, *y = mat + n, dxy[2];
+    x[0] = x[n-1] = x[(1L << 30) - 1] = x[1L << 30] = 1.0;
+    y[0] = 2.0;
+    y[n-1] = 3.0;
+    y[(1L << 30) - 1] = 5.0;
+    y[1L << 30] = 7.0;
+    fflush(NULL); t1 = timer_now();
+    if( simd_dot(x, y, n) != 17.0 ) printf("simd_dot is wrong past 2^30 elements\n");
+    fflush(NULL); t2 = timer_now();
+    // x[t] meets y[n-t-1]: (0,n-1), (2^30-1,100), (2^30,99), (n-1,0)
+    if( simd_dotrev(x, y, n) != 5.0 ) printf("simd_dotrev is wrong past 2^30 elements\n");
+    simd_dot2(dxy, x, x, y, n);
+    if( dxy[0] != 4.0 || dxy[1] != 17.0 ) printf("simd_dot2 is wrong past 2^30 elements\n");
+    munmap(mat, 2 * n * sizeof(double));
+    printf("> Dot product of %li elements : %2.2f s\n", n, t2 - t1);
+  }
+#endif
+
+  printf("----------------------------------------------");
+
+}
+
+
+void test_matfile(int dim)
+{
+  int i, n;
+  long t;
+  double t1, t2, tload_text, tload_bin;
+  char filename[512], textname[512];
+  matfile mf;
+  matfile_writer w;
+  FILE *fp;
+  const char *tmpdir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+  const char *msg = "Nobody inspects the spammish repetition";
+
+  printf("\n==============================================\n");
+  printf("Testing binary matrix files\n");
+  printf("----------------------------------------------\n");
+
+  snprintf(filename, sizeof(filename), "%s/symtrx_test_%i.mat", tmpdir, (int)getpid());
+  snprintf(textname, sizeof(textname), "%s/symtrx_test_%i.txt", tmpdir, (int)getpid());
+
+  // Known answers of the checksum (XXH64)
+  if( matfile_checksum("", 0) != 0xEF46DB3751D8E999ULL ) printf("matfile_checksum is wrong for an empty input\n");
+  if( matfile_checksum("a", 1) != 0xD24EC4F1A98C6E5BULL ) printf("matfile_checksum is wrong for a short input\n");
+  if( matfile_checksum(msg, strlen(msg)) != 0xFBCEA83C8A378BF1ULL ) printf("matfile_checksum is wrong for a long input\n");
+
+  // Round trips of every type, used in place by the kernels
+  double *matfull, *matcomp, *matdiag, *matbisym;
+  square_alloc(&matfull, dim);
+  centrosym_alloc(&matcomp, dim);
+  centrodiag_alloc(&matdiag, dim);
+  bisym_alloc(&matbisym, dim);
+  bisym_full_random(matfull, dim);
+  centrosym_full_extractcomp(matcomp, matfull, dim);
+  centrodiag_from_centrosym(matdiag, matcomp, dim);
+  bisym_full_extractcomp(matbisym, matfull, dim);
+
+  const int types[6] = { MATFILE_SQUARE, MATFILE_CENTROSYM, MATFILE_CENTROSYM, MATFILE_BISYM, MATFILE_SYMMAT, MATFILE_TOEPLITZ };
+  const int layouts[6] = { MATFILE_ROWMAJOR, MATFILE_ROWMAJOR, MATFILE_DIAGMAJOR, MATFILE_ROWMAJOR, MATFILE_ROWMAJOR, MATFILE_ROWMAJOR };
+  double *payloads[6] = { matfull, matcomp, matdiag, matbisym, matcomp, matfull };
+  for( i = 0; i < 6; i++ ){
+    if( matfile_write(filename, types[i], layouts[i], dim, payloads[i]) == 0 ){
+      printf("matfile_write failed (type %i)\n", types[i]);
+      continue;
+    }
+    if( matfile_open(&mf, filename, MATFILE_VERIFY) == 0 ){
+      printf("matfile_open failed (type %i)\n", types[i]);
+      continue;
+    }
+    if( mf.header.dim != dim || mf.header.type != (uint32_t)types[i] || mf.header.layout != (uint32_t)layouts[i]
+        || memcmp(mf.data, payloads[i], matfile_size(types[i], layouts[i], dim) * sizeof(double)) != 0 )
+      printf("matfile round trip is wrong (type %i)\n", types[i]);
+    if( (size_t)mf.data % WORKSPACE_ALIGN != 0 ) printf("matfile payload is not aligned\n");
+    matfile_close(&mf);
+  }
+  matfile_write(filename, MATFILE_CENTROSYM, MATFILE_DIAGMAJOR, dim, matdiag);
+  matfile_open(&mf, filename, 0);
+  if( centrodiag_traceprod(mf.data, matdiag, dim) != centrodiag_traceprod(matdiag, matdiag, dim) ) printf("centrodiag_traceprod is wrong on a mapped file\n");
+  matfile_close(&mf);
+  matfile_write(filename, MATFILE_BISYM, MATFILE_ROWMAJOR, dim, matbisym);
+  matfile_open(&mf, filename, 0);
+  if( bisym_traceprod(mf.data, mf.data, dim) != bisym_traceprod(matbisym, matbisym, dim) ) printf("bisym_traceprod is wrong on a mapped file\n");
+  matfile_close(&mf);
+  // The kernels take the mapped payload as it is (const), without a cast
+  double *prodref, *prodmap;
+  centrosym_alloc(&prodref, dim);
+  centrosym_alloc(&prodmap, dim);
+  matfile_write(filename, MATFILE_CENTROSYM, MATFILE_ROWMAJOR, dim, matcomp);
+  matfile_open(&mf, filename, 0);
+  centrosym_product(prodref, matcomp, matcomp, dim);
+  centrosym_product(prodmap, mf.data, mf.data, dim);
+  if( memcmp(prodmap, prodref, centrosym_size(dim) * sizeof(double)) != 0 ) printf("centrosym_product is wrong on a mapped file\n");
+  if( centrosym_quadform(matfull, mf.data, matfull, dim) != centrosym_quadform(matfull, matcomp, matfull, dim) ) printf("centrosym_quadform is wrong on a mapped file\n");
+  matfile_close(&mf);
+  free(prodref);
+  free(prodmap);
+
+  // Read-only mapping by default, and a copy-on-write view on request which leaves the file unchanged
+  matfile_open(&mf, filename, 0);
+  if( mf.writable != NULL ) printf("matfile_open maps a writable view without MATFILE_WRITABLE\n");
+  matfile_close(&mf);
+  if( matfile_open(&mf, filename, MATFILE_WRITABLE) == 0 || mf.writable != mf.data ) printf("matfile_open with MATFILE_WRITABLE failed\n");
+  else mf.writable[0] += 1.0;
+  matfile_close(&mf);
+  if( matfile_open(&mf, filename, MATFILE_VERIFY) == 0 ) printf("a write to the copy-on-write view changed the file\n");
+  matfile_close(&mf);
+
+  // Streaming write in uneven pieces: same file as a single write
+  if( matfile_size(MATFILE_BISYM, MATFILE_DIAGMAJOR, dim) != -1 ) printf("matfile_size accepts a diagonal-major bisymmetric matrix\n");
+  matfile_writer_open(&w, filename, MATFILE_CENTROSYM, MATFILE_ROWMAJOR, dim);
+  for( t = 0, n = 1; t < centrosym_size(dim); t += n, n = 2 * n + 1 )
+    matfile_writer_append(&w, matcomp + t, MIN(n, centrosym_size(dim) - t));
+  if( matfile_writer_append(&w, matcomp, 1) != 0 ) printf("matfile_writer_append writes past the payload\n");
+  if( matfile_writer_close(&w) == 0 ) printf("matfile_writer_close failed\n");
+  if( matfile_open(&mf, filename, MATFILE_VERIFY) == 0 ) printf("streamed matfile is invalid\n");
+  else if( mf.header.checksum != matfile_checksum(matcomp, centrosym_size(dim) * sizeof(double)) ) printf("streamed matfile has a wrong checksum\n");
+  matfile_close(&mf);
+
+  // Corrupted, truncated and unfinished files are rejected
+  fp = fopen(filename, "r+b");
+  fseek(fp, MATFILE_HEADER_SIZE + 8 * dim + 3, SEEK_SET);
+  fputc(0x5a ^ fgetc(fp), fp);
+  fclose(fp);
+  if( matfile_open(&mf, filename, MATFILE_VERIFY) != 0 ) printf("matfile_open accepts a corrupted payload\n");
+  if( matfile_open(&mf, filename, 0) == 0 ) printf("matfile_open rejects a file without verification\n");
+  matfile_close(&mf);
+  if( truncate(filename, MATFILE_HEADER_SIZE + 8 * dim) != 0 || matfile_open(&mf, filename, 0) != 0 ) printf("matfile_open accepts a truncated file\n");
+  matfile_writer_open(&w, filename, MATFILE_CENTROSYM, MATFILE_ROWMAJOR, dim);
+  matfile_writer_append(&w, matcomp, dim);
+  if( matfile_writer_close(&w) != 0 ) printf("matfile_writer_close accepts an incomplete payload\n");
+  if( matfile_open(&mf, filename, 0) != 0 ) printf("matfile_open accepts an unfinished file\n");
+
+  // Benchmark the load of a centrosymmetric matrix against parsing its full form as text
+  fp = fopen(textname, "w");
+  for( t = 0; t < (long)dim * dim; t++ )
+    fprintf(fp, "%.17g\n", matfull[t]);
+  fclose(fp);
+  matfile_write(filename, MATFILE_CENTROSYM, MATFILE_ROWMAJOR, dim, matcomp);
+  fflush(NULL); t1 = timer_now();
+  fp = fopen(textname, "r");
+  for( t = 0; t < (long)dim * dim; t++ )
+    if( fscanf(fp, "%lf", matfull + t) != 1 ) break;
+  fclose(fp);
+  centrosym_full_extractcomp(matdiag, matfull, dim);
+  fflush(NULL); t2 = timer_now();
+  tload_text = t2 - t1;
+  fflush(NULL); t1 = timer_now();
+  matfile_open(&mf, filename, MATFILE_VERIFY);
+  fflush(NULL); t2 = timer_now();
+  tload_bin = t2 - t1;
+  if( centrosym_assertequal(mf.data, matdiag, dim) == 0 ) printf("matfile and text loads differ\n");
+  matfile_close(&mf);
+  printf("> Load acceleration factor over text (with checksum) : %2.2f \n", tload_text / tload_bin);
+
+  remove(filename);
+  remove(textname);
+  free(matfull);
+  free(matcomp);
+  free(matdiag);
+  free(matbisym);
+
+  printf("----------------------------------------------");
+
+}
+
+
+void test_outofcore(int dim)
+{
+  double t1, t2, tmem;
+  char file1[512], file2[512], outfile[512];
+  outofcore_stats stats;
+  matfile mf;
+  const char *tmpdir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+  const size_t matbytes = centrosym_size(dim) * sizeof(double);
+
+  printf("\n==============================================\n");
+  printf("Testing out-of-core products\n");
+  printf("----------------------------------------------\n");
+
+  snprintf(file1, sizeof(file1), "%s/symtrx_test_%i_1.mat", tmpdir, (int)getpid());
+  snprintf(file2, sizeof(file2), "%s/symtrx_test_%i_2.mat", tmpdir, (int)getpid());
+  snprintf(outfile, sizeof(outfile), "%s/symtrx_test_%i_3.mat", tmpdir, (int)getpid());
+
+  double *mat1, *mat2, *matprod;
+  centrosym_alloc(&mat1, dim);
+  centrosym_alloc(&mat2, dim);
+  centrosym_alloc(&matprod, dim);
+  centrosym_random(mat1, dim, 1, 21);
+  centrosym_random(mat2, dim, 1, 22);
+  matfile_write(file1, MATFILE_CENTROSYM, MATFILE_ROWMAJOR, dim, mat1);
+  matfile_write(file2, MATFILE_CENTROSYM, MATFILE_ROWMAJOR, dim, mat2);
+
+  fflush(NULL); t1 = timer_now();
+  centrosym_product(matprod, mat1, mat2, dim);
+  fflush(NULL); t2 = timer_now();
+  tmem = t2 - t1;
+
+  // Budget of one operand (the in-memory product needs three): several stripes, each a pass over mat2
+  if( outofcore_centrosym_product(outfile, file1, file2, matbytes, &stats) == 0 )
+    printf("outofcore_centrosym_product failed\n");
+  if( stats.nstripes < 2 || stats.memory > matbytes ) printf("outofcore_plan is wrong\n");
+  if( matfile_open(&mf, outfile, MATFILE_VERIFY) == 0 )
+    printf("outofcore_centrosym_product wrote an invalid file\n");
+  else if( centrosym_assertequal(mf.data, matprod, dim) == 0 )
+    printf("outofcore_centrosym_product is wrong\n");
+  matfile_close(&mf);
+  printf("> Stripes of %i rows, panels of %i rows, %.0f kB of buffers\n", stats.stripe, stats.panel, stats.memory / 1e3);
+  printf("> Bytes read over payloads : %2.2f \n", stats.nread / (2.0 * matbytes));
+  printf("> Time waiting for reads   : %2.2f %% \n", 100.0 * stats.twait / stats.ttotal);
+  printf("> Slowdown over in-memory product : %2.2f \n", stats.ttotal / tmem);
+
+  // Smallest budgets: panels of a single row, stripes of a single row
+  if( outofcore_plan(&stats, dim, 4 * matbytes) == 0 || stats.stripe != dim ) printf("outofcore_plan does not fit in memory\n");
+  outofcore_plan(&stats, dim, 1);
+  if( stats.stripe != 0 ) printf("outofcore_plan accepts a tiny budget\n");
+  size_t budget = 64 * dim;
+  while( outofcore_plan(&stats, dim, budget) == 0 )
+    budget += budget / 8;
+  if( stats.stripe != 1 ) printf("outofcore_plan is wrong for the smallest budget\n");
+  if( outofcore_centrosym_product(outfile, file1, file2, budget, &stats) == 0 || stats.nstripes != dim )
+    printf("outofcore_centrosym_product failed with the smallest budget\n");
+  else if( matfile_open(&mf, outfile, MATFILE_VERIFY) == 0 || centrosym_assertequal(mf.data, matprod, dim) == 0 )
+    printf("outofcore_centrosym_product is wrong with the smallest budget\n");
+  matfile_close(&mf);
+
+  // Failures: budget too small, mismatched or missing operands, no file left behind
+  remove(outfile);
+  if( outofcore_centrosym_product(outfile, file1, file2, 1, &stats) != 0 ) printf("outofcore_centrosym_product accepts a tiny budget\n");
+  matfile_write(file2, MATFILE_CENTROSYM, MATFILE_ROWMAJOR, dim - 1, mat2);
+  if( outofcore_centrosym_product(outfile, file1, file2, matbytes, &stats) != 0 ) printf("outofcore_centrosym_product accepts mismatched dimensions\n");
+  matfile_write(file2, MATFILE_BISYM, MATFILE_ROWMAJOR, dim, mat2);
+  if( outofcore_centrosym_product(outfile, file1, file2, matbytes, &stats) != 0 ) printf("outofcore_centrosym_product accepts a bisymmetric matrix\n");
+  remove(file2);
+  if( outofcore_centrosym_product(outfile, file1, file2, matbytes, &stats) != 0 ) printf("outofcore_centrosym_product accepts a missing file\n");
+  if( access(outfile, F_OK) == 0 ) printf("outofcore_centrosym_product left an invalid file\n");
+
+  remove(file1);
+  remove(outfile);
+  free(mat1);
+  free(mat2);
+  free(matprod);
+
+  printf("----------------------------------------------");
+
+}
+
+
 void test_centrosym(int NREPEAT, int dim)
 {
-  int res, irepeat;
-  clock_t t1, t2;
-  double tmean_product_full=0, tmean_product_comp=0;
+  int res, irepeat, dimsmall, i, imatvec;
+  const int NMATVEC = 100, NVEC = 16;
+  double t1, t2;
+  double tmean_product_full=0, tmean_product_comp=0, tmean_product_blockdiag=0;
   double tmean_traceprod_full=0, tmean_traceprod_comp=0;
   double tmean_traceprodnaive_full=0, tmean_traceprodnaive_comp=0;
   double tmean_quadform_full=0, tmean_quadform_comp=0;
+  double tmean_matvec_full=0, tmean_matvec_comp=0, tmean_matmat_full=0, tmean_matmat_comp=0;
+  double tmean_matvec_full_large=0, tmean_matvec_comp_large=0;
 
   printf("\n==============================================\n");
   printf("Testing properties of centrosymmetric matrices\n");
   printf("----------------------------------------------\n");
+
+  // Check the products against the full product for small even and odd sizes,
+  // with a tiny tile size so that the blocked loops have partial tiles,
+  // and with more threads than chunks of rows
+  tiling_set(2);
+  parallel_set_threads(3);
+  for( dimsmall = 1; dimsmall <= 9; dimsmall++ ){
+    double *matfull1, *matfull2, *matfull3;
+    square_alloc(&matfull1, dimsmall);
+    square_alloc(&matfull2, dimsmall);
+    square_alloc(&matfull3, dimsmall);
+    centrosym_full_random(matfull1, dimsmall);
+    centrosym_full_random(matfull2, dimsmall);
+    square_product(matfull3, matfull1, matfull2, dimsmall);
+    double *matcomp1, *matcomp2, *matcomp3, *matcomp4;
+    centrosym_alloc(&matcomp1, dimsmall);
+    centrosym_alloc(&matcomp2, dimsmall);
+    centrosym_alloc(&matcomp3, dimsmall);
+    centrosym_alloc(&matcomp4, dimsmall);
+    centrosym_full_extractcomp(matcomp1, matfull1, dimsmall);
+    centrosym_full_extractcomp(matcomp2, matfull2, dimsmall);
+    centrosym_full_extractcomp(matcomp3, matfull3, dimsmall);
+    res = centrosym_isvalid(matfull3, dimsmall);
+    if(res == 0) printf("full product is not centrosymmetric for dim = %i\n", dimsmall);
+    centrosym_product(matcomp4, matcomp1, matcomp2, dimsmall);
+    res = centrosym_assertequal(matcomp4, matcomp3, dimsmall);
+    if(res == 0) printf("compressed product is wrong for dim = %i\n", dimsmall);
+    centrosym_product_blockdiag(matcomp4, matcomp1, matcomp2, dimsmall);
+    res = centrosym_assertequal(matcomp4, matcomp3, dimsmall);
+    if(res == 0) printf("block diagonal product is wrong for dim = %i\n", dimsmall);
+    double *x = (double*)calloc(3 * dimsmall, sizeof(double));
+    double *y = (double*)calloc(3 * dimsmall, sizeof(double));
+    double *z = (double*)calloc(3 * dimsmall, sizeof(double));
+    vector_random(x, 3 * dimsmall);
+    square_matvec(y, matfull1, x, dimsmall);
+    centrosym_matvec(z, matcomp1, x, dimsmall);
+    for( i = 0; i < dimsmall; i++ )
+      if( fabs(y[i] - z[i]) > 1e-12 * dimsmall ){
+        printf("matrix-vector product is wrong for dim = %i\n", dimsmall);
+        break;
+      }
+    square_matmat(y, matfull1, x, 3, dimsmall);
+    centrosym_times_dense(z, matcomp1, x, 3, dimsmall);
+    for( i = 0; i < 3 * dimsmall; i++ )
+      if( fabs(y[i] - z[i]) > 1e-12 * dimsmall ){
+        printf("matrix-panel product is wrong for dim = %i\n", dimsmall);
+        break;
+      }
+    free(x);
+    free(y);
+    free(z);
+    free(matfull1);
+    free(matfull2);
+    free(matfull3);
+    free(matcomp1);
+    free(matcomp2);
+    free(matcomp3);
+    free(matcomp4);
+  }
+  tiling_set(0);
+  parallel_set_threads(0);
+
   printf("Performing benchmark");
 
   for( irepeat = 0; irepeat < NREPEAT; irepeat++ ){
@@ -54,12 +887,12 @@ void test_centrosym(int NREPEAT, int dim)
     // Perform the product in full form
     double *matfull3;
     square_alloc(&matfull3, dim);
-    fflush(NULL); t1 = clock();
+    fflush(NULL); t1 = timer_now();
     square_product(matfull3, matfull1, matfull2, dim);
-    fflush(NULL); t2 = clock();
-    tmean_product_full += (double)(t2 - t1) / (double)CLOCKS_PER_SEC;
-    tmean_traceprodnaive_full += (double)(t2 - t1) / (double)CLOCKS_PER_SEC;
-    //printf("Matrix product in full form : %4.4e seconds\n",(t2 - t1) / (double)CLOCKS_PER_SEC);
+    fflush(NULL); t2 = timer_now();
+    tmean_product_full += (t2 - t1);
+    tmean_traceprodnaive_full += (t2 - t1);
+    //printf("Matrix product in full form : %4.4e seconds\n",(t2 - t1));
     double *matcomp3;
     centrosym_alloc(&matcomp3, dim);
     centrosym_full_extractcomp(matcomp3, matfull3, dim);
@@ -71,12 +904,12 @@ void test_centrosym(int NREPEAT, int dim)
     // Perform the product in compressed fonm
     double *matcomp4;
     centrosym_alloc(&matcomp4, dim);
-    fflush(NULL); t1 = clock();
+    fflush(NULL); t1 = timer_now();
     centrosym_product(matcomp4, matcomp1, matcomp2, dim);
-    fflush(NULL); t2 = clock();
-    tmean_product_comp += (double)(t2 - t1) / (double)CLOCKS_PER_SEC;
-    tmean_traceprodnaive_comp += (double)(t2 - t1) / (double)CLOCKS_PER_SEC;
-    //printf("Matrix product in comp form : %4.4e seconds\n",(t2 - t1) / (double)CLOCKS_PER_SEC);
+    fflush(NULL); t2 = timer_now();
+    tmean_product_comp += (t2 - t1);
+    tmean_traceprodnaive_comp += (t2 - t1);
+    //printf("Matrix product in comp form : %4.4e seconds\n",(t2 - t1));
 
     // Extract and compare the two results
     res = centrosym_assertequal(matcomp4, matcomp3, dim);
@@ -84,26 +917,36 @@ void test_centrosym(int NREPEAT, int dim)
     //centrosym_print(matcomp3, dim);
     //centrosym_print(matcomp4, dim);
 
+    // Perform the product through the half-size blocks
+    double *matcomp5;
+    centrosym_alloc(&matcomp5, dim);
+    fflush(NULL); t1 = timer_now();
+    centrosym_product_blockdiag(matcomp5, matcomp1, matcomp2, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_product_blockdiag += (t2 - t1);
+    res = centrosym_assertequal(matcomp5, matcomp3, dim);
+    if(res == 0) printf("matcomp5 is not equal to matcomp3\n");
+
     // Test the trace of a product
-    fflush(NULL); t1 = clock();
+    fflush(NULL); t1 = timer_now();
     double traceprodfull = square_traceprod(matfull1, matfull2, dim);
-    fflush(NULL); t2 = clock();
-    tmean_traceprod_full += (double)(t2 - t1) / (double)CLOCKS_PER_SEC;
-    fflush(NULL); t1 = clock();
+    fflush(NULL); t2 = timer_now();
+    tmean_traceprod_full += (t2 - t1);
+    fflush(NULL); t1 = timer_now();
     double traceprodcomp = centrosym_traceprod(matcomp1, matcomp2, dim);
-    fflush(NULL); t2 = clock();
-    tmean_traceprod_comp += (double)(t2 - t1) / (double)CLOCKS_PER_SEC;
-    if( abs(traceprodfull - traceprodcomp) > 1e-10 ) printf("traceprodcomp is not equal to traceprodfull\n");
+    fflush(NULL); t2 = timer_now();
+    tmean_traceprod_comp += (t2 - t1);
+    if( fabs(traceprodfull - traceprodcomp) > 1e-10 ) printf("traceprodcomp is not equal to traceprodfull\n");
 
-    fflush(NULL); t1 = clock();
+    fflush(NULL); t1 = timer_now();
     double traceprodfullnaive = square_trace(matfull3, dim);
-    fflush(NULL); t2 = clock();
-    tmean_traceprodnaive_comp += (double)(t2 - t1) / (double)CLOCKS_PER_SEC;
-    fflush(NULL); t1 = clock();
+    fflush(NULL); t2 = timer_now();
+    tmean_traceprodnaive_full += (t2 - t1);
+    fflush(NULL); t1 = timer_now();
     double traceprodcompnaive = centrosym_trace(matcomp4, dim);
-    fflush(NULL); t2 = clock();
-    tmean_traceprodnaive_full += (double)(t2 - t1) / (double)CLOCKS_PER_SEC;
-    if( abs(traceprodfullnaive - traceprodcompnaive) > 1e-10 ) printf("traceprodfullnaive is not equal to traceprodcompnaive\n");
+    fflush(NULL); t2 = timer_now();
+    tmean_traceprodnaive_comp += (t2 - t1);
+    if( fabs(traceprodfullnaive - traceprodcompnaive) > 1e-10 ) printf("traceprodfullnaive is not equal to traceprodcompnaive\n");
 
     // Generate random vectors
     double *x = (double*)calloc(dim, sizeof(double));
@@ -112,17 +955,54 @@ void test_centrosym(int NREPEAT, int dim)
     vector_random(y, dim);
 
     // Test quadratic forms
-    fflush(NULL);t1 = clock();
+    fflush(NULL);t1 = timer_now();
     double quadform_full = square_quadform(x, matfull3, y, dim);
-    fflush(NULL);t2 = clock();
-    tmean_quadform_full += (double)(t2 - t1) / (double)CLOCKS_PER_SEC;
-    fflush(NULL);t1 = clock();
+    fflush(NULL);t2 = timer_now();
+    tmean_quadform_full += (t2 - t1);
+    fflush(NULL);t1 = timer_now();
     double quadform_comp = centrosym_quadform(x, matcomp4, y, dim);
-    fflush(NULL);t2 = clock();
-    tmean_quadform_comp += (double)(t2 - t1) / (double)CLOCKS_PER_SEC;
+    fflush(NULL);t2 = timer_now();
+    tmean_quadform_comp += (t2 - t1);
     //printf("\n %f - %f = %2.2e\n",quadform_full,quadform_comp,quadform_full-quadform_comp);
-    if( abs(quadform_full - quadform_comp) > 1e-6 ) printf("quadform_full is not equal to quadform_comp\n");
+    if( fabs(quadform_full - quadform_comp) > 1e-6 ) printf("quadform_full is not equal to quadform_comp\n");
+
+    // Test matrix-vector and matrix-panel products (repeated, as in iterative methods)
+    double *yfull = (double*)calloc(dim * NVEC, sizeof(double));
+    double *ycomp = (double*)calloc(dim * NVEC, sizeof(double));
+    double *xpanel = (double*)calloc(dim * NVEC, sizeof(double));
+    vector_random(xpanel, dim * NVEC);
+    fflush(NULL);t1 = timer_now();
+    for( imatvec = 0; imatvec < NMATVEC; imatvec++ )
+      square_matvec(yfull, matfull3, x, dim);
+    fflush(NULL);t2 = timer_now();
+    tmean_matvec_full += (t2 - t1);
+    fflush(NULL);t1 = timer_now();
+    for( imatvec = 0; imatvec < NMATVEC; imatvec++ )
+      centrosym_matvec(ycomp, matcomp4, x, dim);
+    fflush(NULL);t2 = timer_now();
+    tmean_matvec_comp += (t2 - t1);
+    for( i = 0; i < dim; i++ )
+      if( fabs(yfull[i] - ycomp[i]) > 1e-10 * dim ){
+        printf("matvec_full is not equal to matvec_comp\n");
+        break;
+      }
+    fflush(NULL);t1 = timer_now();
+    square_matmat(yfull, matfull3, xpanel, NVEC, dim);
+    fflush(NULL);t2 = timer_now();
+    tmean_matmat_full += (t2 - t1);
+    fflush(NULL);t1 = timer_now();
+    centrosym_times_dense(ycomp, matcomp4, xpanel, NVEC, dim);
+    fflush(NULL);t2 = timer_now();
+    tmean_matmat_comp += (t2 - t1);
+    for( i = 0; i < dim * NVEC; i++ )
+      if( fabs(yfull[i] - ycomp[i]) > 1e-10 * dim ){
+        printf("matmat_full is not equal to matmat_comp\n");
+        break;
+      }
 
+    free(yfull);
+    free(ycomp);
+    free(xpanel);
 
     free(x);
     free(y);
@@ -133,6 +1013,7 @@ void test_centrosym(int NREPEAT, int dim)
     free(matfull3);
     free(matcomp3);
     free(matcomp4);
+    free(matcomp5);
 
   }
 
@@ -143,16 +1024,408 @@ void test_centrosym(int NREPEAT, int dim)
   //printf("Mean time for matrix product in full form : %4.4f seconds\n",tmean_product_full / (double)NREPEAT);
   //printf("Mean time for matrix product in comp form : %4.4f seconds\n",tmean_product_comp / (double)NREPEAT);
   printf("> Matrix product acceleration factor : %2.2f \n", (double)tmean_product_full / (double)tmean_product_comp );
+  printf("> Block diagonal product acceleration factor : %2.2f \n", (double)tmean_product_full / (double)tmean_product_blockdiag );
 
   //printf("Mean time for trace product in full form : %4.4f seconds\n",tmean_traceprod_full / (double)NREPEAT);
   //printf("Mean time for trace product in comp form : %4.4f seconds\n",tmean_traceprod_comp / (double)NREPEAT);
   //printf("Mean time for naive trace product in full form : %4.4f seconds\n",tmean_traceprodnaive_full / (double)NREPEAT);
   //printf("Mean time for naive trace product in comp form : %4.4f seconds\n",tmean_traceprodnaive_comp / (double)NREPEAT);
   printf("> Trace-product acceleration factor  : %2.2f \n", (double)tmean_traceprod_full / (double)tmean_traceprod_comp );
+  printf("> Naive trace-product (product then trace) acceleration factor : %2.2f \n", (double)tmean_traceprodnaive_full / (double)tmean_traceprodnaive_comp );
   
   //printf("Mean time for full quadratic form : %4.4f seconds\n",tmean_quadform_full / (double)NREPEAT);
   //printf("Mean time for compressed quadratic form : %4.4f seconds\n",tmean_quadform_comp / (double)NREPEAT);
+  // The matrix-vector products do the same flops in both forms, the compressed one reads half the memory:
+  // it only pays off once the matrix is out of the caches
+  {
+    const int dimlarge = 8 * dim;
+    double *matfull, *matcomp;
+    double *xlarge = (double*)calloc(dimlarge, sizeof(double));
+    double *ylarge = (double*)calloc(dimlarge, sizeof(double));
+    square_alloc(&matfull, dimlarge);
+    centrosym_alloc(&matcomp, dimlarge);
+    centrosym_full_random(matfull, dimlarge);
+    centrosym_full_extractcomp(matcomp, matfull, dimlarge);
+    vector_random(xlarge, dimlarge);
+    fflush(NULL);t1 = timer_now();
+    for( imatvec = 0; imatvec < NMATVEC / 10; imatvec++ )
+      square_matvec(ylarge, matfull, xlarge, dimlarge);
+    fflush(NULL);t2 = timer_now();
+    tmean_matvec_full_large += (t2 - t1);
+    fflush(NULL);t1 = timer_now();
+    for( imatvec = 0; imatvec < NMATVEC / 10; imatvec++ )
+      centrosym_matvec(ylarge, matcomp, xlarge, dimlarge);
+    fflush(NULL);t2 = timer_now();
+    tmean_matvec_comp_large += (t2 - t1);
+    free(matfull);
+    free(matcomp);
+    free(xlarge);
+    free(ylarge);
+  }
+
   printf("> Quadratic form acceleration factor : %2.2f \n", (double)tmean_quadform_full / (double)tmean_quadform_comp );
+  printf("> Matrix-vector product acceleration factor (in cache) : %2.2f \n", (double)tmean_matvec_full / (double)tmean_matvec_comp );
+  printf("> Matrix-vector product acceleration factor (dim = %i, out of cache) : %2.2f \n", 8 * dim, tmean_matvec_full_large / tmean_matvec_comp_large );
+  printf("> Matrix-panel product acceleration factor : %2.2f \n", (double)tmean_matmat_full / (double)tmean_matmat_comp );
+
+  printf("----------------------------------------------");
+
+}
+
+
+
+void test_centrosym_batch(int NREPEAT, int dim, int nmat)
+{
+  int res, irepeat, a, b, ndim, dims[3];
+  double t1, t2;
+  double tmean_traceprod_pairs=0, tmean_traceprod_batch=0;
+  double **mats1 = (double**)calloc(nmat, sizeof(double*));
+  double **mats2 = (double**)calloc(nmat, sizeof(double*));
+  double *trmat = (double*)calloc(nmat * nmat, sizeof(double));
+  double *trref = (double*)calloc(nmat * nmat, sizeof(double));
+  double *matfull;
+
+  printf("\n==============================================\n");
+  printf("Testing batched trace-products of centrosymmetric matrices\n");
+  printf("----------------------------------------------\n");
+
+  // Check against centrosym_traceprod for even and odd sizes, with one or two sets
+  dims[0] = 1; dims[1] = 7; dims[2] = 16;
+  for( ndim = 0; ndim < 3; ndim++ ){
+    square_alloc(&matfull, dims[ndim]);
+    for( a = 0; a < nmat; a++ ){
+      centrosym_alloc(&mats1[a], dims[ndim]);
+      centrosym_alloc(&mats2[a], dims[ndim]);
+      centrosym_full_random(matfull, dims[ndim]);
+      centrosym_full_extractcomp(mats1[a], matfull, dims[ndim]);
+      centrosym_full_random(matfull, dims[ndim]);
+      centrosym_full_extractcomp(mats2[a], matfull, dims[ndim]);
+    }
+    centrosym_traceprod_batch(trmat, mats1, nmat, mats2, nmat - 1, dims[ndim]);
+    res = 1;
+    for( a = 0; a < nmat; a++ )
+      for( b = 0; b < nmat - 1; b++ )
+        if( fabs(trmat[a*(nmat-1)+b] - centrosym_traceprod(mats1[a], mats2[b], dims[ndim])) > 1e-10 ) res = 0;
+    if(res == 0) printf("batched trace-products of two sets are wrong for dim = %i\n", dims[ndim]);
+    centrosym_traceprod_batch(trmat, mats1, nmat, mats1, nmat, dims[ndim]);
+    res = 1;
+    for( a = 0; a < nmat; a++ )
+      for( b = 0; b < nmat; b++ )
+        if( fabs(trmat[a*nmat+b] - centrosym_traceprod(mats1[a], mats1[b], dims[ndim])) > 1e-10 ) res = 0;
+    if(res == 0) printf("batched trace-products of one set are wrong for dim = %i\n", dims[ndim]);
+    for( a = 0; a < nmat; a++ ){
+      free(mats1[a]);
+      free(mats2[a]);
+    }
+    free(matfull);
+  }
+
+  printf("Performing benchmark");
+
+  square_alloc(&matfull, dim);
+  for( a = 0; a < nmat; a++ ){
+    centrosym_alloc(&mats1[a], dim);
+    centrosym_full_random(matfull, dim);
+    centrosym_full_extractcomp(mats1[a], matfull, dim);
+  }
+
+  for( irepeat = 0; irepeat < NREPEAT; irepeat++ ){
+    fflush(NULL);
+    printf(".");
+
+    fflush(NULL); t1 = timer_now();
+    for( a = 0; a < nmat; a++ )
+      for( b = 0; b < nmat; b++ )
+        trref[a*nmat+b] = centrosym_traceprod(mats1[a], mats1[b], dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_traceprod_pairs += (t2 - t1);
+
+    fflush(NULL); t1 = timer_now();
+    centrosym_traceprod_batch(trmat, mats1, nmat, mats1, nmat, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_traceprod_batch += (t2 - t1);
+
+    res = 1;
+    for( a = 0; a < nmat * nmat; a++ )
+      if( fabs(trmat[a] - trref[a]) > 1e-8 ) res = 0;
+    if(res == 0) printf("trmat is not equal to trref\n");
+  }
+
+  printf("done\n");
+  printf("> Number of matrices : %i\n", nmat);
+  printf("> Batched trace-product acceleration factor : %2.2f \n", (double)tmean_traceprod_pairs / (double)tmean_traceprod_batch );
+
+  for( a = 0; a < nmat; a++ )
+    free(mats1[a]);
+  free(matfull);
+  free(mats1);
+  free(mats2);
+  free(trmat);
+  free(trref);
+
+  printf("----------------------------------------------");
+
+}
+
+
+
+void test_centrosym_dense(int NREPEAT, int dim)
+{
+  int irepeat, dimsmall, im, i, j, k;
+  double t1, t2;
+  double tmean_left_full=0, tmean_left_expand=0, tmean_left_comp=0;
+  double tmean_right_full=0, tmean_right_expand=0, tmean_right_comp=0;
+
+  printf("\n==============================================\n");
+  printf("Testing products of centrosymmetric and dense matrices\n");
+  printf("----------------------------------------------\n");
+
+  // Check both products against naive loops on the full form, for rectangular dense matrices,
+  // with a tiny tile size and more threads than chunks
+  tiling_set(2);
+  parallel_set_threads(3);
+  for( dimsmall = 1; dimsmall <= 9; dimsmall++ ){
+    const int ms[3] = { 1, 3, 2 * dimsmall + 1 };
+    double *matfull, *matcomp;
+    square_alloc(&matfull, dimsmall);
+    centrosym_alloc(&matcomp, dimsmall);
+    centrosym_full_random(matfull, dimsmall);
+    centrosym_full_extractcomp(matcomp, matfull, dimsmall);
+    for( im = 0; im < 3; im++ ){
+      const int mm = ms[im];
+      double *x = (double*)calloc(dimsmall * mm, sizeof(double));
+      double *yfull = (double*)calloc(dimsmall * mm, sizeof(double));
+      double *ycomp = (double*)calloc(dimsmall * mm, sizeof(double));
+      vector_random(x, dimsmall * mm);
+      // A * X, with X dimsmall x mm
+      for( i = 0; i < dimsmall; i++ )
+        for( j = 0; j < mm; j++ ){
+          yfull[i*mm+j] = 0.0;
+          for( k = 0; k < dimsmall; k++ )
+            yfull[i*mm+j] += matfull[ square_ind(i,k,dimsmall) ] * x[k*mm+j];
+        }
+      centrosym_times_dense(ycomp, matcomp, x, mm, dimsmall);
+      for( i = 0; i < dimsmall * mm; i++ )
+        if( fabs(yfull[i] - ycomp[i]) > 1e-12 * dimsmall ){
+          printf("centrosym_times_dense is wrong for dim = %i, m = %i\n", dimsmall, mm);
+          break;
+        }
+      // X * A, with X mm x dimsmall
+      for( i = 0; i < mm; i++ )
+        for( j = 0; j < dimsmall; j++ ){
+          yfull[i*dimsmall+j] = 0.0;
+          for( k = 0; k < dimsmall; k++ )
+            yfull[i*dimsmall+j] += x[i*dimsmall+k] * matfull[ square_ind(k,j,dimsmall) ];
+        }
+      dense_times_centrosym(ycomp, x, matcomp, mm, dimsmall);
+      for( i = 0; i < dimsmall * mm; i++ )
+        if( fabs(yfull[i] - ycomp[i]) > 1e-12 * dimsmall ){
+          printf("dense_times_centrosym is wrong for dim = %i, m = %i\n", dimsmall, mm);
+          break;
+        }
+      free(x);
+      free(yfull);
+      free(ycomp);
+    }
+    free(matfull);
+    free(matcomp);
+  }
+  tiling_set(0);
+  parallel_set_threads(0);
+
+  printf("Performing benchmark");
+
+  for( irepeat = 0; irepeat < NREPEAT; irepeat++ ){
+    fflush(NULL);
+    printf(".");
+
+    // Square dense operand, so that the reference is the full square product
+    double *matfull, *matexp, *matcomp, *x, *yfull, *ycomp;
+    square_alloc(&matfull, dim);
+    square_alloc(&matexp, dim);
+    square_alloc(&x, dim);
+    square_alloc(&yfull, dim);
+    square_alloc(&ycomp, dim);
+    centrosym_alloc(&matcomp, dim);
+    centrosym_full_random(matfull, dim);
+    centrosym_full_extractcomp(matcomp, matfull, dim);
+    square_random(x, dim);
+
+    // Left product (A * X): full form, expansion of the compressed form then full product, folded kernel
+    fflush(NULL); t1 = timer_now();
+    square_product(yfull, matfull, x, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_left_full += (t2 - t1);
+    fflush(NULL); t1 = timer_now();
+    centrosym_comp_expandfull(matexp, matcomp, dim);
+    square_product(ycomp, matexp, x, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_left_expand += (t2 - t1);
+    fflush(NULL); t1 = timer_now();
+    centrosym_times_dense(ycomp, matcomp, x, dim, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_left_comp += (t2 - t1);
+    for( i = 0; i < dim * dim; i++ )
+      if( fabs(yfull[i] - ycomp[i]) > 1e-10 * dim ){
+        printf("centrosym_times_dense is not equal to square_product\n");
+        break;
+      }
+
+    // Right product (X * A)
+    fflush(NULL); t1 = timer_now();
+    square_product(yfull, x, matfull, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_right_full += (t2 - t1);
+    fflush(NULL); t1 = timer_now();
+    centrosym_comp_expandfull(matexp, matcomp, dim);
+    square_product(ycomp, x, matexp, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_right_expand += (t2 - t1);
+    fflush(NULL); t1 = timer_now();
+    dense_times_centrosym(ycomp, x, matcomp, dim, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_right_comp += (t2 - t1);
+    for( i = 0; i < dim * dim; i++ )
+      if( fabs(yfull[i] - ycomp[i]) > 1e-10 * dim ){
+        printf("dense_times_centrosym is not equal to square_product\n");
+        break;
+      }
+
+    free(matfull);
+    free(matexp);
+    free(matcomp);
+    free(x);
+    free(yfull);
+    free(ycomp);
+  }
+
+  printf("done\n");
+  printf("> Centrosym x dense acceleration factor : %2.2f (%2.2f w.r.t. expansion and full product)\n",
+    tmean_left_full / tmean_left_comp, tmean_left_expand / tmean_left_comp );
+  printf("> Dense x centrosym acceleration factor : %2.2f (%2.2f w.r.t. expansion and full product)\n",
+    tmean_right_full / tmean_right_comp, tmean_right_expand / tmean_right_comp );
+
+  printf("----------------------------------------------");
+
+}
+
+
+void test_centrosym_solve(int NREPEAT, int dim)
+{
+  int res, irepeat, ndim, spd, i, j, r, d, dims[3];
+  const int nrhs = 3;
+  double t1, t2;
+  double tmean_solve_full=0, tmean_solve_comp=0, resid;
+
+  printf("\n==============================================\n");
+  printf("Testing inverse and solve of centrosymmetric matrices\n");
+  printf("----------------------------------------------\n");
+
+  dims[0] = 1; dims[1] = 7; dims[2] = dim;
+  for( ndim = 0; ndim < 3; ndim++ ){
+    d = dims[ndim];
+    // General (LU) and symmetric positive-definite (Cholesky) matrices,
+    // made diagonally dominant so that they are well conditioned
+    for( spd = 0; spd <= 1; spd++ ){
+      double *matfull, *matcomp, *matinv, *matinvfull, *matprod, *ident;
+      square_alloc(&matfull, d);
+      square_alloc(&matinvfull, d);
+      if( spd ) bisym_full_random(matfull, d);
+      else centrosym_full_random(matfull, d);
+      for( i = 0; i < d; i++ )
+        matfull[ square_ind(i,i,d) ] += d;
+      centrosym_alloc(&matcomp, d);
+      centrosym_alloc(&matinv, d);
+      centrosym_alloc(&matprod, d);
+      centrosym_alloc(&ident, d);
+      centrosym_full_extractcomp(matcomp, matfull, d);
+      for( i = 0; i < d; i++ )
+        ident[ centrosym_ind(i,i,d) ] = 1.0;
+
+      // Inverse
+      res = centrosym_inverse(matinv, matcomp, d);
+      if(res == 0) printf("centrosym_inverse failed for dim = %i\n", d);
+      centrosym_comp_expandfull(matinvfull, matinv, d);
+      res = centrosym_isvalid(matinvfull, d);
+      if(res == 0) printf("inverse is not centrosymmetric for dim = %i\n", d);
+      centrosym_product(matprod, matcomp, matinv, d);
+      res = centrosym_assertequal(matprod, ident, d);
+      if(res == 0) printf("mat * inverse is not the identity for dim = %i\n", d);
+
+      // Solve with several right-hand sides
+      double *b = (double*)calloc(d * nrhs, sizeof(double));
+      double *x = (double*)calloc(d * nrhs, sizeof(double));
+      vector_random(b, d * nrhs);
+      res = centrosym_solve_multi(x, matcomp, b, nrhs, d);
+      if(res == 0) printf("centrosym_solve_multi failed for dim = %i\n", d);
+      res = 1;
+      for( i = 0; i < d; i++ )
+        for( r = 0; r < nrhs; r++ ){
+          resid = -b[i*nrhs+r];
+          for( j = 0; j < d; j++ )
+            resid += matfull[ square_ind(i,j,d) ] * x[j*nrhs+r];
+          if( fabs(resid) > 1e-12 ) res = 0;
+        }
+      if(res == 0) printf("centrosym_solve_multi residual is too large for dim = %i\n", d);
+      res = centrosym_solve(x, matcomp, b, d);
+      for( i = 0; i < d; i++ ){
+        resid = -b[i];
+        for( j = 0; j < d; j++ )
+          resid += matfull[ square_ind(i,j,d) ] * x[j];
+        if( fabs(resid) > 1e-12 ) res = 0;
+      }
+      if(res == 0) printf("centrosym_solve residual is too large for dim = %i\n", d);
+
+      free(b);
+      free(x);
+      free(matfull);
+      free(matinvfull);
+      free(matcomp);
+      free(matinv);
+      free(matprod);
+      free(ident);
+    }
+  }
+
+  printf("Performing benchmark");
+
+  for( irepeat = 0; irepeat < NREPEAT; irepeat++ ){
+    fflush(NULL);
+    printf(".");
+
+    double *matfull, *matcomp;
+    square_alloc(&matfull, dim);
+    centrosym_full_random(matfull, dim);
+    for( i = 0; i < dim; i++ )
+      matfull[ square_ind(i,i,dim) ] += dim;
+    centrosym_alloc(&matcomp, dim);
+    centrosym_full_extractcomp(matcomp, matfull, dim);
+    double *b = (double*)calloc(dim, sizeof(double));
+    double *x = (double*)calloc(dim, sizeof(double));
+    int *piv = (int*)calloc(dim, sizeof(int));
+    vector_random(b, dim);
+
+    // Dense LU in full form
+    fflush(NULL); t1 = timer_now();
+    square_lu(matfull, piv, dim);
+    square_lu_solve(x, matfull, piv, b, 1, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_solve_full += (t2 - t1);
+
+    fflush(NULL); t1 = timer_now();
+    centrosym_solve(x, matcomp, b, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_solve_comp += (t2 - t1);
+
+    free(matfull);
+    free(matcomp);
+    free(b);
+    free(x);
+    free(piv);
+  }
+
+  printf("done\n");
+  printf("> Linear solve acceleration factor : %2.2f \n", (double)tmean_solve_full / (double)tmean_solve_comp );
 
   printf("----------------------------------------------");
 
@@ -162,9 +1435,12 @@ void test_centrosym(int NREPEAT, int dim)
 
 void test_bisym(int NREPEAT, int dim)
 {
-  int res, irepeat;
-  clock_t t1, t2;
-  double tmean_product_full=0, tmean_product_comp=0;
+  int i, res, irepeat, dimsmall, irep;
+  const int NREP = 100;
+  double t1, t2;
+  double tmean_product_full=0, tmean_product_comp=0, tmean_product_centrosym=0;
+  double tmean_traceprod_full=0, tmean_traceprod_comp=0, tmean_quadform_full=0, tmean_quadform_comp=0;
+  double resfull, rescomp;
 
   
   
@@ -172,6 +1448,58 @@ void test_bisym(int NREPEAT, int dim)
   printf("Testing properties of bisymmetric matrices\n");
   printf("----------------------------------------------\n");
 
+  // Check the product against the full product for small even and odd sizes
+  for( dimsmall = 1; dimsmall <= 9; dimsmall++ ){
+    double *matfull1, *matfull2, *matfull3;
+    square_alloc(&matfull1, dimsmall);
+    square_alloc(&matfull2, dimsmall);
+    square_alloc(&matfull3, dimsmall);
+    bisym_full_random(matfull1, dimsmall);
+    bisym_full_random(matfull2, dimsmall);
+    square_product(matfull3, matfull1, matfull2, dimsmall);
+    double *matcomp1, *matcomp2, *matcomp3, *matcomp4;
+    bisym_alloc(&matcomp1, dimsmall);
+    bisym_alloc(&matcomp2, dimsmall);
+    centrosym_alloc(&matcomp3, dimsmall);
+    centrosym_alloc(&matcomp4, dimsmall);
+    bisym_full_extractcomp(matcomp1, matfull1, dimsmall);
+    bisym_full_extractcomp(matcomp2, matfull2, dimsmall);
+    centrosym_full_extractcomp(matcomp3, matfull3, dimsmall);
+    bisym_product(matcomp4, matcomp1, matcomp2, dimsmall);
+    res = centrosym_assertequal(matcomp4, matcomp3, dimsmall);
+    if(res == 0) printf("bisymmetric product is wrong for dim = %i\n", dimsmall);
+    if( fabs(bisym_trace(matcomp1, dimsmall) - square_trace(matfull1, dimsmall)) > 1e-10 )
+      printf("bisymmetric trace is wrong for dim = %i\n", dimsmall);
+    if( fabs(bisym_traceprod(matcomp1, matcomp2, dimsmall) - square_traceprod(matfull1, matfull2, dimsmall)) > 1e-10 )
+      printf("bisymmetric traceprod is wrong for dim = %i\n", dimsmall);
+    double *x = (double*)calloc(dimsmall, sizeof(double));
+    double *y = (double*)calloc(dimsmall, sizeof(double));
+    vector_random(x, dimsmall);
+    vector_random(y, dimsmall);
+    if( fabs(bisym_quadform(x, matcomp1, y, dimsmall) - square_quadform(x, matfull1, y, dimsmall)) > 1e-10 )
+      printf("bisymmetric quadform is wrong for dim = %i\n", dimsmall);
+    double *z = (double*)calloc(dimsmall, sizeof(double));
+    square_matvec(y, matfull1, x, dimsmall);
+    bisym_matvec(z, matcomp1, x, dimsmall);
+    for( i = 0; i < dimsmall; i++ )
+      if( fabs(y[i] - z[i]) > 1e-12 * dimsmall ){
+        printf("bisymmetric matrix-vector product is wrong for dim = %i\n", dimsmall);
+        break;
+      }
+    free(x);
+    free(y);
+    free(z);
+    free(matfull1);
+    free(matfull2);
+    free(matfull3);
+    free(matcomp1);
+    free(matcomp2);
+    free(matcomp3);
+    free(matcomp4);
+  }
+
+  printf("Performing benchmark");
+
   for( irepeat = 0; irepeat < NREPEAT; irepeat++ ){
     fflush(NULL);
     printf(".");
@@ -199,32 +1527,78 @@ void test_bisym(int NREPEAT, int dim)
     // Perform the product in full form
     double *matfull3;
     square_alloc(&matfull3, dim);
-    t1 = clock();
+    fflush(NULL); t1 = timer_now();
     square_product(matfull3, matfull1, matfull2, dim);
-    t2 = clock();
+    fflush(NULL); t2 = timer_now();
     tmean_product_full += t2 - t1;
-    //printf("Matrix product in full form : %4.4e seconds\n",(t2 - t1) / (double)CLOCKS_PER_SEC);
-    double *matcomp3;
-    bisym_alloc(&matcomp3, dim);
-    bisym_full_extractcomp(matcomp3, matfull3, dim);
+    //printf("Matrix product in full form : %4.4e seconds\n",(t2 - t1));
 
-    // Check that the full form is still centrosymmetric
+    // The product is centrosymmetric (not bisymmetric)
     res = centrosym_isvalid(matfull3, dim);
     if(res == 0) printf("matfull3 is not centrosymmetric\n");
+    double *matcomp3;
+    centrosym_alloc(&matcomp3, dim);
+    centrosym_full_extractcomp(matcomp3, matfull3, dim);
+
+    // Perform the product of the same matrices seen as centrosymmetric
+    double *matcentro1, *matcentro2, *matcentro3;
+    centrosym_alloc(&matcentro1, dim);
+    centrosym_alloc(&matcentro2, dim);
+    centrosym_alloc(&matcentro3, dim);
+    centrosym_full_extractcomp(matcentro1, matfull1, dim);
+    centrosym_full_extractcomp(matcentro2, matfull2, dim);
+    fflush(NULL); t1 = timer_now();
+    centrosym_product(matcentro3, matcentro1, matcentro2, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_product_centrosym += t2 - t1;
 
     // Perform the product in compressed fonm
     double *matcomp4;
     centrosym_alloc(&matcomp4, dim);
-    t1 = clock();
+    fflush(NULL); t1 = timer_now();
     bisym_product(matcomp4, matcomp1, matcomp2, dim);
-    t2 = clock();
+    fflush(NULL); t2 = timer_now();
     tmean_product_comp += t2 - t1;
-    //printf("Matrix product in comp form : %4.4e seconds\n",(t2 - t1) / (double)CLOCKS_PER_SEC);
+    //printf("Matrix product in comp form : %4.4e seconds\n",(t2 - t1));
 
     // Extract and compare the two results
     res = centrosym_assertequal(matcomp4, matcomp3, dim);
     if(res == 0) printf("matcomp4 is not equal to matcomp3\n");
 
+    // Test the trace of a product (repeated, too fast to be timed alone)
+    resfull = rescomp = 0.0;
+    fflush(NULL); t1 = timer_now();
+    for( irep = 0; irep < NREP; irep++ )
+      resfull += square_traceprod(matfull1, matfull2, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_traceprod_full += t2 - t1;
+    fflush(NULL); t1 = timer_now();
+    for( irep = 0; irep < NREP; irep++ )
+      rescomp += bisym_traceprod(matcomp1, matcomp2, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_traceprod_comp += t2 - t1;
+    if( fabs(resfull - rescomp) > 1e-10 * fabs(resfull) ) printf("traceprodcomp is not equal to traceprodfull\n");
+
+    // Test quadratic forms
+    double *x = (double*)calloc(dim, sizeof(double));
+    double *y = (double*)calloc(dim, sizeof(double));
+    vector_random(x, dim);
+    vector_random(y, dim);
+    resfull = rescomp = 0.0;
+    fflush(NULL); t1 = timer_now();
+    for( irep = 0; irep < NREP; irep++ )
+      resfull += square_quadform(x, matfull1, y, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_quadform_full += t2 - t1;
+    fflush(NULL); t1 = timer_now();
+    for( irep = 0; irep < NREP; irep++ )
+      rescomp += bisym_quadform(x, matcomp1, y, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_quadform_comp += t2 - t1;
+    if( fabs(resfull - rescomp) > 1e-10 * fabs(resfull) ) printf("quadform_full is not equal to quadform_comp\n");
+
+    free(x);
+    free(y);
     free(matfull1);
     free(matcomp1);
     free(matfull2);
@@ -232,14 +1606,20 @@ void test_bisym(int NREPEAT, int dim)
     free(matfull3);
     free(matcomp3);
     free(matcomp4);
+    free(matcentro1);
+    free(matcentro2);
+    free(matcentro3);
 
   }
 
   printf("done\n");
-  printf("Mean time for matrix product in full form : %4.4f seconds\n",tmean_product_full / (double)CLOCKS_PER_SEC);
-  printf("Mean time for matrix product in comp form : %4.4f seconds\n",tmean_product_comp / (double)CLOCKS_PER_SEC);
+  printf("Mean time for matrix product in full form : %4.4f seconds\n",tmean_product_full / (double)NREPEAT);
+  printf("Mean time for matrix product in comp form : %4.4f seconds\n",tmean_product_comp / (double)NREPEAT);
   printf("> Acceleration factor : %f \n", (double)tmean_product_full / tmean_product_comp );
-  printf("> Storage size factor : %f \n", ((double)dim*dim)/(dim*(dim+1)/2) );
+  printf("> Acceleration factor over centrosym_product : %f \n", (double)tmean_product_centrosym / tmean_product_comp );
+  printf("> Trace-product acceleration factor  : %2.2f \n", (double)tmean_traceprod_full / tmean_traceprod_comp );
+  printf("> Quadratic form acceleration factor : %2.2f \n", (double)tmean_quadform_full / tmean_quadform_comp );
+  printf("> Storage size factor : %f \n", ((double)dim*dim)/bisym_size(dim) );
 
   printf("----------------------------------------------");
 
@@ -247,7 +1627,940 @@ void test_bisym(int NREPEAT, int dim)
 
 }
 
+
+
+void test_bisym_eig(int NREPEAT, int dim)
+{
+  int res, irepeat, ndim, i, j, k, d, dims[5];
+  double t1, t2;
+  double tmean_eig_full=0, tmean_eig_comp=0, tmean_eigval_full=0, tmean_eigval_comp=0;
+  double resid, trace;
+
+  printf("\n==============================================\n");
+  printf("Testing eigendecomposition of bisymmetric matrices\n");
+  printf("----------------------------------------------\n");
+
+  dims[0] = 1; dims[1] = 2; dims[2] = 7; dims[3] = 8; dims[4] = dim;
+  for( ndim = 0; ndim < 5; ndim++ ){
+    d = dims[ndim];
+    double *matfull, *matcomp, *vec;
+    square_alloc(&matfull, d);
+    bisym_full_random(matfull, d);
+    bisym_alloc(&matcomp, d);
+    bisym_full_extractcomp(matcomp, matfull, d);
+    double *eigval = (double*)calloc(d, sizeof(double));
+    double *eigval2 = (double*)calloc(d, sizeof(double));
+    double *eigvec = (double*)calloc((d+1)/2 * ((d+1)/2) + (d/2) * (d/2), sizeof(double));
+    vec = (double*)calloc(d, sizeof(double));
+
+    res = bisym_eig(eigval, eigvec, matcomp, d);
+    if(res == 0) printf("bisym_eig did not converge for dim = %i\n", d);
+    res = 1;
+    for( k = 0; k < d; k++ ){
+      bisym_eigvec_expand(vec, eigvec, k, d);
+      for( i = 0; i < d; i++ ){
+        resid = - eigval[k] * vec[i];
+        for( j = 0; j < d; j++ )
+          resid += matfull[ square_ind(i,j,d) ] * vec[j];
+        if( fabs(resid) > 1e-12 * d ) res = 0;
+      }
+    }
+    if(res == 0) printf("bisym_eig eigenpairs are wrong for dim = %i\n", d);
+    trace = 0.0;
+    for( k = 0; k < d; k++ )
+      trace += eigval[k] - matfull[ square_ind(k,k,d) ];
+    if( fabs(trace) > 1e-12 * d ) printf("bisym_eig eigenvalues do not sum to the trace for dim = %i\n", d);
+
+    res = bisym_eigval(eigval2, matcomp, d);
+    for( k = 0; k < d; k++ )
+      if( fabs(eigval2[k] - eigval[k]) > 1e-12 * d ) res = 0;
+    if(res == 0) printf("bisym_eigval is wrong for dim = %i\n", d);
+
+    free(matfull);
+    free(matcomp);
+    free(eigval);
+    free(eigval2);
+    free(eigvec);
+    free(vec);
+  }
+
+  printf("Performing benchmark");
+
+  for( irepeat = 0; irepeat < NREPEAT; irepeat++ ){
+    fflush(NULL);
+    printf(".");
+
+    double *matfull, *matwork, *matcomp;
+    square_alloc(&matfull, dim);
+    square_alloc(&matwork, dim);
+    bisym_full_random(matfull, dim);
+    bisym_alloc(&matcomp, dim);
+    bisym_full_extractcomp(matcomp, matfull, dim);
+    double *eigval = (double*)calloc(dim, sizeof(double));
+    double *eigvec = (double*)calloc((dim+1)/2 * ((dim+1)/2) + (dim/2) * (dim/2), sizeof(double));
+
+    // Full symmetric eigensolve
+    memcpy(matwork, matfull, dim * dim * sizeof(double));
+    fflush(NULL); t1 = timer_now();
+    square_symeig(eigval, matwork, 1, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_eig_full += (t2 - t1);
+    memcpy(matwork, matfull, dim * dim * sizeof(double));
+    fflush(NULL); t1 = timer_now();
+    square_symeig(eigval, matwork, 0, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_eigval_full += (t2 - t1);
+
+    fflush(NULL); t1 = timer_now();
+    bisym_eig(eigval, eigvec, matcomp, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_eig_comp += (t2 - t1);
+    fflush(NULL); t1 = timer_now();
+    bisym_eigval(eigval, matcomp, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_eigval_comp += (t2 - t1);
+
+    free(matfull);
+    free(matwork);
+    free(matcomp);
+    free(eigval);
+    free(eigvec);
+  }
+
+  printf("done\n");
+  printf("> Eigendecomposition acceleration factor : %2.2f \n", (double)tmean_eig_full / (double)tmean_eig_comp );
+  printf("> Eigenvalues acceleration factor : %2.2f \n", (double)tmean_eigval_full / (double)tmean_eigval_comp );
+
+  printf("----------------------------------------------");
+
+}
+
+
+
+void test_centrodiag(int NREPEAT, int dim)
+{
+  int i, res, irepeat, dimsmall, size, nrep, irep;
+  double t1, t2;
+  double tprod_row, tprod_diag, ttrace_row, ttrace_diag, tquad_row, tquad_diag;
+
+  printf("\n==============================================\n");
+  printf("Testing the diagonal-major form of centrosymmetric matrices\n");
+  printf("----------------------------------------------\n");
+
+  // Check every kernel against the full form for small even and odd sizes
+  tiling_set(2);
+  parallel_set_threads(3);
+  for( dimsmall = 1; dimsmall <= 9; dimsmall++ ){
+    double *matfull1, *matfull2, *matfull3, *matfull4;
+    square_alloc(&matfull1, dimsmall);
+    square_alloc(&matfull2, dimsmall);
+    square_alloc(&matfull3, dimsmall);
+    square_alloc(&matfull4, dimsmall);
+    centrosym_full_random(matfull1, dimsmall);
+    centrosym_full_random(matfull2, dimsmall);
+    square_product(matfull3, matfull1, matfull2, dimsmall);
+    double *matdiag1, *matdiag2, *matdiag3, *matdiag4, *matcomp1, *matcomp2;
+    centrodiag_alloc(&matdiag1, dimsmall);
+    centrodiag_alloc(&matdiag2, dimsmall);
+    centrodiag_alloc(&matdiag3, dimsmall);
+    centrodiag_alloc(&matdiag4, dimsmall);
+    centrosym_alloc(&matcomp1, dimsmall);
+    centrosym_alloc(&matcomp2, dimsmall);
+    centrodiag_full_extractcomp(matdiag1, matfull1, dimsmall);
+    centrodiag_full_extractcomp(matdiag2, matfull2, dimsmall);
+    centrodiag_full_extractcomp(matdiag3, matfull3, dimsmall);
+
+    centrodiag_comp_expandfull(matfull4, matdiag1, dimsmall);
+    if( memcmp(matfull4, matfull1, dimsmall * dimsmall * sizeof(double)) != 0 )
+      printf("diagonal-major expansion is wrong for dim = %i\n", dimsmall);
+    centrosym_full_extractcomp(matcomp1, matfull1, dimsmall);
+    centrodiag_from_centrosym(matdiag4, matcomp1, dimsmall);
+    if( memcmp(matdiag4, matdiag1, centrodiag_size(dimsmall) * sizeof(double)) != 0 )
+      printf("conversion to diagonal-major form is wrong for dim = %i\n", dimsmall);
+    centrodiag_to_centrosym(matcomp2, matdiag1, dimsmall);
+    if( memcmp(matcomp2, matcomp1, centrosym_size(dimsmall) * sizeof(double)) != 0 )
+      printf("conversion from diagonal-major form is wrong for dim = %i\n", dimsmall);
+
+    centrodiag_product(matdiag4, matdiag1, matdiag2, dimsmall);
+    res = centrosym_assertequal(matdiag4, matdiag3, dimsmall);
+    if(res == 0) printf("diagonal-major product is wrong for dim = %i\n", dimsmall);
+    if( fabs(centrodiag_trace(matdiag3, dimsmall) - square_trace(matfull3, dimsmall)) > 1e-10 )
+      printf("diagonal-major trace is wrong for dim = %i\n", dimsmall);
+    if( fabs(centrodiag_traceprod(matdiag1, matdiag2, dimsmall) - square_trace(matfull3, dimsmall)) > 1e-10 )
+      printf("diagonal-major traceprod is wrong for dim = %i\n", dimsmall);
+    double *x = (double*)calloc(dimsmall, sizeof(double));
+    double *y = (double*)calloc(dimsmall, sizeof(double));
+    vector_random(x, dimsmall);
+    vector_random(y, dimsmall);
+    if( fabs(centrodiag_quadform(x, matdiag1, y, dimsmall) - square_quadform(x, matfull1, y, dimsmall)) > 1e-10 )
+      printf("diagonal-major quadform is wrong for dim = %i\n", dimsmall);
+    double *z = (double*)calloc(dimsmall, sizeof(double));
+    square_matvec(y, matfull1, x, dimsmall);
+    centrodiag_matvec(z, matdiag1, x, dimsmall);
+    for( i = 0; i < dimsmall; i++ )
+      if( fabs(y[i] - z[i]) > 1e-12 * dimsmall ){
+        printf("diagonal-major matrix-vector product is wrong for dim = %i\n", dimsmall);
+        break;
+      }
+
+    free(x);
+    free(y);
+    free(z);
+    free(matfull1);
+    free(matfull2);
+    free(matfull3);
+    free(matfull4);
+    free(matdiag1);
+    free(matdiag2);
+    free(matdiag3);
+    free(matdiag4);
+    free(matcomp1);
+    free(matcomp2);
+  }
+  tiling_set(0);
+  parallel_set_threads(0);
+
+  // Compare the two compressed forms across sizes, with the same amount of work per size
+  printf("Performing benchmark (time ratio row-major / diagonal-major)\n");
+  printf(">  %6s %10s %10s %10s\n", "dim", "product", "traceprod", "quadform");
+  for( size = 16; size <= dim; size *= 2 ){
+    tprod_row = tprod_diag = ttrace_row = ttrace_diag = tquad_row = tquad_diag = 0.0;
+    for( irepeat = 0; irepeat < NREPEAT; irepeat++ ){
+      double *matfull;
+      square_alloc(&matfull, size);
+      centrosym_full_random(matfull, size);
+      double *matcomp1, *matcomp2, *matdiag1, *matdiag2;
+      centrosym_alloc(&matcomp1, size);
+      centrosym_alloc(&matcomp2, size);
+      centrodiag_alloc(&matdiag1, size);
+      centrodiag_alloc(&matdiag2, size);
+      centrosym_full_extractcomp(matcomp1, matfull, size);
+      centrodiag_from_centrosym(matdiag1, matcomp1, size);
+      double *x = (double*)calloc(size, sizeof(double));
+      vector_random(x, size);
+      double trrow = 0.0, trdiag = 0.0, qrow = 0.0, qdiag = 0.0;
+
+      nrep = MAX(1, (dim / size) * (dim / size) * (dim / size));
+      fflush(NULL); t1 = timer_now();
+      for( irep = 0; irep < nrep; irep++ )
+        centrosym_product(matcomp2, matcomp1, matcomp1, size);
+      fflush(NULL); t2 = timer_now();
+      tprod_row += (t2 - t1);
+      fflush(NULL); t1 = timer_now();
+      for( irep = 0; irep < nrep; irep++ )
+        centrodiag_product(matdiag2, matdiag1, matdiag1, size);
+      fflush(NULL); t2 = timer_now();
+      tprod_diag += (t2 - t1);
+
+      nrep = MAX(1, 64 * (dim / size) * (dim / size));
+      fflush(NULL); t1 = timer_now();
+      for( irep = 0; irep < nrep; irep++ )
+        trrow += centrosym_traceprod(matcomp1, matcomp1, size);
+      fflush(NULL); t2 = timer_now();
+      ttrace_row += (t2 - t1);
+      fflush(NULL); t1 = timer_now();
+      for( irep = 0; irep < nrep; irep++ )
+        trdiag += centrodiag_traceprod(matdiag1, matdiag1, size);
+      fflush(NULL); t2 = timer_now();
+      ttrace_diag += (t2 - t1);
+      if( fabs(trrow - trdiag) > 1e-8 * fabs(trrow) ) printf("traceprod of the two forms differ for dim = %i\n", size);
+
+      fflush(NULL); t1 = timer_now();
+      for( irep = 0; irep < nrep; irep++ )
+        qrow += centrosym_quadform(x, matcomp1, x, size);
+      fflush(NULL); t2 = timer_now();
+      tquad_row += (t2 - t1);
+      fflush(NULL); t1 = timer_now();
+      for( irep = 0; irep < nrep; irep++ )
+        qdiag += centrodiag_quadform(x, matdiag1, x, size);
+      fflush(NULL); t2 = timer_now();
+      tquad_diag += (t2 - t1);
+      if( fabs(qrow - qdiag) > 1e-8 * fabs(qrow) ) printf("quadform of the two forms differ for dim = %i\n", size);
+
+      free(x);
+      free(matfull);
+      free(matcomp1);
+      free(matcomp2);
+      free(matdiag1);
+      free(matdiag2);
+    }
+    printf(">  %6i %10.2f %10.2f %10.2f\n", size, tprod_row / tprod_diag, ttrace_row / ttrace_diag, tquad_row / tquad_diag);
+  }
+
+  printf("----------------------------------------------");
+
+}
+
+
+
+void test_symmat(int NREPEAT, int dim)
+{
+  int res, irepeat, dimsmall, i, irep;
+  const int NREP = 100, NVEC = 16;
+  double t1, t2;
+  double tmean_product_full=0, tmean_product_comp=0;
+  double tmean_traceprod_full=0, tmean_traceprod_comp=0;
+  double tmean_quadform_full=0, tmean_quadform_comp=0;
+  double tmean_matvec_full=0, tmean_matvec_comp=0, tmean_matmat_full=0, tmean_matmat_comp=0;
+  double resfull, rescomp;
+
+  printf("\n==============================================\n");
+  printf("Testing properties of symmetric matrices\n");
+  printf("----------------------------------------------\n");
+
+  // Check every kernel against the full form for small sizes, with a tiny tile size
+  // so that the blocked loops have partial tiles, and with more threads than chunks of rows
+  tiling_set(2);
+  parallel_set_threads(3);
+  for( dimsmall = 1; dimsmall <= 9; dimsmall++ ){
+    double *matfull1, *matfull2, *matfull3, *matfull4;
+    square_alloc(&matfull1, dimsmall);
+    square_alloc(&matfull2, dimsmall);
+    square_alloc(&matfull3, dimsmall);
+    square_alloc(&matfull4, dimsmall);
+    symmat_full_random(matfull1, dimsmall);
+    symmat_full_random(matfull2, dimsmall);
+    square_product(matfull3, matfull1, matfull2, dimsmall);
+    double *matcomp1, *matcomp2;
+    symmat_alloc(&matcomp1, dimsmall);
+    symmat_alloc(&matcomp2, dimsmall);
+    symmat_full_extractcomp(matcomp1, matfull1, dimsmall);
+    symmat_full_extractcomp(matcomp2, matfull2, dimsmall);
+    symmat_comp_expandfull(matfull4, matcomp1, dimsmall);
+    if( memcmp(matfull4, matfull1, dimsmall * dimsmall * sizeof(double)) != 0 )
+      printf("symmetric expansion is wrong for dim = %i\n", dimsmall);
+    symmat_product(matfull4, matcomp1, matcomp2, dimsmall);
+    for( i = 0; i < dimsmall * dimsmall; i++ )
+      if( fabs(matfull4[i] - matfull3[i]) > 1e-12 * dimsmall ){
+        printf("symmetric product is wrong for dim = %i\n", dimsmall);
+        break;
+      }
+    if( fabs(symmat_trace(matcomp1, dimsmall) - square_trace(matfull1, dimsmall)) > 1e-10 )
+      printf("symmetric trace is wrong for dim = %i\n", dimsmall);
+    if( fabs(symmat_traceprod(matcomp1, matcomp2, dimsmall) - square_trace(matfull3, dimsmall)) > 1e-10 )
+      printf("symmetric traceprod is wrong for dim = %i\n", dimsmall);
+    double *x = (double*)calloc(3 * dimsmall, sizeof(double));
+    double *y = (double*)calloc(3 * dimsmall, sizeof(double));
+    double *z = (double*)calloc(3 * dimsmall, sizeof(double));
+    vector_random(x, 3 * dimsmall);
+    vector_random(y, dimsmall);
+    if( fabs(symmat_quadform(x, matcomp1, y, dimsmall) - square_quadform(x, matfull1, y, dimsmall)) > 1e-10 )
+      printf("symmetric quadform is wrong for dim = %i\n", dimsmall);
+    square_matvec(y, matfull1, x, dimsmall);
+    symmat_matvec(z, matcomp1, x, dimsmall);
+    for( i = 0; i < dimsmall; i++ )
+      if( fabs(y[i] - z[i]) > 1e-12 * dimsmall ){
+        printf("symmetric matrix-vector product is wrong for dim = %i\n", dimsmall);
+        break;
+      }
+    square_matmat(y, matfull1, x, 3, dimsmall);
+    symmat_matmat(z, matcomp1, x, 3, dimsmall);
+    for( i = 0; i < 3 * dimsmall; i++ )
+      if( fabs(y[i] - z[i]) > 1e-12 * dimsmall ){
+        printf("symmetric matrix-panel product is wrong for dim = %i\n", dimsmall);
+        break;
+      }
+    free(x);
+    free(y);
+    free(z);
+    free(matfull1);
+    free(matfull2);
+    free(matfull3);
+    free(matfull4);
+    free(matcomp1);
+    free(matcomp2);
+  }
+  tiling_set(0);
+  parallel_set_threads(0);
+
+  printf("Performing benchmark");
+
+  for( irepeat = 0; irepeat < NREPEAT; irepeat++ ){
+    fflush(NULL);
+    printf(".");
+
+    // Generate two random symmetric matrices (full form)
+    double *matfull1, *matfull2, *matfull3, *matfull4;
+    square_alloc(&matfull1, dim);
+    square_alloc(&matfull2, dim);
+    square_alloc(&matfull3, dim);
+    square_alloc(&matfull4, dim);
+    symmat_full_random(matfull1, dim);
+    symmat_full_random(matfull2, dim);
+    res = symmat_isvalid(matfull1, dim) && symmat_isvalid(matfull2, dim);
+    if(res == 0) printf("matfull1 or matfull2 is not symmetric\n");
+
+    // Extract compressed forms
+    double *matcomp1, *matcomp2;
+    symmat_alloc(&matcomp1, dim);
+    symmat_alloc(&matcomp2, dim);
+    symmat_full_extractcomp(matcomp1, matfull1, dim);
+    symmat_full_extractcomp(matcomp2, matfull2, dim);
+
+    // Products
+    fflush(NULL); t1 = timer_now();
+    square_product(matfull3, matfull1, matfull2, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_product_full += (t2 - t1);
+    fflush(NULL); t1 = timer_now();
+    symmat_product(matfull4, matcomp1, matcomp2, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_product_comp += (t2 - t1);
+    for( i = 0; i < dim * dim; i++ )
+      if( fabs(matfull4[i] - matfull3[i]) > 1e-10 * dim ){
+        printf("matfull4 is not equal to matfull3\n");
+        break;
+      }
+
+    // Trace of a product (repeated, too fast to be timed alone)
+    resfull = rescomp = 0.0;
+    fflush(NULL); t1 = timer_now();
+    for( irep = 0; irep < NREP; irep++ )
+      resfull += square_traceprod(matfull1, matfull2, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_traceprod_full += (t2 - t1);
+    fflush(NULL); t1 = timer_now();
+    for( irep = 0; irep < NREP; irep++ )
+      rescomp += symmat_traceprod(matcomp1, matcomp2, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_traceprod_comp += (t2 - t1);
+    if( fabs(resfull - rescomp) > 1e-10 * fabs(resfull) ) printf("traceprodcomp is not equal to traceprodfull\n");
+
+    // Quadratic forms and matrix-vector products
+    double *x = (double*)calloc(dim * NVEC, sizeof(double));
+    double *yfull = (double*)calloc(dim * NVEC, sizeof(double));
+    double *ycomp = (double*)calloc(dim * NVEC, sizeof(double));
+    vector_random(x, dim * NVEC);
+    vector_random(yfull, dim);
+    resfull = rescomp = 0.0;
+    fflush(NULL); t1 = timer_now();
+    for( irep = 0; irep < NREP; irep++ )
+      resfull += square_quadform(x, matfull1, yfull, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_quadform_full += (t2 - t1);
+    fflush(NULL); t1 = timer_now();
+    for( irep = 0; irep < NREP; irep++ )
+      rescomp += symmat_quadform(x, matcomp1, yfull, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_quadform_comp += (t2 - t1);
+    if( fabs(resfull - rescomp) > 1e-10 * fabs(resfull) ) printf("quadform_full is not equal to quadform_comp\n");
+
+    fflush(NULL); t1 = timer_now();
+    for( irep = 0; irep < NREP; irep++ )
+      square_matvec(yfull, matfull1, x, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_matvec_full += (t2 - t1);
+    fflush(NULL); t1 = timer_now();
+    for( irep = 0; irep < NREP; irep++ )
+      symmat_matvec(ycomp, matcomp1, x, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_matvec_comp += (t2 - t1);
+    for( i = 0; i < dim; i++ )
+      if( fabs(yfull[i] - ycomp[i]) > 1e-10 * dim ){
+        printf("matvec_full is not equal to matvec_comp\n");
+        break;
+      }
+
+    fflush(NULL); t1 = timer_now();
+    square_matmat(yfull, matfull1, x, NVEC, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_matmat_full += (t2 - t1);
+    fflush(NULL); t1 = timer_now();
+    symmat_matmat(ycomp, matcomp1, x, NVEC, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_matmat_comp += (t2 - t1);
+    for( i = 0; i < dim * NVEC; i++ )
+      if( fabs(yfull[i] - ycomp[i]) > 1e-10 * dim ){
+        printf("matmat_full is not equal to matmat_comp\n");
+        break;
+      }
+
+    free(x);
+    free(yfull);
+    free(ycomp);
+    free(matfull1);
+    free(matfull2);
+    free(matfull3);
+    free(matfull4);
+    free(matcomp1);
+    free(matcomp2);
+  }
+
+  printf("done\n");
+  printf("> Memory gain due to compressed form : %2.2f \n", ((double)dim*dim)/symmat_size(dim) );
+  printf("> Matrix product acceleration factor : %2.2f \n", tmean_product_full / tmean_product_comp );
+  printf("> Trace-product acceleration factor  : %2.2f \n", tmean_traceprod_full / tmean_traceprod_comp );
+  printf("> Quadratic form acceleration factor : %2.2f \n", tmean_quadform_full / tmean_quadform_comp );
+  printf("> Matrix-vector product acceleration factor : %2.2f \n", tmean_matvec_full / tmean_matvec_comp );
+  printf("> Matrix-panel product acceleration factor : %2.2f \n", tmean_matmat_full / tmean_matmat_comp );
+
+  printf("----------------------------------------------");
+
+}
+
+
+
+void test_toeplitz(int NREPEAT, int dim, int dimmax)
+{
+  int res, irepeat, dimsmall, dimlarge, i, j, irep;
+  const int NREP = 100;
+  double t1, t2;
+  double tmean_quadform_full=0, tmean_quadform_bisym=0, tmean_quadform_comp=0;
+  double tmean_matvec_full=0, tmean_matvec_comp=0;
+  double tmean_solve_full=0, tmean_solve_comp=0, tmean_logdet_full=0, tmean_logdet_comp=0;
+  double resfull, resbisym, rescomp, t_matvec, t_solve;
+
+  printf("\n==============================================\n");
+  printf("Testing properties of symmetric Toeplitz matrices\n");
+  printf("----------------------------------------------\n");
+
+  // An empty system is solved, a vanishing first element is singular
+  double toep2[2] = { 0.0, 1.0 }, sol2[2];
+  if( toeplitz_solve(sol2, toep2, toep2, 0) != 1 ) printf("toeplitz_solve fails on an empty system\n");
+  if( toeplitz_solve(sol2, toep2, toep2, 2) != 0 ) printf("toeplitz_solve accepts a zero first element\n");
+
+  // Check every kernel against the full form for small sizes (and one that is not close to a power of two)
+  for( dimsmall = 1; dimsmall <= 10; dimsmall++ ){
+    const int d = dimsmall == 10 ? 37 : dimsmall;
+    double *matfull1, *matfull2, *matfull3;
+    square_alloc(&matfull1, d);
+    square_alloc(&matfull2, d);
+    square_alloc(&matfull3, d);
+    toeplitz_full_random(matfull1, d);
+    toeplitz_full_random(matfull2, d);
+    if( toeplitz_isvalid(matfull1, d) == 0 ) printf("matfull1 is not Toeplitz for dim = %i\n", d);
+    double *matcomp1, *matcomp2, *matbisym;
+    toeplitz_alloc(&matcomp1, d);
+    toeplitz_alloc(&matcomp2, d);
+    bisym_alloc(&matbisym, d);
+    toeplitz_full_extractcomp(matcomp1, matfull1, d);
+    toeplitz_full_extractcomp(matcomp2, matfull2, d);
+    toeplitz_comp_expandfull(matfull3, matcomp1, d);
+    if( memcmp(matfull3, matfull1, d * d * sizeof(double)) != 0 )
+      printf("Toeplitz expansion is wrong for dim = %i\n", d);
+    toeplitz_to_bisym(matbisym, matcomp1, d);
+    double *matbisym2;
+    bisym_alloc(&matbisym2, d);
+    bisym_full_extractcomp(matbisym2, matfull1, d);
+    if( bisym_assertequal(matbisym, matbisym2, d) == 0 )
+      printf("Toeplitz to bisymmetric conversion is wrong for dim = %i\n", d);
+    toeplitz_from_bisym(matcomp2, matbisym, d);
+    if( memcmp(matcomp2, matcomp1, d * sizeof(double)) != 0 )
+      printf("Toeplitz from bisymmetric conversion is wrong for dim = %i\n", d);
+    toeplitz_full_extractcomp(matcomp2, matfull2, d);
+    if( fabs(toeplitz_trace(matcomp1, d) - square_trace(matfull1, d)) > 1e-10 )
+      printf("Toeplitz trace is wrong for dim = %i\n", d);
+    if( fabs(toeplitz_traceprod(matcomp1, matcomp2, d) - square_traceprod(matfull1, matfull2, d)) > 1e-10 * d )
+      printf("Toeplitz traceprod is wrong for dim = %i\n", d);
+    double *x = (double*)calloc(d, sizeof(double));
+    double *y = (double*)calloc(d, sizeof(double));
+    double *z = (double*)calloc(d, sizeof(double));
+    vector_random(x, d);
+    vector_random(y, d);
+    if( fabs(toeplitz_quadform(x, matcomp1, y, d) - square_quadform(x, matfull1, y, d)) > 1e-10 * d )
+      printf("Toeplitz quadform is wrong for dim = %i\n", d);
+    square_matvec(y, matfull1, x, d);
+    toeplitz_matvec(z, matcomp1, x, d);
+    for( i = 0; i < d; i++ )
+      if( fabs(y[i] - z[i]) > 1e-12 * d ){
+        printf("Toeplitz matrix-vector product is wrong for dim = %i\n", d);
+        break;
+      }
+    // Make the matrix diagonally dominant for the solve, and compare the determinant to the LU one
+    matcomp1[0] += d;
+    toeplitz_comp_expandfull(matfull1, matcomp1, d);
+    res = toeplitz_solve(z, matcomp1, x, d);
+    square_matvec(y, matfull1, z, d);
+    for( i = 0; i < d; i++ )
+      if( res == 0 || fabs(y[i] - x[i]) > 1e-10 ){
+        printf("Toeplitz solve is wrong for dim = %i\n", d);
+        break;
+      }
+    // Same system scaled far below 1: the solution scales back, the matrix is not singular
+    for( i = 0; i < d; i++ )
+      matcomp2[i] = 1e-14 * matcomp1[i];
+    res = toeplitz_solve(y, matcomp2, x, d);
+    for( i = 0; i < d; i++ )
+      if( res == 0 || fabs(1e-14 * y[i] - z[i]) > 1e-10 * fabs(z[i]) ){
+        printf("Toeplitz solve is wrong for a scaled matrix of dim = %i\n", d);
+        break;
+      }
+    int *piv = (int*)calloc(d, sizeof(int));
+    square_lu(matfull1, piv, d);
+    resfull = 0.0;
+    for( i = 0; i < d; i++ )
+      resfull += log(fabs(matfull1[ square_ind(i,i,d) ]));
+    if( fabs(toeplitz_logdet(matcomp1, d) - resfull) > 1e-10 * d )
+      printf("Toeplitz logdet is wrong for dim = %i\n", d);
+    free(piv);
+    free(x);
+    free(y);
+    free(z);
+    free(matfull1);
+    free(matfull2);
+    free(matfull3);
+    free(matcomp1);
+    free(matcomp2);
+    free(matbisym);
+    free(matbisym2);
+  }
+
+  printf("Performing benchmark");
+
+  for( irepeat = 0; irepeat < NREPEAT; irepeat++ ){
+    fflush(NULL);
+    printf(".");
+
+    // Generate a random diagonally-dominant Toeplitz matrix and its full and bisymmetric forms
+    double *matfull, *matchol, *matbisym, *matcomp;
+    square_alloc(&matfull, dim);
+    square_alloc(&matchol, dim);
+    bisym_alloc(&matbisym, dim);
+    toeplitz_alloc(&matcomp, dim);
+    toeplitz_full_random(matfull, dim);
+    toeplitz_full_extractcomp(matcomp, matfull, dim);
+    matcomp[0] += dim;
+    toeplitz_comp_expandfull(matfull, matcomp, dim);
+    toeplitz_to_bisym(matbisym, matcomp, dim);
+
+    double *x = (double*)calloc(dim, sizeof(double));
+    double *yfull = (double*)calloc(dim, sizeof(double));
+    double *ycomp = (double*)calloc(dim, sizeof(double));
+    vector_random(x, dim);
+    vector_random(yfull, dim);
+
+    // Quadratic forms
+    resfull = resbisym = rescomp = 0.0;
+    fflush(NULL); t1 = timer_now();
+    for( irep = 0; irep < NREP; irep++ )
+      resfull += square_quadform(x, matfull, yfull, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_quadform_full += (t2 - t1);
+    fflush(NULL); t1 = timer_now();
+    for( irep = 0; irep < NREP; irep++ )
+      resbisym += bisym_quadform(x, matbisym, yfull, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_quadform_bisym += (t2 - t1);
+    fflush(NULL); t1 = timer_now();
+    for( irep = 0; irep < NREP; irep++ )
+      rescomp += toeplitz_quadform(x, matcomp, yfull, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_quadform_comp += (t2 - t1);
+    if( fabs(resfull - rescomp) > 1e-10 * fabs(resfull) ) printf("quadform_full is not equal to quadform_comp\n");
+    if( fabs(resfull - resbisym) > 1e-10 * fabs(resfull) ) printf("quadform_full is not equal to quadform_bisym\n");
+
+    // Matrix-vector products
+    fflush(NULL); t1 = timer_now();
+    for( irep = 0; irep < NREP; irep++ )
+      square_matvec(yfull, matfull, x, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_matvec_full += (t2 - t1);
+    fflush(NULL); t1 = timer_now();
+    for( irep = 0; irep < NREP; irep++ )
+      toeplitz_matvec(ycomp, matcomp, x, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_matvec_comp += (t2 - t1);
+    for( i = 0; i < dim; i++ )
+      if( fabs(yfull[i] - ycomp[i]) > 1e-10 * dim ){
+        printf("matvec_full is not equal to matvec_comp\n");
+        break;
+      }
+
+    // Linear solve (Cholesky for the full form) and log-determinant
+    fflush(NULL); t1 = timer_now();
+    memcpy(matchol, matfull, dim * dim * sizeof(double));
+    square_cholesky(matchol, dim);
+    square_cholesky_solve(yfull, matchol, x, 1, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_solve_full += (t2 - t1);
+    fflush(NULL); t1 = timer_now();
+    res = toeplitz_solve(ycomp, matcomp, x, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_solve_comp += (t2 - t1);
+    for( i = 0; i < dim; i++ )
+      if( res == 0 || fabs(yfull[i] - ycomp[i]) > 1e-10 ){
+        printf("solve_full is not equal to solve_comp\n");
+        break;
+      }
+    fflush(NULL); t1 = timer_now();
+    memcpy(matchol, matfull, dim * dim * sizeof(double));
+    square_cholesky(matchol, dim);
+    resfull = 0.0;
+    for( i = 0; i < dim; i++ )
+      resfull += 2.0 * log(matchol[ square_ind(i,i,dim) ]);
+    fflush(NULL); t2 = timer_now();
+    tmean_logdet_full += (t2 - t1);
+    fflush(NULL); t1 = timer_now();
+    rescomp = toeplitz_logdet(matcomp, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_logdet_comp += (t2 - t1);
+    if( fabs(resfull - rescomp) > 1e-10 * fabs(resfull) ) printf("logdet_full is not equal to logdet_comp\n");
+
+    free(x);
+    free(yfull);
+    free(ycomp);
+    free(matfull);
+    free(matchol);
+    free(matbisym);
+    free(matcomp);
+  }
+
+  printf("done\n");
+  printf("> Memory gain due to compressed form : %2.2f (%2.2f w.r.t. the bisymmetric form)\n",
+    ((double)dim*dim)/toeplitz_size(dim), ((double)bisym_size(dim))/toeplitz_size(dim) );
+  printf("> Quadratic form acceleration factor : %2.2f (%2.2f w.r.t. the bisymmetric form)\n",
+    tmean_quadform_full / tmean_quadform_comp, tmean_quadform_bisym / tmean_quadform_comp );
+  printf("> Matrix-vector product acceleration factor : %2.2f \n", tmean_matvec_full / tmean_matvec_comp );
+  printf("> Linear solve acceleration factor (Levinson vs Cholesky) : %2.2f \n", tmean_solve_full / tmean_solve_comp );
+  printf("> Log-determinant acceleration factor (Durbin vs Cholesky) : %2.2f \n", tmean_logdet_full / tmean_logdet_comp );
+
+  // Large sizes, where neither the full nor the bisymmetric form fit in memory:
+  // exponential covariance, with a few rows of the products checked directly
+  printf("Large sizes (exponential covariance)\n");
+  for( dimlarge = 1024; dimlarge <= dimmax; dimlarge *= 4 ){
+    double *matcomp;
+    toeplitz_alloc(&matcomp, dimlarge);
+    for( j = 0; j < dimlarge; j++ )
+      matcomp[j] = exp(- j / 100.0);
+    double *x = (double*)calloc(dimlarge, sizeof(double));
+    double *y = (double*)calloc(dimlarge, sizeof(double));
+    vector_random(x, dimlarge);
+
+    fflush(NULL); t1 = timer_now();
+    toeplitz_matvec(y, matcomp, x, dimlarge);
+    fflush(NULL); t2 = timer_now();
+    t_matvec = (t2 - t1);
+    for( i = 0; i < dimlarge; i += dimlarge / 7 ){
+      resfull = 0.0;
+      for( j = 0; j < dimlarge; j++ )
+        resfull += matcomp[ toeplitz_ind(i,j,dimlarge) ] * x[j];
+      if( fabs(resfull - y[i]) > 1e-10 * fabs(resfull) ){
+        printf("Toeplitz matrix-vector product is wrong for dim = %i\n", dimlarge);
+        break;
+      }
+    }
+
+    // The O(dim^2) solve is only timed at moderate sizes
+    t_solve = 0.0;
+    if( dimlarge <= 16384 ){
+      fflush(NULL); t1 = timer_now();
+      res = toeplitz_solve(x, matcomp, y, dimlarge);
+      fflush(NULL); t2 = timer_now();
+      t_solve = (t2 - t1);
+      toeplitz_matvec(x, matcomp, x, dimlarge);
+      for( i = 0; i < dimlarge; i++ )
+        if( res == 0 || fabs(x[i] - y[i]) > 1e-8 * fabs(y[i]) ){
+          printf("Toeplitz solve is wrong for dim = %i\n", dimlarge);
+          break;
+        }
+    }
+    printf("> dim = %8i : bisymmetric form %10.2f MB, matvec %8.4f s", dimlarge,
+      (double)dimlarge * (dimlarge + 2) / 4 * sizeof(double) / 1e6, t_matvec);
+    if( t_solve > 0.0 )
+      printf(", solve %8.4f s", t_solve);
+    printf("\n");
+
+    free(x);
+    free(y);
+    free(matcomp);
+  }
+
+  printf("----------------------------------------------");
+
+}
+
  
+double test_precision_relerr(const float *res, const double *ref, long n)
+{
+  long t;
+  double err = 0.0, norm = 0.0;
+  for( t = 0; t < n; t++ ){
+    err = MAX(err, fabs(res[t] - ref[t]));
+    norm = MAX(norm, fabs(ref[t]));
+  }
+  return err / MAX(norm, DBL_MIN);
+}
+
+
+void test_precision(int NREPEAT, int dim)
+{
+  int k, irepeat;
+  // Accumulating in single precision loses up to dim roundings, in double only the final ones
+  const double tolf = dim * FLT_EPSILON, tolfd = 4 * FLT_EPSILON;
+  const char *names[3] = { "square", "centrosym", "bisym" };
+  long sizes[3] = { (long)dim * dim, centrosym_size(dim), bisym_size(dim) };
+  double t1, t2, tmean_double = 0, tmean_f = 0, tmean_fd = 0;
+  double err[2], ref, res[2];
+  double *matfull, *matd1, *matd2, *matd3;
+  float *matf1, *matf2, *matf3;
+  double *x = (double*)calloc(dim, sizeof(double));
+  double *y = (double*)calloc(dim, sizeof(double));
+  float *xf = (float*)calloc(dim, sizeof(float));
+  float *yf = (float*)calloc(dim, sizeof(float));
+  square_alloc(&matfull, dim);
+  square_alloc(&matd1, dim);
+  square_alloc(&matd2, dim);
+  square_alloc(&matd3, dim);
+  square_alloc_f(&matf1, dim);
+  square_alloc_f(&matf2, dim);
+  square_alloc_f(&matf3, dim);
+
+  printf("\n==============================================\n");
+  printf("Testing single and mixed precision kernels\n");
+  printf("----------------------------------------------\n");
+  printf("> Tolerances (relative) : %.1e in single, %.1e in mixed precision\n", tolf, tolfd);
+
+  // The double precision kernels on the rounded matrices are the reference,
+  // so that only the accumulation errors are measured
+  vector_random(x, dim);
+  vector_random(y, dim);
+  vector_to_float(xf, x, dim);
+  vector_to_float(yf, y, dim);
+  vector_to_double(x, xf, dim);
+  vector_to_double(y, yf, dim);
+  for( k = 0; k < 3; k++ ){
+    if( k == 0 ){
+      square_random(matfull, dim);
+      square_symmetrise(matfull, dim);
+      vector_to_float(matf1, matfull, sizes[k]);
+      square_random(matfull, dim);
+      square_symmetrise(matfull, dim);
+      vector_to_float(matf2, matfull, sizes[k]);
+    } else if( k == 1 ){
+      centrosym_full_random(matfull, dim);
+      centrosym_full_extractcomp_f(matf1, matfull, dim);
+      centrosym_full_random(matfull, dim);
+      centrosym_full_extractcomp_f(matf2, matfull, dim);
+    } else {
+      bisym_full_random(matfull, dim);
+      bisym_full_extractcomp_f(matf1, matfull, dim);
+      bisym_full_random(matfull, dim);
+      bisym_full_extractcomp_f(matf2, matfull, dim);
+    }
+    vector_to_double(matd1, matf1, sizes[k]);
+    vector_to_double(matd2, matf2, sizes[k]);
+
+    // Products (the product of bisymmetric matrices is centrosymmetric)
+    if( k == 0 ){
+      square_product(matd3, matd1, matd2, dim);
+      square_product_f(matf3, matf1, matf2, dim);
+      err[0] = test_precision_relerr(matf3, matd3, sizes[0]);
+      square_product_fd(matf3, matf1, matf2, dim);
+      err[1] = test_precision_relerr(matf3, matd3, sizes[0]);
+    } else if( k == 1 ){
+      centrosym_product(matd3, matd1, matd2, dim);
+      centrosym_product_f(matf3, matf1, matf2, dim);
+      err[0] = test_precision_relerr(matf3, matd3, sizes[1]);
+      centrosym_product_fd(matf3, matf1, matf2, dim);
+      err[1] = test_precision_relerr(matf3, matd3, sizes[1]);
+    } else {
+      bisym_product(matd3, matd1, matd2, dim);
+      bisym_product_f(matf3, matf1, matf2, dim);
+      err[0] = test_precision_relerr(matf3, matd3, sizes[1]);
+      bisym_product_fd(matf3, matf1, matf2, dim);
+      err[1] = test_precision_relerr(matf3, matd3, sizes[1]);
+    }
+    printf("> %-9s product   : relative error %.1e in single, %.1e in mixed precision\n", names[k], err[0], err[1]);
+    if( err[0] > tolf ) printf("%s_product_f is wrong\n", names[k]);
+    if( err[1] > tolfd ) printf("%s_product_fd is wrong\n", names[k]);
+
+    // Trace-products
+    if( k == 0 ){
+      ref = square_traceprod(matd1, matd2, dim);
+      res[0] = square_traceprod_f(matf1, matf2, dim);
+      res[1] = square_traceprod_fd(matf1, matf2, dim);
+    } else if( k == 1 ){
+      ref = centrosym_traceprod(matd1, matd2, dim);
+      res[0] = centrosym_traceprod_f(matf1, matf2, dim);
+      res[1] = centrosym_traceprod_fd(matf1, matf2, dim);
+    } else {
+      ref = bisym_traceprod(matd1, matd2, dim);
+      res[0] = bisym_traceprod_f(matf1, matf2, dim);
+      res[1] = bisym_traceprod_fd(matf1, matf2, dim);
+    }
+    if( fabs(res[0] - ref) > tolf * fabs(ref) ) printf("%s_traceprod_f is wrong : %e vs %e\n", names[k], res[0], ref);
+    if( fabs(res[1] - ref) > tolfd * fabs(ref) ) printf("%s_traceprod_fd is wrong : %e vs %e\n", names[k], res[1], ref);
+
+    // Quadratic forms
+    if( k == 0 ){
+      ref = square_quadform(x, matd1, y, dim);
+      res[0] = square_quadform_f(xf, matf1, yf, dim);
+      res[1] = square_quadform_fd(xf, matf1, yf, dim);
+    } else if( k == 1 ){
+      ref = centrosym_quadform(x, matd1, y, dim);
+      res[0] = centrosym_quadform_f(xf, matf1, yf, dim);
+      res[1] = centrosym_quadform_fd(xf, matf1, yf, dim);
+    } else {
+      ref = bisym_quadform(x, matd1, y, dim);
+      res[0] = bisym_quadform_f(xf, matf1, yf, dim);
+      res[1] = bisym_quadform_fd(xf, matf1, yf, dim);
+    }
+    if( fabs(res[0] - ref) > tolf * fabs(ref) ) printf("%s_quadform_f is wrong : %e vs %e\n", names[k], res[0], ref);
+    if( fabs(res[1] - ref) > tolfd * fabs(ref) ) printf("%s_quadform_fd is wrong : %e vs %e\n", names[k], res[1], ref);
+
+    // Matrix-vector products (the folded vectors are rounded to float in mixed precision too)
+    if( k == 0 ){
+      square_matvec(matd3, matd1, x, dim);
+      square_matvec_f(matf3, matf1, xf, dim);
+      err[0] = test_precision_relerr(matf3, matd3, dim);
+      square_matvec_fd(matf3, matf1, xf, dim);
+      err[1] = test_precision_relerr(matf3, matd3, dim);
+    } else if( k == 1 ){
+      centrosym_matvec(matd3, matd1, x, dim);
+      centrosym_matvec_f(matf3, matf1, xf, dim);
+      err[0] = test_precision_relerr(matf3, matd3, dim);
+      centrosym_matvec_fd(matf3, matf1, xf, dim);
+      err[1] = test_precision_relerr(matf3, matd3, dim);
+    } else {
+      bisym_matvec(matd3, matd1, x, dim);
+      bisym_matvec_f(matf3, matf1, xf, dim);
+      err[0] = test_precision_relerr(matf3, matd3, dim);
+      bisym_matvec_fd(matf3, matf1, xf, dim);
+      err[1] = test_precision_relerr(matf3, matd3, dim);
+    }
+    printf("> %-9s matvec    : relative error %.1e in single, %.1e in mixed precision\n", names[k], err[0], err[1]);
+    if( err[0] > tolf ) printf("%s_matvec_f is wrong\n", names[k]);
+    if( err[1] > tolfd ) printf("%s_matvec_fd is wrong\n", names[k]);
+  }
+
+  // Benchmark of the centrosymmetric product (matrices of the last iteration, stored as centrosym)
+  centrosym_full_random(matfull, dim);
+  centrosym_full_extractcomp(matd1, matfull, dim);
+  centrosym_full_extractcomp_f(matf1, matfull, dim);
+  for( irepeat = 0; irepeat < NREPEAT; irepeat++ ){
+    fflush(NULL); t1 = timer_now();
+    centrosym_product(matd3, matd1, matd1, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_double += (t2 - t1) / NREPEAT;
+    fflush(NULL); t1 = timer_now();
+    centrosym_product_f(matf3, matf1, matf1, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_f += (t2 - t1) / NREPEAT;
+    fflush(NULL); t1 = timer_now();
+    centrosym_product_fd(matf3, matf1, matf1, dim);
+    fflush(NULL); t2 = timer_now();
+    tmean_fd += (t2 - t1) / NREPEAT;
+  }
+  printf("> Acceleration factor of centrosym_product_f (vs double)  : %2.2f \n", tmean_double / tmean_f);
+  printf("> Acceleration factor of centrosym_product_fd (vs double) : %2.2f \n", tmean_double / tmean_fd);
+
+  free(x);
+  free(y);
+  free(xf);
+  free(yf);
+  free(matfull);
+  free(matd1);
+  free(matd2);
+  free(matd3);
+  free(matf1);
+  free(matf2);
+  free(matf3);
+
+  printf("----------------------------------------------");
+
+}
+
+
 int main(int argc, char *argv[]) 
 {
 
@@ -270,13 +2583,56 @@ int main(int argc, char *argv[])
   printf("\n");
   printf("Size of square matrices : %i x %i\n", dim, dim);
   printf("Number of realisations  : %i\n", NREPEAT);
+  printf("Number of threads       : %i\n", parallel_threads());
+
+  // Testing vectorised kernels
+  test_simd(dim);
+
+  // Testing counter-based random numbers
+  test_random(dim);
+
+  // Testing workspaces
+  test_workspace(dim);
+
+  // Testing 64-bit indexing
+  test_indexing();
+
+  // Testing binary matrix files
+  test_matfile(dim);
+
+  // Testing out-of-core products
+  test_outofcore(dim);
 
   // Testing centrosymmetric matrices
   test_centrosym(NREPEAT, dim);
 
+  // Testing batched trace-products of centrosymmetric matrices
+  test_centrosym_batch(NREPEAT, dim, 32);
+
+  // Testing products of centrosymmetric and dense matrices
+  test_centrosym_dense(NREPEAT, dim);
+
+  // Testing inverse and solve of centrosymmetric matrices
+  test_centrosym_solve(NREPEAT, dim);
+
   // Testing bisymmetric matrices
   test_bisym(NREPEAT, dim);
 
+  // Testing properties of symmetric matrices
+  test_symmat(NREPEAT, dim);
+
+  // Testing symmetric Toeplitz matrices, up to 1e6
+  test_toeplitz(NREPEAT, dim, 1048576);
+
+  // Testing the diagonal-major form of centrosymmetric matrices
+  test_centrodiag(NREPEAT, dim);
+
+  // Testing eigendecomposition of bisymmetric matrices
+  test_bisym_eig(NREPEAT, dim);
+
+  // Testing single and mixed precision kernels
+  test_precision(NREPEAT, dim);
+
   
   printf("\n==============================================\n");
   return 0;
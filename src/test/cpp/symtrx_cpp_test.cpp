@@ -0,0 +1,277 @@
+// Symmetrix (SMTRX) package
+// Copyright (C) 2012
+// Boris Leistedt
+
+#include "symtrx.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+#define MAX(a,b) ((a) > (b) ? (a) : (b))
+#define MIN(a,b) ((a) > (b) ? (b) : (a))
+
+using namespace symtrx;
+
+// The types of the products are deduced from the structure of the operands
+static_assert(std::is_same<Product< Bisym<double>, Bisym<double> >::result_type, Centrosym<double> >::value, "bisym * bisym is centrosym");
+static_assert(std::is_same<Product< Bisym<float>, Bisym<float> >::result_type, Centrosym<float> >::value, "bisym * bisym is centrosym");
+static_assert(std::is_same<Product< Centrosym<double, DiagMajor>, Centrosym<double, DiagMajor> >::result_type,
+  Centrosym<double, DiagMajor> >::value, "the layout is kept");
+static_assert(std::is_same<Product< Product< Bisym<double>, Bisym<double> >, Centrosym<double> >::result_type,
+  Centrosym<double> >::value, "products of products");
+
+
+int relerr_wrong(double res, double ref, double tol)
+{
+  return fabs(res - ref) > tol * MAX(1.0, fabs(ref));
+}
+
+
+template<class T>
+int vector_wrong(const Vector<T> &z, const double *ref, double tol)
+{
+  int k;
+  for( k = 0; k < z.dim(); k++ )
+    if( relerr_wrong(z[k], ref[k], tol) )
+      return 1;
+  return 0;
+}
+
+
+void test_cpp(int dim)
+{
+  int k;
+  double t1, t2, tfused, tformed;
+  double *matfull1, *matfull2, *ref1, *ref2, *ref3, *vec1, *vec2;
+  square_alloc(&matfull1, dim);
+  square_alloc(&matfull2, dim);
+  square_alloc(&ref1, dim);
+  square_alloc(&ref2, dim);
+  square_alloc(&ref3, dim);
+  vec1 = (double*)calloc(dim, sizeof(double));
+  vec2 = (double*)calloc(dim, sizeof(double));
+  Vector<double> x(dim), y(dim);
+  Vector<float> xf(dim), yf(dim);
+  vector_random(x.data(), dim);
+  vector_random(y.data(), dim);
+  vector_to_float(xf.data(), x.data(), dim);
+  vector_to_float(yf.data(), y.data(), dim);
+
+  printf("\n==============================================\n");
+  printf("Testing the C++ layer (dimension %i)\n", dim);
+  printf("----------------------------------------------\n");
+
+  // Centrosymmetric matrices: the expressions call the same kernels as the C API
+  centrosym_full_random(matfull1, dim);
+  centrosym_full_random(matfull2, dim);
+  {
+    Centrosym<double> A = Centrosym<double>::from_full(matfull1, dim);
+    Centrosym<double> B = Centrosym<double>::from_full(matfull2, dim);
+    Centrosym<double> C = A * B;
+    centrosym_product(ref1, A.data(), B.data(), dim);
+    if( centrosym_assertequal(C.data(), ref1, dim) == 0 ) printf("Centrosym product is wrong\n");
+    if( trace(A * B) != centrosym_traceprod(A.data(), B.data(), dim) ) printf("Centrosym trace(A * B) is wrong\n");
+    if( relerr_wrong(trans(x) * (A * B) * y, centrosym_quadform(x.data(), ref1, y.data(), dim), 1e-12) )
+      printf("Centrosym x^t (A * B) y is wrong\n");
+    if( quadform(x, A, y) != centrosym_quadform(x.data(), A.data(), y.data(), dim) ) printf("Centrosym quadform is wrong\n");
+    Vector<double> z = A * B * x;
+    centrosym_matvec(vec1, ref1, x.data(), dim);
+    for( k = 0; k < dim; k++ )
+      if( relerr_wrong(z[k], vec1[k], 1e-12) ){
+        printf("Centrosym (A * B) * x is wrong\n");
+        break;
+      }
+    // Products of products: trace(A * B * A) forms A * B only
+    centrosym_product(ref2, ref1, A.data(), dim);
+    if( relerr_wrong(trace(A * B * A), centrosym_trace(ref2, dim), 1e-12) ) printf("Centrosym trace(A * B * A) is wrong\n");
+    // Aliased assignments go through a new matrix
+    C = C * B;
+    centrosym_product(ref2, ref1, B.data(), dim);
+    if( centrosym_assertequal(C.data(), ref2, dim) == 0 ) printf("Centrosym aliased product is wrong\n");
+    z = A * z;
+    centrosym_matvec(vec2, A.data(), vec1, dim);
+    for( k = 0; k < dim; k++ )
+      if( relerr_wrong(z[k], vec2[k], 1e-12) ){
+        printf("Centrosym aliased matrix-vector product is wrong\n");
+        break;
+      }
+
+    // Fused trace-product against the product followed by the trace
+    fflush(NULL); t1 = timer_now();
+    trace(A * B);
+    fflush(NULL); t2 = timer_now();
+    tfused = t2 - t1;
+    fflush(NULL); t1 = timer_now();
+    trace(eval(A * B));
+    fflush(NULL); t2 = timer_now();
+    tformed = t2 - t1;
+    printf("> Acceleration factor of trace(A * B) over trace(eval(A * B)) : %2.2f \n", tformed / tfused);
+  }
+
+  // Diagonal-major form
+  {
+    Centrosym<double, DiagMajor> A = Centrosym<double, DiagMajor>::from_full(matfull1, dim);
+    Centrosym<double, DiagMajor> B = Centrosym<double, DiagMajor>::from_full(matfull2, dim);
+    Centrosym<double, DiagMajor> C = A * B;
+    centrodiag_product(ref1, A.data(), B.data(), dim);
+    if( memcmp(C.data(), ref1, C.size() * sizeof(double)) != 0 ) printf("Centrosym<DiagMajor> product is wrong\n");
+    if( trace(A * B) != centrodiag_traceprod(A.data(), B.data(), dim) ) printf("Centrosym<DiagMajor> trace(A * B) is wrong\n");
+    if( relerr_wrong(trans(x) * (A * B) * y, centrodiag_quadform(x.data(), ref1, y.data(), dim), 1e-12) )
+      printf("Centrosym<DiagMajor> x^t (A * B) y is wrong\n");
+    // Matrix-vector products go through the row-major form
+    Vector<double> z = A * B * x;
+    centrodiag_to_centrosym(ref2, ref1, dim);
+    centrosym_matvec(vec1, ref2, x.data(), dim);
+    if( vector_wrong(z, vec1, 1e-12) ) printf("Centrosym<DiagMajor> (A * B) * x is wrong\n");
+  }
+
+  // Single precision
+  {
+    Centrosym<float> A = Centrosym<float>::from_full(matfull1, dim);
+    Centrosym<float> B = Centrosym<float>::from_full(matfull2, dim);
+    Centrosym<float> C = A * B;
+    Centrosym<float> Cref(dim);
+    centrosym_product_f(Cref.data(), A.data(), B.data(), dim);
+    if( memcmp(C.data(), Cref.data(), C.size() * sizeof(float)) != 0 ) printf("Centrosym<float> product is wrong\n");
+    if( trace(A * B) != centrosym_traceprod_f(A.data(), B.data(), dim) ) printf("Centrosym<float> trace(A * B) is wrong\n");
+    if( relerr_wrong(trans(xf) * (A * B) * yf, centrosym_quadform_f(xf.data(), Cref.data(), yf.data(), dim), dim * FLT_EPSILON) )
+      printf("Centrosym<float> x^t (A * B) y is wrong\n");
+    // Chain of matrix-vector products, against the same one in double precision
+    Vector<float> zf = A * B * xf;
+    vector_to_double(ref1, A.data(), A.size());
+    vector_to_double(ref2, B.data(), B.size());
+    vector_to_double(vec1, xf.data(), dim);
+    centrosym_matvec(vec2, ref2, vec1, dim);
+    centrosym_matvec(vec1, ref1, vec2, dim);
+    if( vector_wrong(zf, vec1, dim * FLT_EPSILON) ) printf("Centrosym<float> (A * B) * x is wrong\n");
+  }
+
+  // Bisymmetric matrices: the product is centrosymmetric
+  bisym_full_random(matfull1, dim);
+  bisym_full_random(matfull2, dim);
+  {
+    Bisym<double> A = Bisym<double>::from_full(matfull1, dim);
+    Bisym<double> B = Bisym<double>::from_full(matfull2, dim);
+    Centrosym<double> C = A * B;
+    bisym_product(ref1, A.data(), B.data(), dim);
+    if( centrosym_assertequal(C.data(), ref1, dim) == 0 ) printf("Bisym product is wrong\n");
+    if( trace(A * B) != bisym_traceprod(A.data(), B.data(), dim) ) printf("Bisym trace(A * B) is wrong\n");
+    if( relerr_wrong(trans(x) * (A * B) * y, centrosym_quadform(x.data(), ref1, y.data(), dim), 1e-12) )
+      printf("Bisym x^t (A * B) y is wrong\n");
+    Vector<double> z = A * B * x;
+    centrosym_matvec(vec1, ref1, x.data(), dim);
+    for( k = 0; k < dim; k++ )
+      if( relerr_wrong(z[k], vec1[k], 1e-12) ){
+        printf("Bisym (A * B) * x is wrong\n");
+        break;
+      }
+    Vector<double> w = A * x;
+    square_matvec(vec2, matfull1, x.data(), dim);
+    if( vector_wrong(w, vec2, 1e-12) ) printf("Bisym A * x is wrong\n");
+    if( relerr_wrong(trace(A * B * C), centrosym_traceprod(ref1, C.data(), dim), 1e-12) )
+      printf("Bisym trace(A * B * C) is wrong\n");
+    Bisym<float> Af = Bisym<float>::from_full(matfull1, dim);
+    Bisym<float> Bf = Bisym<float>::from_full(matfull2, dim);
+    if( relerr_wrong(trace(Af * Bf), trace(A * B), dim * FLT_EPSILON) ) printf("Bisym<float> trace(A * B) is wrong\n");
+    Vector<float> zf = Af * Bf * xf;
+    if( vector_wrong(zf, z.data(), dim * FLT_EPSILON) ) printf("Bisym<float> (A * B) * x is wrong\n");
+  }
+
+  // Square matrices
+  square_random(matfull1, dim);
+  square_random(matfull2, dim);
+  {
+    Square<double> A = Square<double>::from_full(matfull1, dim);
+    Square<double> B = Square<double>::from_full(matfull2, dim);
+    Square<double> C = A * B;
+    square_product(ref1, matfull1, matfull2, dim);
+    if( memcmp(C.data(), ref1, C.size() * sizeof(double)) != 0 ) printf("Square product is wrong\n");
+    if( trace(A * B) != square_traceprod(matfull1, matfull2, dim) ) printf("Square trace(A * B) is wrong\n");
+    if( relerr_wrong(trans(x) * (A * B) * y, square_quadform(x.data(), ref1, y.data(), dim), 1e-12) )
+      printf("Square x^t (A * B) y is wrong\n");
+    square_product(ref3, ref1, matfull1, dim);
+    if( relerr_wrong(trans(x) * (A * B * A) * y, square_quadform(x.data(), ref3, y.data(), dim), 1e-12) )
+      printf("Square x^t (A * B * A) y is wrong\n");
+    Square<double> D(C);
+    D = D * D;
+    square_product(ref2, ref1, ref1, dim);
+    if( memcmp(D.data(), ref2, D.size() * sizeof(double)) != 0 ) printf("Square aliased product is wrong\n");
+    Square<float> Af = Square<float>::from_full(matfull1, dim);
+    Vector<float> wf = Af * xf;
+    square_matvec(vec1, matfull1, x.data(), dim);
+    if( vector_wrong(wf, vec1, dim * FLT_EPSILON) ) printf("Square<float> A * x is wrong\n");
+  }
+
+  // Copy and move assignments, between matrices of different dimensions
+  {
+    Square<double> A = Square<double>::from_full(matfull1, dim);
+    Square<double> B(1), C(1);
+    B = A;
+    if( B.dim() != dim || memcmp(B.data(), A.data(), A.size() * sizeof(double)) != 0 ) printf("Square copy assignment is wrong\n");
+    B[0] += 1.0;
+    if( A[0] == B[0] ) printf("Square copy assignment shares the elements\n");
+    const double *data = A.data();
+    C = std::move(A);
+    if( C.dim() != dim || C.data() != data ) printf("Square move assignment is wrong\n");
+    centrosym_full_random(ref1, dim);
+    Centrosym<double> D = Centrosym<double>::from_full(ref1, dim);
+    Centrosym<double> E(1), F(1);
+    E = D;
+    if( E.dim() != dim || centrosym_assertequal(E.data(), D.data(), dim) == 0 ) printf("Centrosym copy assignment is wrong\n");
+    data = D.data();
+    F = std::move(D);
+    if( F.dim() != dim || F.data() != data ) printf("Centrosym move assignment is wrong\n");
+    bisym_full_random(ref1, dim);
+    Bisym<float> G = Bisym<float>::from_full(ref1, dim);
+    Bisym<float> H(1), I(1);
+    H = G;
+    if( H.dim() != dim || memcmp(H.data(), G.data(), G.size() * sizeof(float)) != 0 ) printf("Bisym<float> copy assignment is wrong\n");
+    const float *dataf = G.data();
+    I = std::move(G);
+    if( I.dim() != dim || I.data() != dataf ) printf("Bisym<float> move assignment is wrong\n");
+    Vector<double> u(1), v(1);
+    u = x;
+    if( u.dim() != dim || memcmp(u.data(), x.data(), dim * sizeof(double)) != 0 ) printf("Vector copy assignment is wrong\n");
+    data = u.data();
+    v = std::move(u);
+    if( v.dim() != dim || v.data() != data ) printf("Vector move assignment is wrong\n");
+  }
+
+  // Mismatched dimensions
+  {
+    Centrosym<double> A(dim), B(dim + 1);
+    int thrown = 0;
+    try{
+      trace(A * B);
+    } catch( const std::invalid_argument & ){
+      thrown = 1;
+    }
+    if( thrown == 0 ) printf("mismatched dimensions are accepted\n");
+  }
+
+  free(matfull1);
+  free(matfull2);
+  free(ref1);
+  free(ref2);
+  free(ref3);
+  free(vec1);
+  free(vec2);
+
+  printf("----------------------------------------------");
+
+}
+
+
+int main(int argc, char *argv[])
+{
+
+  // Even and odd dimensions
+  test_cpp(256);
+  test_cpp(9);
+
+  printf("\n==============================================\n");
+  return 0;
+
+}